@@ -0,0 +1,80 @@
+/*
+ * boot_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * A/B bootloader, linked at 0x0000 and started on every reset.
+ *
+ * Boots the newest slot whose header and image CRC-32 check out. An image
+ * that the application has not confirmed yet is given SM_FW_MAX_BOOT_ATTEMPTS
+ * resets, after which the previous slot is booted again.
+ *
+ * The selected slot is mapped to address 0 with FMC_ISPCMD_VECMAP, which needs
+ * CONFIG0 CBS set to boot from APROM with IAP enabled, and started by a CPU
+ * reset. A chip reset clears the map and comes back here.
+ */
+
+#include "NuMicro.h"
+#include "sm_fw_image.h"
+#include "sm_flash.h"
+#include "sm_crc.h"
+#include "sm_ramfunc.h"
+
+/* Runs from SRAM: once VECMAP is set, page 0 is the application's first
+ * page, so nothing after the ISP trigger may be fetched from it. The CPU
+ * reset then starts the application from its own vector table at address 0,
+ * VECMAP is kept across it. Registers stay unlocked for IPRST0 */
+static SM_RAMFUNC void boot_remap(uint32_t _addr){
+	__disable_irq();
+
+	/* FMC_SetVectorPageAddr() spelled out, it must not be an out of line copy in flash */
+	FMC->ISPCMD = FMC_ISPCMD_VECMAP;
+	FMC->ISPADDR = _addr;
+	FMC->ISPTRG = 0x1u;
+	__ISB();
+	while(FMC->ISPTRG);
+
+	FMC_DISABLE_ISP();
+
+	SYS->IPRST0 |= SYS_IPRST0_CPURST_Msk;
+	while(1);
+}
+
+static void boot_jump(uint32_t _addr){
+	CLK_DisableModuleClock(CRC_MODULE);
+
+	FMC_Open();
+	boot_remap(_addr);
+}
+
+int main(void){
+	int32_t slot;
+	uint32_t addr;
+
+	SYS_UnlockReg();
+
+	sm_flash_init();
+	sm_crc_init();
+
+	slot = sm_fw_image_select();
+
+	if(slot >= 0){
+		if(sm_fw_image_get_header((uint8_t)slot)->m_confirmed != 0)
+			sm_fw_image_consume_attempt((uint8_t)slot);
+
+		addr = SM_FW_SLOT_ADDR(slot);
+	}else if(sm_fw_image_vectors_valid(SM_FW_SLOT_A_ADDR)){
+		/* Factory image flashed without a header */
+		addr = SM_FW_SLOT_A_ADDR;
+	}else{
+		/* Nothing bootable, wait for ICP/LDROM programming */
+		while(1);
+	}
+
+	boot_jump(addr);
+
+	while(1);
+}
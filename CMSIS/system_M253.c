@@ -19,6 +19,11 @@
 
 extern void *__Vectors;                   /* see startup file */
 
+/* Raise HCLK in SystemInit, define NO_INIT_SYSCLK_AT_BOOTING to keep the reset clock */
+#if !defined(INIT_SYSCLK_AT_BOOTING) && !defined(NO_INIT_SYSCLK_AT_BOOTING)
+    #define INIT_SYSCLK_AT_BOOTING
+#endif
+
 /*----------------------------------------------------------------------------
   Clock Variable definitions
  *----------------------------------------------------------------------------*/
@@ -83,7 +88,21 @@ void SystemInit(void)
 #endif
 
 #ifdef INIT_SYSCLK_AT_BOOTING
-
+    /* HCLK = HIRC 48MHz / 1 before the C runtime starts, so the RAM set-up in
+       Reset_Handler already runs at full speed. Registers were unlocked by the
+       startup. A HIRC that never becomes stable leaves the reset clock as is */
+    {
+        uint32_t u32TimeOut = 0x10000UL;
+
+        CLK->PWRCTL |= CLK_PWRCTL_HIRCEN_Msk;
+        while (!(CLK->STATUS & CLK_STATUS_HIRCSTB_Msk) && --u32TimeOut) ;
+
+        if (u32TimeOut)
+        {
+            CLK->CLKDIV0 = (CLK->CLKDIV0 & ~CLK_CLKDIV0_HCLKDIV_Msk) | CLK_CLKDIV0_HCLK(1);
+            CLK->CLKSEL0 = (CLK->CLKSEL0 & ~CLK_CLKSEL0_HCLKSEL_Msk) | CLK_CLKSEL0_HCLKSEL_HIRC;
+        }
+    }
 #endif
 
 }
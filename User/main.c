@@ -1,6 +1,190 @@
 #include "sm_board.h"
+#include "sm_clock.h"
+#include "sm_ramfunc.h"
+#include "sm_uart.h"
+#include "sm_ram.h"
+#include "sm_prof.h"
+#include "sm_fw_update.h"
+#include "sm_usb_cdc.h"
+#include "sm_fw_link.h"
+#include "sm_kernel.h"
+#include "sm_relay_pmm.h"
+#include "sm_pwrfail_pmm.h"
 
+#include <string.h>
+
+#define SM_MAIN_DEBUG_PRIORITY      3
+#define SM_MAIN_USB_PRIORITY        2
+#define SM_MAIN_RS485_PRIORITY      2
+#define SM_MAIN_RELAY_PRIORITY      1
+#define SM_MAIN_PWRFAIL_PRIORITY    1
+
+#define SM_MAIN_CMD_SIZE            16
+
+/* Threads: the relay supervision preempts the protocol handlers */
+#define SM_MAIN_RELAY_THREAD_PRIO   1
+#define SM_MAIN_RELAY_STACK_SIZE    256
+#define SM_MAIN_RELAY_PERIOD        10      /* ticks */
+#define SM_MAIN_PROTO_THREAD_PRIO   3
+#define SM_MAIN_PROTO_STACK_SIZE    1024
+
+/* Update frames on RS485 port 1: this node's address, and the silence that
+ * ends a frame, four characters of 10 bits */
+#define SM_MAIN_FW_LINK_ADDR        0x01
+#define SM_MAIN_FW_LINK_IDLE_US     (40000000UL / uart_rs485_1.m_baudrate)
+
+/* A console line per port: both ports take the same commands */
+typedef struct sm_main_console{
+	sm_fmt_write_fn_t m_write;
+	void* m_arg;
+	uint8_t m_len;
+	char m_cmd[SM_MAIN_CMD_SIZE];
+}sm_main_console_t;
+
+static sm_uart_t* g_debug;
+static uint8_t g_usb_open;
+static SM_FW_UPDATE_STATE g_fw_state;
+static sm_fw_link_t g_fw_link;
+static sm_main_console_t g_console_uart;
+static sm_main_console_t g_console_usb = {.m_write = sm_usb_cdc_print};
+static uint32_t g_relay_stack[SM_MAIN_RELAY_STACK_SIZE / 4] __attribute__((aligned(8)));
+static uint32_t g_proto_stack[SM_MAIN_PROTO_STACK_SIZE / 4] __attribute__((aligned(8)));
+
+/* sm_fmt output of the reports, on the debug UART */
+static void sm_main_print(const char* _str, uint32_t _len, void* _arg){
+	sm_uart_write(_arg, (const uint8_t*)_str, (uint16_t)_len);
+}
+
+/* The profiler's commands first, then the reports of main's modules */
+static void sm_main_command(sm_main_console_t* _this){
+	if(!sm_prof_command(_this->m_cmd, _this->m_write, _this->m_arg))
+		return;
+
+	if(!strcmp(_this->m_cmd, "ram"))
+		sm_ram_report(_this->m_write, _this->m_arg);
+	else if(!strcmp(_this->m_cmd, "kernel"))
+		sm_kernel_dump(_this->m_write, _this->m_arg);
+	else if(!strcmp(_this->m_cmd, "pwrfail"))
+		sm_pwrfail_dump(_this->m_write, _this->m_arg);
+}
+
+static void sm_main_console_input(sm_main_console_t* _this, const uint8_t* _buf, int32_t _len){
+	for(int32_t i = 0; i < _len; i++){
+		char c = (char)_buf[i];
+
+		if(c == '\r' || c == '\n'){
+			_this->m_cmd[_this->m_len] = '\0';
+			if(_this->m_len)
+				sm_main_command(_this);
+			_this->m_len = 0;
+		}else if(_this->m_len < SM_MAIN_CMD_SIZE - 1){
+			_this->m_cmd[_this->m_len++] = c;
+		}
+	}
+}
+
+/* A touched stack guard means memory can no longer be trusted: open all
+ * relays, once, and leave them to the watchdog and the reset */
+static void sm_main_relay_thread(void* _arg){
+	uint8_t tripped = 0;
+
+	(void)_arg;
+	while(1){
+		if(!tripped && sm_kernel_stack_fault() >= 0){
+			sm_relay_trip();
+			tripped = 1;
+			sm_pwrfail_pmm_count(SM_PWRFAIL_PMM_CNT_STACK_FAULT);
+			sm_pwrfail_pmm_event(SM_PWRFAIL_PMM_EVT_STACK_FAULT, (uint16_t)sm_kernel_stack_fault());
+		}
+		sm_kernel_sleep(SM_MAIN_RELAY_PERIOD);
+	}
+}
+
+/* Update frames, the USB terminal and the console, polled once a tick */
+static void sm_main_proto_thread(void* _arg){
+	uint8_t buf[16];
+	int32_t len;
+
+	(void)_arg;
+	while(1){
+		sm_fw_link_process(&g_fw_link);
+		sm_fw_update_process();
+		sm_pwrfail_process();
+
+		if(sm_fw_update_get_state() != g_fw_state){
+			g_fw_state = sm_fw_update_get_state();
+			if(g_fw_state == SM_FW_UPDATE_RECEIVING)
+				sm_pwrfail_pmm_count(SM_PWRFAIL_PMM_CNT_FW_UPDATE);
+			sm_pwrfail_pmm_event(SM_PWRFAIL_PMM_EVT_FW_UPDATE, (uint16_t)g_fw_state);
+		}
+
+		if(sm_usb_cdc_is_open() != g_usb_open){
+			g_usb_open = sm_usb_cdc_is_open();
+			if(g_usb_open){
+				sm_clock_hold();
+				sm_pwrfail_pmm_count(SM_PWRFAIL_PMM_CNT_USB_OPEN);
+				/* A terminal came up: the boot report again, for it */
+				g_console_usb.m_len = 0;
+				sm_ram_report(sm_usb_cdc_print, NULL);
+			}else{
+				sm_clock_release();
+			}
+			sm_pwrfail_pmm_event(SM_PWRFAIL_PMM_EVT_USB, g_usb_open);
+		}
+
+		/* The debug port belongs to sm_uart; commands come off its RX buffer,
+		 * and off the USB terminal's */
+		while(g_debug && (len = sm_uart_read(g_debug, buf, sizeof(buf))) > 0)
+			sm_main_console_input(&g_console_uart, buf, len);
+		while(g_usb_open && (len = sm_usb_cdc_read(buf, sizeof(buf))) > 0)
+			sm_main_console_input(&g_console_usb, buf, len);
+
+		sm_kernel_sleep(1);
+	}
+}
 
 int main(){
-	while(1);
+	/* Before any interrupt is enabled: the UART RX handlers and the FMC
+	 * waits run from SRAM, their vector fetches have to as well */
+	sm_ramfunc_vectors_init();
+
+	sm_clock_init();
+	sm_board_init();
+	/* Outputs off and timed from TIMER1 on HIRC before anything else */
+	sm_relay_pmm_init(SM_MAIN_RELAY_PRIORITY);
+	sm_prof_init();
+	/* The record of the last brownout is read here, the next page erased */
+	sm_pwrfail_pmm_init(SM_MAIN_PWRFAIL_PRIORITY);
+	sm_pwrfail_pmm_count(SM_PWRFAIL_PMM_CNT_BOOT);
+	sm_pwrfail_pmm_event(SM_PWRFAIL_PMM_EVT_BOOT, (uint16_t)SYS->RSTSTS);
+	g_debug = sm_uart_create(uart_debug.m_instance, uart_debug.m_baudrate, uart_debug.m_fifo_size);
+	if(g_debug)
+		sm_uart_enable_interrupt(g_debug, SM_MAIN_DEBUG_PRIORITY);
+	g_console_uart.m_write = sm_main_print;
+	g_console_uart.m_arg = g_debug;
+	sm_usb_cdc_init(SM_MAIN_USB_PRIORITY);
+
+	sm_fw_update_init();
+	sm_fw_link_init(&g_fw_link,
+			sm_uart_create(uart_rs485_1.m_instance, uart_rs485_1.m_baudrate, uart_rs485_1.m_fifo_size),
+			sm_gpio_create(io_rs485_en_1.m_port, io_rs485_en_1.m_pin, io_rs485_en_1.m_mode),
+			SM_MAIN_FW_LINK_ADDR, SM_MAIN_FW_LINK_IDLE_US, SM_MAIN_RS485_PRIORITY);
+
+	if(g_debug)
+		sm_ram_report(sm_main_print, g_debug);
+
+	/* Up and running: keep this image, the bootloader rolls back an
+	 * unconfirmed one after SM_FW_MAX_BOOT_ATTEMPTS resets */
+	sm_fw_update_confirm();
+
+	/* Idle at low power; an update (sm_fw_update) and an open USB terminal
+	 * hold full speed */
+	sm_clock_set(SM_CLOCK_LOW);
+
+	sm_kernel_init();
+	sm_kernel_thread("relay", sm_main_relay_thread, NULL, SM_MAIN_RELAY_THREAD_PRIO, g_relay_stack,
+			sizeof(g_relay_stack));
+	sm_kernel_thread("proto", sm_main_proto_thread, NULL, SM_MAIN_PROTO_THREAD_PRIO, g_proto_stack,
+			sizeof(g_proto_stack));
+	sm_kernel_start();
 }
@@ -0,0 +1,184 @@
+/*
+ * sm_ac.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_ac.h"
+#include "sm_fmt.h"
+
+#include <string.h>
+
+#define SM_AC_ADC_MID               2048
+
+static void sm_ac_reset(sm_ac_t* _this){
+	for(uint8_t c = 0; c < _this->m_config.m_channels; c++){
+		_this->m_sum[c] = 0;
+		_this->m_sum_sq[c] = 0;
+	}
+	_this->m_index = 0;
+	_this->m_last = 0;
+	_this->m_crossings = 0;
+}
+
+/* Close the window on the frames accumulated so far. _end: the closing
+ * crossing, Q16 frames from the window start, ignored when lost */
+static void sm_ac_close(sm_ac_t* _this, int32_t _end, uint8_t _lost){
+	sm_ac_result_t* result = &_this->m_result;
+	uint32_t n = _this->m_index;
+
+	if(!n)
+		return;
+
+	sm_atomic_seq_write_begin(&_this->m_lock);
+	for(uint8_t c = 0; c < _this->m_config.m_channels; c++){
+		/* Sum of the squared deviations from the window's own mean:
+		 * (n * S2 - S1^2) / n, below 2^38 for 12-bit samples */
+		uint64_t dev = ((uint64_t)n * _this->m_sum_sq[c] - (uint64_t)_this->m_sum[c] * _this->m_sum[c]) / n;
+		/* Mean square in Q16, its root is the RMS in Q8 counts */
+		uint32_t rms = sm_ac_isqrt((dev << 16) / n);
+
+		result->m_rms[c] = (uint32_t)(((uint64_t)rms * _this->m_config.m_scale[c]) / (256UL * 1000UL));
+	}
+
+	if(_lost){
+		result->m_freq = 0;
+		result->m_cycles = 0;
+		result->m_flags = SM_AC_LOST;
+	}else{
+		/* cycles / ((end - start) / 65536 / rate), in mHz */
+		result->m_freq = (uint32_t)(((uint64_t)_this->m_config.m_rate * _this->m_crossings * 1000UL << 16) /
+				(uint32_t)(_end - _this->m_start));
+		result->m_cycles = _this->m_crossings;
+		result->m_flags = 0;
+	}
+	result->m_samples = (uint16_t)n;
+	result->m_seq++;
+	sm_atomic_seq_write_end(&_this->m_lock);
+
+	_this->m_mean = (uint16_t)(_this->m_sum[0] / n);
+
+	if(_this->m_fn)
+		_this->m_fn(result, _this->m_arg);
+}
+
+int32_t sm_ac_init(sm_ac_t* _this, const sm_ac_config_t* _config, sm_ac_fn_t _fn, void* _arg){
+	if(!_this || !_config || !_config->m_rate || !_config->m_cycles || !_config->m_channels ||
+			_config->m_channels > SM_AC_CH_MAX)
+		return -1;
+
+	/* Crossing positions are Q16 frames in an int32 */
+	if((uint64_t)_config->m_rate * _config->m_cycles / SM_AC_FREQ_MIN >= 0x7FFFUL)
+		return -1;
+
+	memset(_this, 0, sizeof(sm_ac_t));
+	_this->m_config = *_config;
+	_this->m_fn = _fn;
+	_this->m_arg = _arg;
+	_this->m_min_period = (uint16_t)(_config->m_rate / SM_AC_FREQ_MAX);
+	_this->m_timeout = (uint16_t)(_config->m_rate / SM_AC_FREQ_MIN);
+	_this->m_mean = SM_AC_ADC_MID;
+	sm_atomic_seq_init(&_this->m_lock);
+	return 0;
+}
+
+void sm_ac_process(sm_ac_t* _this, const uint16_t* _block, uint32_t _frames){
+	const uint8_t channels = _this->m_config.m_channels;
+	const int32_t hysteresis = _this->m_config.m_hysteresis;
+
+	for(; _frames; _frames--, _block += channels){
+		int32_t x = (int32_t)_block[0] - _this->m_mean;
+
+		if(x < -hysteresis){
+			_this->m_armed = 1;
+		}else if(x >= 0 && _this->m_armed && _this->m_prev < 0 &&
+				(!_this->m_started || (uint16_t)(_this->m_index - _this->m_last) >= _this->m_min_period)){
+			/* Rising crossing between the last frame and this one */
+			int32_t frac = (int32_t)(((uint32_t)-_this->m_prev << 16) / (uint32_t)(x - _this->m_prev));
+			int32_t at = (((int32_t)_this->m_index - 1) << 16) + frac;
+
+			_this->m_armed = 0;
+			if(_this->m_started && ++_this->m_crossings >= _this->m_config.m_cycles){
+				sm_ac_close(_this, at, 0);
+				sm_ac_reset(_this);
+			}else if(!_this->m_started){
+				/* Whatever came before the first crossing is not a whole cycle */
+				sm_ac_reset(_this);
+				_this->m_started = 1;
+			}else{
+				_this->m_last = _this->m_index;
+			}
+			/* Relative to the new window start when one was opened above */
+			if(!_this->m_index)
+				_this->m_start = frac - 65536;
+		}
+
+		if((uint16_t)(_this->m_index - _this->m_last) >= _this->m_timeout){
+			sm_ac_close(_this, 0, 1);
+			sm_ac_reset(_this);
+			_this->m_started = 0;
+		}
+
+		for(uint8_t c = 0; c < channels; c++){
+			uint32_t s = _block[c];
+
+			_this->m_sum[c] += s;
+			_this->m_sum_sq[c] += s * s;
+		}
+
+		_this->m_prev = x;
+		_this->m_index++;
+	}
+}
+
+int32_t sm_ac_get(sm_ac_t* _this, sm_ac_result_t* _result){
+	uint32_t seq;
+
+	if(!_this || !_result)
+		return -1;
+
+	do{
+		seq = sm_atomic_seq_read_begin(&_this->m_lock);
+		*_result = _this->m_result;
+	}while(sm_atomic_seq_read_retry(&_this->m_lock, seq));
+
+	return _result->m_seq ? 0 : -1;
+}
+
+/* Digit by digit, two bits of the operand per step: no multiply, no divide,
+ * at most 32 steps */
+uint32_t sm_ac_isqrt(uint64_t _value){
+	uint64_t root = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while(bit > _value)
+		bit >>= 2;
+
+	while(bit){
+		if(_value >= root + bit){
+			_value -= root + bit;
+			root = (root >> 1) + bit;
+		}else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+int32_t sm_ac_dump(sm_ac_t* _this, sm_fmt_write_fn_t _write, void* _arg){
+	sm_ac_result_t result;
+
+	if(!_this || !_write)
+		return -1;
+
+	if(sm_ac_get(_this, &result) < 0){
+		sm_fmt_print(_write, _arg, "ac: no window yet\r\n");
+	}else{
+		sm_fmt_print(_write, _arg, "ac: %.3lq Hz, %.3lq / %.3lq rms, %u cycles in %u frames%s\r\n",
+				(long)result.m_freq, (long)result.m_rms[0], _this->m_config.m_channels > 1 ? (long)result.m_rms[1] : 0L,
+				result.m_cycles, result.m_samples, (result.m_flags & SM_AC_LOST) ? ", lost" : "");
+	}
+	return 0;
+}
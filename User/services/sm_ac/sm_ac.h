@@ -0,0 +1,101 @@
+/*
+ * sm_ac.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_AC_SM_AC_H_
+#define SERVICES_SM_AC_SM_AC_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+#include "sm_atomic.h"
+
+/*
+ * Mains RMS and frequency from EADC samples, in integer math. Blocks go in
+ * as they arrive, each sample is used once and dropped, so a PDMA
+ * half-buffer is processed while the other half fills and nothing waits
+ * for a whole window:
+ *
+ *   static void on_pdma(int32_t _ch, uint32_t _events, void* _arg){
+ *       if(_events & SM_PDMA_EVT_TABLE){
+ *           sm_ac_process(&g_mains, g_samples[g_half], SM_SAMPLES / 2);
+ *           g_half ^= 1;
+ *       }
+ *   }
+ *
+ * A block holds frames of m_channels interleaved 12-bit samples; channel 0
+ * is the voltage the rising zero crossings are taken from, interpolated
+ * between the two samples around them. A window is m_cycles mains cycles
+ * from one crossing to another: the frequency is the cycles over the
+ * crossing-to-crossing time, the RMS of every channel is taken over the same
+ * whole cycles, its mean (the ADC bias) removed exactly.
+ *
+ * Without a crossing for longer than a SM_AC_FREQ_MIN period, the window
+ * closes anyway with a frequency of 0 and SM_AC_LOST: the mains are gone.
+ */
+
+#define SM_AC_CH_MAX                2
+#define SM_AC_FREQ_MIN              40      /* Hz, slower is no mains */
+#define SM_AC_FREQ_MAX              70      /* Hz, closer crossings are noise */
+
+/* m_flags of a result */
+#define SM_AC_LOST                  0x01
+
+typedef struct sm_ac_config{
+	uint32_t m_rate;                /* frames per second */
+	uint8_t m_channels;
+	uint8_t m_cycles;               /* mains cycles per window, 10 at 50 Hz is 200 ms */
+	uint16_t m_hysteresis;          /* counts under the mean that arm the next crossing */
+	uint32_t m_scale[SM_AC_CH_MAX]; /* uV or uA per count, divider and shunt included */
+}sm_ac_config_t;
+
+typedef struct sm_ac_result{
+	uint32_t m_seq;                 /* windows closed since init */
+	uint32_t m_rms[SM_AC_CH_MAX];   /* mV or mA */
+	uint32_t m_freq;                /* mHz, 0 when SM_AC_LOST */
+	uint16_t m_samples;             /* frames in the window */
+	uint8_t m_cycles;
+	uint8_t m_flags;
+}sm_ac_result_t;
+
+/* In the context of sm_ac_process(), at the end of every window */
+typedef void (*sm_ac_fn_t)(const sm_ac_result_t* _result, void* _arg);
+
+/* Owned by the caller, static. Fields are the engine's */
+typedef struct sm_ac{
+	sm_ac_config_t m_config;
+	sm_ac_fn_t m_fn;
+	void* m_arg;
+	uint16_t m_min_period;          /* frames */
+	uint16_t m_timeout;             /* frames */
+	uint16_t m_mean;                /* of channel 0 in the last window */
+	uint16_t m_index;               /* frames since the window start */
+	uint16_t m_last;                /* frame of the last crossing */
+	uint8_t m_armed;
+	uint8_t m_started;              /* the window starts on a crossing */
+	uint8_t m_crossings;
+	int32_t m_prev;
+	int32_t m_start;                /* the start crossing, Q16 frames from m_index 0 */
+	uint32_t m_sum[SM_AC_CH_MAX];
+	uint64_t m_sum_sq[SM_AC_CH_MAX];
+	sm_atomic_seq_t m_lock;
+	sm_ac_result_t m_result;
+}sm_ac_t;
+
+/* -1 when a window at SM_AC_FREQ_MIN would not fit 32767 frames */
+int32_t sm_ac_init(sm_ac_t* _this, const sm_ac_config_t* _config, sm_ac_fn_t _fn, void* _arg);
+
+void sm_ac_process(sm_ac_t* _this, const uint16_t* _block, uint32_t _frames);
+
+/* The last window, from any context that does not preempt sm_ac_process().
+ * -1 before the first */
+int32_t sm_ac_get(sm_ac_t* _this, sm_ac_result_t* _result);
+
+/* floor(sqrt(_value)) */
+uint32_t sm_ac_isqrt(uint64_t _value);
+
+int32_t sm_ac_dump(sm_ac_t* _this, sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_AC_SM_AC_H_ */
@@ -0,0 +1,201 @@
+/*
+ * sm_atomic.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_atomic.h"
+#include "cmsis_compiler.h"
+
+#include <string.h>
+
+uint32_t sm_atomic_add(sm_atomic_t* _value, int32_t _delta){
+	uint32_t value;
+
+	do{
+		value = __LDREXW(_value) + (uint32_t)_delta;
+	}while(__STREXW(value, _value));
+
+	return value;
+}
+
+uint32_t sm_atomic_swap(sm_atomic_t* _value, uint32_t _new){
+	uint32_t old;
+
+	do{
+		old = __LDREXW(_value);
+	}while(__STREXW(_new, _value));
+
+	return old;
+}
+
+int32_t sm_atomic_cas(sm_atomic_t* _value, uint32_t _expected, uint32_t _new){
+	do{
+		if(__LDREXW(_value) != _expected){
+			__CLREX();
+			return -1;
+		}
+	}while(__STREXW(_new, _value));
+
+	return 0;
+}
+
+uint32_t sm_atomic_flags_set(sm_atomic_t* _flags, uint32_t _mask){
+	uint32_t old;
+
+	do{
+		old = __LDREXW(_flags);
+	}while(__STREXW(old | _mask, _flags));
+
+	return old;
+}
+
+uint32_t sm_atomic_flags_clear(sm_atomic_t* _flags, uint32_t _mask){
+	uint32_t old;
+
+	do{
+		old = __LDREXW(_flags);
+	}while(__STREXW(old & ~_mask, _flags));
+
+	return old;
+}
+
+uint32_t sm_atomic_flags_take(sm_atomic_t* _flags, uint32_t _mask){
+	return sm_atomic_flags_clear(_flags, _mask) & _mask;
+}
+
+int32_t sm_atomic_spsc_init(sm_atomic_spsc_t* _this, void* _buf, uint16_t _item_size, uint16_t _count){
+	if(!_this || !_buf || !_item_size || !_count || (_count & (_count - 1)))
+		return -1;
+
+	_this->m_buf = _buf;
+	_this->m_item_size = _item_size;
+	_this->m_mask = (uint16_t)(_count - 1);
+	_this->m_head = 0;
+	_this->m_tail = 0;
+	return 0;
+}
+
+int32_t sm_atomic_spsc_push(sm_atomic_spsc_t* _this, const void* _item){
+	uint32_t head = _this->m_head;
+
+	if(head - _this->m_tail > _this->m_mask)
+		return -1;
+
+	memcpy(&_this->m_buf[(head & _this->m_mask) * _this->m_item_size], _item, _this->m_item_size);
+	__DMB();
+	_this->m_head = head + 1;
+	return 0;
+}
+
+int32_t sm_atomic_spsc_pop(sm_atomic_spsc_t* _this, void* _item){
+	uint32_t tail = _this->m_tail;
+
+	if(tail == _this->m_head)
+		return -1;
+
+	__DMB();
+	memcpy(_item, &_this->m_buf[(tail & _this->m_mask) * _this->m_item_size], _this->m_item_size);
+	__DMB();
+	_this->m_tail = tail + 1;
+	return 0;
+}
+
+uint32_t sm_atomic_spsc_count(const sm_atomic_spsc_t* _this){
+	return _this->m_head - _this->m_tail;
+}
+
+/*
+ * A slot's sequence word says whose turn it is. For the lap that puts item
+ * pos in it, it is pos while the slot is free, pos + 1 once the item is
+ * written and pos + count when the consumer has taken it.
+ */
+int32_t sm_atomic_mpsc_init(sm_atomic_mpsc_t* _this, uint32_t* _buf, uint16_t _item_size, uint16_t _count){
+	if(!_this || !_buf || !_item_size || !_count || (_count & (_count - 1)))
+		return -1;
+
+	_this->m_buf = _buf;
+	_this->m_item_size = _item_size;
+	_this->m_slot_words = (uint16_t)(1 + (_item_size + 3) / 4);
+	_this->m_mask = (uint16_t)(_count - 1);
+	_this->m_head = 0;
+	_this->m_tail = 0;
+	for(uint32_t i = 0; i < _count; i++)
+		_buf[i * _this->m_slot_words] = i;
+	return 0;
+}
+
+int32_t sm_atomic_mpsc_push(sm_atomic_mpsc_t* _this, const void* _item){
+	volatile uint32_t* slot;
+	uint32_t pos;
+
+	while(1){
+		int32_t lap;
+
+		pos = __LDREXW(&_this->m_head);
+		slot = &_this->m_buf[(pos & _this->m_mask) * _this->m_slot_words];
+		lap = (int32_t)(slot[0] - pos);
+
+		if(!lap){
+			if(!__STREXW(pos + 1, &_this->m_head))
+				break;
+			continue;
+		}
+		__CLREX();
+		/* Behind: the slot still holds the item of the lap before */
+		if(lap < 0)
+			return -1;
+		/* Ahead: a nested push took pos after the head was read */
+	}
+
+	memcpy((void*)&slot[1], _item, _this->m_item_size);
+	__DMB();
+	slot[0] = pos + 1;
+	return 0;
+}
+
+int32_t sm_atomic_mpsc_pop(sm_atomic_mpsc_t* _this, void* _item){
+	uint32_t tail = _this->m_tail;
+	volatile uint32_t* slot = &_this->m_buf[(tail & _this->m_mask) * _this->m_slot_words];
+
+	if(slot[0] != tail + 1)
+		return -1;
+
+	__DMB();
+	memcpy(_item, (const void*)&slot[1], _this->m_item_size);
+	__DMB();
+	slot[0] = tail + _this->m_mask + 1;
+	_this->m_tail = tail + 1;
+	return 0;
+}
+
+uint32_t sm_atomic_mpsc_count(const sm_atomic_mpsc_t* _this){
+	return _this->m_head - _this->m_tail;
+}
+
+void sm_atomic_seq_init(sm_atomic_seq_t* _this){
+	_this->m_seq = 0;
+}
+
+void sm_atomic_seq_write_begin(sm_atomic_seq_t* _this){
+	_this->m_seq = _this->m_seq + 1;
+	__DMB();
+}
+
+void sm_atomic_seq_write_end(sm_atomic_seq_t* _this){
+	__DMB();
+	_this->m_seq = _this->m_seq + 1;
+}
+
+uint32_t sm_atomic_seq_read_begin(const sm_atomic_seq_t* _this){
+	uint32_t seq = _this->m_seq;
+
+	__DMB();
+	return seq;
+}
+
+uint8_t sm_atomic_seq_read_retry(const sm_atomic_seq_t* _this, uint32_t _seq){
+	__DMB();
+	return (_seq & 1) || _this->m_seq != _seq;
+}
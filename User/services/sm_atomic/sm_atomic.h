@@ -0,0 +1,102 @@
+/*
+ * sm_atomic.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_ATOMIC_SM_ATOMIC_H_
+#define SERVICES_SM_ATOMIC_SM_ATOMIC_H_
+
+#include "stdint.h"
+
+/*
+ * Lock-free building blocks for the paths between interrupts and threads.
+ * The Cortex-M23 has no BASEPRI: the only lock is PRIMASK, which holds every
+ * interrupt off, the protection ones too. These use LDREX/STREX instead. An
+ * exception entry or return clears the monitor, so a sequence that an
+ * interrupt cut into fails its STREX and starts over; nothing waits.
+ *
+ * - Counters and flag words: read-modify-write of one word.
+ * - SPSC ring: one producer, one consumer, any two contexts. Plain loads and
+ *   stores, each index has a single writer.
+ * - MPSC ring: producers anywhere (nested interrupts too), one consumer. A
+ *   producer claims a slot by moving the head with STREX, fills it, then
+ *   publishes it through the slot's sequence word.
+ * - Sequence lock: one writer, readers that retry when the writer ran
+ *   meanwhile. A reader must not preempt the writer: it would retry forever.
+ *
+ * Item counts are powers of two; items are copied in and out with memcpy.
+ */
+
+/* Bytes of the SPSC buffer and 32-bit words of the MPSC one */
+#define SM_ATOMIC_SPSC_SIZE(_item_size, _count)     ((_item_size) * (_count))
+#define SM_ATOMIC_MPSC_WORDS(_item_size, _count)    ((1 + ((_item_size) + 3) / 4) * (_count))
+
+typedef volatile uint32_t sm_atomic_t;
+
+typedef struct sm_atomic_spsc{
+	uint8_t* m_buf;
+	uint16_t m_item_size;
+	uint16_t m_mask;
+	volatile uint32_t m_head;       /* written by the producer only */
+	volatile uint32_t m_tail;       /* written by the consumer only */
+}sm_atomic_spsc_t;
+
+typedef struct sm_atomic_mpsc{
+	uint32_t* m_buf;                /* per slot: the sequence word, then the item */
+	uint16_t m_item_size;
+	uint16_t m_slot_words;
+	uint16_t m_mask;
+	volatile uint32_t m_head;
+	uint32_t m_tail;
+}sm_atomic_mpsc_t;
+
+typedef struct sm_atomic_seq{
+	volatile uint32_t m_seq;        /* odd while a write is in progress */
+}sm_atomic_seq_t;
+
+/* Return the new value */
+uint32_t sm_atomic_add(sm_atomic_t* _value, int32_t _delta);
+/* Return the old value */
+uint32_t sm_atomic_swap(sm_atomic_t* _value, uint32_t _new);
+/* 0 when _value held _expected and now holds _new, -1 otherwise */
+int32_t sm_atomic_cas(sm_atomic_t* _value, uint32_t _expected, uint32_t _new);
+
+/* Return the flags before */
+uint32_t sm_atomic_flags_set(sm_atomic_t* _flags, uint32_t _mask);
+uint32_t sm_atomic_flags_clear(sm_atomic_t* _flags, uint32_t _mask);
+/* Clear the flags of _mask and return those of them that were set */
+uint32_t sm_atomic_flags_take(sm_atomic_t* _flags, uint32_t _mask);
+
+/* _buf: SM_ATOMIC_SPSC_SIZE(_item_size, _count) bytes */
+int32_t sm_atomic_spsc_init(sm_atomic_spsc_t* _this, void* _buf, uint16_t _item_size, uint16_t _count);
+/* -1 when full */
+int32_t sm_atomic_spsc_push(sm_atomic_spsc_t* _this, const void* _item);
+/* -1 when empty */
+int32_t sm_atomic_spsc_pop(sm_atomic_spsc_t* _this, void* _item);
+uint32_t sm_atomic_spsc_count(const sm_atomic_spsc_t* _this);
+
+/* _buf: SM_ATOMIC_MPSC_WORDS(_item_size, _count) words */
+int32_t sm_atomic_mpsc_init(sm_atomic_mpsc_t* _this, uint32_t* _buf, uint16_t _item_size, uint16_t _count);
+/* Any context. -1 when full */
+int32_t sm_atomic_mpsc_push(sm_atomic_mpsc_t* _this, const void* _item);
+/* The consumer. -1 when empty, or when the oldest item is still being
+ * written by a producer that was cut off */
+int32_t sm_atomic_mpsc_pop(sm_atomic_mpsc_t* _this, void* _item);
+/* Claimed items, published or not */
+uint32_t sm_atomic_mpsc_count(const sm_atomic_mpsc_t* _this);
+
+void sm_atomic_seq_init(sm_atomic_seq_t* _this);
+void sm_atomic_seq_write_begin(sm_atomic_seq_t* _this);
+void sm_atomic_seq_write_end(sm_atomic_seq_t* _this);
+/*
+ *   do{
+ *       seq = sm_atomic_seq_read_begin(&lock);
+ *       copy = shared;
+ *   }while(sm_atomic_seq_read_retry(&lock, seq));
+ */
+uint32_t sm_atomic_seq_read_begin(const sm_atomic_seq_t* _this);
+uint8_t sm_atomic_seq_read_retry(const sm_atomic_seq_t* _this, uint32_t _seq);
+
+#endif /* SERVICES_SM_ATOMIC_SM_ATOMIC_H_ */
@@ -0,0 +1,248 @@
+/*
+ * sm_bus.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_bus.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+/* In front of every message; 8 bytes, so that the message keeps an 8 byte
+ * alignment and sits at the same offset in every slab */
+typedef struct sm_bus_msg{
+	sm_atomic_t m_refs;
+	uint8_t m_topic;
+	uint8_t m_slot;
+	uint16_t m_reserved;
+}sm_bus_msg_t;
+
+#define SM_BUS_SLAB(_name, _type, _slots) \
+	typedef struct{ \
+		sm_bus_msg_t m_hdr; \
+		_type m_msg; \
+	}sm_bus_slot_##_name##_t; \
+	_Static_assert((_slots) > 0 && (_slots) <= 32, "sm_bus: 1 to 32 messages per topic"); \
+	_Static_assert(offsetof(sm_bus_slot_##_name##_t, m_msg) == sizeof(sm_bus_msg_t), \
+			"sm_bus: message alignment above 8"); \
+	static sm_bus_slot_##_name##_t g_bus_slab_##_name[_slots];
+SM_BUS_TOPICS(SM_BUS_SLAB)
+#undef SM_BUS_SLAB
+
+typedef struct sm_bus_info{
+	uint8_t* m_slab;
+	uint16_t m_stride;
+	uint8_t m_slots;
+	const char* m_name;
+}sm_bus_info_t;
+
+#define SM_BUS_INFO(_name, _type, _slots) \
+	{(uint8_t*)g_bus_slab_##_name, sizeof(sm_bus_slot_##_name##_t), _slots, #_name},
+static const sm_bus_info_t g_bus_info[SM_BUS_TOPIC_NUM] = {
+	SM_BUS_TOPICS(SM_BUS_INFO)
+};
+#undef SM_BUS_INFO
+
+typedef struct sm_bus_state{
+	sm_atomic_t m_free;             /* a bit per slab slot */
+	sm_atomic_t m_published;
+	sm_atomic_t m_exhausted;        /* allocations that found the slab empty */
+	sm_bus_sub_t* m_sub[SM_BUS_SUB_MAX];
+}sm_bus_state_t;
+
+typedef struct sm_bus{
+	uint32_t (*m_time)(void);
+	sm_bus_state_t m_topic[SM_BUS_TOPIC_NUM];
+}sm_bus_t;
+
+static sm_bus_t g_bus;
+
+static sm_bus_msg_t* sm_bus_hdr(const void* _msg){
+	return (sm_bus_msg_t*)((uint8_t*)_msg - sizeof(sm_bus_msg_t));
+}
+
+int32_t sm_bus_init(void){
+	for(uint8_t t = 0; t < SM_BUS_TOPIC_NUM; t++){
+		const sm_bus_info_t* info = &g_bus_info[t];
+		sm_bus_state_t* state = &g_bus.m_topic[t];
+
+		for(uint8_t i = 0; i < info->m_slots; i++){
+			sm_bus_msg_t* hdr = (sm_bus_msg_t*)(info->m_slab + (uint32_t)i * info->m_stride);
+
+			hdr->m_refs = 0;
+			hdr->m_topic = t;
+			hdr->m_slot = i;
+		}
+		state->m_free = info->m_slots == 32 ? 0xFFFFFFFFUL : (1UL << info->m_slots) - 1;
+		state->m_published = 0;
+		state->m_exhausted = 0;
+		for(uint8_t s = 0; s < SM_BUS_SUB_MAX; s++)
+			state->m_sub[s] = NULL;
+	}
+	return 0;
+}
+
+int32_t sm_bus_subscribe(sm_bus_sub_t* _sub, sm_bus_topic_t _topic, sm_bus_notify_fn_t _notify, void* _arg){
+	sm_bus_state_t* state;
+	uint32_t primask;
+	int32_t rc = -1;
+
+	if(!_sub || _topic >= SM_BUS_TOPIC_NUM)
+		return -1;
+
+	/* A subscriber of several topics keeps the one queue */
+	if(_sub->m_queue.m_buf != _sub->m_buf){
+		sm_atomic_mpsc_init(&_sub->m_queue, _sub->m_buf, sizeof(void*), SM_BUS_SUB_QUEUE);
+		_sub->m_missed = 0;
+	}
+	_sub->m_notify_arg = _arg;
+	_sub->m_notify = _notify;
+
+	state = &g_bus.m_topic[_topic];
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t s = 0; s < SM_BUS_SUB_MAX; s++){
+		if(state->m_sub[s] == _sub){
+			rc = 0;
+			break;
+		}
+		if(!state->m_sub[s]){
+			state->m_sub[s] = _sub;
+			rc = 0;
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return rc;
+}
+
+void* sm_bus_alloc(sm_bus_topic_t _topic){
+	const sm_bus_info_t* info;
+	sm_bus_state_t* state;
+	sm_bus_msg_t* hdr;
+	uint32_t free;
+	uint32_t bit;
+	uint8_t slot = 0;
+
+	if(_topic >= SM_BUS_TOPIC_NUM)
+		return NULL;
+
+	info = &g_bus_info[_topic];
+	state = &g_bus.m_topic[_topic];
+	do{
+		free = state->m_free;
+		if(!free){
+			sm_atomic_add(&state->m_exhausted, 1);
+			return NULL;
+		}
+		bit = free & (~free + 1);
+	}while(sm_atomic_cas(&state->m_free, free, free & ~bit) < 0);
+
+	/* No CLZ on the M23 either: count the bit down */
+	while(bit >>= 1)
+		slot++;
+
+	hdr = (sm_bus_msg_t*)(info->m_slab + (uint32_t)slot * info->m_stride);
+	hdr->m_refs = 1;
+	return hdr + 1;
+}
+
+int32_t sm_bus_publish(void* _msg){
+	sm_bus_msg_t* hdr;
+	sm_bus_state_t* state;
+
+	if(!_msg)
+		return -1;
+
+	hdr = sm_bus_hdr(_msg);
+	state = &g_bus.m_topic[hdr->m_topic];
+	sm_atomic_add(&state->m_published, 1);
+
+	for(uint8_t s = 0; s < SM_BUS_SUB_MAX; s++){
+		sm_bus_sub_t* sub = state->m_sub[s];
+
+		if(!sub)
+			continue;
+
+		/* The reference goes first: the subscriber may be done before we are */
+		sm_atomic_add(&hdr->m_refs, 1);
+		if(sm_atomic_mpsc_push(&sub->m_queue, &_msg) < 0){
+			sm_atomic_add(&hdr->m_refs, -1);
+			sm_atomic_add(&sub->m_missed, 1);
+			continue;
+		}
+		if(sub->m_notify)
+			sub->m_notify(sub->m_notify_arg);
+	}
+
+	sm_bus_release(_msg);
+	return 0;
+}
+
+const void* sm_bus_take(sm_bus_sub_t* _sub){
+	void* msg;
+
+	if(!_sub || sm_atomic_mpsc_pop(&_sub->m_queue, &msg) < 0)
+		return NULL;
+	return msg;
+}
+
+void sm_bus_retain(const void* _msg){
+	if(_msg)
+		sm_atomic_add(&sm_bus_hdr(_msg)->m_refs, 1);
+}
+
+void sm_bus_release(const void* _msg){
+	sm_bus_msg_t* hdr;
+
+	if(!_msg)
+		return;
+
+	hdr = sm_bus_hdr(_msg);
+	if(!sm_atomic_add(&hdr->m_refs, -1))
+		sm_atomic_flags_set(&g_bus.m_topic[hdr->m_topic].m_free, 1UL << hdr->m_slot);
+}
+
+sm_bus_topic_t sm_bus_topic(const void* _msg){
+	return (sm_bus_topic_t)sm_bus_hdr(_msg)->m_topic;
+}
+
+void sm_bus_set_clock(uint32_t (*_time)(void)){
+	g_bus.m_time = _time;
+}
+
+void sm_bus_on_gpio(void* _gpio, uint32_t _level, void* _id){
+	sm_bus_gpio_t* event = SM_BUS_ALLOC(GPIO);
+
+	(void)_gpio;
+	if(!event)
+		return;
+
+	event->m_time = g_bus.m_time ? g_bus.m_time() : 0;
+	event->m_id = (uint32_t)_id;
+	event->m_level = _level;
+	sm_bus_publish(event);
+}
+
+int32_t sm_bus_dump(sm_fmt_write_fn_t _write, void* _arg){
+	if(!_write)
+		return -1;
+
+	for(uint8_t t = 0; t < SM_BUS_TOPIC_NUM; t++){
+		const sm_bus_state_t* state = &g_bus.m_topic[t];
+		uint32_t free = state->m_free;
+		uint8_t idle = 0;
+
+		for(; free; free &= free - 1)
+			idle++;
+
+		sm_fmt_print(_write, _arg, "bus %-7s: published %lu, in flight %u/%u, exhausted %lu\r\n",
+				g_bus_info[t].m_name, (unsigned long)state->m_published, g_bus_info[t].m_slots - idle,
+				g_bus_info[t].m_slots, (unsigned long)state->m_exhausted);
+	}
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * sm_bus.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_BUS_SM_BUS_H_
+#define SERVICES_SM_BUS_SM_BUS_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+#include "sm_atomic.h"
+#include "sm_bus_topics.h"
+
+/*
+ * Publish/subscribe between the drivers and the control logic, without a
+ * copy or a malloc. A producer takes a message from its topic's slab, fills
+ * it in place and publishes it; every subscriber of the topic gets the same
+ * pointer in its queue, and the message goes back to the slab when the last
+ * of them releases it:
+ *
+ *   sm_bus_adc_t* adc = SM_BUS_ALLOC(ADC);
+ *   if(adc){
+ *       adc->m_value[0] = ...;
+ *       sm_bus_publish(adc);
+ *   }
+ *
+ *   const sm_bus_adc_t* adc;
+ *   while((adc = sm_bus_take(&g_control_sub))){
+ *       ...
+ *       sm_bus_release(adc);
+ *   }
+ *
+ * Topics are the lines of SM_BUS_TOPICS (sm_bus_topics.h): SM_BUS_<NAME> is
+ * the index of the topic, known at compile time. Allocation, publish and
+ * release are lock-free and may come from interrupts (sm_atomic); a
+ * subscriber is drained by one context. Subscribe at init, before anything
+ * is published.
+ *
+ * A message is read-only once published. A subscriber whose queue is full
+ * misses it, the others still get it; both cases are counted.
+ */
+
+#ifndef SM_BUS_SUB_MAX
+#define SM_BUS_SUB_MAX              4
+#endif
+
+#ifndef SM_BUS_SUB_QUEUE
+#define SM_BUS_SUB_QUEUE            8
+#endif
+
+#define SM_BUS_TOPIC_ENUM(_name, _type, _slots)     SM_BUS_##_name,
+typedef enum{
+	SM_BUS_TOPICS(SM_BUS_TOPIC_ENUM)
+	SM_BUS_TOPIC_NUM
+}sm_bus_topic_t;
+#undef SM_BUS_TOPIC_ENUM
+
+#define SM_BUS_TOPIC_TYPE(_name, _type, _slots)     typedef _type sm_bus_type_##_name##_t;
+SM_BUS_TOPICS(SM_BUS_TOPIC_TYPE)
+#undef SM_BUS_TOPIC_TYPE
+
+/* Typed allocation: NULL when the slab is empty */
+#define SM_BUS_ALLOC(_name)         ((sm_bus_type_##_name##_t*)sm_bus_alloc(SM_BUS_##_name))
+
+typedef void (*sm_bus_notify_fn_t)(void* _arg);
+
+/* Owned by the subscriber, static. Fields are the bus's */
+typedef struct sm_bus_sub{
+	sm_atomic_mpsc_t m_queue;
+	uint32_t m_buf[SM_ATOMIC_MPSC_WORDS(sizeof(void*), SM_BUS_SUB_QUEUE)];
+	sm_bus_notify_fn_t m_notify;
+	void* m_notify_arg;
+	sm_atomic_t m_missed;
+}sm_bus_sub_t;
+
+int32_t sm_bus_init(void);
+
+/* _notify, if any, runs in the publisher's context after each delivery:
+ * wake the subscriber there, do not read the message */
+int32_t sm_bus_subscribe(sm_bus_sub_t* _sub, sm_bus_topic_t _topic, sm_bus_notify_fn_t _notify, void* _arg);
+
+/* A message of _topic with one reference, the caller's. NULL when all are in flight */
+void* sm_bus_alloc(sm_bus_topic_t _topic);
+
+/* Hand the message to the subscribers and drop the caller's reference */
+int32_t sm_bus_publish(void* _msg);
+
+/* The oldest message delivered to _sub, NULL when none. Release it after use */
+const void* sm_bus_take(sm_bus_sub_t* _sub);
+
+/* Take an extra reference, to keep a message beyond the one it came with */
+void sm_bus_retain(const void* _msg);
+void sm_bus_release(const void* _msg);
+
+sm_bus_topic_t sm_bus_topic(const void* _msg);
+
+/* sm_gpio_irq_fn_t publishing on GPIO, the argument given as m_id. _time:
+ * clock for the time stamps of the adapters, may be NULL */
+void sm_bus_set_clock(uint32_t (*_time)(void));
+void sm_bus_on_gpio(void* _gpio, uint32_t _level, void* _id);
+
+int32_t sm_bus_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_BUS_SM_BUS_H_ */
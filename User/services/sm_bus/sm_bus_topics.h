@@ -0,0 +1,59 @@
+/*
+ * sm_bus_topics.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_BUS_SM_BUS_TOPICS_H_
+#define SERVICES_SM_BUS_SM_BUS_TOPICS_H_
+
+#include "stdint.h"
+
+/*
+ * The topics of the bus, fixed at build time. Each line gives the name, the
+ * message type and the number of messages its slab holds (at most 32): how
+ * many may be in flight at once, from allocation to the last release.
+ */
+#define SM_BUS_TOPICS(X) \
+	X(ADC,      sm_bus_adc_t,       4) \
+	X(GPIO,     sm_bus_gpio_t,      8) \
+	X(CAN,      sm_bus_can_t,       8) \
+	X(MODBUS,   sm_bus_modbus_t,    2)
+
+#define SM_BUS_ADC_CHANNELS         8
+#define SM_BUS_CAN_DATA_MAX         64
+#define SM_BUS_MODBUS_REG_MAX       32
+
+/* One conversion of the channels set in m_channels */
+typedef struct sm_bus_adc{
+	uint32_t m_time;
+	uint16_t m_channels;
+	uint16_t m_value[SM_BUS_ADC_CHANNELS];
+}sm_bus_adc_t;
+
+typedef struct sm_bus_gpio{
+	uint32_t m_time;
+	uint32_t m_id;                  /* the argument the input was set up with */
+	uint32_t m_level;               /* as the interrupt sampled the pins */
+}sm_bus_gpio_t;
+
+typedef struct sm_bus_can{
+	uint32_t m_time;
+	uint32_t m_id;
+	uint8_t m_len;
+	uint8_t m_flags;
+	uint8_t m_data[SM_BUS_CAN_DATA_MAX];
+}sm_bus_can_t;
+
+/* The outcome of one request: registers read, or written back */
+typedef struct sm_bus_modbus{
+	uint8_t m_unit;
+	uint8_t m_function;
+	int16_t m_status;               /* 0, or the exception code, or -1 on timeout */
+	uint16_t m_address;
+	uint16_t m_count;
+	uint16_t m_value[SM_BUS_MODBUS_REG_MAX];
+}sm_bus_modbus_t;
+
+#endif /* SERVICES_SM_BUS_SM_BUS_TOPICS_H_ */
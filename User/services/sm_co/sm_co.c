@@ -0,0 +1,166 @@
+/*
+ * sm_co.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_co.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+typedef struct sm_co_sched{
+	uint32_t (*m_ms)(void);
+	sm_co_t* m_co[SM_CO_MAX];
+}sm_co_sched_t;
+
+static sm_co_sched_t g_co;
+
+static uint8_t sm_co_expired(const sm_co_t* _co){
+	return _co->m_timed && g_co.m_ms && (int32_t)(g_co.m_ms() - _co->m_deadline) >= 0;
+}
+
+static uint8_t sm_co_due(const sm_co_t* _co){
+	return _co->m_poll || (_co->m_events & _co->m_wait) || sm_co_expired(_co);
+}
+
+int32_t sm_co_init(uint32_t (*_ms)(void)){
+	g_co.m_ms = _ms;
+	return 0;
+}
+
+int32_t sm_co_start(sm_co_t* _co, sm_co_fn_t _fn){
+	uint32_t primask;
+	int32_t slot = -1;
+
+	if(!_co || !_fn)
+		return -1;
+
+	_co->m_line = 0;
+	_co->m_used = 1;
+	_co->m_poll = 1;
+	_co->m_events = 0;
+	_co->m_wait = 0;
+	_co->m_result = 0;
+	_co->m_timed = 0;
+	_co->m_fn = _fn;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < SM_CO_MAX; i++){
+		if(g_co.m_co[i] == _co){
+			slot = i;
+			break;
+		}
+		if(slot < 0 && !g_co.m_co[i])
+			slot = i;
+	}
+	if(slot >= 0)
+		g_co.m_co[slot] = _co;
+	__set_PRIMASK(primask);
+
+	return slot < 0 ? -1 : 0;
+}
+
+int32_t sm_co_stop(sm_co_t* _co){
+	uint32_t primask;
+	int32_t ret = -1;
+
+	if(!_co)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < SM_CO_MAX; i++){
+		if(g_co.m_co[i] == _co){
+			g_co.m_co[i] = NULL;
+			_co->m_used = 0;
+			_co->m_wait = 0;
+			_co->m_timed = 0;
+			ret = 0;
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+uint32_t sm_co_run(void){
+	uint32_t stepped = 0;
+
+	for(uint8_t i = 0; i < SM_CO_MAX; i++){
+		sm_co_t* co = g_co.m_co[i];
+
+		if(!co || !sm_co_due(co))
+			continue;
+
+		stepped++;
+		if(co->m_fn(co) == SM_CO_DONE){
+			g_co.m_co[i] = NULL;
+			co->m_used = 0;
+		}
+	}
+	return stepped;
+}
+
+void sm_co_signal(sm_co_t* _co, uint16_t _events){
+	uint32_t primask;
+
+	if(!_co)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	_co->m_events |= _events;
+	__set_PRIMASK(primask);
+}
+
+uint16_t sm_co_result(const sm_co_t* _co){
+	return _co->m_result;
+}
+
+/* Events that came before the wait still count: a callback may run between
+ * starting a transfer and awaiting it */
+void sm_co_wait(sm_co_t* _co, uint16_t _mask, uint32_t _ms, uint8_t _poll){
+	_co->m_wait = _mask;
+	_co->m_poll = _poll;
+	_co->m_result = 0;
+	_co->m_timed = _ms != SM_CO_FOREVER;
+	if(_co->m_timed)
+		_co->m_deadline = (g_co.m_ms ? g_co.m_ms() : 0) + _ms;
+}
+
+uint8_t sm_co_ready(sm_co_t* _co){
+	uint32_t primask = __get_PRIMASK();
+	uint16_t got;
+
+	__disable_irq();
+	got = _co->m_events & _co->m_wait;
+	_co->m_events &= (uint16_t)~got;
+	__set_PRIMASK(primask);
+
+	if(!got && !sm_co_expired(_co))
+		return 0;
+
+	_co->m_result = got;
+	_co->m_wait = 0;
+	_co->m_timed = 0;
+	return 1;
+}
+
+void sm_co_on_uart_idle(void* _uart, uint16_t _len, void* _co){
+	(void)_uart;
+	(void)_len;
+	sm_co_signal(_co, SM_CO_EVT_UART);
+}
+
+void sm_co_on_i2c_done(sm_i2c_xfer_t* _xfer, void* _co){
+	(void)_xfer;
+	sm_co_signal(_co, SM_CO_EVT_I2C);
+}
+
+void sm_co_on_mem_done(int32_t _status, void* _co){
+	sm_co_signal(_co, _status < 0 ? SM_CO_EVT_MEM | SM_CO_EVT_MEM_ERR : SM_CO_EVT_MEM);
+}
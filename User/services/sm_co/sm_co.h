@@ -0,0 +1,144 @@
+/*
+ * sm_co.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_CO_SM_CO_H_
+#define SERVICES_SM_CO_SM_CO_H_
+
+#include "stdint.h"
+#include "sm_i2c.h"
+
+/*
+ * Stackless coroutines for protocol handlers, protothread style: a handler is
+ * a function that returns wherever it waits and, on the next call, jumps back
+ * there through a switch on the line it left at. All handlers share the main
+ * stack; what a handler keeps across a wait lives in its own state struct,
+ * with the sm_co_t first:
+ *
+ *   typedef struct modbus{
+ *       sm_co_t m_co;
+ *       uint16_t m_len;
+ *   }modbus_t;
+ *
+ *   static int32_t modbus_task(sm_co_t* _co){
+ *       modbus_t* this = (modbus_t*)_co;
+ *
+ *       SM_CO_BEGIN(_co);
+ *       while(1){
+ *           SM_CO_AWAIT_EVENT(_co, SM_CO_EVT_UART, SM_CO_FOREVER);
+ *           this->m_len = sm_uart_read(...);
+ *           SM_CO_AWAIT_EVENT(_co, SM_CO_EVT_I2C, 20);
+ *           if(!sm_co_result(_co))
+ *               continue;                   // timed out
+ *       }
+ *       SM_CO_END(_co);
+ *   }
+ *
+ * Events are bits set with sm_co_signal(), from anywhere, interrupts too; the
+ * sm_co_on_*() adapters are driver callbacks that do it, with the coroutine as
+ * their argument. sm_co_run() from the main loop steps the coroutines that got
+ * an event, passed their deadline or poll a condition.
+ *
+ * Locals do not survive a wait, and a wait cannot sit inside a switch of the
+ * handler's own.
+ */
+
+#ifndef SM_CO_MAX
+#define SM_CO_MAX                   8
+#endif
+
+#define SM_CO_FOREVER               0xFFFFFFFFUL
+
+#define SM_CO_WAITING               0
+#define SM_CO_DONE                  1
+
+/* Events of the adapters; the bits from SM_CO_EVT_USER up are free */
+#define SM_CO_EVT_UART              (1U << 0)
+#define SM_CO_EVT_I2C               (1U << 1)
+#define SM_CO_EVT_MEM               (1U << 2)
+#define SM_CO_EVT_MEM_ERR           (1U << 3)       /* with SM_CO_EVT_MEM when the channel aborted; await both */
+#define SM_CO_EVT_USER              (1U << 8)
+
+typedef struct sm_co sm_co_t;
+
+typedef int32_t (*sm_co_fn_t)(sm_co_t* _co);
+
+struct sm_co{
+	uint16_t m_line;                /* where the handler resumes, 0 at the start */
+	uint8_t m_used;
+	uint8_t m_poll;                 /* waiting on a condition: step on every run */
+	volatile uint16_t m_events;
+	uint16_t m_wait;                /* events the current wait takes */
+	uint16_t m_result;              /* events that ended it, 0 on timeout */
+	uint8_t m_timed;
+	uint32_t m_deadline;
+	sm_co_fn_t m_fn;
+};
+
+#define SM_CO_BEGIN(_co)            switch((_co)->m_line){ case 0:
+
+#define SM_CO_END(_co)              } (_co)->m_line = 0; return SM_CO_DONE
+
+/* Give the other coroutines a turn */
+#define SM_CO_YIELD(_co) \
+	do{ \
+		sm_co_wait(_co, 0, 0, 1); \
+		(_co)->m_line = __LINE__; \
+		return SM_CO_WAITING; \
+		case __LINE__:; \
+	}while(0)
+
+/* Until one of _mask is signalled or _ms passed. sm_co_result(): the events */
+#define SM_CO_AWAIT_EVENT(_co, _mask, _ms) \
+	do{ \
+		sm_co_wait(_co, _mask, _ms, 0); \
+		(_co)->m_line = __LINE__; \
+		case __LINE__: \
+		if(!sm_co_ready(_co)) \
+			return SM_CO_WAITING; \
+	}while(0)
+
+/* Until _cond holds or _ms passed; polled on every sm_co_run() */
+#define SM_CO_AWAIT(_co, _cond, _ms) \
+	do{ \
+		sm_co_wait(_co, 0, _ms, 1); \
+		(_co)->m_line = __LINE__; \
+		case __LINE__: \
+		if(!(_cond) && !sm_co_ready(_co)) \
+			return SM_CO_WAITING; \
+		sm_co_wait(_co, 0, SM_CO_FOREVER, 0); \
+	}while(0)
+
+#define SM_CO_SLEEP(_co, _ms)       SM_CO_AWAIT_EVENT(_co, 0, _ms)
+
+/* _ms: millisecond clock for the timeouts */
+int32_t sm_co_init(uint32_t (*_ms)(void));
+
+/* Run _fn as coroutine _co from its beginning, until it returns SM_CO_DONE */
+int32_t sm_co_start(sm_co_t* _co, sm_co_fn_t _fn);
+/* Thread or interrupt */
+int32_t sm_co_stop(sm_co_t* _co);
+
+/* Step every coroutine that can go on. Return how many were stepped */
+uint32_t sm_co_run(void);
+
+/* Thread or interrupt */
+void sm_co_signal(sm_co_t* _co, uint16_t _events);
+
+uint16_t sm_co_result(const sm_co_t* _co);
+
+/* Used by the macros */
+void sm_co_wait(sm_co_t* _co, uint16_t _mask, uint32_t _ms, uint8_t _poll);
+uint8_t sm_co_ready(sm_co_t* _co);
+
+/* Driver callbacks that signal the coroutine given as their argument. The
+ * UART one is an sm_uart_idle_fn_t (sm_uart_t is void). Other sources signal
+ * bits from SM_CO_EVT_USER with sm_co_signal() */
+void sm_co_on_uart_idle(void* _uart, uint16_t _len, void* _co);
+void sm_co_on_i2c_done(sm_i2c_xfer_t* _xfer, void* _co);
+void sm_co_on_mem_done(int32_t _status, void* _co);
+
+#endif /* SERVICES_SM_CO_SM_CO_H_ */
@@ -0,0 +1,127 @@
+/*
+ * sm_defer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_defer.h"
+#include "sm_atomic.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+typedef struct sm_defer_item{
+	sm_defer_fn_t m_fn;
+	void* m_arg;
+	uint32_t m_data;
+}sm_defer_item_t;
+
+typedef struct sm_defer_queue{
+	sm_atomic_mpsc_t m_mpsc;
+	uint32_t m_run;
+	sm_atomic_t m_dropped;
+	uint32_t m_peak;                /* deepest seen by a producer, may miss a nested one */
+	uint32_t m_buf[SM_ATOMIC_MPSC_WORDS(sizeof(sm_defer_item_t), SM_DEFER_QUEUE_SIZE)];
+}sm_defer_queue_t;
+
+static sm_defer_queue_t g_defer[SM_DEFER_PRIO_NUM];
+static volatile uint8_t g_defer_ready;
+
+int32_t sm_defer_init(void){
+	if(g_defer_ready)
+		return 0;
+
+	for(uint8_t p = 0; p < SM_DEFER_PRIO_NUM; p++){
+		sm_defer_queue_t* queue = &g_defer[p];
+
+		if(sm_atomic_mpsc_init(&queue->m_mpsc, queue->m_buf, sizeof(sm_defer_item_t), SM_DEFER_QUEUE_SIZE) < 0)
+			return -1;
+		queue->m_run = 0;
+		queue->m_peak = 0;
+	}
+
+	NVIC_SetPriority(PendSV_IRQn, (1UL << __NVIC_PRIO_BITS) - 1);
+	g_defer_ready = 1;
+	return 0;
+}
+
+int32_t sm_defer_post(sm_defer_prio_t _prio, sm_defer_fn_t _fn, void* _arg, uint32_t _data){
+	sm_defer_queue_t* queue;
+	sm_defer_item_t item;
+	uint32_t depth;
+
+	if(_prio >= SM_DEFER_PRIO_NUM || !_fn)
+		return -1;
+
+	queue = &g_defer[_prio];
+	/* An interrupt enabled before sm_defer_init(): its rings have no buffer yet */
+	if(!g_defer_ready){
+		sm_atomic_add(&queue->m_dropped, 1);
+		return -1;
+	}
+	item.m_fn = _fn;
+	item.m_arg = _arg;
+	item.m_data = _data;
+	if(sm_atomic_mpsc_push(&queue->m_mpsc, &item) < 0){
+		sm_atomic_add(&queue->m_dropped, 1);
+		return -1;
+	}
+
+	depth = sm_atomic_mpsc_count(&queue->m_mpsc);
+	if(depth > queue->m_peak)
+		queue->m_peak = depth;
+
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	return 0;
+}
+
+void sm_defer_run(void){
+	uint8_t prio = 0;
+
+	if(!g_defer_ready)
+		return;
+
+	while(prio < SM_DEFER_PRIO_NUM){
+		sm_defer_queue_t* queue = &g_defer[prio];
+		sm_defer_item_t item;
+
+		/* Empty, or its producer was cut off before publishing: it pends
+		 * PendSV again once it has */
+		if(sm_atomic_mpsc_pop(&queue->m_mpsc, &item) < 0){
+			prio++;
+			continue;
+		}
+		queue->m_run++;
+
+		item.m_fn(item.m_arg, item.m_data);
+		prio = 0;
+	}
+}
+
+uint32_t sm_defer_dropped(void){
+	uint32_t dropped = 0;
+
+	for(uint8_t p = 0; p < SM_DEFER_PRIO_NUM; p++)
+		dropped += g_defer[p].m_dropped;
+	return dropped;
+}
+
+int32_t sm_defer_dump(sm_fmt_write_fn_t _write, void* _arg){
+	if(!_write)
+		return -1;
+
+	for(uint8_t p = 0; p < SM_DEFER_PRIO_NUM; p++){
+		const sm_defer_queue_t* queue = &g_defer[p];
+
+		sm_fmt_print(_write, _arg, "defer %u: run %lu, dropped %lu, peak %lu/%u\r\n", p,
+				(unsigned long)queue->m_run, (unsigned long)queue->m_dropped, (unsigned long)queue->m_peak,
+				SM_DEFER_QUEUE_SIZE);
+	}
+	return 0;
+}
+
+#if SM_DEFER_PENDSV_HANDLER
+void PendSV_Handler(void){
+	sm_defer_run();
+}
+#endif
@@ -0,0 +1,68 @@
+/*
+ * sm_defer.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_DEFER_SM_DEFER_H_
+#define SERVICES_SM_DEFER_SM_DEFER_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * Bottom halves of the interrupt handlers. An ISR takes what the hardware
+ * will not keep (a length, a status, the pin levels), acknowledges the source
+ * and posts the rest of its work with sm_defer_post(); the work runs at
+ * PendSV, the lowest interrupt priority, after every ISR has returned. The
+ * ISRs stay a few dozen cycles long, so a protection interrupt waits at most
+ * that long behind a busy UART, while all the work still gets done.
+ *
+ * One queue per level, SM_DEFER_HIGH first: after every item the runner looks
+ * at the higher queues again, so a high item never waits for more than the
+ * one item running. Each queue is an sm_atomic MPSC ring: any number of
+ * producers may post, nested interrupts too; a full queue drops the item and
+ * counts it.
+ *
+ * sm_defer owns PendSV_Handler unless SM_DEFER_PENDSV_HANDLER is 0. The
+ * firmware build (.cproject) sets it to 0: there sm_kernel_port.S owns the
+ * handler and runs the queues before it switches, with or without threads
+ * started. The host build keeps the one here.
+ */
+
+#ifndef SM_DEFER_PENDSV_HANDLER
+#define SM_DEFER_PENDSV_HANDLER     1
+#endif
+
+/* Items per level, a power of two */
+#ifndef SM_DEFER_QUEUE_SIZE
+#define SM_DEFER_QUEUE_SIZE         16
+#endif
+
+typedef enum{
+	SM_DEFER_HIGH = 0,              /* protection paths */
+	SM_DEFER_NORMAL,
+	SM_DEFER_LOW,                   /* bulk data */
+	SM_DEFER_PRIO_NUM
+}sm_defer_prio_t;
+
+/* _data: what the ISR captured */
+typedef void (*sm_defer_fn_t)(void* _arg, uint32_t _data);
+
+/* From sm_board_init(), before any driver interrupt is enabled; again is a no-op */
+int32_t sm_defer_init(void);
+
+/* Interrupt or thread. -1 when the queue of _prio is full, or before
+ * sm_defer_init() (counted as dropped) */
+int32_t sm_defer_post(sm_defer_prio_t _prio, sm_defer_fn_t _fn, void* _arg, uint32_t _data);
+
+/* Run every item posted so far. Called from PendSV_Handler */
+void sm_defer_run(void);
+
+/* Items dropped on a full queue or before init, all levels */
+uint32_t sm_defer_dropped(void);
+
+int32_t sm_defer_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_DEFER_SM_DEFER_H_ */
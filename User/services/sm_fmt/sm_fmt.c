@@ -0,0 +1,312 @@
+/*
+ * sm_fmt.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_fmt.h"
+
+#include <stddef.h>
+
+#define SM_FMT_FLAG_LEFT            0x01
+#define SM_FMT_FLAG_ZERO            0x02
+#define SM_FMT_FLAG_PLUS            0x04
+#define SM_FMT_FLAG_UPPER           0x08
+
+/* 2^64 is 20 digits; precisions past this many digits are cut */
+#define SM_FMT_DIGITS_MAX           24
+
+typedef struct sm_fmt_out{
+	char* m_buf;
+	uint32_t m_size;                /* buffer: room with the NUL, print: chunk size */
+	uint32_t m_len;
+	uint32_t m_total;
+	sm_fmt_write_fn_t m_write;      /* NULL: the caller buffer is the output */
+	void* m_arg;
+}sm_fmt_out_t;
+
+typedef struct sm_fmt_spec{
+	uint8_t m_flags;
+	int32_t m_width;
+	int32_t m_prec;                 /* -1 when not given */
+	uint8_t m_point;                /* %q: digits after the point */
+}sm_fmt_spec_t;
+
+static void sm_fmt_flush(sm_fmt_out_t* _out){
+	if(_out->m_write && _out->m_len){
+		_out->m_write(_out->m_buf, _out->m_len, _out->m_arg);
+		_out->m_len = 0;
+	}
+}
+
+static void sm_fmt_putc(sm_fmt_out_t* _out, char _c){
+	_out->m_total++;
+	if(_out->m_write){
+		_out->m_buf[_out->m_len++] = _c;
+		if(_out->m_len == _out->m_size)
+			sm_fmt_flush(_out);
+	}else if(_out->m_len + 1 < _out->m_size){
+		_out->m_buf[_out->m_len++] = _c;
+	}
+}
+
+static void sm_fmt_pad(sm_fmt_out_t* _out, char _c, int32_t _num){
+	for(; _num > 0; _num--)
+		sm_fmt_putc(_out, _c);
+}
+
+static void sm_fmt_string(sm_fmt_out_t* _out, const sm_fmt_spec_t* _spec, const char* _str){
+	int32_t len = 0;
+
+	if(!_str)
+		_str = "(null)";
+	while(_str[len] && (_spec->m_prec < 0 || len < _spec->m_prec))
+		len++;
+
+	if(!(_spec->m_flags & SM_FMT_FLAG_LEFT))
+		sm_fmt_pad(_out, ' ', _spec->m_width - len);
+	for(int32_t i = 0; i < len; i++)
+		sm_fmt_putc(_out, _str[i]);
+	if(_spec->m_flags & SM_FMT_FLAG_LEFT)
+		sm_fmt_pad(_out, ' ', _spec->m_width - len);
+}
+
+/* Digits come out last first. 32 bit values stay off the 64 bit division */
+static uint8_t sm_fmt_digits(char* _digits, uint64_t _value, uint8_t _base, uint8_t _upper){
+	const char* set = _upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	uint8_t n = 0;
+
+	if(_base == 16){
+		for(; _value; _value >>= 4)
+			_digits[n++] = set[_value & 0x0F];
+		return n;
+	}
+
+	for(; _value > UINT32_MAX; _value /= 10)
+		_digits[n++] = set[_value % 10];
+	for(uint32_t value = (uint32_t)_value; value; value /= 10)
+		_digits[n++] = set[value % 10];
+	return n;
+}
+
+static void sm_fmt_number(sm_fmt_out_t* _out, const sm_fmt_spec_t* _spec, uint64_t _value, uint8_t _neg,
+		uint8_t _base){
+	char digits[SM_FMT_DIGITS_MAX];
+	uint8_t num = sm_fmt_digits(digits, _value, _base, _spec->m_flags & SM_FMT_FLAG_UPPER);
+	int32_t min = _spec->m_point ? _spec->m_point + 1 : _spec->m_prec < 0 ? 1 : _spec->m_prec;
+	char sign = _neg ? '-' : (_spec->m_flags & SM_FMT_FLAG_PLUS) ? '+' : 0;
+	int32_t len;
+	int32_t pad;
+
+	if(min > SM_FMT_DIGITS_MAX)
+		min = SM_FMT_DIGITS_MAX;
+	while(num < min)
+		digits[num++] = '0';
+
+	len = num + (sign ? 1 : 0) + (_spec->m_point ? 1 : 0);
+	pad = _spec->m_width - len;
+
+	/* '0' pads after the sign; C drops it for integers with a precision */
+	if(!(_spec->m_flags & SM_FMT_FLAG_LEFT) &&
+			(!(_spec->m_flags & SM_FMT_FLAG_ZERO) || (_spec->m_prec >= 0 && !_spec->m_point))){
+		sm_fmt_pad(_out, ' ', pad);
+		pad = 0;
+	}
+	if(sign)
+		sm_fmt_putc(_out, sign);
+	if(!(_spec->m_flags & SM_FMT_FLAG_LEFT)){
+		sm_fmt_pad(_out, '0', pad);
+		pad = 0;
+	}
+
+	while(num){
+		if(_spec->m_point && num == _spec->m_point)
+			sm_fmt_putc(_out, '.');
+		sm_fmt_putc(_out, digits[--num]);
+	}
+	sm_fmt_pad(_out, ' ', pad);
+}
+
+static int32_t sm_fmt_run(sm_fmt_out_t* _out, const char* _fmt, va_list _ap){
+	for(; *_fmt; _fmt++){
+		sm_fmt_spec_t spec = {0, 0, -1, 0};
+		uint8_t length = 0;         /* 1 long, 2 long long, 0xFF / 0xFE h / hh */
+		uint8_t base = 10;
+		uint8_t neg = 0;
+		uint64_t value;
+
+		if(*_fmt != '%'){
+			sm_fmt_putc(_out, *_fmt);
+			continue;
+		}
+		_fmt++;
+
+		for(;; _fmt++){
+			if(*_fmt == '-')
+				spec.m_flags |= SM_FMT_FLAG_LEFT;
+			else if(*_fmt == '0')
+				spec.m_flags |= SM_FMT_FLAG_ZERO;
+			else if(*_fmt == '+')
+				spec.m_flags |= SM_FMT_FLAG_PLUS;
+			else
+				break;
+		}
+
+		if(*_fmt == '*'){
+			spec.m_width = va_arg(_ap, int);
+			if(spec.m_width < 0){
+				spec.m_flags |= SM_FMT_FLAG_LEFT;
+				spec.m_width = -spec.m_width;
+			}
+			_fmt++;
+		}
+		for(; *_fmt >= '0' && *_fmt <= '9'; _fmt++)
+			spec.m_width = spec.m_width * 10 + (*_fmt - '0');
+
+		if(*_fmt == '.'){
+			_fmt++;
+			spec.m_prec = 0;
+			if(*_fmt == '*'){
+				spec.m_prec = va_arg(_ap, int);
+				_fmt++;
+			}
+			for(; *_fmt >= '0' && *_fmt <= '9'; _fmt++)
+				spec.m_prec = spec.m_prec * 10 + (*_fmt - '0');
+		}
+
+		for(;; _fmt++){
+			if(*_fmt == 'l')
+				length++;
+			else if(*_fmt == 'h')
+				length--;
+			else if(*_fmt == 'z')
+				length = sizeof(size_t) > sizeof(int) ? 1 : 0;
+			else
+				break;
+		}
+
+		switch(*_fmt){
+		case '\0':
+			_fmt--;
+			continue;
+
+		case '%':
+			sm_fmt_putc(_out, '%');
+			continue;
+
+		case 'c':
+			{
+				char c = (char)va_arg(_ap, int);
+
+				if(!(spec.m_flags & SM_FMT_FLAG_LEFT))
+					sm_fmt_pad(_out, ' ', spec.m_width - 1);
+				sm_fmt_putc(_out, c);
+				if(spec.m_flags & SM_FMT_FLAG_LEFT)
+					sm_fmt_pad(_out, ' ', spec.m_width - 1);
+			}
+			continue;
+
+		case 's':
+			sm_fmt_string(_out, &spec, va_arg(_ap, const char*));
+			continue;
+
+		case 'p':
+			sm_fmt_putc(_out, '0');
+			sm_fmt_putc(_out, 'x');
+			spec.m_width -= 2;
+			sm_fmt_number(_out, &spec, (uintptr_t)va_arg(_ap, void*), 0, 16);
+			continue;
+
+		case 'q':
+			spec.m_point = (uint8_t)(spec.m_prec > 0 ? (spec.m_prec < SM_FMT_DIGITS_MAX - 1 ? spec.m_prec :
+					SM_FMT_DIGITS_MAX - 2) : 0);
+			/* fall through */
+		case 'd':
+		case 'i':
+			{
+				int64_t v = length == 2 ? va_arg(_ap, long long) : length == 1 ? va_arg(_ap, long) :
+						va_arg(_ap, int);
+
+				if(length == 0xFF)
+					v = (short)v;
+				else if(length == 0xFE)
+					v = (signed char)v;
+				neg = v < 0;
+				value = neg ? 0 - (uint64_t)v : (uint64_t)v;
+			}
+			sm_fmt_number(_out, &spec, value, neg, 10);
+			continue;
+
+		case 'X':
+			spec.m_flags |= SM_FMT_FLAG_UPPER;
+			/* fall through */
+		case 'x':
+			base = 16;
+			/* fall through */
+		case 'u':
+			value = length == 2 ? va_arg(_ap, unsigned long long) : length == 1 ? va_arg(_ap, unsigned long) :
+					va_arg(_ap, unsigned int);
+			if(length == 0xFF)
+				value = (unsigned short)value;
+			else if(length == 0xFE)
+				value = (unsigned char)value;
+			sm_fmt_number(_out, &spec, value, 0, base);
+			continue;
+
+		default:
+			sm_fmt_putc(_out, '%');
+			sm_fmt_putc(_out, *_fmt);
+			continue;
+		}
+	}
+	return (int32_t)_out->m_total;
+}
+
+int32_t sm_fmt_vsnprintf(char* _buf, uint32_t _size, const char* _fmt, va_list _ap){
+	sm_fmt_out_t out = {_buf, _size, 0, 0, NULL, NULL};
+	int32_t total;
+
+	if(!_fmt || (!_buf && _size))
+		return -1;
+
+	total = sm_fmt_run(&out, _fmt, _ap);
+	if(_size)
+		_buf[out.m_len] = '\0';
+	return total;
+}
+
+int32_t sm_fmt_snprintf(char* _buf, uint32_t _size, const char* _fmt, ...){
+	va_list ap;
+	int32_t total;
+
+	va_start(ap, _fmt);
+	total = sm_fmt_vsnprintf(_buf, _size, _fmt, ap);
+	va_end(ap);
+
+	return total;
+}
+
+int32_t sm_fmt_vprint(sm_fmt_write_fn_t _write, void* _arg, const char* _fmt, va_list _ap){
+	char chunk[SM_FMT_CHUNK_SIZE];
+	sm_fmt_out_t out = {chunk, sizeof(chunk), 0, 0, _write, _arg};
+	int32_t total;
+
+	if(!_write || !_fmt)
+		return -1;
+
+	total = sm_fmt_run(&out, _fmt, _ap);
+	sm_fmt_flush(&out);
+	return total;
+}
+
+int32_t sm_fmt_print(sm_fmt_write_fn_t _write, void* _arg, const char* _fmt, ...){
+	va_list ap;
+	int32_t total;
+
+	va_start(ap, _fmt);
+	total = sm_fmt_vprint(_write, _arg, _fmt, ap);
+	va_end(ap);
+
+	return total;
+}
@@ -0,0 +1,43 @@
+/*
+ * sm_fmt.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_FMT_SM_FMT_H_
+#define SERVICES_SM_FMT_SM_FMT_H_
+
+#include "stdint.h"
+#include <stdarg.h>
+
+/*
+ * Formatter for diagnostics, in place of newlib's vfprintf: no heap, no
+ * floating point, a few hundred bytes of code. Output goes to a caller
+ * buffer (sm_fmt_snprintf) or, a chunk at a time from the stack, to a write
+ * callback such as sm_usb_cdc_print (sm_fmt_print).
+ *
+ *   %d %i %u %x %X %c %s %p %%
+ *   flags '-' '0' '+', width and precision, '*' for either
+ *   length h hh l ll (ll is the slow 64 bit path)
+ *   %q  fixed point: an integer scaled by 10^precision, "%.3q" of 12345
+ *       prints 12.345, "%.1lq" of -5 prints -0.5
+ *
+ * Return values follow snprintf: the length of the whole output, even when
+ * the buffer got less of it.
+ */
+
+/* Stack chunk of sm_fmt_print, one write call per chunk */
+#ifndef SM_FMT_CHUNK_SIZE
+#define SM_FMT_CHUNK_SIZE           32
+#endif
+
+typedef void (*sm_fmt_write_fn_t)(const char* _str, uint32_t _len, void* _arg);
+
+int32_t sm_fmt_vsnprintf(char* _buf, uint32_t _size, const char* _fmt, va_list _ap);
+int32_t sm_fmt_snprintf(char* _buf, uint32_t _size, const char* _fmt, ...);
+
+int32_t sm_fmt_vprint(sm_fmt_write_fn_t _write, void* _arg, const char* _fmt, va_list _ap);
+int32_t sm_fmt_print(sm_fmt_write_fn_t _write, void* _arg, const char* _fmt, ...);
+
+#endif /* SERVICES_SM_FMT_SM_FMT_H_ */
@@ -0,0 +1,153 @@
+/*
+ * sm_fw_decoder.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_fw_decoder.h"
+
+#include <string.h>
+
+#define SM_FW_TOKEN_MATCH         0x80
+#define SM_FW_TOKEN_OLD           0xC0
+#define SM_FW_MATCH_MIN           3
+
+#define SM_FW_WINDOW_MASK         (SM_FW_DECODER_WINDOW - 1)
+
+static uint8_t sm_fw_decoder_token_size(uint8_t _ctrl){
+	if(_ctrl < SM_FW_TOKEN_MATCH)
+		return 1;
+	if(_ctrl < SM_FW_TOKEN_OLD)
+		return 2;
+	return 5;
+}
+
+static int32_t sm_fw_decoder_output(sm_fw_decoder_t* _this, const void* _data, uint32_t _len){
+	if(_this->m_output(_this->m_arg, _data, _len) < 0)
+		return -1;
+
+	_this->m_out_len += _len;
+	return 0;
+}
+
+/* Output a run and keep the tail of it for later matches */
+static int32_t sm_fw_decoder_emit(sm_fw_decoder_t* _this, const uint8_t* _data, uint32_t _len){
+	if(sm_fw_decoder_output(_this, _data, _len) < 0)
+		return -1;
+
+	if(_len > SM_FW_DECODER_WINDOW){
+		_data += _len - SM_FW_DECODER_WINDOW;
+		_len = SM_FW_DECODER_WINDOW;
+	}
+
+	for(uint32_t i = 0; i < _len; i++){
+		_this->m_window[_this->m_window_pos] = _data[i];
+		_this->m_window_pos = (uint8_t)((_this->m_window_pos + 1) & SM_FW_WINDOW_MASK);
+	}
+	return 0;
+}
+
+/* Byte by byte through the window so that overlapping matches (dist < len)
+ * repeat the pattern, as in LZ77 */
+static int32_t sm_fw_decoder_match(sm_fw_decoder_t* _this, uint16_t _len, uint16_t _dist){
+	uint8_t buf[16];
+	uint8_t n = 0;
+
+	if(_dist > _this->m_out_len)
+		return -1;
+
+	while(_len--){
+		uint8_t byte = _this->m_window[(_this->m_window_pos - _dist) & SM_FW_WINDOW_MASK];
+
+		_this->m_window[_this->m_window_pos] = byte;
+		_this->m_window_pos = (uint8_t)((_this->m_window_pos + 1) & SM_FW_WINDOW_MASK);
+
+		buf[n++] = byte;
+		if(n == sizeof(buf) || !_len){
+			if(sm_fw_decoder_output(_this, buf, n) < 0)
+				return -1;
+			n = 0;
+		}
+	}
+	return 0;
+}
+
+static int32_t sm_fw_decoder_execute(sm_fw_decoder_t* _this){
+	const uint8_t* token = _this->m_token;
+	uint8_t ctrl = token[0];
+
+	if(ctrl < SM_FW_TOKEN_MATCH){
+		_this->m_literal_left = (uint16_t)(ctrl + 1);
+		return 0;
+	}
+
+	if(ctrl < SM_FW_TOKEN_OLD)
+		return sm_fw_decoder_match(_this, (uint16_t)((ctrl & 0x3F) + SM_FW_MATCH_MIN), (uint16_t)(token[1] + 1));
+
+	uint32_t len = ((((uint32_t)ctrl & 0x3F) << 8) | token[1]) + 1;
+	uint32_t offset = (uint32_t)token[2] | ((uint32_t)token[3] << 8) | ((uint32_t)token[4] << 16);
+
+	if(!_this->m_old || offset + len > _this->m_old_size)
+		return -1;
+
+	return sm_fw_decoder_emit(_this, _this->m_old + offset, len);
+}
+
+int32_t sm_fw_decoder_init(sm_fw_decoder_t* _this, const void* _old, uint32_t _old_size,
+		sm_fw_decoder_output_fn_t _output, void* _arg){
+	if(!_this || !_output)
+		return -1;
+
+	memset(_this, 0, sizeof(sm_fw_decoder_t));
+	_this->m_old = (const uint8_t*)_old;
+	_this->m_old_size = _old_size;
+	_this->m_output = _output;
+	_this->m_arg = _arg;
+	return 0;
+}
+
+int32_t sm_fw_decoder_put(sm_fw_decoder_t* _this, const uint8_t* _data, uint32_t _len){
+	if(!_this)
+		return -1;
+
+	while(_len){
+		if(_this->m_literal_left){
+			uint32_t chunk = _this->m_literal_left < _len ? _this->m_literal_left : _len;
+
+			if(sm_fw_decoder_emit(_this, _data, chunk) < 0)
+				return -1;
+
+			_this->m_literal_left = (uint16_t)(_this->m_literal_left - chunk);
+			_data += chunk;
+			_len -= chunk;
+			continue;
+		}
+
+		if(!_this->m_token_len){
+			_this->m_token_need = sm_fw_decoder_token_size(*_data);
+		}
+
+		while(_this->m_token_len < _this->m_token_need && _len){
+			_this->m_token[_this->m_token_len++] = *_data++;
+			_len--;
+		}
+
+		if(_this->m_token_len < _this->m_token_need)
+			break;
+
+		_this->m_token_len = 0;
+		if(sm_fw_decoder_execute(_this) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+int32_t sm_fw_decoder_done(sm_fw_decoder_t* _this){
+	return _this && !_this->m_token_len && !_this->m_literal_left;
+}
+
+uint32_t sm_fw_decoder_get_out_len(sm_fw_decoder_t* _this){
+	return _this ? _this->m_out_len : 0;
+}
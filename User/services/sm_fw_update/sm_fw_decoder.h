@@ -0,0 +1,60 @@
+/*
+ * sm_fw_decoder.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_FW_UPDATE_SM_FW_DECODER_H_
+#define SERVICES_SM_FW_UPDATE_SM_FW_DECODER_H_
+
+#include "stdint.h"
+
+/*
+ * Streaming decoder for compressed and delta update payloads
+ * (tools/sm_fw_pack.py builds them).
+ *
+ * The payload is a sequence of tokens, each starting with a control byte:
+ *   0x00 - 0x7F  | c |                  literal: the next c + 1 bytes
+ *   0x80 - 0xBF  | c | dist - 1 |       match: (c & 0x3F) + 3 bytes from dist
+ *                                       bytes back in the output
+ *   0xC0 - 0xFF  | c | lo | offset u24 | old copy: ((c & 0x3F) << 8 | lo) + 1
+ *                                       bytes of the running image at offset
+ *
+ * Matches only reach back SM_FW_DECODER_WINDOW bytes, kept in a RAM ring.
+ * Old copies read the active slot straight from flash, which is what makes a
+ * delta against the running firmware cost almost nothing in RAM.
+ * Tokens may be split anywhere across put() calls.
+ */
+
+#define SM_FW_DECODER_WINDOW      256
+
+typedef int32_t (*sm_fw_decoder_output_fn_t)(void* _arg, const void* _data, uint32_t _len);
+
+typedef struct sm_fw_decoder{
+	const uint8_t* m_old;
+	uint32_t m_old_size;
+	sm_fw_decoder_output_fn_t m_output;
+	void* m_arg;
+	uint32_t m_out_len;
+	uint8_t m_window[SM_FW_DECODER_WINDOW];
+	uint8_t m_window_pos;
+	uint8_t m_token[5];
+	uint8_t m_token_len;
+	uint8_t m_token_need;
+	uint16_t m_literal_left;
+}sm_fw_decoder_t;
+
+int32_t sm_fw_decoder_init(sm_fw_decoder_t* _this, const void* _old, uint32_t _old_size,
+		sm_fw_decoder_output_fn_t _output, void* _arg);
+
+/* Return -1 on a malformed token or an output error */
+int32_t sm_fw_decoder_put(sm_fw_decoder_t* _this, const uint8_t* _data, uint32_t _len);
+
+/* Payload ended on a token boundary */
+int32_t sm_fw_decoder_done(sm_fw_decoder_t* _this);
+
+/* Image bytes produced so far */
+uint32_t sm_fw_decoder_get_out_len(sm_fw_decoder_t* _this);
+
+#endif /* SERVICES_SM_FW_UPDATE_SM_FW_DECODER_H_ */
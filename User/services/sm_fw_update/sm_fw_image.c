@@ -0,0 +1,135 @@
+/*
+ * sm_fw_image.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_fw_image.h"
+#include "sm_flash.h"
+#include "sm_crc.h"
+
+#include <stddef.h>
+
+const sm_fw_image_header_t* sm_fw_image_get_header(uint8_t _slot){
+	if(_slot >= SM_FW_SLOT_NUM)
+		return NULL;
+
+	return (const sm_fw_image_header_t*)SM_FW_META_SLOT_ADDR(_slot);
+}
+
+int32_t sm_fw_image_header_valid(uint8_t _slot){
+	const sm_fw_image_header_t* header = sm_fw_image_get_header(_slot);
+
+	if(!header || header->m_magic != SM_FW_IMAGE_MAGIC)
+		return 0;
+
+	if(header->m_header_crc != sm_crc32(header, SM_FW_HEADER_CRC_SIZE))
+		return 0;
+
+	if(header->m_image_addr != SM_FW_SLOT_ADDR(_slot) || !header->m_image_size ||
+			header->m_image_size > SM_FW_SLOT_SIZE)
+		return 0;
+
+	return 1;
+}
+
+int32_t sm_fw_image_vectors_valid(uint32_t _addr){
+	const uint32_t* vectors = (const uint32_t*)_addr;
+	uint32_t sp = vectors[0];
+	uint32_t reset = vectors[1] & ~1UL;
+
+	if(sp < SRAM_BASE || sp > SRAM_BASE + 16UL * 1024UL || (sp & 0x03UL))
+		return 0;
+
+	if(reset < _addr || reset >= _addr + SM_FW_SLOT_SIZE)
+		return 0;
+
+	return 1;
+}
+
+int32_t sm_fw_image_valid(uint8_t _slot){
+	if(!sm_fw_image_header_valid(_slot))
+		return 0;
+
+	const sm_fw_image_header_t* header = sm_fw_image_get_header(_slot);
+
+	if(!sm_fw_image_vectors_valid(header->m_image_addr))
+		return 0;
+
+	return sm_crc32((const void*)header->m_image_addr, header->m_image_size) == header->m_image_crc;
+}
+
+uint8_t sm_fw_image_attempts_left(uint8_t _slot){
+	const sm_fw_image_header_t* header = sm_fw_image_get_header(_slot);
+	uint8_t left = 0;
+
+	for(uint8_t i = 0; i < SM_FW_MAX_BOOT_ATTEMPTS; i++){
+		if(header->m_attempts[i] == SM_FLASH_ERASED_WORD)
+			left++;
+	}
+	return left;
+}
+
+int32_t sm_fw_image_select(void){
+	int32_t best = -1;
+	uint32_t best_sequence = 0;
+
+	for(uint8_t slot = 0; slot < SM_FW_SLOT_NUM; slot++){
+		if(!sm_fw_image_valid(slot))
+			continue;
+
+		const sm_fw_image_header_t* header = sm_fw_image_get_header(slot);
+
+		if(header->m_confirmed != 0 && !sm_fw_image_attempts_left(slot))
+			continue;
+
+		if(best < 0 || header->m_sequence > best_sequence){
+			best = slot;
+			best_sequence = header->m_sequence;
+		}
+	}
+
+	return best;
+}
+
+int32_t sm_fw_image_write_header(uint8_t _slot, const sm_fw_image_header_t* _header){
+	if(_slot >= SM_FW_SLOT_NUM || !_header)
+		return -1;
+
+	uint32_t addr = SM_FW_META_SLOT_ADDR(_slot);
+
+	if(!sm_flash_is_erased(addr, FMC_FLASH_PAGE_SIZE) && sm_flash_erase(addr) < 0)
+		return -1;
+
+	/* Only the checked part: confirmed and attempts stay erased */
+	return sm_flash_write(addr, (const uint32_t*)_header, SM_FW_HEADER_CRC_SIZE / 4);
+}
+
+int32_t sm_fw_image_consume_attempt(uint8_t _slot){
+	const sm_fw_image_header_t* header = sm_fw_image_get_header(_slot);
+
+	if(!header)
+		return -1;
+
+	for(uint8_t i = 0; i < SM_FW_MAX_BOOT_ATTEMPTS; i++){
+		if(header->m_attempts[i] == SM_FLASH_ERASED_WORD){
+			uint32_t zero = 0;
+			return sm_flash_write((uint32_t)&header->m_attempts[i], &zero, 1);
+		}
+	}
+	return -1;
+}
+
+int32_t sm_fw_image_confirm(uint8_t _slot){
+	const sm_fw_image_header_t* header = sm_fw_image_get_header(_slot);
+
+	if(!header || !sm_fw_image_header_valid(_slot))
+		return -1;
+
+	if(header->m_confirmed == 0)
+		return 0;
+
+	uint32_t zero = 0;
+	return sm_flash_write((uint32_t)&header->m_confirmed, &zero, 1);
+}
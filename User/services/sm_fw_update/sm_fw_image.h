@@ -0,0 +1,78 @@
+/*
+ * sm_fw_image.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_FW_UPDATE_SM_FW_IMAGE_H_
+#define SERVICES_SM_FW_UPDATE_SM_FW_IMAGE_H_
+
+#include "stdint.h"
+#include "NuMicro.h"
+
+/*
+ * A/B slot layout and image header, shared by the application updater and the
+ * bootloader. Must match the MEMORY regions of CMSIS/GCC/gcc_arm*.ld.
+ *
+ * Each slot holds a raw image linked for that slot (gcc_arm.ld for A,
+ * gcc_arm_slot_b.ld for B) starting with its vector table. Its header lives in
+ * its own page of the BOOTMETA region and is written by the updater once the
+ * image CRC has been checked, so an image that was flashed with a debugger
+ * simply has no header.
+ */
+
+#define SM_FW_SLOT_NUM                2
+#define SM_FW_SLOT_A_ADDR             0x00005000UL
+#define SM_FW_SLOT_B_ADDR             0x00010000UL
+#define SM_FW_SLOT_SIZE               (44UL * 1024UL)
+#define SM_FW_META_ADDR               0x0001B000UL
+
+#define SM_FW_IMAGE_MAGIC             0x46574D50UL
+#define SM_FW_MAX_BOOT_ATTEMPTS       3
+
+#define SM_FW_SLOT_ADDR(slot)         ((slot) ? SM_FW_SLOT_B_ADDR : SM_FW_SLOT_A_ADDR)
+#define SM_FW_META_SLOT_ADDR(slot)    (SM_FW_META_ADDR + (uint32_t)(slot) * FMC_FLASH_PAGE_SIZE)
+
+typedef struct sm_fw_image_header{
+	uint32_t m_magic;
+	uint32_t m_image_addr;
+	uint32_t m_image_size;
+	uint32_t m_image_crc;
+	uint32_t m_version;
+	uint32_t m_sequence;          /* the newest valid image boots first */
+	uint32_t m_header_crc;        /* over the words above */
+
+	/* Cleared word by word after the header is written, no erase needed */
+	uint32_t m_confirmed;         /* 0 once the application reports a good boot */
+	uint32_t m_attempts[SM_FW_MAX_BOOT_ATTEMPTS];
+}sm_fw_image_header_t;
+
+#define SM_FW_HEADER_CRC_SIZE         (7 * sizeof(uint32_t))
+
+const sm_fw_image_header_t* sm_fw_image_get_header(uint8_t _slot);
+
+/* Header intact and describing this slot */
+int32_t sm_fw_image_header_valid(uint8_t _slot);
+
+/* Header valid, vector table sane and image CRC-32 matching */
+int32_t sm_fw_image_valid(uint8_t _slot);
+
+/* Sane initial stack pointer and reset vector for an image at _addr */
+int32_t sm_fw_image_vectors_valid(uint32_t _addr);
+
+/* Attempts left before an unconfirmed image is given up */
+uint8_t sm_fw_image_attempts_left(uint8_t _slot);
+
+/* Slot to boot: the newest valid image that is confirmed or still has boot
+ * attempts left, -1 if there is none */
+int32_t sm_fw_image_select(void);
+
+int32_t sm_fw_image_write_header(uint8_t _slot, const sm_fw_image_header_t* _header);
+
+/* Burn one boot attempt of an unconfirmed image */
+int32_t sm_fw_image_consume_attempt(uint8_t _slot);
+
+int32_t sm_fw_image_confirm(uint8_t _slot);
+
+#endif /* SERVICES_SM_FW_UPDATE_SM_FW_IMAGE_H_ */
@@ -0,0 +1,114 @@
+/*
+ * sm_fw_link.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_fw_link.h"
+#include "sm_fw_update.h"
+#include "sm_crc.h"
+
+#define SM_FW_LINK_HEAD             1       /* address */
+#define SM_FW_LINK_CRC              4
+#define SM_FW_LINK_REPLY            7
+
+static uint32_t sm_fw_link_get_u32(const uint8_t* _buf){
+	return (uint32_t)_buf[0] | ((uint32_t)_buf[1] << 8) | ((uint32_t)_buf[2] << 16) | ((uint32_t)_buf[3] << 24);
+}
+
+static void sm_fw_link_put_u32(uint8_t* _buf, uint32_t _value){
+	_buf[0] = (uint8_t)_value;
+	_buf[1] = (uint8_t)(_value >> 8);
+	_buf[2] = (uint8_t)(_value >> 16);
+	_buf[3] = (uint8_t)(_value >> 24);
+}
+
+/* PDMA interrupt: the line went quiet, a frame is in */
+static void sm_fw_link_idle(sm_uart_t* _uart, uint16_t _len, void* _arg){
+	sm_fw_link_t* this = _arg;
+
+	(void)_uart;
+	this->m_idle_len = _len;
+}
+
+static void sm_fw_link_reply(sm_fw_link_t* _this, uint8_t _cmd, int32_t _status){
+	uint8_t reply[SM_FW_LINK_REPLY];
+
+	reply[0] = _this->m_addr;
+	reply[1] = _cmd;
+	reply[2] = _status < 0 ? 1 : 0;
+	sm_fw_link_put_u32(&reply[3], sm_crc32(reply, 3));
+
+	sm_gpio_write(_this->m_de, 1);
+	sm_uart_write(_this->m_uart, reply, sizeof(reply));
+	sm_uart_flush(_this->m_uart);
+	sm_gpio_write(_this->m_de, 0);
+}
+
+int32_t sm_fw_link_init(sm_fw_link_t* _this, sm_uart_t* _uart, sm_gpio_t* _de, uint8_t _addr, uint32_t _idle_us,
+		uint8_t _priority){
+	if(!_this || !_uart || !_de)
+		return -1;
+
+	_this->m_uart = _uart;
+	_this->m_de = _de;
+	_this->m_addr = _addr;
+	_this->m_idle_len = 0;
+	_this->m_frames = 0;
+	_this->m_errors = 0;
+
+	sm_gpio_write(_de, 0);
+	return sm_uart_enable_dma_rx(_uart, _idle_us, _priority, sm_fw_link_idle, _this);
+}
+
+int32_t sm_fw_link_process(sm_fw_link_t* _this){
+	uint8_t* frame;
+	uint16_t len;
+	int32_t status;
+
+	if(!_this || !_this->m_idle_len)
+		return 0;
+
+	len = _this->m_idle_len;
+	_this->m_idle_len = 0;
+
+	if(len > SM_FW_LINK_FRAME_MAX){
+		/* Not ours to read whole: drop it */
+		while(len){
+			int32_t n = sm_uart_read(_this->m_uart, _this->m_buf, len < SM_FW_LINK_FRAME_MAX ? len : SM_FW_LINK_FRAME_MAX);
+
+			if(n <= 0)
+				break;
+			len = (uint16_t)(len - n);
+		}
+		_this->m_errors++;
+		return 0;
+	}
+
+	if(sm_uart_read(_this->m_uart, _this->m_buf, len) != len || len < SM_FW_LINK_HEAD + 1 + SM_FW_LINK_CRC ||
+			sm_crc32(_this->m_buf, len - SM_FW_LINK_CRC) != sm_fw_link_get_u32(&_this->m_buf[len - SM_FW_LINK_CRC])){
+		_this->m_errors++;
+		return 0;
+	}
+
+	if(_this->m_buf[0] != _this->m_addr)
+		return 0;
+
+	_this->m_frames++;
+	frame = &_this->m_buf[SM_FW_LINK_HEAD];
+	len = (uint16_t)(len - SM_FW_LINK_HEAD - SM_FW_LINK_CRC);
+
+	/* Activation resets the chip: answer first */
+	if(frame[0] == SM_FW_CMD_ACTIVATE){
+		status = sm_fw_update_get_state() == SM_FW_UPDATE_READY ? 0 : -1;
+		sm_fw_link_reply(_this, frame[0], status);
+		if(!status)
+			sm_fw_update_activate();
+		return 1;
+	}
+
+	status = sm_fw_update_handle_frame(frame, len);
+	sm_fw_link_reply(_this, frame[0], status);
+	return 1;
+}
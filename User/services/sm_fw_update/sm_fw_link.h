@@ -0,0 +1,53 @@
+/*
+ * sm_fw_link.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_FW_UPDATE_SM_FW_LINK_H_
+#define SERVICES_SM_FW_UPDATE_SM_FW_LINK_H_
+
+#include "stdint.h"
+#include "sm_uart.h"
+#include "sm_gpio.h"
+
+/*
+ * sm_fw_update frames over a half duplex RS485 port. The port receives
+ * through PDMA (sm_uart_enable_dma_rx()) and a quiet line ends a frame, as in
+ * Modbus RTU; the idle callback only notes the length, the frame is checked
+ * and handed to sm_fw_update_handle_frame() from sm_fw_link_process(), in the
+ * main loop, where flash programming and clock changes are allowed.
+ *
+ * Request, to one node, the host waits for the reply before the next:
+ *   | addr u8 | update frame (sm_fw_update.h) | crc32 u32 |
+ * Reply, with the driver enable up:
+ *   | addr u8 | command u8 | status u8 (0 ok, 1 refused) | crc32 u32 |
+ *
+ * The CRC-32 (sm_crc32()) covers everything before it. A frame for another
+ * address, too short, too long or with a bad CRC gets no reply; the host
+ * repeats it, sm_fw_update_write() takes a repeated DATA frame again.
+ */
+
+#define SM_FW_LINK_FRAME_MAX        240     /* below the port's RX buffer, DATA of 230 bytes */
+
+typedef struct sm_fw_link{
+	sm_uart_t* m_uart;
+	sm_gpio_t* m_de;
+	uint8_t m_addr;
+	volatile uint16_t m_idle_len;   /* bytes of the last frame, from the idle callback */
+	uint32_t m_frames;
+	uint32_t m_errors;
+	uint8_t m_buf[SM_FW_LINK_FRAME_MAX];
+}sm_fw_link_t;
+
+/* _uart: created with an even RX buffer larger than SM_FW_LINK_FRAME_MAX.
+ * _de: the transceiver's driver enable, high to send. _idle_us: the silence
+ * that ends a frame, a few characters long. _priority: of UART and PDMA */
+int32_t sm_fw_link_init(sm_fw_link_t* _this, sm_uart_t* _uart, sm_gpio_t* _de, uint8_t _addr, uint32_t _idle_us,
+		uint8_t _priority);
+
+/* Handle a frame that came in, from the main loop. 1 when one was answered */
+int32_t sm_fw_link_process(sm_fw_link_t* _this);
+
+#endif /* SERVICES_SM_FW_UPDATE_SM_FW_LINK_H_ */
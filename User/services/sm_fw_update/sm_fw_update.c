@@ -0,0 +1,260 @@
+/*
+ * sm_fw_update.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_fw_update.h"
+#include "sm_fw_decoder.h"
+#include "sm_flash.h"
+#include "sm_crc.h"
+#include "sm_clock.h"
+
+#include <string.h>
+
+extern uint32_t __Vectors[];
+
+typedef struct sm_fw_update_impl{
+	SM_FW_UPDATE_STATE m_state;
+	uint8_t m_active_slot;
+	uint8_t m_target_slot;
+	uint32_t m_size;
+	uint32_t m_crc;
+	uint32_t m_version;
+	uint32_t m_received;        /* payload bytes */
+	uint32_t m_written;         /* image bytes */
+	SM_FW_ENCODING m_encoding;
+	uint8_t m_clock_held;
+	sm_flash_stream_t m_stream;
+	sm_fw_decoder_t m_decoder;
+}sm_fw_update_impl_t;
+
+static sm_fw_update_impl_t g_fw_update;
+
+static uint32_t sm_fw_update_get_u32(const uint8_t* _buf){
+	return (uint32_t)_buf[0] | ((uint32_t)_buf[1] << 8) | ((uint32_t)_buf[2] << 16) | ((uint32_t)_buf[3] << 24);
+}
+
+/* Full speed from BEGIN until the image is in or the update failed */
+static void sm_fw_update_clock(uint8_t _full){
+	if(_full == g_fw_update.m_clock_held)
+		return;
+
+	g_fw_update.m_clock_held = _full;
+	if(_full)
+		sm_clock_hold();
+	else
+		sm_clock_release();
+}
+
+static int32_t sm_fw_update_fail(void){
+	g_fw_update.m_state = SM_FW_UPDATE_ERROR;
+	sm_fw_update_clock(0);
+	return -1;
+}
+
+static int32_t sm_fw_update_output(void* _arg, const void* _data, uint32_t _len){
+	(void)_arg;
+
+	if(g_fw_update.m_written + _len > g_fw_update.m_size)
+		return -1;
+
+	if(sm_flash_stream_put(&g_fw_update.m_stream, _data, _len) < 0)
+		return -1;
+
+	g_fw_update.m_written += _len;
+	return 0;
+}
+
+int32_t sm_fw_update_init(void){
+	sm_fw_update_clock(0);
+	memset(&g_fw_update, 0, sizeof(g_fw_update));
+
+	g_fw_update.m_active_slot = ((uint32_t)__Vectors == SM_FW_SLOT_B_ADDR) ? 1 : 0;
+	g_fw_update.m_target_slot = (uint8_t)(g_fw_update.m_active_slot ^ 1);
+	g_fw_update.m_state = SM_FW_UPDATE_IDLE;
+
+	sm_flash_init();
+	sm_crc_init();
+	return 0;
+}
+
+uint8_t sm_fw_update_active_slot(void){
+	return g_fw_update.m_active_slot;
+}
+
+uint32_t sm_fw_update_target_addr(void){
+	return SM_FW_SLOT_ADDR(g_fw_update.m_target_slot);
+}
+
+SM_FW_UPDATE_STATE sm_fw_update_get_state(void){
+	return g_fw_update.m_state;
+}
+
+int32_t sm_fw_update_begin(uint32_t _image_addr, uint32_t _size, uint32_t _crc, uint32_t _version,
+		SM_FW_ENCODING _encoding){
+	uint8_t slot = g_fw_update.m_target_slot;
+
+	if(_image_addr != SM_FW_SLOT_ADDR(slot) || !_size || _size > SM_FW_SLOT_SIZE ||
+			_encoding > SM_FW_ENCODING_PACKED)
+		return -1;
+
+	/* Drop the old header first: a half written slot must never look bootable */
+	uint32_t meta = SM_FW_META_SLOT_ADDR(slot);
+	if(!sm_flash_is_erased(meta, FMC_FLASH_PAGE_SIZE) && sm_flash_erase(meta) < 0)
+		return sm_fw_update_fail();
+
+	if(sm_flash_stream_open(&g_fw_update.m_stream, _image_addr, SM_FW_SLOT_SIZE) < 0)
+		return sm_fw_update_fail();
+
+	if(_encoding == SM_FW_ENCODING_PACKED){
+		/* Old copies come from the running image */
+		uint8_t active = g_fw_update.m_active_slot;
+		uint32_t old_size = SM_FW_SLOT_SIZE;
+
+		if(sm_fw_image_header_valid(active))
+			old_size = sm_fw_image_get_header(active)->m_image_size;
+
+		sm_fw_decoder_init(&g_fw_update.m_decoder, (const void*)SM_FW_SLOT_ADDR(active), old_size,
+				sm_fw_update_output, NULL);
+	}
+
+	g_fw_update.m_size = _size;
+	g_fw_update.m_crc = _crc;
+	g_fw_update.m_version = _version;
+	g_fw_update.m_encoding = _encoding;
+	g_fw_update.m_received = 0;
+	g_fw_update.m_written = 0;
+	g_fw_update.m_state = SM_FW_UPDATE_RECEIVING;
+	sm_fw_update_clock(1);
+	return 0;
+}
+
+int32_t sm_fw_update_write(uint32_t _offset, const void* _data, uint32_t _len){
+	if(g_fw_update.m_state != SM_FW_UPDATE_RECEIVING)
+		return -1;
+
+	/* A repeated frame (lost ack) is accepted again without being rewritten */
+	if(_offset + _len <= g_fw_update.m_received)
+		return 0;
+
+	if(_offset != g_fw_update.m_received)
+		return -1;
+
+	int32_t ret;
+	if(g_fw_update.m_encoding == SM_FW_ENCODING_PACKED){
+		ret = sm_fw_decoder_put(&g_fw_update.m_decoder, (const uint8_t*)_data, _len);
+	}else{
+		ret = sm_fw_update_output(NULL, _data, _len);
+	}
+
+	if(ret < 0)
+		return sm_fw_update_fail();
+
+	g_fw_update.m_received += _len;
+	return 0;
+}
+
+int32_t sm_fw_update_finish(void){
+	if(g_fw_update.m_state != SM_FW_UPDATE_RECEIVING || g_fw_update.m_written != g_fw_update.m_size)
+		return -1;
+
+	if(g_fw_update.m_encoding == SM_FW_ENCODING_PACKED && !sm_fw_decoder_done(&g_fw_update.m_decoder))
+		return -1;
+
+	if(sm_flash_stream_close(&g_fw_update.m_stream) < 0)
+		return sm_fw_update_fail();
+
+	uint8_t slot = g_fw_update.m_target_slot;
+	uint32_t addr = SM_FW_SLOT_ADDR(slot);
+
+	if(!sm_fw_image_vectors_valid(addr) || sm_crc32((const void*)addr, g_fw_update.m_size) != g_fw_update.m_crc)
+		return sm_fw_update_fail();
+
+	sm_fw_image_header_t header;
+	memset(&header, 0xFF, sizeof(header));
+
+	header.m_magic = SM_FW_IMAGE_MAGIC;
+	header.m_image_addr = addr;
+	header.m_image_size = g_fw_update.m_size;
+	header.m_image_crc = g_fw_update.m_crc;
+	header.m_version = g_fw_update.m_version;
+	header.m_sequence = 1;
+
+	uint8_t active = g_fw_update.m_active_slot;
+	if(sm_fw_image_header_valid(active))
+		header.m_sequence = sm_fw_image_get_header(active)->m_sequence + 1;
+
+	header.m_header_crc = sm_crc32(&header, SM_FW_HEADER_CRC_SIZE);
+
+	if(sm_fw_image_write_header(slot, &header) < 0 || !sm_fw_image_header_valid(slot))
+		return sm_fw_update_fail();
+
+	g_fw_update.m_state = SM_FW_UPDATE_READY;
+	sm_fw_update_clock(0);
+	return 0;
+}
+
+int32_t sm_fw_update_process(void){
+	if(g_fw_update.m_state != SM_FW_UPDATE_RECEIVING)
+		return 0;
+
+	int32_t ret = sm_flash_stream_process(&g_fw_update.m_stream);
+	if(ret < 0)
+		return sm_fw_update_fail();
+
+	return ret;
+}
+
+int32_t sm_fw_update_activate(void){
+	if(g_fw_update.m_state != SM_FW_UPDATE_READY)
+		return -1;
+
+	/* A chip reset, not NVIC_SystemReset(): the bootloader's VECMAP has to
+	 * go back to CONFIG0 so that the bootloader picks the new slot */
+	SYS_UnlockReg();
+	SYS_ResetChip();
+	return 0;
+}
+
+int32_t sm_fw_update_confirm(void){
+	uint8_t slot = g_fw_update.m_active_slot;
+
+	/* Running from a slot without header (flashed by a debugger): nothing to confirm */
+	if(!sm_fw_image_header_valid(slot))
+		return 0;
+
+	return sm_fw_image_confirm(slot);
+}
+
+int32_t sm_fw_update_handle_frame(const uint8_t* _frame, uint16_t _len){
+	if(!_frame || !_len)
+		return -1;
+
+	switch(_frame[0]){
+	case SM_FW_CMD_BEGIN:
+		if(_len < 17)
+			return -1;
+		return sm_fw_update_begin(sm_fw_update_get_u32(&_frame[1]), sm_fw_update_get_u32(&_frame[5]),
+				sm_fw_update_get_u32(&_frame[9]), sm_fw_update_get_u32(&_frame[13]),
+				_len > 17 ? (SM_FW_ENCODING)_frame[17] : SM_FW_ENCODING_RAW);
+
+	case SM_FW_CMD_DATA:
+		if(_len < 5)
+			return -1;
+		return sm_fw_update_write(sm_fw_update_get_u32(&_frame[1]), &_frame[5], _len - 5);
+
+	case SM_FW_CMD_END:
+		return sm_fw_update_finish();
+
+	case SM_FW_CMD_ACTIVATE:
+		return sm_fw_update_activate();
+
+	case SM_FW_CMD_CONFIRM:
+		return sm_fw_update_confirm();
+
+	default:
+		return -1;
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * sm_fw_update.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_FW_UPDATE_SM_FW_UPDATE_H_
+#define SERVICES_SM_FW_UPDATE_SM_FW_UPDATE_H_
+
+#include "stdint.h"
+#include "sm_fw_image.h"
+
+/*
+ * In-application updater: the image is received into the inactive slot while
+ * the active one keeps running, checked, given a header and booted by the
+ * bootloader after sm_fw_update_activate(). HCLK is held at full speed
+ * (sm_clock_hold()) from BEGIN until the image is checked or the update
+ * failed. Call the updater from thread level.
+ *
+ * Transport independent: a link passes its payloads to
+ * sm_fw_update_handle_frame() and sends the return code back; sm_fw_link is
+ * the RS485 one, on uart_rs485_1 from main.
+ *
+ * Frames (little endian):
+ *   BEGIN    | 0x01 | image addr u32 | size u32 | crc32 u32 | version u32 | [encoding u8] |
+ *   DATA     | 0x02 | offset u32 | data ... |
+ *   END      | 0x03 |
+ *   ACTIVATE | 0x04 |
+ *   CONFIRM  | 0x05 |
+ *
+ * size and crc32 always describe the decoded image. With SM_FW_ENCODING_PACKED
+ * the DATA offsets count payload bytes, which sm_fw_decoder expands on the fly
+ * (compressed, or a delta against the running slot).
+ */
+
+typedef enum{
+	SM_FW_CMD_BEGIN = 0x01,
+	SM_FW_CMD_DATA,
+	SM_FW_CMD_END,
+	SM_FW_CMD_ACTIVATE,
+	SM_FW_CMD_CONFIRM,
+}SM_FW_CMD;
+
+typedef enum{
+	SM_FW_ENCODING_RAW = 0,
+	SM_FW_ENCODING_PACKED,
+}SM_FW_ENCODING;
+
+typedef enum{
+	SM_FW_UPDATE_IDLE = 0,
+	SM_FW_UPDATE_RECEIVING,
+	SM_FW_UPDATE_READY,
+	SM_FW_UPDATE_ERROR,
+}SM_FW_UPDATE_STATE;
+
+int32_t sm_fw_update_init(void);
+
+uint8_t sm_fw_update_active_slot(void);
+
+/* Link address the next image must be built for (the inactive slot) */
+uint32_t sm_fw_update_target_addr(void);
+
+SM_FW_UPDATE_STATE sm_fw_update_get_state(void);
+
+int32_t sm_fw_update_begin(uint32_t _image_addr, uint32_t _size, uint32_t _crc, uint32_t _version,
+		SM_FW_ENCODING _encoding);
+
+/* Payload must arrive in order. Return -1 on a gap, a bad token or a flash error */
+int32_t sm_fw_update_write(uint32_t _offset, const void* _data, uint32_t _len);
+
+int32_t sm_fw_update_finish(void);
+
+/* Program pending flash in the background, call from the main loop */
+int32_t sm_fw_update_process(void);
+
+/* Reset into the bootloader, which picks the newest valid slot */
+int32_t sm_fw_update_activate(void);
+
+/* Mark the running image good, otherwise the bootloader rolls back after
+ * SM_FW_MAX_BOOT_ATTEMPTS resets */
+int32_t sm_fw_update_confirm(void);
+
+int32_t sm_fw_update_handle_frame(const uint8_t* _frame, uint16_t _len);
+
+#endif /* SERVICES_SM_FW_UPDATE_SM_FW_UPDATE_H_ */
@@ -0,0 +1,585 @@
+/*
+ * sm_kernel.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_kernel.h"
+#include "sm_clock.h"
+#include "sm_ram.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+#define SM_KERNEL_IDLE              SM_KERNEL_THREAD_MAX
+#define SM_KERNEL_FRAME_WORDS       16      /* r4-r11, then r0-r3 r12 lr pc xpsr */
+#define SM_KERNEL_XPSR_T            0x01000000UL
+#define SM_KERNEL_BOOT_WORDS        32
+
+typedef enum{
+	SM_KERNEL_FREE,
+	SM_KERNEL_READY,
+	SM_KERNEL_SLEEP,
+	SM_KERNEL_WAIT,
+	SM_KERNEL_DEAD
+}sm_kernel_state_t;
+
+typedef struct sm_kernel_tcb{
+	uint32_t m_sp;                  /* first: PendSV_Handler saves and loads it */
+	struct sm_kernel_tcb* m_next;   /* in a ready list or a wait list */
+	const char* m_name;
+	uint8_t m_state;
+	uint8_t m_base;                 /* priority given at create */
+	uint8_t m_prio;                 /* the one it runs at, lent by mutex waiters */
+	uint8_t m_timed;
+	int32_t m_result;
+	uint32_t m_wake;
+	struct sm_kernel_tcb** m_list;  /* wait list it is on */
+	sm_kernel_mutex_t* m_blocked;   /* mutex it waits for */
+	sm_kernel_mutex_t* m_held;      /* mutexes it owns */
+	uint32_t* m_stack;
+	uint32_t m_stack_size;
+}sm_kernel_tcb_t;
+
+/* Read by PendSV_Handler (sm_kernel_port.S): keep the fields in this order */
+typedef struct sm_kernel_switch{
+	sm_kernel_tcb_t* m_current;
+	sm_kernel_tcb_t* m_next;
+	uint32_t m_enter;               /* SysTick->VAL when the switch began */
+	uint32_t m_cycles_max;          /* longest switch, core clocks */
+}sm_kernel_switch_t;
+
+typedef struct sm_kernel{
+	sm_kernel_tcb_t m_tcb[SM_KERNEL_THREAD_MAX + 1];
+	sm_kernel_tcb_t* m_ready[SM_KERNEL_PRIO_NUM];
+	sm_kernel_tcb_t* m_ready_tail[SM_KERNEL_PRIO_NUM];
+	uint8_t m_ready_map;            /* bit n: level n has a ready thread */
+	uint8_t m_started;
+	int8_t m_fault;
+	volatile uint32_t m_ticks;
+}sm_kernel_t;
+
+sm_kernel_switch_t g_kernel_switch;
+
+static sm_kernel_t g_kernel = {.m_fault = -1};
+static uint32_t g_kernel_idle_stack[SM_KERNEL_IDLE_STACK_SIZE / 4];
+static uint32_t g_kernel_boot[SM_KERNEL_BOOT_WORDS] __attribute__((aligned(8)));
+
+/* Lowest set bit of a nibble; the idle level keeps the map from being 0 */
+static const uint8_t g_kernel_lsb[16] = {0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0};
+
+static const char* const g_kernel_state_name[] = {"free", "ready", "sleep", "wait", "dead"};
+
+static uint8_t sm_kernel_top(void){
+	uint8_t map = g_kernel.m_ready_map;
+
+	return (map & 0x0F) ? g_kernel_lsb[map & 0x0F] : (uint8_t)(4 + g_kernel_lsb[map >> 4]);
+}
+
+static void sm_kernel_ready_add(sm_kernel_tcb_t* _tcb, uint8_t _front){
+	uint8_t prio = _tcb->m_prio;
+
+	_tcb->m_state = SM_KERNEL_READY;
+	if(!g_kernel.m_ready[prio]){
+		_tcb->m_next = NULL;
+		g_kernel.m_ready[prio] = _tcb;
+		g_kernel.m_ready_tail[prio] = _tcb;
+	}else if(_front){
+		_tcb->m_next = g_kernel.m_ready[prio];
+		g_kernel.m_ready[prio] = _tcb;
+	}else{
+		_tcb->m_next = NULL;
+		g_kernel.m_ready_tail[prio]->m_next = _tcb;
+		g_kernel.m_ready_tail[prio] = _tcb;
+	}
+	g_kernel.m_ready_map |= (uint8_t)(1U << prio);
+}
+
+static void sm_kernel_ready_remove(sm_kernel_tcb_t* _tcb){
+	uint8_t prio = _tcb->m_prio;
+	sm_kernel_tcb_t* prev = NULL;
+
+	for(sm_kernel_tcb_t* t = g_kernel.m_ready[prio]; t && t != _tcb; t = t->m_next)
+		prev = t;
+
+	if(prev)
+		prev->m_next = _tcb->m_next;
+	else
+		g_kernel.m_ready[prio] = _tcb->m_next;
+	if(g_kernel.m_ready_tail[prio] == _tcb)
+		g_kernel.m_ready_tail[prio] = prev;
+	if(!g_kernel.m_ready[prio])
+		g_kernel.m_ready_map &= (uint8_t)~(1U << prio);
+	_tcb->m_next = NULL;
+}
+
+/* Wait lists keep the highest priority first, FIFO among equals */
+static void sm_kernel_wait_insert(sm_kernel_tcb_t** _list, sm_kernel_tcb_t* _tcb){
+	sm_kernel_tcb_t** link = _list;
+
+	while(*link && (*link)->m_prio <= _tcb->m_prio)
+		link = &(*link)->m_next;
+	_tcb->m_next = *link;
+	*link = _tcb;
+	_tcb->m_list = _list;
+}
+
+static void sm_kernel_wait_remove(sm_kernel_tcb_t* _tcb){
+	sm_kernel_tcb_t** link = _tcb->m_list;
+
+	while(*link && *link != _tcb)
+		link = &(*link)->m_next;
+	if(*link)
+		*link = _tcb->m_next;
+	_tcb->m_next = NULL;
+	_tcb->m_list = NULL;
+}
+
+/* Pick the thread to run and have PendSV switch to it. Interrupts off */
+static void sm_kernel_schedule(void){
+	sm_kernel_tcb_t* next = g_kernel.m_ready[sm_kernel_top()];
+
+	g_kernel_switch.m_next = next;
+	if(g_kernel.m_started && next != g_kernel_switch.m_current)
+		SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* Take the running thread off the ready list. The switch happens once the
+ * caller turns interrupts back on */
+static void sm_kernel_block(sm_kernel_tcb_t** _list, uint8_t _state, uint32_t _timeout){
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+
+	sm_kernel_ready_remove(cur);
+	cur->m_state = _state;
+	cur->m_result = 0;
+	cur->m_timed = _timeout != SM_KERNEL_WAIT_FOREVER;
+	cur->m_wake = g_kernel.m_ticks + _timeout;
+	if(_list)
+		sm_kernel_wait_insert(_list, cur);
+	sm_kernel_schedule();
+}
+
+static void sm_kernel_wake(sm_kernel_tcb_t* _tcb, int32_t _result){
+	if(_tcb->m_list)
+		sm_kernel_wait_remove(_tcb);
+	_tcb->m_timed = 0;
+	_tcb->m_result = _result;
+	sm_kernel_ready_add(_tcb, 0);
+}
+
+static uint8_t sm_kernel_inherited(const sm_kernel_tcb_t* _tcb){
+	uint8_t prio = _tcb->m_base;
+
+	for(const sm_kernel_mutex_t* m = _tcb->m_held; m; m = m->m_next){
+		const sm_kernel_tcb_t* waiter = m->m_wait;
+
+		if(waiter && waiter->m_prio < prio)
+			prio = waiter->m_prio;
+	}
+	return prio;
+}
+
+/* Priority of _tcb after its held mutexes changed, passed on along the chain
+ * of owners it is blocked behind */
+static void sm_kernel_update_prio(sm_kernel_tcb_t* _tcb){
+	for(uint8_t n = 0; _tcb && n <= SM_KERNEL_THREAD_MAX; n++){
+		uint8_t prio = sm_kernel_inherited(_tcb);
+
+		if(prio == _tcb->m_prio)
+			return;
+
+		if(_tcb->m_state == SM_KERNEL_READY){
+			sm_kernel_ready_remove(_tcb);
+			_tcb->m_prio = prio;
+			sm_kernel_ready_add(_tcb, _tcb == g_kernel_switch.m_current);
+		}else{
+			_tcb->m_prio = prio;
+			if(_tcb->m_list){
+				sm_kernel_tcb_t** list = _tcb->m_list;
+
+				sm_kernel_wait_remove(_tcb);
+				sm_kernel_wait_insert(list, _tcb);
+			}
+		}
+		_tcb = _tcb->m_blocked ? _tcb->m_blocked->m_owner : NULL;
+	}
+}
+
+static void sm_kernel_exit(void){
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	sm_kernel_ready_remove(g_kernel_switch.m_current);
+	g_kernel_switch.m_current->m_state = SM_KERNEL_DEAD;
+	sm_kernel_schedule();
+	__set_PRIMASK(primask);
+
+	while(1);
+}
+
+static void sm_kernel_idle(void* _arg){
+	(void)_arg;
+	while(1)
+		__WFI();
+}
+
+static int32_t sm_kernel_guard_ok(const uint32_t* _stack){
+	for(uint32_t i = 0; i < SM_RAM_STACK_GUARD_SIZE / 4; i++){
+		if(_stack[i] != SM_RAM_STACK_PAINT)
+			return 0;
+	}
+	return 1;
+}
+
+static void sm_kernel_check_stacks(void){
+	if(g_kernel.m_fault >= 0)
+		return;
+
+	if(sm_ram_stack_check() < 0){
+		g_kernel.m_fault = SM_KERNEL_THREAD_MAX;
+		return;
+	}
+	for(uint8_t i = 0; i < SM_KERNEL_THREAD_MAX; i++){
+		const sm_kernel_tcb_t* tcb = &g_kernel.m_tcb[i];
+
+		if(tcb->m_state != SM_KERNEL_FREE && !sm_kernel_guard_ok(tcb->m_stack)){
+			g_kernel.m_fault = (int8_t)i;
+			return;
+		}
+	}
+}
+
+void SysTick_Handler(void){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t ticks;
+
+	__disable_irq();
+	ticks = ++g_kernel.m_ticks;
+
+	for(uint8_t i = 0; i < SM_KERNEL_THREAD_MAX; i++){
+		sm_kernel_tcb_t* tcb = &g_kernel.m_tcb[i];
+		sm_kernel_mutex_t* mutex = tcb->m_blocked;
+
+		if(!tcb->m_timed || (int32_t)(ticks - tcb->m_wake) < 0)
+			continue;
+
+		tcb->m_blocked = NULL;
+		sm_kernel_wake(tcb, -1);
+		if(mutex)
+			sm_kernel_update_prio(mutex->m_owner);
+	}
+	sm_kernel_schedule();
+	__set_PRIMASK(primask);
+
+	sm_kernel_check_stacks();
+}
+
+static void sm_kernel_systick(uint32_t _hclk){
+	SysTick->LOAD = _hclk / SM_KERNEL_TICK_HZ - 1;
+	SysTick->VAL = 0;
+}
+
+static void sm_kernel_clock(sm_clock_event_t _event, uint32_t _hclk, void* _arg){
+	(void)_arg;
+	if(_event == SM_CLOCK_POST && g_kernel.m_started)
+		sm_kernel_systick(_hclk);
+}
+
+static int32_t sm_kernel_create(uint8_t _index, const char* _name, sm_kernel_fn_t _fn, void* _arg, uint8_t _priority,
+		void* _stack, uint32_t _stack_size){
+	sm_kernel_tcb_t* tcb = &g_kernel.m_tcb[_index];
+	uint32_t top = ((uint32_t)_stack + _stack_size) & ~7UL;
+	uint32_t* frame = (uint32_t*)top - SM_KERNEL_FRAME_WORDS;
+
+	sm_ram_paint(_stack, _stack_size);
+	for(uint8_t i = 0; i < SM_KERNEL_FRAME_WORDS; i++)
+		frame[i] = 0;
+	frame[8] = (uint32_t)_arg;
+	frame[13] = (uint32_t)sm_kernel_exit;
+	frame[14] = (uint32_t)_fn & ~1UL;
+	frame[15] = SM_KERNEL_XPSR_T;
+
+	tcb->m_sp = (uint32_t)frame;
+	tcb->m_name = _name;
+	tcb->m_base = _priority;
+	tcb->m_prio = _priority;
+	tcb->m_timed = 0;
+	tcb->m_list = NULL;
+	tcb->m_blocked = NULL;
+	tcb->m_held = NULL;
+	tcb->m_stack = _stack;
+	tcb->m_stack_size = _stack_size;
+	sm_kernel_ready_add(tcb, 0);
+
+	return _index;
+}
+
+int32_t sm_kernel_init(void){
+	if(g_kernel.m_tcb[SM_KERNEL_IDLE].m_state != SM_KERNEL_FREE)
+		return 0;
+
+	sm_kernel_create(SM_KERNEL_IDLE, "idle", sm_kernel_idle, NULL, SM_KERNEL_PRIO_IDLE, g_kernel_idle_stack,
+			sizeof(g_kernel_idle_stack));
+	sm_clock_register(sm_kernel_clock, NULL);
+
+	return 0;
+}
+
+int32_t sm_kernel_thread(const char* _name, sm_kernel_fn_t _fn, void* _arg, uint8_t _priority, void* _stack,
+		uint32_t _stack_size){
+	uint32_t primask;
+	int32_t id = -1;
+
+	if(!_fn || !_stack || _stack_size < SM_KERNEL_STACK_MIN || ((uint32_t)_stack & 3) ||
+			_priority >= SM_KERNEL_PRIO_IDLE)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < SM_KERNEL_THREAD_MAX; i++){
+		if(g_kernel.m_tcb[i].m_state == SM_KERNEL_FREE || g_kernel.m_tcb[i].m_state == SM_KERNEL_DEAD){
+			id = sm_kernel_create(i, _name, _fn, _arg, _priority, _stack, _stack_size);
+			sm_kernel_schedule();
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return id;
+}
+
+void sm_kernel_start(void){
+	sm_kernel_init();
+
+	__disable_irq();
+	NVIC_SetPriority(PendSV_IRQn, (1UL << __NVIC_PRIO_BITS) - 1);
+	NVIC_SetPriority(SysTick_IRQn, (1UL << __NVIC_PRIO_BITS) - 1);
+	sm_kernel_systick(SystemCoreClock);
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	/* Thread mode goes to PSP on a scratch area: the first PendSV stacks its
+	 * frame there and, with no current thread, loads the first one */
+	g_kernel.m_started = 1;
+	g_kernel_switch.m_current = NULL;
+	__set_PSP((uint32_t)&g_kernel_boot[SM_KERNEL_BOOT_WORDS]);
+	__set_CONTROL(__get_CONTROL() | CONTROL_SPSEL_Msk);
+	__ISB();
+
+	sm_kernel_schedule();
+	__enable_irq();
+
+	while(1);
+}
+
+int32_t sm_kernel_self(void){
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+
+	return cur ? (int32_t)(cur - g_kernel.m_tcb) : -1;
+}
+
+uint32_t sm_kernel_ticks(void){
+	return g_kernel.m_ticks;
+}
+
+void sm_kernel_sleep(uint32_t _ticks){
+	uint32_t primask;
+
+	if(!g_kernel_switch.m_current)
+		return;
+	if(!_ticks){
+		sm_kernel_yield();
+		return;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	sm_kernel_block(NULL, SM_KERNEL_SLEEP, _ticks);
+	__set_PRIMASK(primask);
+}
+
+/* Behind the other ready threads of the same priority */
+void sm_kernel_yield(void){
+	uint32_t primask = __get_PRIMASK();
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+
+	if(!cur)
+		return;
+
+	__disable_irq();
+	sm_kernel_ready_remove(cur);
+	sm_kernel_ready_add(cur, 0);
+	sm_kernel_schedule();
+	__set_PRIMASK(primask);
+}
+
+int32_t sm_kernel_sem_init(sm_kernel_sem_t* _sem, uint32_t _count, uint32_t _max){
+	if(!_sem || !_max || _count > _max)
+		return -1;
+
+	_sem->m_count = _count;
+	_sem->m_max = _max;
+	_sem->m_wait = NULL;
+	return 0;
+}
+
+int32_t sm_kernel_sem_take(sm_kernel_sem_t* _sem, uint32_t _timeout){
+	uint32_t primask;
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+
+	if(!_sem)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(_sem->m_count){
+		_sem->m_count--;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	if(!_timeout || !cur){
+		__set_PRIMASK(primask);
+		return -1;
+	}
+	sm_kernel_block((sm_kernel_tcb_t**)&_sem->m_wait, SM_KERNEL_WAIT, _timeout);
+	__set_PRIMASK(primask);
+
+	/* Back here once given (0) or timed out (-1) */
+	return cur->m_result;
+}
+
+int32_t sm_kernel_sem_give(sm_kernel_sem_t* _sem){
+	uint32_t primask;
+	int32_t ret = 0;
+
+	if(!_sem)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(_sem->m_wait){
+		sm_kernel_wake(_sem->m_wait, 0);
+		sm_kernel_schedule();
+	}else if(_sem->m_count < _sem->m_max){
+		_sem->m_count++;
+	}else{
+		ret = -1;
+	}
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+int32_t sm_kernel_mutex_init(sm_kernel_mutex_t* _mutex){
+	if(!_mutex)
+		return -1;
+
+	_mutex->m_owner = NULL;
+	_mutex->m_wait = NULL;
+	_mutex->m_next = NULL;
+	return 0;
+}
+
+int32_t sm_kernel_mutex_lock(sm_kernel_mutex_t* _mutex, uint32_t _timeout){
+	uint32_t primask;
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+
+	if(!_mutex || !cur)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(!_mutex->m_owner){
+		_mutex->m_owner = cur;
+		_mutex->m_next = cur->m_held;
+		cur->m_held = _mutex;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	if(_mutex->m_owner == cur || !_timeout){
+		__set_PRIMASK(primask);
+		return -1;
+	}
+
+	cur->m_blocked = _mutex;
+	sm_kernel_block((sm_kernel_tcb_t**)&_mutex->m_wait, SM_KERNEL_WAIT, _timeout);
+	sm_kernel_update_prio(_mutex->m_owner);
+	sm_kernel_schedule();
+	__set_PRIMASK(primask);
+
+	/* The unlock hands the mutex over before waking us */
+	return cur->m_result;
+}
+
+int32_t sm_kernel_mutex_unlock(sm_kernel_mutex_t* _mutex){
+	uint32_t primask;
+	sm_kernel_tcb_t* cur = g_kernel_switch.m_current;
+	sm_kernel_tcb_t* next;
+
+	if(!_mutex)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(_mutex->m_owner != cur){
+		__set_PRIMASK(primask);
+		return -1;
+	}
+
+	for(sm_kernel_mutex_t** link = &cur->m_held; *link; link = &(*link)->m_next){
+		if(*link == _mutex){
+			*link = _mutex->m_next;
+			break;
+		}
+	}
+
+	next = _mutex->m_wait;
+	_mutex->m_owner = next;
+	if(next){
+		next->m_blocked = NULL;
+		sm_kernel_wake(next, 0);
+		_mutex->m_next = next->m_held;
+		next->m_held = _mutex;
+		sm_kernel_update_prio(next);
+	}
+
+	/* Give back what the waiters lent */
+	sm_kernel_update_prio(cur);
+	sm_kernel_schedule();
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int32_t sm_kernel_stack_fault(void){
+	return g_kernel.m_fault;
+}
+
+uint32_t sm_kernel_switch_cycles(void){
+	return g_kernel_switch.m_cycles_max;
+}
+
+int32_t sm_kernel_dump(sm_fmt_write_fn_t _write, void* _arg){
+	if(!_write)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "kernel: tick %lu, stack fault %ld\r\n",
+			(unsigned long)g_kernel.m_ticks, (long)g_kernel.m_fault);
+	sm_fmt_print(_write, _arg, "  switch max %lu cycles, %lu ns\r\n",
+			(unsigned long)g_kernel_switch.m_cycles_max,
+			(unsigned long)(g_kernel_switch.m_cycles_max * 1000UL / (SystemCoreClock / 1000000UL)));
+
+	for(uint8_t i = 0; i <= SM_KERNEL_THREAD_MAX; i++){
+		const sm_kernel_tcb_t* tcb = &g_kernel.m_tcb[i];
+
+		if(tcb->m_state == SM_KERNEL_FREE)
+			continue;
+
+		sm_fmt_print(_write, _arg, "  %-8s p%u/%u %-5s stack %lu/%lu%s\r\n",
+				tcb->m_name ? tcb->m_name : "?", tcb->m_prio, tcb->m_base, g_kernel_state_name[tcb->m_state],
+				(unsigned long)sm_ram_high_water(tcb->m_stack, tcb->m_stack_size), (unsigned long)tcb->m_stack_size,
+				tcb == g_kernel_switch.m_current ? " *" : "");
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * sm_kernel.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_KERNEL_SM_KERNEL_H_
+#define SERVICES_SM_KERNEL_SM_KERNEL_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * Preemptive fixed-priority kernel for the Cortex-M23. Threads run in thread
+ * mode on their own PSP stack, interrupts keep the main stack. PendSV, at the
+ * lowest interrupt priority, only swaps the registers of the thread that ran
+ * for the one already picked when the ready set changed, so a switch is a few
+ * dozen cycles. SysTick drives sleeps and timeouts and checks the stacks.
+ *
+ * Priority 0 is the highest. Threads of the same priority run first come,
+ * first served: there is no time slice, a thread runs until it blocks, yields
+ * or a higher one becomes ready. The lowest level is the idle thread's.
+ *
+ * Semaphores may be given from interrupts. Mutexes are for threads only and
+ * lend the owner the priority of its highest waiter, through chains of
+ * owners blocked on other mutexes as well.
+ *
+ * Blocking calls have to be made with interrupts enabled, from a thread.
+ *
+ * The PendSV_Handler here runs the sm_defer bottom halves, when linked, before
+ * it switches; the firmware build defines SM_DEFER_PENDSV_HANDLER=0 so that
+ * sm_defer does not define a second one.
+ */
+
+#define SM_KERNEL_THREAD_MAX        8
+#define SM_KERNEL_PRIO_NUM          8
+#define SM_KERNEL_PRIO_IDLE         (SM_KERNEL_PRIO_NUM - 1)
+
+#ifndef SM_KERNEL_TICK_HZ
+#define SM_KERNEL_TICK_HZ           1000
+#endif
+
+#define SM_KERNEL_IDLE_STACK_SIZE   128
+/* Thread stacks need the exception frame and the saved registers at least */
+#define SM_KERNEL_STACK_MIN         128
+
+#define SM_KERNEL_WAIT_FOREVER      0xFFFFFFFFUL
+
+typedef void (*sm_kernel_fn_t)(void* _arg);
+
+typedef struct sm_kernel_sem{
+	uint32_t m_count;
+	uint32_t m_max;
+	void* m_wait;                   /* waiting threads, highest priority first */
+}sm_kernel_sem_t;
+
+typedef struct sm_kernel_mutex{
+	void* m_owner;
+	void* m_wait;
+	struct sm_kernel_mutex* m_next; /* next mutex the owner holds */
+}sm_kernel_mutex_t;
+
+int32_t sm_kernel_init(void);
+
+/* _stack is painted and kept by the thread. Return the thread id, or -1 */
+int32_t sm_kernel_thread(const char* _name, sm_kernel_fn_t _fn, void* _arg, uint8_t _priority, void* _stack,
+		uint32_t _stack_size);
+
+/* Start SysTick and the highest thread. The caller's context is dropped */
+void sm_kernel_start(void) __attribute__((noreturn));
+
+int32_t sm_kernel_self(void);
+uint32_t sm_kernel_ticks(void);
+void sm_kernel_sleep(uint32_t _ticks);
+void sm_kernel_yield(void);
+
+int32_t sm_kernel_sem_init(sm_kernel_sem_t* _sem, uint32_t _count, uint32_t _max);
+/* 0 when taken, -1 on timeout. _timeout 0 polls */
+int32_t sm_kernel_sem_take(sm_kernel_sem_t* _sem, uint32_t _timeout);
+/* Thread or interrupt. -1 when the count is already at _max */
+int32_t sm_kernel_sem_give(sm_kernel_sem_t* _sem);
+
+int32_t sm_kernel_mutex_init(sm_kernel_mutex_t* _mutex);
+int32_t sm_kernel_mutex_lock(sm_kernel_mutex_t* _mutex, uint32_t _timeout);
+int32_t sm_kernel_mutex_unlock(sm_kernel_mutex_t* _mutex);
+
+/* Thread whose stack guard was touched, SM_KERNEL_THREAD_MAX for the main
+ * stack, -1 while none was. Latched until reset */
+int32_t sm_kernel_stack_fault(void);
+
+/* Longest context switch in PendSV so far, core clocks; the exception entry
+ * and return, about 15 clocks each on the M23, come on top */
+uint32_t sm_kernel_switch_cycles(void);
+
+int32_t sm_kernel_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_KERNEL_SM_KERNEL_H_ */
@@ -0,0 +1,352 @@
+/*
+ * sm_kv.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_kv.h"
+#include "sm_flash.h"
+#include "sm_crc.h"
+
+#include <string.h>
+
+/* Page layout:  | magic | sequence | record | record | ... | 0xFF... |
+ * Record layout: | len << 16 | key | value, padded to a word | crc32 |
+ * A record with len 0 is a tombstone. The CRC word is programmed last, so a
+ * record torn by a reset fails its check and is skipped on the next boot. */
+#define SM_KV_PAGE_MAGIC          0x314B5653UL
+#define SM_KV_PAGE_HEADER_SIZE    8
+#define SM_KV_RECORD_OVERHEAD     8
+
+#define SM_KV_ALIGN4(x)           (((x) + 3UL) & ~3UL)
+#define SM_KV_RECORD_SIZE(len)    (SM_KV_RECORD_OVERHEAD + SM_KV_ALIGN4(len))
+#define SM_KV_RECORD_KEY(hdr)     ((uint16_t)((hdr) & 0xFFFFUL))
+#define SM_KV_RECORD_LEN(hdr)     ((uint16_t)((hdr) >> 16))
+
+extern const uint32_t __kv_store_start__[];
+extern const uint32_t __kv_store_end__[];
+
+typedef struct sm_kv_impl{
+	uint32_t m_base;
+	uint16_t m_page_num;
+	uint16_t m_head;
+	uint16_t m_tail;
+	uint16_t m_used;
+	uint16_t m_head_offset;
+	uint16_t m_gc_offset;
+	uint32_t m_sequence;
+	uint32_t m_erase_count;
+	uint32_t m_index[SM_KV_MAX_KEYS];
+}sm_kv_impl_t;
+
+static sm_kv_impl_t g_kv;
+
+static inline uint32_t sm_kv_page_addr(uint16_t _page){
+	return g_kv.m_base + (uint32_t)_page * SM_FLASH_PAGE_SIZE;
+}
+
+static inline uint16_t sm_kv_next_page(uint16_t _page){
+	return (uint16_t)((_page + 1) % g_kv.m_page_num);
+}
+
+static inline uint16_t sm_kv_free_pages(void){
+	return (uint16_t)(g_kv.m_page_num - g_kv.m_used);
+}
+
+static uint32_t sm_kv_record_crc(uint32_t _hdr, const void* _value, uint16_t _len){
+	uint32_t crc = sm_crc32_update(SM_CRC32_INIT, &_hdr, sizeof(_hdr));
+	crc = sm_crc32_update(crc, _value, _len);
+	return sm_crc32_final(crc);
+}
+
+/* Return the record size when the record at _addr is intact, 0 when it is
+ * torn (still skippable) and -1 when the rest of the page can't be parsed */
+static int32_t sm_kv_check_record(uint32_t _addr, uint32_t _page_end){
+	uint32_t hdr = *(const uint32_t*)_addr;
+
+	if(hdr == SM_FLASH_ERASED_WORD)
+		return -1;
+
+	uint16_t key = SM_KV_RECORD_KEY(hdr);
+	uint16_t len = SM_KV_RECORD_LEN(hdr);
+	uint32_t size = SM_KV_RECORD_SIZE(len);
+
+	if(key >= SM_KV_MAX_KEYS || len > SM_KV_MAX_VALUE_SIZE || _addr + size > _page_end)
+		return -1;
+
+	uint32_t crc = *(const uint32_t*)(_addr + size - 4);
+	if(crc != sm_kv_record_crc(hdr, (const void*)(_addr + 4), len))
+		return 0;
+
+	return (int32_t)size;
+}
+
+static int32_t sm_kv_open_next_page(void){
+	if(!sm_kv_free_pages())
+		return -1;
+
+	uint16_t page = sm_kv_next_page(g_kv.m_head);
+	uint32_t addr = sm_kv_page_addr(page);
+
+	if(!sm_flash_is_erased(addr, SM_FLASH_PAGE_SIZE)){
+		if(sm_flash_erase(addr) < 0)
+			return -1;
+		g_kv.m_erase_count++;
+	}
+
+	uint32_t header[2] = {SM_KV_PAGE_MAGIC, g_kv.m_sequence + 1};
+	if(sm_flash_write(addr, header, 2) < 0)
+		return -1;
+
+	g_kv.m_sequence++;
+	g_kv.m_head = page;
+	g_kv.m_head_offset = SM_KV_PAGE_HEADER_SIZE;
+	g_kv.m_used++;
+	return 0;
+}
+
+static int32_t sm_kv_append(uint16_t _key, const void* _value, uint16_t _len){
+	uint32_t record[(SM_KV_RECORD_OVERHEAD + SM_KV_MAX_VALUE_SIZE) / 4];
+	uint32_t size = SM_KV_RECORD_SIZE(_len);
+
+	if(g_kv.m_head_offset + size > SM_FLASH_PAGE_SIZE){
+		if(sm_kv_open_next_page() < 0)
+			return -1;
+	}
+
+	memset(record, 0xFF, size);
+	record[0] = ((uint32_t)_len << 16) | _key;
+	if(_len)
+		memcpy(&record[1], _value, _len);
+	record[size / 4 - 1] = sm_kv_record_crc(record[0], _value, _len);
+
+	uint32_t addr = sm_kv_page_addr(g_kv.m_head) + g_kv.m_head_offset;
+
+	/* The offset moves even on failure: the words may be half programmed */
+	g_kv.m_head_offset += size;
+	if(sm_flash_write(addr, record, size / 4) < 0)
+		return -1;
+
+	g_kv.m_index[_key] = _len ? addr : 0;
+	return 0;
+}
+
+/* Move one live record out of the tail page, or erase the tail once it is
+ * drained. Return 1 if something was done */
+static int32_t sm_kv_compact_step(void){
+	if(g_kv.m_tail == g_kv.m_head)
+		return 0;
+
+	uint32_t page_addr = sm_kv_page_addr(g_kv.m_tail);
+	uint32_t page_end = page_addr + SM_FLASH_PAGE_SIZE;
+
+	if(!g_kv.m_gc_offset)
+		g_kv.m_gc_offset = SM_KV_PAGE_HEADER_SIZE;
+
+	while(g_kv.m_gc_offset + SM_KV_RECORD_OVERHEAD <= SM_FLASH_PAGE_SIZE){
+		uint32_t addr = page_addr + g_kv.m_gc_offset;
+		int32_t size = sm_kv_check_record(addr, page_end);
+
+		if(size < 0)
+			break;
+
+		if(size == 0){
+			g_kv.m_gc_offset += SM_KV_RECORD_SIZE(SM_KV_RECORD_LEN(*(const uint32_t*)addr));
+			continue;
+		}
+
+		g_kv.m_gc_offset += size;
+
+		uint32_t hdr = *(const uint32_t*)addr;
+		uint16_t key = SM_KV_RECORD_KEY(hdr);
+		if(g_kv.m_index[key] != addr)
+			continue;
+
+		if(sm_kv_append(key, (const void*)(addr + 4), SM_KV_RECORD_LEN(hdr)) < 0)
+			return -1;
+		return 1;
+	}
+
+	if(sm_flash_erase(page_addr) < 0)
+		return -1;
+
+	g_kv.m_erase_count++;
+	g_kv.m_tail = sm_kv_next_page(g_kv.m_tail);
+	g_kv.m_used--;
+	g_kv.m_gc_offset = 0;
+	return 1;
+}
+
+/* Make room for a record of _size bytes. Opening a page for it must still
+ * leave one erased page for compaction to copy into */
+static int32_t sm_kv_reserve(uint32_t _size){
+	uint16_t rounds = g_kv.m_page_num;
+
+	while(g_kv.m_head_offset + _size > SM_FLASH_PAGE_SIZE && sm_kv_free_pages() <= 1){
+		if(!rounds--)
+			return -1;
+
+		uint16_t tail = g_kv.m_tail;
+		while(g_kv.m_tail == tail){
+			if(sm_kv_compact_step() <= 0)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+static int32_t sm_kv_format(void){
+	g_kv.m_head = (uint16_t)(g_kv.m_page_num - 1);
+	g_kv.m_tail = 0;
+	g_kv.m_used = 0;
+	g_kv.m_sequence = 0;
+
+	return sm_kv_open_next_page();
+}
+
+static void sm_kv_replay_page(uint16_t _page){
+	uint32_t page_addr = sm_kv_page_addr(_page);
+	uint32_t page_end = page_addr + SM_FLASH_PAGE_SIZE;
+	uint32_t offset = SM_KV_PAGE_HEADER_SIZE;
+
+	while(offset + SM_KV_RECORD_OVERHEAD <= SM_FLASH_PAGE_SIZE){
+		uint32_t addr = page_addr + offset;
+		uint32_t hdr = *(const uint32_t*)addr;
+		int32_t size = sm_kv_check_record(addr, page_end);
+
+		if(size < 0){
+			/* Garbage that is not erased space: nothing more can go in this page */
+			if(hdr != SM_FLASH_ERASED_WORD)
+				offset = SM_FLASH_PAGE_SIZE;
+			break;
+		}
+
+		if(size == 0){
+			offset += SM_KV_RECORD_SIZE(SM_KV_RECORD_LEN(hdr));
+			continue;
+		}
+
+		g_kv.m_index[SM_KV_RECORD_KEY(hdr)] = SM_KV_RECORD_LEN(hdr) ? addr : 0;
+		offset += size;
+	}
+
+	g_kv.m_head_offset = (uint16_t)offset;
+}
+
+int32_t sm_kv_init(void){
+	memset(&g_kv, 0, sizeof(g_kv));
+
+	g_kv.m_base = (uint32_t)__kv_store_start__;
+	g_kv.m_page_num = (uint16_t)(((uint32_t)__kv_store_end__ - g_kv.m_base) / SM_FLASH_PAGE_SIZE);
+
+	if(g_kv.m_page_num < SM_KV_GC_RESERVE_PAGES + 2)
+		return -1;
+
+	sm_flash_init();
+	sm_crc_init();
+
+	uint32_t min_seq = 0xFFFFFFFFUL;
+	uint32_t max_seq = 0;
+
+	for(uint16_t page = 0; page < g_kv.m_page_num; page++){
+		const uint32_t* header = (const uint32_t*)sm_kv_page_addr(page);
+
+		if(header[0] != SM_KV_PAGE_MAGIC || header[1] == SM_FLASH_ERASED_WORD)
+			continue;
+
+		if(header[1] < min_seq){
+			min_seq = header[1];
+			g_kv.m_tail = page;
+		}
+		if(header[1] >= max_seq){
+			max_seq = header[1];
+			g_kv.m_head = page;
+		}
+	}
+
+	if(!max_seq)
+		return sm_kv_format();
+
+	g_kv.m_sequence = max_seq;
+	g_kv.m_used = (uint16_t)((g_kv.m_head + g_kv.m_page_num - g_kv.m_tail) % g_kv.m_page_num + 1);
+
+	/* Replay oldest to newest so the index ends up on the latest records */
+	for(uint16_t page = g_kv.m_tail, i = 0; i < g_kv.m_used; page = sm_kv_next_page(page), i++){
+		sm_kv_replay_page(page);
+	}
+
+	return 0;
+}
+
+int32_t sm_kv_read(uint16_t _key, void* _buf, uint16_t _size){
+	uint16_t len;
+	const void* value = sm_kv_get(_key, &len);
+
+	if(!value)
+		return -1;
+
+	memcpy(_buf, value, len < _size ? len : _size);
+	return len;
+}
+
+const void* sm_kv_get(uint16_t _key, uint16_t* _len){
+	if(_key >= SM_KV_MAX_KEYS || !g_kv.m_index[_key])
+		return NULL;
+
+	uint32_t addr = g_kv.m_index[_key];
+	if(_len)
+		*_len = SM_KV_RECORD_LEN(*(const uint32_t*)addr);
+
+	return (const void*)(addr + 4);
+}
+
+int32_t sm_kv_write(uint16_t _key, const void* _value, uint16_t _len){
+	if(_key >= SM_KV_MAX_KEYS || !_value || !_len || _len > SM_KV_MAX_VALUE_SIZE)
+		return -1;
+
+	uint16_t len;
+	const void* current = sm_kv_get(_key, &len);
+	if(current && len == _len && !memcmp(current, _value, _len))
+		return 0;
+
+	if(sm_kv_reserve(SM_KV_RECORD_SIZE(_len)) < 0)
+		return -1;
+
+	return sm_kv_append(_key, _value, _len);
+}
+
+int32_t sm_kv_delete(uint16_t _key){
+	if(_key >= SM_KV_MAX_KEYS)
+		return -1;
+
+	if(!g_kv.m_index[_key])
+		return 0;
+
+	if(sm_kv_reserve(SM_KV_RECORD_OVERHEAD) < 0)
+		return -1;
+
+	return sm_kv_append(_key, NULL, 0);
+}
+
+int32_t sm_kv_process(void){
+	if(!g_kv.m_page_num)
+		return -1;
+
+	if(sm_kv_free_pages() > SM_KV_GC_RESERVE_PAGES && !g_kv.m_gc_offset)
+		return 0;
+
+	return sm_kv_compact_step();
+}
+
+int32_t sm_kv_get_stat(sm_kv_stat_t* _stat){
+	if(!_stat)
+		return -1;
+
+	_stat->m_page_num = g_kv.m_page_num;
+	_stat->m_used_pages = g_kv.m_used;
+	_stat->m_free_bytes = (uint16_t)(SM_FLASH_PAGE_SIZE - g_kv.m_head_offset);
+	_stat->m_sequence = g_kv.m_sequence;
+	_stat->m_erase_count = g_kv.m_erase_count;
+	return 0;
+}
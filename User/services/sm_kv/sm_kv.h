@@ -0,0 +1,63 @@
+/*
+ * sm_kv.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_KV_SM_KV_H_
+#define SERVICES_SM_KV_SM_KV_H_
+
+#include "stdint.h"
+
+/*
+ * Log-structured key/value store on the KVSTORE pages of gcc_arm.ld.
+ *
+ * Every write appends a record (header, value, CRC-32) to the active page, so
+ * a page is never read-modified-written. The pages form a ring: the oldest one
+ * is compacted (live records copied to the head) and erased by
+ * sm_kv_process(), which spreads erases evenly over the whole region.
+ * The RAM index maps each key straight to its latest record.
+ */
+
+#define SM_KV_MAX_KEYS            64
+#define SM_KV_MAX_VALUE_SIZE      128
+/* Erased pages kept in hand; compaction starts when we drop to this */
+#define SM_KV_GC_RESERVE_PAGES    2
+
+typedef enum{
+	SM_KV_KEY_CALIBRATION = 0,
+	SM_KV_KEY_STATION_CONFIG,
+	SM_KV_KEY_RELAY_BSS_CYCLES,
+	SM_KV_KEY_RELAY_FAN_CYCLES,
+	SM_KV_KEY_RELAY_CHR_CYCLES,
+	SM_KV_KEY_USER_BASE = 16,
+}SM_KV_KEY;
+
+typedef struct sm_kv_stat{
+	uint16_t m_page_num;
+	uint16_t m_used_pages;
+	uint16_t m_free_bytes;     /* left in the active page */
+	uint32_t m_sequence;       /* pages opened since the region was formatted */
+	uint32_t m_erase_count;    /* erases done since boot */
+}sm_kv_stat_t;
+
+int32_t sm_kv_init(void);
+
+/* Return the value length, or -1 if the key holds no value */
+int32_t sm_kv_read(uint16_t _key, void* _buf, uint16_t _size);
+
+/* Zero-copy access to the value in flash, valid until the next write/process */
+const void* sm_kv_get(uint16_t _key, uint16_t* _len);
+
+/* Writing the value already stored is a no-op and costs no flash */
+int32_t sm_kv_write(uint16_t _key, const void* _value, uint16_t _len);
+
+int32_t sm_kv_delete(uint16_t _key);
+
+/* Background compaction, call from the main loop. Return 1 while there is work left */
+int32_t sm_kv_process(void);
+
+int32_t sm_kv_get_stat(sm_kv_stat_t* _stat);
+
+#endif /* SERVICES_SM_KV_SM_KV_H_ */
@@ -0,0 +1,31 @@
+/*
+ * sm_libc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_LIBC_SM_LIBC_H_
+#define SERVICES_SM_LIBC_SM_LIBC_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * sm_libc_m23.S replaces newlib's memcpy, memset, memcmp and strlen at link
+ * time (SM_LIBC_ENABLE, on by default); nothing to call, the usual string.h
+ * names are the fast ones.
+ *
+ * sm_libc_bench() times whatever the image links against a plain byte loop,
+ * for a few sizes and for aligned, equally misaligned and mismatched buffers,
+ * and checks every result. It runs on the target with sm_prof_cycles() as the
+ * clock, and on the host (make -C host bench) against the host libc. Build
+ * the target once with SM_LIBC_ENABLE 0 to get the newlib figures.
+ */
+
+/* _buf is the scratch the copies run in, sizes go up to about _size / 2.
+ * Return -1 when a result was wrong */
+int32_t sm_libc_bench(uint8_t* _buf, uint32_t _size, uint32_t (*_clock)(void), sm_fmt_write_fn_t _write,
+		void* _arg);
+
+#endif /* SERVICES_SM_LIBC_SM_LIBC_H_ */
@@ -0,0 +1,191 @@
+/*
+ * sm_libc_bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_libc.h"
+#include "sm_fmt.h"
+
+#include <string.h>
+
+#define SM_LIBC_ROUNDS              8
+#define SM_LIBC_SLACK               8
+
+typedef enum{
+	SM_LIBC_MEMCPY,
+	SM_LIBC_MEMSET,
+	SM_LIBC_MEMCMP,
+	SM_LIBC_STRLEN,
+	SM_LIBC_FN_NUM
+}sm_libc_fn_t;
+
+static const char* const g_libc_fn_name[SM_LIBC_FN_NUM] = {"memcpy", "memset", "memcmp", "strlen"};
+
+static const uint32_t g_libc_size[] = {8, 16, 64, 256, 1024, 4096};
+
+/* dst / src offsets from a word boundary: aligned, both off by one, mismatched */
+static const uint8_t g_libc_offset[][2] = {{0, 0}, {1, 1}, {1, 2}};
+
+/* The byte loops the library is measured against. Volatile so the compiler
+ * does not turn them back into library calls */
+static void sm_libc_ref_cpy(uint8_t* _dst, const uint8_t* _src, uint32_t _len){
+	volatile uint8_t* dst = _dst;
+
+	while(_len--)
+		*dst++ = *_src++;
+}
+
+static void sm_libc_ref_set(uint8_t* _dst, uint8_t _value, uint32_t _len){
+	volatile uint8_t* dst = _dst;
+
+	while(_len--)
+		*dst++ = _value;
+}
+
+static int32_t sm_libc_ref_cmp(const uint8_t* _a, const uint8_t* _b, uint32_t _len){
+	const volatile uint8_t* a = _a;
+
+	for(; _len; _len--, a++, _b++){
+		if(*a != *_b)
+			return *a - *_b;
+	}
+	return 0;
+}
+
+static uint32_t sm_libc_ref_len(const char* _str){
+	const volatile char* str = _str;
+
+	while(*str)
+		str++;
+	return (uint32_t)(str - _str);
+}
+
+/* One call of _fn, library or reference. Return -1 when its result is wrong */
+static int32_t sm_libc_call(sm_libc_fn_t _fn, uint8_t _ref, uint8_t* _dst, uint8_t* _src, uint32_t _len){
+	switch(_fn){
+	case SM_LIBC_MEMCPY:
+		if(_ref)
+			sm_libc_ref_cpy(_dst, _src, _len);
+		else if(memcpy(_dst, _src, _len) != _dst)
+			return -1;
+		return 0;
+
+	case SM_LIBC_MEMSET:
+		if(_ref)
+			sm_libc_ref_set(_dst, 0xA5, _len);
+		else if(memset(_dst, 0xA5, _len) != _dst)
+			return -1;
+		return 0;
+
+	case SM_LIBC_MEMCMP:
+		if(_ref)
+			return sm_libc_ref_cmp(_dst, _src, _len) > 0 ? 0 : -1;
+		return memcmp(_dst, _src, _len) > 0 ? 0 : -1;
+
+	case SM_LIBC_STRLEN:
+	default:
+		if(_ref)
+			return sm_libc_ref_len((const char*)_src) == _len ? 0 : -1;
+		return strlen((const char*)_src) == _len ? 0 : -1;
+	}
+}
+
+/* Fill the buffers for _fn: memcmp gets equal runs where the last byte of
+ * _dst is the greater, strlen a string of _len */
+static void sm_libc_prepare(sm_libc_fn_t _fn, uint8_t* _dst, uint8_t* _src, uint32_t _len){
+	for(uint32_t i = 0; i < _len; i++){
+		_src[i] = (uint8_t)(((i * 7) & 0x7F) | 0x01);
+		_dst[i] = _fn == SM_LIBC_MEMCMP ? _src[i] : (uint8_t)~_src[i];
+	}
+
+	if(_fn == SM_LIBC_MEMCMP)
+		_dst[_len - 1] |= 0x80;
+	if(_fn == SM_LIBC_STRLEN)
+		_src[_len] = 0;
+}
+
+/* Every byte in place and nothing written around the run */
+static int32_t sm_libc_verify(sm_libc_fn_t _fn, const uint8_t* _dst, const uint8_t* _src, uint32_t _len){
+	if(_dst[-1] != 0x5A || _dst[_len] != 0x5A)
+		return -1;
+
+	for(uint32_t i = 0; i < _len; i++){
+		if(_fn == SM_LIBC_MEMCPY && _dst[i] != _src[i])
+			return -1;
+		if(_fn == SM_LIBC_MEMSET && _dst[i] != 0xA5)
+			return -1;
+	}
+	return 0;
+}
+
+/* Best of SM_LIBC_ROUNDS, an interrupt in one round does not count */
+static uint32_t sm_libc_time(sm_libc_fn_t _fn, uint8_t _ref, uint8_t* _dst, uint8_t* _src, uint32_t _len,
+		uint32_t (*_clock)(void), int32_t* _err){
+	uint32_t best = UINT32_MAX;
+
+	for(uint8_t n = 0; n < SM_LIBC_ROUNDS; n++){
+		uint32_t start;
+		uint32_t time;
+
+		_dst[-1] = 0x5A;
+		_dst[_len] = 0x5A;
+		sm_libc_prepare(_fn, _dst, _src, _len);
+		start = _clock();
+		if(sm_libc_call(_fn, _ref, _dst, _src, _len) < 0)
+			*_err = -1;
+		time = _clock() - start;
+		if(time < best)
+			best = time;
+
+		if(sm_libc_verify(_fn, _dst, _src, _len) < 0)
+			*_err = -1;
+	}
+	return best;
+}
+
+int32_t sm_libc_bench(uint8_t* _buf, uint32_t _size, uint32_t (*_clock)(void), sm_fmt_write_fn_t _write,
+		void* _arg){
+	uint32_t half = _size > 4 ? ((_size - 4) / 2) & ~3UL : 0;
+	int32_t err = 0;
+
+	if(!_buf || !_clock || !_write || half <= SM_LIBC_SLACK)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "libc: %-6s %5s %5s %8s %8s %6s\r\n", "fn", "size", "d/s", "lib", "byte",
+			"x");
+
+	for(uint8_t fn = 0; fn < SM_LIBC_FN_NUM; fn++){
+		for(uint8_t s = 0; s < sizeof(g_libc_size) / sizeof(g_libc_size[0]); s++){
+			uint32_t size = g_libc_size[s];
+
+			if(size > half - SM_LIBC_SLACK)
+				break;
+
+			for(uint8_t o = 0; o < sizeof(g_libc_offset) / sizeof(g_libc_offset[0]); o++){
+				uint8_t* base = (uint8_t*)(((uintptr_t)_buf + 3) & ~(uintptr_t)3);
+				uint8_t* dst = base + 4 + g_libc_offset[o][0];
+				uint8_t* src = base + half + 4 + g_libc_offset[o][1];
+				int32_t fn_err = 0;
+				uint32_t lib;
+				uint32_t ref;
+
+				/* One offset is enough for the single buffer ones */
+				if((fn == SM_LIBC_MEMSET || fn == SM_LIBC_STRLEN) && g_libc_offset[o][0] != g_libc_offset[o][1])
+					continue;
+
+				lib = sm_libc_time(fn, 0, dst, src, size, _clock, &fn_err);
+				ref = sm_libc_time(fn, 1, dst, src, size, _clock, &fn_err);
+				if(fn_err)
+					err = -1;
+
+				sm_fmt_print(_write, _arg, "      %-6s %5lu %2u/%-2u %8lu %8lu %3lu.%lu%s\r\n",
+						g_libc_fn_name[fn], (unsigned long)size, g_libc_offset[o][0], g_libc_offset[o][1],
+						(unsigned long)lib, (unsigned long)ref, (unsigned long)(lib ? ref / lib : 0),
+						(unsigned long)(lib ? ref * 10 / lib % 10 : 0), fn_err ? " FAIL" : "");
+			}
+		}
+	}
+	return err;
+}
@@ -0,0 +1,161 @@
+/*
+ * sm_mem.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_mem.h"
+#include "sm_pdma.h"
+
+#include <string.h>
+
+#define SM_MEM_MAX_COUNT            ((PDMA_DSCT_CTL_TXCNT_Msk >> PDMA_DSCT_CTL_TXCNT_Pos) + 1)
+
+typedef struct sm_mem{
+	int32_t m_ch;
+	volatile uint8_t m_busy;
+	sm_mem_done_fn_t m_done;
+	void* m_arg;
+	uint32_t m_fill;                /* source of a fill, read by the channel */
+}sm_mem_t;
+
+static sm_mem_t g_mem = {.m_ch = -1};
+
+static void sm_mem_event(int32_t _ch, uint32_t _events, void* _arg){
+	sm_mem_done_fn_t done = g_mem.m_done;
+
+	(void)_ch;
+	(void)_arg;
+	if(!(_events & (SM_PDMA_EVT_DONE | SM_PDMA_EVT_ABORT)))
+		return;
+
+	/* Free before the callback so it can start the next one */
+	g_mem.m_busy = 0;
+	if(done)
+		done(_events & SM_PDMA_EVT_ABORT ? -1 : 0, g_mem.m_arg);
+}
+
+/* Widest unit both addresses can move in: 4, 2 or 1 */
+static uint32_t sm_mem_unit(uint32_t _dst, uint32_t _src){
+	uint32_t diff = _dst ^ _src;
+
+	if(!(diff & 3))
+		return 4;
+	if(!(diff & 1))
+		return 2;
+	return 1;
+}
+
+static uint32_t sm_mem_width(uint32_t _unit){
+	if(_unit == 4)
+		return PDMA_WIDTH_32;
+	if(_unit == 2)
+		return PDMA_WIDTH_16;
+	return PDMA_WIDTH_8;
+}
+
+/* Claim the channel, 0 when the CPU has to do it */
+static uint8_t sm_mem_claim(uint32_t _len){
+	uint32_t primask;
+	uint8_t claimed = 0;
+
+	if(g_mem.m_ch < 0 || _len < SM_MEM_DMA_MIN)
+		return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(!g_mem.m_busy){
+		g_mem.m_busy = 1;
+		claimed = 1;
+	}
+	__set_PRIMASK(primask);
+
+	return claimed;
+}
+
+static int32_t sm_mem_start(uint32_t _dst, uint32_t _src, uint32_t _count, uint32_t _unit, uint32_t _sar,
+		sm_mem_done_fn_t _done, void* _arg){
+	g_mem.m_done = _done;
+	g_mem.m_arg = _arg;
+
+	if(sm_pdma_start_basic(g_mem.m_ch, _src, _dst, _count,
+			sm_mem_width(_unit) | _sar | PDMA_DAR_INC | PDMA_REQ_BURST | PDMA_BURST_128) < 0){
+		g_mem.m_busy = 0;
+		return -1;
+	}
+	return SM_MEM_PENDING;
+}
+
+int32_t sm_mem_init(uint8_t _priority){
+	if(g_mem.m_ch >= 0)
+		return 0;
+
+	sm_pdma_init(_priority);
+	g_mem.m_ch = sm_pdma_alloc(PDMA_MEM, 0, sm_mem_event, NULL);
+
+	return g_mem.m_ch < 0 ? -1 : 0;
+}
+
+int32_t sm_memcpy_async(void* _dst, const void* _src, uint32_t _len, sm_mem_done_fn_t _done, void* _arg){
+	uint32_t dst = (uint32_t)_dst;
+	uint32_t src = (uint32_t)_src;
+	uint32_t unit;
+	uint32_t head;
+	uint32_t count;
+
+	if(!_dst || !_src)
+		return -1;
+
+	if(!sm_mem_claim(_len)){
+		memcpy(_dst, _src, _len);
+		return SM_MEM_DONE;
+	}
+
+	/* CPU takes the bytes up to the first aligned unit and the ones past the last */
+	unit = sm_mem_unit(dst, src);
+	head = (unit - (dst & (unit - 1))) & (unit - 1);
+	count = (_len - head) / unit;
+	if(count > SM_MEM_MAX_COUNT)
+		count = SM_MEM_MAX_COUNT;
+
+	memcpy(_dst, _src, head);
+	memcpy((uint8_t*)_dst + head + count * unit, (const uint8_t*)_src + head + count * unit,
+			_len - head - count * unit);
+
+	return sm_mem_start(dst + head, src + head, count, unit, PDMA_SAR_INC, _done, _arg);
+}
+
+int32_t sm_memset_async(void* _dst, uint8_t _value, uint32_t _len, sm_mem_done_fn_t _done, void* _arg){
+	uint32_t dst = (uint32_t)_dst;
+	uint32_t head;
+	uint32_t count;
+
+	if(!_dst)
+		return -1;
+
+	if(!sm_mem_claim(_len)){
+		memset(_dst, _value, _len);
+		return SM_MEM_DONE;
+	}
+
+	head = (4 - (dst & 3)) & 3;
+	count = (_len - head) / 4;
+	if(count > SM_MEM_MAX_COUNT)
+		count = SM_MEM_MAX_COUNT;
+
+	memset(_dst, _value, head);
+	memset((uint8_t*)_dst + head + count * 4, _value, _len - head - count * 4);
+
+	/* The channel reads the pattern word over and over */
+	g_mem.m_fill = _value * 0x01010101UL;
+	return sm_mem_start(dst + head, (uint32_t)&g_mem.m_fill, count, 4, PDMA_SAR_FIX, _done, _arg);
+}
+
+uint8_t sm_mem_is_busy(void){
+	return g_mem.m_busy;
+}
+
+void sm_mem_wait(void){
+	while(g_mem.m_busy);
+}
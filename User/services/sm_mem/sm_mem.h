@@ -0,0 +1,48 @@
+/*
+ * sm_mem.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_MEM_SM_MEM_H_
+#define SERVICES_SM_MEM_SM_MEM_H_
+
+#include "stdint.h"
+
+/*
+ * Bulk copy and fill on a PDMA memory channel (PDMA_MEM). The CPU does the
+ * unaligned head and tail bytes, the channel moves the body at the widest
+ * width the two addresses allow, and the caller gets _done from
+ * PDMA_IRQHandler while it carries on with control code.
+ *
+ * Below SM_MEM_DMA_MIN bytes, while the channel is still busy, or before
+ * sm_mem_init(), the call is served on the spot by memcpy()/memset(), the
+ * sm_libc_m23.S ones. The return value tells which: SM_MEM_DONE and _done is
+ * not called, or SM_MEM_PENDING and the buffers belong to the channel until
+ * _done. _done gets 0 when the channel finished, -1 when it was aborted
+ * (a bus error): the destination is then only partly written.
+ */
+
+/* Under this, setting up the channel and taking its interrupt costs more */
+#ifndef SM_MEM_DMA_MIN
+#define SM_MEM_DMA_MIN              128
+#endif
+
+#define SM_MEM_DONE                 0
+#define SM_MEM_PENDING              1
+
+typedef void (*sm_mem_done_fn_t)(int32_t _status, void* _arg);
+
+/* Take a PDMA channel, PDMA interrupt at _priority */
+int32_t sm_mem_init(uint8_t _priority);
+
+int32_t sm_memcpy_async(void* _dst, const void* _src, uint32_t _len, sm_mem_done_fn_t _done, void* _arg);
+int32_t sm_memset_async(void* _dst, uint8_t _value, uint32_t _len, sm_mem_done_fn_t _done, void* _arg);
+
+uint8_t sm_mem_is_busy(void);
+
+/* Spin until the transfer in flight is done */
+void sm_mem_wait(void);
+
+#endif /* SERVICES_SM_MEM_SM_MEM_H_ */
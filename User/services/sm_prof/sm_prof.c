@@ -0,0 +1,363 @@
+/*
+ * sm_prof.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_prof.h"
+#include "sm_clock.h"
+#include "sm_fmt.h"
+
+#include <string.h>
+
+#define SM_PROF_TIMER             TIMER3
+#define SM_PROF_TIMER_MODULE      TMR3_MODULE
+#define SM_PROF_TIMER_IRQn        TMR3_IRQn
+#define SM_PROF_TIMER_BITS        24
+#define SM_PROF_TIMER_HALF        (1UL << (SM_PROF_TIMER_BITS - 1))
+/* TIF, and so the wrap count, comes this many counts after the wrap */
+#define SM_PROF_TIMER_CMP         2
+#define SM_PROF_CALIBRATE_ROUNDS  8
+#define SM_PROF_LINE_WIDTH        96      /* the histogram wraps before */
+#define SM_PROF_CMD_SIZE          16
+
+typedef struct sm_prof_impl{
+	sm_prof_region_t m_region[SM_PROF_REGION_MAX];
+	uint8_t m_region_num;
+	uint32_t m_clock;
+	uint32_t m_hclk_ratio;        /* HCLK cycles per TIMER count, for SysTick */
+	uint32_t m_overhead;          /* cost of an empty stamp/end pair */
+	uint64_t m_window_start;
+
+	volatile uint32_t m_isr_cycles;
+	volatile uint32_t m_depth;
+	sm_prof_stamp_t m_stack[SM_PROF_NEST_MAX];
+
+	char m_cmd[SM_PROF_CMD_SIZE];
+	uint8_t m_cmd_len;
+}sm_prof_impl_t;
+
+static sm_prof_impl_t g_prof;
+static volatile uint32_t g_prof_wraps;
+static int8_t g_prof_clock_id = -1;
+
+void TMR3_IRQHandler(void){
+	SM_PROF_TIMER->INTSTS = TIMER_INTSTS_TIF_Msk;
+	g_prof_wraps++;
+}
+
+uint64_t sm_prof_cycles64(void){
+	uint32_t wraps;
+	uint32_t cnt;
+	uint32_t tif;
+
+	do{
+		wraps = g_prof_wraps;
+		cnt = SM_PROF_TIMER->CNT;
+		tif = SM_PROF_TIMER->INTSTS & TIMER_INTSTS_TIF_Msk;
+	}while(wraps != g_prof_wraps);
+
+	/* Wrapped, but the wrap interrupt has not run: masked, or about to */
+	if(cnt < SM_PROF_TIMER_HALF && (tif || cnt < SM_PROF_TIMER_CMP))
+		wraps++;
+
+	return ((uint64_t)wraps << SM_PROF_TIMER_BITS) | cnt;
+}
+
+uint32_t sm_prof_cycles(void){
+	return (uint32_t)sm_prof_cycles64();
+}
+
+uint32_t sm_prof_clock(void){
+	return g_prof.m_clock;
+}
+
+void sm_prof_stamp(sm_prof_stamp_t* _stamp){
+	_stamp->m_cycles = sm_prof_cycles();
+	_stamp->m_systick = SysTick->VAL;
+	_stamp->m_isr = g_prof.m_isr_cycles;
+}
+
+static uint8_t sm_prof_bucket(uint32_t _cycles){
+	uint8_t n = 0;
+
+	while(_cycles > 1 && n < SM_PROF_HIST_BUCKETS - 1){
+		_cycles >>= 1;
+		n++;
+	}
+	return n;
+}
+
+/* SysTick counts down and reloads, so a later value above the earlier one
+ * means a tick came in between */
+static uint8_t sm_prof_tick_crossed(uint32_t _begin, uint32_t _end, uint32_t _elapsed){
+	if(!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+		return 0;
+
+	return _end > _begin || (uint64_t)_elapsed * g_prof.m_hclk_ratio > SysTick->LOAD;
+}
+
+/* Close a measurement whose end stamp is _end. ISR cycles are read before the
+ * counter here, so a handler that lands in between only ever adds to self */
+static uint32_t sm_prof_close(int32_t _id, const sm_prof_stamp_t* _begin, uint32_t _isr, uint32_t _systick){
+	uint32_t elapsed = sm_prof_cycles() - _begin->m_cycles;
+	uint32_t inner = _isr - _begin->m_isr;
+	uint8_t tick = sm_prof_tick_crossed(_begin->m_systick, _systick, elapsed);
+	uint32_t self;
+
+	elapsed = elapsed > g_prof.m_overhead ? elapsed - g_prof.m_overhead : 0;
+	self = elapsed > inner ? elapsed - inner : 0;
+
+	if(_id < 0 || _id >= g_prof.m_region_num)
+		return self;
+
+	sm_prof_region_t* region = &g_prof.m_region[_id];
+	uint8_t bucket = sm_prof_bucket(elapsed);
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	region->m_count++;
+	if(elapsed < region->m_min)
+		region->m_min = elapsed;
+	if(elapsed > region->m_max)
+		region->m_max = elapsed;
+	region->m_total += elapsed;
+	region->m_self += self;
+	region->m_ticks += tick;
+	region->m_hist[bucket]++;
+
+	__set_PRIMASK(primask);
+	return self;
+}
+
+void sm_prof_end(int32_t _id, const sm_prof_stamp_t* _begin){
+	uint32_t isr = g_prof.m_isr_cycles;
+	uint32_t systick = SysTick->VAL;
+
+	sm_prof_close(_id, _begin, isr, systick);
+}
+
+/* The depth is claimed before the stamp is taken: a handler preempting us in
+ * between uses the next slot and gives it back before we resume */
+void sm_prof_isr_enter(int32_t _id){
+	uint32_t depth = g_prof.m_depth++;
+
+	(void)_id;
+	if(depth < SM_PROF_NEST_MAX)
+		sm_prof_stamp(&g_prof.m_stack[depth]);
+}
+
+void sm_prof_isr_exit(int32_t _id){
+	uint32_t depth = g_prof.m_depth;
+	uint32_t isr = g_prof.m_isr_cycles;
+	uint32_t systick = SysTick->VAL;
+
+	if(!depth)
+		return;
+
+	if(depth <= SM_PROF_NEST_MAX){
+		uint32_t self = sm_prof_close(_id, &g_prof.m_stack[depth - 1], isr, systick);
+		uint32_t primask = __get_PRIMASK();
+
+		__disable_irq();
+		g_prof.m_isr_cycles += self;
+		__set_PRIMASK(primask);
+	}
+
+	g_prof.m_depth = depth - 1;
+}
+
+static int32_t sm_prof_add(const char* _name, uint8_t _is_isr){
+	if(g_prof.m_region_num >= SM_PROF_REGION_MAX)
+		return -1;
+
+	sm_prof_region_t* region = &g_prof.m_region[g_prof.m_region_num];
+
+	memset(region, 0, sizeof(sm_prof_region_t));
+	region->m_name = _name;
+	region->m_is_isr = _is_isr;
+	region->m_min = UINT32_MAX;
+
+	return g_prof.m_region_num++;
+}
+
+int32_t sm_prof_region(const char* _name){
+	return sm_prof_add(_name, 0);
+}
+
+int32_t sm_prof_isr(const char* _name){
+	return sm_prof_add(_name, 1);
+}
+
+const sm_prof_region_t* sm_prof_get(int32_t _id){
+	if(_id < 0 || _id >= g_prof.m_region_num)
+		return NULL;
+	return &g_prof.m_region[_id];
+}
+
+void sm_prof_reset(void){
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	for(uint8_t i = 0; i < g_prof.m_region_num; i++){
+		sm_prof_region_t* region = &g_prof.m_region[i];
+
+		region->m_count = 0;
+		region->m_min = UINT32_MAX;
+		region->m_max = 0;
+		region->m_total = 0;
+		region->m_self = 0;
+		region->m_ticks = 0;
+		memset(region->m_hist, 0, sizeof(region->m_hist));
+	}
+	g_prof.m_window_start = sm_prof_cycles64();
+
+	__set_PRIMASK(primask);
+}
+
+/* Smallest cost of an empty measurement, taken off every sample */
+static void sm_prof_calibrate(void){
+	sm_prof_stamp_t begin;
+	uint32_t best = UINT32_MAX;
+
+	g_prof.m_overhead = 0;
+
+	for(uint8_t i = 0; i < SM_PROF_CALIBRATE_ROUNDS; i++){
+		sm_prof_stamp(&begin);
+		uint32_t cost = sm_prof_close(-1, &begin, g_prof.m_isr_cycles, SysTick->VAL);
+
+		if(cost < best)
+			best = cost;
+	}
+	g_prof.m_overhead = best;
+}
+
+static void sm_prof_set_clock(void){
+	g_prof.m_clock = TIMER_GetModuleClock(SM_PROF_TIMER);
+	g_prof.m_hclk_ratio = g_prof.m_clock ? SystemCoreClock / g_prof.m_clock : 1;
+	if(!g_prof.m_hclk_ratio)
+		g_prof.m_hclk_ratio = 1;
+}
+
+/* The timer runs from PCLK1: a count is longer at the low clock. A region
+ * that spans the change mixes both */
+static void sm_prof_clock_change(sm_clock_event_t _event, uint32_t _hclk, void* _arg){
+	(void)_hclk;
+	(void)_arg;
+	if(_event == SM_CLOCK_POST)
+		sm_prof_set_clock();
+}
+
+int32_t sm_prof_init(void){
+	uint32_t locked = SYS_IsRegLocked();
+
+	if(locked)
+		SYS_UnlockReg();
+
+	CLK_EnableModuleClock(SM_PROF_TIMER_MODULE);
+	CLK_SetModuleClock(SM_PROF_TIMER_MODULE, CLK_CLKSEL1_TMR3SEL_PCLK1, 0);
+
+	if(locked)
+		SYS_LockReg();
+
+	memset(&g_prof, 0, sizeof(g_prof));
+	g_prof_wraps = 0;
+
+	SM_PROF_TIMER->CTL = 0;
+	SM_PROF_TIMER->INTSTS = TIMER_INTSTS_TIF_Msk;
+	SM_PROF_TIMER->CMP = SM_PROF_TIMER_CMP;
+	SM_PROF_TIMER->CTL = TIMER_CONTINUOUS_MODE | TIMER_CTL_INTEN_Msk | TIMER_CTL_CNTEN_Msk;
+
+	NVIC_SetPriority(SM_PROF_TIMER_IRQn, 0);
+	NVIC_EnableIRQ(SM_PROF_TIMER_IRQn);
+
+	sm_prof_set_clock();
+	if(g_prof_clock_id < 0)
+		g_prof_clock_id = (int8_t)sm_clock_register(sm_prof_clock_change, NULL);
+
+	sm_prof_calibrate();
+	g_prof.m_window_start = sm_prof_cycles64();
+	return 0;
+}
+
+static void sm_prof_dump_hist(const sm_prof_region_t* _region, sm_fmt_write_fn_t _write, void* _arg){
+	int32_t col = sm_fmt_print(_write, _arg, "    hist");
+
+	for(uint8_t n = 0; n < SM_PROF_HIST_BUCKETS; n++){
+		if(!_region->m_hist[n])
+			continue;
+
+		if(col > SM_PROF_LINE_WIDTH - 24)
+			col = sm_fmt_print(_write, _arg, "\r\n        ") - 2;
+		col += sm_fmt_print(_write, _arg, " %s2^%u:%lu", n == SM_PROF_HIST_BUCKETS - 1 ? ">=" : "<",
+				n == SM_PROF_HIST_BUCKETS - 1 ? n : n + 1, (unsigned long)_region->m_hist[n]);
+	}
+	sm_fmt_print(_write, _arg, "\r\n");
+}
+
+int32_t sm_prof_dump(sm_fmt_write_fn_t _write, void* _arg){
+	uint64_t window = sm_prof_cycles64() - g_prof.m_window_start;
+	uint32_t clock = g_prof.m_clock ? g_prof.m_clock : 1;
+
+	if(!_write)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "prof: %lu ms at %lu Hz, overhead %lu cyc\r\n",
+			(unsigned long)(window * 1000 / clock), (unsigned long)clock, (unsigned long)g_prof.m_overhead);
+	sm_fmt_print(_write, _arg, "  %-12s %8s %7s %7s %7s %6s %5s\r\n", "name", "count", "min", "avg", "max", "load%",
+			"tick");
+
+	for(uint8_t i = 0; i < g_prof.m_region_num; i++){
+		sm_prof_region_t region;
+		uint32_t primask = __get_PRIMASK();
+
+		/* A consistent copy, the live one keeps counting */
+		__disable_irq();
+		region = g_prof.m_region[i];
+		__set_PRIMASK(primask);
+
+		uint32_t avg = region.m_count ? (uint32_t)(region.m_total / region.m_count) : 0;
+		uint32_t load = window ? (uint32_t)(region.m_self * 1000 / window) : 0;
+
+		sm_fmt_print(_write, _arg, "%c %-12s %8lu %7lu %7lu %7lu %4lu.%lu %5lu\r\n", region.m_is_isr ? '*' : ' ',
+				region.m_name, (unsigned long)region.m_count, (unsigned long)(region.m_count ? region.m_min : 0),
+				(unsigned long)avg, (unsigned long)region.m_max, (unsigned long)(load / 10),
+				(unsigned long)(load % 10), (unsigned long)region.m_ticks);
+		if(region.m_count)
+			sm_prof_dump_hist(&region, _write, _arg);
+	}
+	return 0;
+}
+
+int32_t sm_prof_command(const char* _cmd, sm_fmt_write_fn_t _write, void* _arg){
+	if(!strcmp(_cmd, "prof"))
+		return sm_prof_dump(_write, _arg);
+
+	if(!strcmp(_cmd, "prof reset")){
+		sm_prof_reset();
+		return 0;
+	}
+	return -1;
+}
+
+int32_t sm_prof_input(const uint8_t* _buf, uint32_t _len, sm_fmt_write_fn_t _write, void* _arg){
+	if(!_buf || !_write)
+		return -1;
+
+	for(uint32_t i = 0; i < _len; i++){
+		char c = (char)_buf[i];
+
+		if(c == '\r' || c == '\n'){
+			g_prof.m_cmd[g_prof.m_cmd_len] = '\0';
+			if(g_prof.m_cmd_len)
+				sm_prof_command(g_prof.m_cmd, _write, _arg);
+			g_prof.m_cmd_len = 0;
+		}else if(g_prof.m_cmd_len < SM_PROF_CMD_SIZE - 1){
+			g_prof.m_cmd[g_prof.m_cmd_len++] = c;
+		}
+	}
+	return 0;
+}
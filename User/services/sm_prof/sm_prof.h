@@ -0,0 +1,114 @@
+/*
+ * sm_prof.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_PROF_SM_PROF_H_
+#define SERVICES_SM_PROF_SM_PROF_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+/*
+ * Cycle profiling without DWT. TIMER3 free-runs on PCLK1 and is extended to
+ * 64 bit by its own wrap interrupt; a stamp takes its count together with the
+ * SysTick current value, so a sample that spans a tick is flagged.
+ *
+ * Regions and ISRs are registered once by name, then measured with the
+ * SM_PROF_* macros. ISR time is accounted exclusive of the handlers that
+ * preempted it, and every region also gets its time minus the ISRs that ran
+ * inside it. Durations go into log2 histograms; sm_prof_dump() prints them
+ * and the debug port command "prof" / "prof reset" dumps or clears them.
+ *
+ * Build with SM_PROF_ENABLE 0 and the macros cost nothing.
+ */
+
+#ifndef SM_PROF_ENABLE
+#define SM_PROF_ENABLE            1
+#endif
+
+#define SM_PROF_REGION_MAX        8
+#define SM_PROF_HIST_BUCKETS      16
+#define SM_PROF_NEST_MAX          8
+
+typedef struct sm_prof_stamp{
+	uint32_t m_cycles;
+	uint32_t m_systick;
+	uint32_t m_isr;            /* ISR cycles accounted so far */
+}sm_prof_stamp_t;
+
+typedef struct sm_prof_region{
+	const char* m_name;
+	uint8_t m_is_isr;
+	uint32_t m_count;
+	uint32_t m_min;
+	uint32_t m_max;
+	uint64_t m_total;
+	uint64_t m_self;           /* total minus the ISRs that ran inside */
+	uint32_t m_ticks;          /* samples that spanned a SysTick tick */
+	uint32_t m_hist[SM_PROF_HIST_BUCKETS];   /* bucket n: < 2^(n+1) cycles */
+}sm_prof_region_t;
+
+int32_t sm_prof_init(void);
+
+/* Return the region id, or -1 when the table is full */
+int32_t sm_prof_region(const char* _name);
+int32_t sm_prof_isr(const char* _name);
+
+uint32_t sm_prof_cycles(void);
+uint64_t sm_prof_cycles64(void);
+uint32_t sm_prof_clock(void);
+
+void sm_prof_stamp(sm_prof_stamp_t* _stamp);
+void sm_prof_end(int32_t _id, const sm_prof_stamp_t* _begin);
+
+void sm_prof_isr_enter(int32_t _id);
+void sm_prof_isr_exit(int32_t _id);
+
+const sm_prof_region_t* sm_prof_get(int32_t _id);
+
+void sm_prof_reset(void);
+
+int32_t sm_prof_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+/* Return 0 when _cmd was a profiling command */
+int32_t sm_prof_command(const char* _cmd, sm_fmt_write_fn_t _write, void* _arg);
+
+/* Bytes read from the debug port by its owner (sm_uart_read()), which keeps
+ * the port's RX interrupt: the commands they complete run, replying to _write */
+int32_t sm_prof_input(const uint8_t* _buf, uint32_t _len, sm_fmt_write_fn_t _write, void* _arg);
+
+#if SM_PROF_ENABLE
+
+#define SM_PROF_BEGIN(id)         sm_prof_stamp_t _sm_prof_##id; sm_prof_stamp(&_sm_prof_##id)
+#define SM_PROF_END(id)           sm_prof_end((id), &_sm_prof_##id)
+/* Measures until the enclosing block is left */
+#define SM_PROF_SCOPE(id)         \
+	__attribute__((cleanup(sm_prof_scope_exit))) sm_prof_scope_t _sm_prof_scope = {(id)}; \
+	sm_prof_stamp(&_sm_prof_scope.m_begin)
+#define SM_PROF_ISR_ENTER(id)     sm_prof_isr_enter(id)
+#define SM_PROF_ISR_EXIT(id)      sm_prof_isr_exit(id)
+
+typedef struct sm_prof_scope{
+	int32_t m_id;
+	sm_prof_stamp_t m_begin;
+}sm_prof_scope_t;
+
+static inline void sm_prof_scope_exit(sm_prof_scope_t* _scope){
+	sm_prof_end(_scope->m_id, &_scope->m_begin);
+}
+
+#else
+
+#define SM_PROF_BEGIN(id)
+#define SM_PROF_END(id)
+#define SM_PROF_SCOPE(id)
+#define SM_PROF_ISR_ENTER(id)
+#define SM_PROF_ISR_EXIT(id)
+
+#endif
+
+#endif /* SERVICES_SM_PROF_SM_PROF_H_ */
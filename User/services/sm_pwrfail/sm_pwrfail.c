@@ -0,0 +1,365 @@
+/*
+ * sm_pwrfail.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_pwrfail.h"
+#include "sm_flash.h"
+#include "sm_crc.h"
+#include "sm_gpio.h"
+#include "sm_defer.h"
+#include "sm_prof.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+#include <string.h>
+
+/* Record layout: | header | tag << 16 | size | data, padded to a word | ... | cycles |
+ * One record per page, at its start. The cycles word is programmed last */
+#define SM_PWRFAIL_MAGIC            0x4C465750UL
+#define SM_PWRFAIL_HEADER_SIZE      sizeof(sm_pwrfail_record_t)
+#define SM_PWRFAIL_REGION_MAX       8
+
+#define SM_PWRFAIL_ALIGN4(x)        (((x) + 3UL) & ~3UL)
+
+_Static_assert(!(SM_PWRFAIL_SIZE & 3) && SM_PWRFAIL_SIZE + 4 <= SM_FLASH_PAGE_SIZE,
+		"sm_pwrfail: a record and its cycles word fit in a page");
+
+/* Flash time of a flush, worst case: the record from a page start goes in
+ * multi-word runs of SM_FLASH_BURST_WORDS (sm_flash_write()), at most 3 tail
+ * words and the cycles word one ISP program each, plus a run start per burst */
+#define SM_PWRFAIL_WORD_US          8
+#define SM_PWRFAIL_PROGRAM_US       20
+#define SM_PWRFAIL_FLUSH_US         ((SM_PWRFAIL_SIZE / 4) * SM_PWRFAIL_WORD_US + 4 * SM_PWRFAIL_PROGRAM_US + \
+		(SM_PWRFAIL_SIZE / 4 + SM_FLASH_BURST_WORDS - 1) / SM_FLASH_BURST_WORDS * SM_PWRFAIL_WORD_US)
+
+_Static_assert(SM_PWRFAIL_FLUSH_US + SM_PWRFAIL_HOOK_US <= SM_PWRFAIL_HOLDUP_US,
+		"sm_pwrfail: SM_PWRFAIL_SIZE does not flush within SM_PWRFAIL_HOLDUP_US");
+
+extern const uint32_t __pwrfail_start__[];
+extern const uint32_t __pwrfail_end__[];
+
+typedef struct sm_pwrfail_region{
+	const void* m_data;
+	uint16_t m_tag;
+	uint16_t m_size;
+}sm_pwrfail_region_t;
+
+typedef struct sm_pwrfail_input{
+	sm_gpio_t* m_gpio;
+	GPIO_T* m_port;
+	uint32_t m_pin;
+	uint8_t m_good;
+}sm_pwrfail_input_t;
+
+typedef struct sm_pwrfail_impl{
+	uint32_t m_base;
+	uint16_t m_page_num;
+	uint16_t m_page;                /* of the newest record */
+	uint8_t m_have;
+	uint8_t m_region_num;
+	uint8_t m_input_num;
+	uint16_t m_used;                /* bytes of the record, header included */
+	uint32_t m_next;                /* erased page the flush goes to, 0 while not armed */
+	uint32_t m_seq;
+	sm_pwrfail_hook_fn_t m_hook;
+	void* m_hook_arg;
+	uint32_t m_flushes;
+	uint32_t m_ignored;
+	uint32_t m_failed;
+	uint32_t m_cycles_max;
+	sm_pwrfail_region_t m_region[SM_PWRFAIL_REGION_MAX];
+	sm_pwrfail_input_t m_input[SM_PWRFAIL_INPUT_MAX];
+	uint32_t m_buf[SM_PWRFAIL_SIZE / 4];
+}sm_pwrfail_impl_t;
+
+static sm_pwrfail_impl_t g_pwrfail;
+
+static inline uint32_t sm_pwrfail_page_addr(uint16_t _page){
+	return g_pwrfail.m_base + (uint32_t)_page * SM_FLASH_PAGE_SIZE;
+}
+
+static int32_t sm_pwrfail_check(const sm_pwrfail_record_t* _record){
+	if(_record->m_magic != SM_PWRFAIL_MAGIC || _record->m_size > SM_PWRFAIL_SIZE - SM_PWRFAIL_HEADER_SIZE)
+		return -1;
+
+	if(sm_pwrfail_cycles(_record) == SM_FLASH_ERASED_WORD)
+		return -1;
+
+	if(_record->m_crc != sm_crc32(_record + 1, _record->m_size))
+		return -1;
+
+	return 0;
+}
+
+static uint8_t sm_pwrfail_supply_good(void){
+	if(SYS->BODCTL & SYS_BODCTL_BODOUT_Msk)
+		return 0;
+
+	/* The port sampled here, not the level the interrupt saw: the other
+	 * input may have moved since */
+	for(uint8_t i = 0; i < g_pwrfail.m_input_num; i++){
+		const sm_pwrfail_input_t* input = &g_pwrfail.m_input[i];
+
+		if(((input->m_port->PIN & input->m_pin) ? 1 : 0) == input->m_good)
+			return 1;
+	}
+	return g_pwrfail.m_input_num ? 0 : 1;
+}
+
+/* Outside the window only: an erase stalls the flash for milliseconds */
+static int32_t sm_pwrfail_arm(void){
+	uint16_t page = g_pwrfail.m_have ? (uint16_t)((g_pwrfail.m_page + 1) % g_pwrfail.m_page_num) : 0;
+	uint32_t addr = sm_pwrfail_page_addr(page);
+	uint32_t primask;
+
+	if(!sm_flash_is_erased(addr, SM_FLASH_PAGE_SIZE) && sm_flash_erase(addr) < 0)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	g_pwrfail.m_next = addr;
+	__set_PRIMASK(primask);
+	return 0;
+}
+
+/* Bottom half of the status inputs: flush once none of them is good */
+static void sm_pwrfail_on_input(sm_gpio_t* _gpio, uint32_t _level, void* _arg){
+	(void)_gpio;
+	(void)_level;
+	(void)_arg;
+
+	if(!sm_pwrfail_supply_good())
+		sm_pwrfail_flush(SM_PWRFAIL_CAUSE_INPUT);
+}
+
+void BOD_IRQHandler(void){
+	uint32_t locked = SYS_IsRegLocked();
+
+	if(locked)
+		SYS_UnlockReg();
+	SYS_CLEAR_BOD_INT_FLAG();
+	if(locked)
+		SYS_LockReg();
+
+	/* The flag is set on the way up too */
+	if(SYS->BODCTL & SYS_BODCTL_BODOUT_Msk)
+		sm_pwrfail_flush(SM_PWRFAIL_CAUSE_BOD);
+}
+
+int32_t sm_pwrfail_init(uint32_t _bod_level, uint8_t _priority){
+	uint32_t locked;
+
+	memset(&g_pwrfail, 0, sizeof(g_pwrfail));
+	g_pwrfail.m_base = (uint32_t)__pwrfail_start__;
+	g_pwrfail.m_page_num = (uint16_t)(((uint32_t)__pwrfail_end__ - g_pwrfail.m_base) / SM_FLASH_PAGE_SIZE);
+	g_pwrfail.m_used = SM_PWRFAIL_HEADER_SIZE;
+
+	if(!g_pwrfail.m_page_num)
+		return -1;
+
+	sm_flash_init();
+	sm_crc_init();
+
+	for(uint16_t page = 0; page < g_pwrfail.m_page_num; page++){
+		const sm_pwrfail_record_t* record = (const sm_pwrfail_record_t*)sm_pwrfail_page_addr(page);
+
+		if(sm_pwrfail_check(record) < 0)
+			continue;
+
+		if(!g_pwrfail.m_have || (int32_t)(record->m_seq - g_pwrfail.m_seq) > 0){
+			g_pwrfail.m_have = 1;
+			g_pwrfail.m_page = page;
+			g_pwrfail.m_seq = record->m_seq;
+		}
+	}
+
+	if(sm_pwrfail_arm() < 0)
+		return -1;
+
+	locked = SYS_IsRegLocked();
+	if(locked)
+		SYS_UnlockReg();
+	SYS_EnableBOD(SYS_BODCTL_BOD_INTERRUPT_EN, _bod_level);
+	SYS_CLEAR_BOD_INT_FLAG();
+	if(locked)
+		SYS_LockReg();
+
+	NVIC_SetPriority(BOD_IRQn, _priority);
+	NVIC_EnableIRQ(BOD_IRQn);
+	return 0;
+}
+
+int32_t sm_pwrfail_add(uint16_t _tag, const void* _data, uint16_t _size){
+	uint32_t size = 4 + SM_PWRFAIL_ALIGN4(_size);
+
+	if(!_data || g_pwrfail.m_region_num >= SM_PWRFAIL_REGION_MAX || g_pwrfail.m_used + size > SM_PWRFAIL_SIZE)
+		return -1;
+
+	g_pwrfail.m_region[g_pwrfail.m_region_num].m_data = _data;
+	g_pwrfail.m_region[g_pwrfail.m_region_num].m_tag = _tag;
+	g_pwrfail.m_region[g_pwrfail.m_region_num].m_size = _size;
+	g_pwrfail.m_region_num++;
+	g_pwrfail.m_used = (uint16_t)(g_pwrfail.m_used + size);
+	return 0;
+}
+
+void sm_pwrfail_set_hook(sm_pwrfail_hook_fn_t _fn, void* _arg){
+	g_pwrfail.m_hook_arg = _arg;
+	g_pwrfail.m_hook = _fn;
+}
+
+int32_t sm_pwrfail_watch(void* _port, uint32_t _pin, uint8_t _good, uint8_t _priority){
+	sm_pwrfail_input_t* input;
+
+	if(g_pwrfail.m_input_num >= SM_PWRFAIL_INPUT_MAX)
+		return -1;
+
+	input = &g_pwrfail.m_input[g_pwrfail.m_input_num];
+	input->m_gpio = sm_gpio_create(_port, _pin, GPIO_MODE_INPUT);
+	input->m_port = (GPIO_T*)_port;
+	input->m_pin = _pin;
+	input->m_good = _good ? 1 : 0;
+	if(!input->m_gpio)
+		return -1;
+
+	if(sm_gpio_enable_interrupt(input->m_gpio, GPIO_INT_BOTH_EDGE, _priority, SM_DEFER_HIGH,
+			sm_pwrfail_on_input, NULL) < 0){
+		sm_gpio_destroy(input->m_gpio);
+		return -1;
+	}
+
+	g_pwrfail.m_input_num++;
+	return 0;
+}
+
+int32_t sm_pwrfail_flush(sm_pwrfail_cause_t _cause){
+	uint32_t start = sm_prof_cycles();
+	sm_pwrfail_record_t* record = (sm_pwrfail_record_t*)g_pwrfail.m_buf;
+	uint32_t* word = &g_pwrfail.m_buf[SM_PWRFAIL_HEADER_SIZE / 4];
+	uint32_t primask = __get_PRIMASK();
+	uint32_t addr;
+	uint32_t cycles;
+	int32_t rc;
+
+	__disable_irq();
+	addr = g_pwrfail.m_next;
+	if(!addr){
+		g_pwrfail.m_ignored++;
+		__set_PRIMASK(primask);
+		return -1;
+	}
+	g_pwrfail.m_next = 0;
+
+	if(g_pwrfail.m_hook)
+		g_pwrfail.m_hook(g_pwrfail.m_hook_arg);
+
+	for(uint8_t i = 0; i < g_pwrfail.m_region_num; i++){
+		const sm_pwrfail_region_t* region = &g_pwrfail.m_region[i];
+		uint32_t words = SM_PWRFAIL_ALIGN4(region->m_size) / 4;
+
+		*word++ = ((uint32_t)region->m_tag << 16) | region->m_size;
+		if(words)
+			word[words - 1] = 0;
+		memcpy(word, region->m_data, region->m_size);
+		word += words;
+	}
+
+	record->m_magic = SM_PWRFAIL_MAGIC;
+	record->m_seq = g_pwrfail.m_seq + 1;
+	record->m_cause = (uint16_t)_cause;
+	record->m_size = (uint16_t)(g_pwrfail.m_used - SM_PWRFAIL_HEADER_SIZE);
+	record->m_crc = sm_crc32(record + 1, record->m_size);
+
+	rc = sm_flash_write(addr, g_pwrfail.m_buf, g_pwrfail.m_used / 4);
+	cycles = sm_prof_cycles() - start;
+	if(!rc)
+		rc = sm_flash_write(addr + g_pwrfail.m_used, &cycles, 1);
+
+	if(rc < 0){
+		g_pwrfail.m_failed++;
+	}else{
+		g_pwrfail.m_flushes++;
+		g_pwrfail.m_seq++;
+		g_pwrfail.m_have = 1;
+		g_pwrfail.m_page = (uint16_t)((addr - g_pwrfail.m_base) / SM_FLASH_PAGE_SIZE);
+		if(cycles > g_pwrfail.m_cycles_max)
+			g_pwrfail.m_cycles_max = cycles;
+	}
+
+	__set_PRIMASK(primask);
+	return rc;
+}
+
+int32_t sm_pwrfail_process(void){
+	if(g_pwrfail.m_next || !g_pwrfail.m_page_num || !sm_pwrfail_supply_good())
+		return 0;
+
+	return sm_pwrfail_arm();
+}
+
+const sm_pwrfail_record_t* sm_pwrfail_last(void){
+	const sm_pwrfail_record_t* record;
+
+	if(!g_pwrfail.m_have)
+		return NULL;
+
+	record = (const sm_pwrfail_record_t*)sm_pwrfail_page_addr(g_pwrfail.m_page);
+	return sm_pwrfail_check(record) < 0 ? NULL : record;
+}
+
+const void* sm_pwrfail_region(const sm_pwrfail_record_t* _record, uint16_t _tag, uint16_t* _size){
+	const uint8_t* pos;
+	const uint8_t* end;
+
+	if(!_record)
+		return NULL;
+
+	pos = (const uint8_t*)(_record + 1);
+	end = pos + _record->m_size;
+	while(pos + 4 <= end){
+		uint32_t hdr = *(const uint32_t*)pos;
+		uint16_t size = (uint16_t)(hdr & 0xFFFFUL);
+
+		if((uint16_t)(hdr >> 16) == _tag){
+			if(_size)
+				*_size = size;
+			return pos + 4;
+		}
+		pos += 4 + SM_PWRFAIL_ALIGN4(size);
+	}
+	return NULL;
+}
+
+uint32_t sm_pwrfail_cycles(const sm_pwrfail_record_t* _record){
+	return *(const uint32_t*)((const uint8_t*)(_record + 1) + _record->m_size);
+}
+
+int32_t sm_pwrfail_dump(sm_fmt_write_fn_t _write, void* _arg){
+	const sm_pwrfail_record_t* record = sm_pwrfail_last();
+	uint32_t mhz = sm_prof_clock() / 1000000UL;
+
+	if(!_write)
+		return -1;
+
+	if(!mhz)
+		mhz = 1;
+
+	sm_fmt_print(_write, _arg, "pwrfail: %s, record %u/%u bytes, flushes %lu, ignored %lu, failed %lu\r\n",
+			g_pwrfail.m_next ? "armed" : "not armed", g_pwrfail.m_used, SM_PWRFAIL_SIZE,
+			(unsigned long)g_pwrfail.m_flushes, (unsigned long)g_pwrfail.m_ignored, (unsigned long)g_pwrfail.m_failed);
+
+	if(record){
+		sm_fmt_print(_write, _arg, "  last: seq %lu, cause %u, %lu bytes, flushed in %lu us\r\n",
+				(unsigned long)record->m_seq, record->m_cause, (unsigned long)record->m_size,
+				(unsigned long)(sm_pwrfail_cycles(record) / mhz));
+	}
+
+	if(g_pwrfail.m_cycles_max){
+		sm_fmt_print(_write, _arg, "  slowest flush since boot: %lu us\r\n",
+				(unsigned long)(g_pwrfail.m_cycles_max / mhz));
+	}
+	return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * sm_pwrfail.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_PWRFAIL_SM_PWRFAIL_H_
+#define SERVICES_SM_PWRFAIL_SM_PWRFAIL_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * Power-fail record, for the post-mortem of a brownout.
+ *
+ * The state worth keeping is registered once as regions (counters, the last
+ * event log block, relay states...). When the supply is going, the regions
+ * are copied into one record and programmed into a flash page of the
+ * PWRFAIL area (gcc_arm.ld) erased beforehand, with every interrupt masked:
+ * no erase in the hold-up window, only a multi-word program from SRAM
+ * (sm_flash_write()), so the flush takes a time bounded by SM_PWRFAIL_SIZE,
+ * about 8 us a word plus the hook, checked against SM_PWRFAIL_HOLDUP_US at
+ * build time. The time it took, in sm_prof cycles, is
+ * the last word programmed: a record without it was cut short.
+ *
+ * Two triggers:
+ * - the BOD interrupt, at the top NVIC priority, when VDD crosses the
+ *   SYS_EnableBOD() level on its way down;
+ * - the watched status inputs (the mains and AC/DC good signals), through a
+ *   SM_DEFER_HIGH bottom half, once none of them is at its good level.
+ *
+ * The first trigger flushes, the others are ignored until
+ * sm_pwrfail_process() sees the supply good again and has erased the next
+ * page. The pages form a ring, the older records stay readable.
+ */
+
+#ifndef SM_PWRFAIL_SIZE
+#define SM_PWRFAIL_SIZE             256     /* bytes of a record, regions and header */
+#endif
+
+/* Supply hold-up from the trigger to the lowest VDD the FMC still programs
+ * at, measured on the board, and the part of it left to the hook. A record
+ * of SM_PWRFAIL_SIZE has to be programmed in the rest */
+#ifndef SM_PWRFAIL_HOLDUP_US
+#define SM_PWRFAIL_HOLDUP_US        1000
+#endif
+#ifndef SM_PWRFAIL_HOOK_US
+#define SM_PWRFAIL_HOOK_US          100
+#endif
+
+#define SM_PWRFAIL_INPUT_MAX        2
+
+typedef enum{
+	SM_PWRFAIL_CAUSE_BOD = 1,
+	SM_PWRFAIL_CAUSE_INPUT,
+	SM_PWRFAIL_CAUSE_SOFT,
+}sm_pwrfail_cause_t;
+
+/* In flash: the header, the regions, then the flush time */
+typedef struct sm_pwrfail_record{
+	uint32_t m_magic;
+	uint32_t m_seq;
+	uint16_t m_cause;
+	uint16_t m_size;                /* bytes of regions after the header */
+	uint32_t m_crc;                 /* sm_crc32() of the regions */
+}sm_pwrfail_record_t;
+
+/* Runs first in the window, interrupts masked: capture what the regions do
+ * not hold yet and shed the loads. Keep it short, it counts in the flush */
+typedef void (*sm_pwrfail_hook_fn_t)(void* _arg);
+
+/* _bod_level: SYS_BODCTL_BODVL_x. Erases the next page if needed */
+int32_t sm_pwrfail_init(uint32_t _bod_level, uint8_t _priority);
+
+/* _size bytes at _data, read at flush time. -1 once the record is full */
+int32_t sm_pwrfail_add(uint16_t _tag, const void* _data, uint16_t _size);
+
+void sm_pwrfail_set_hook(sm_pwrfail_hook_fn_t _fn, void* _arg);
+
+/* An input that reads _good while the supply is, _pin a BITn. _priority: its port's NVIC priority */
+int32_t sm_pwrfail_watch(void* _port, uint32_t _pin, uint8_t _good, uint8_t _priority);
+
+/* Flush now, from any context. -1 when not armed */
+int32_t sm_pwrfail_flush(sm_pwrfail_cause_t _cause);
+
+/* Re-arm after a supply that came back, call from the main loop */
+int32_t sm_pwrfail_process(void);
+
+/* The newest complete record in flash, NULL when none */
+const sm_pwrfail_record_t* sm_pwrfail_last(void);
+
+/* A region of _record, NULL when it has no _tag */
+const void* sm_pwrfail_region(const sm_pwrfail_record_t* _record, uint16_t _tag, uint16_t* _size);
+
+/* Flush time of _record, in sm_prof cycles */
+uint32_t sm_pwrfail_cycles(const sm_pwrfail_record_t* _record);
+
+int32_t sm_pwrfail_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_PWRFAIL_SM_PWRFAIL_H_ */
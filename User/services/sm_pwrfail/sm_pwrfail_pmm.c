@@ -0,0 +1,97 @@
+/*
+ * sm_pwrfail_pmm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_pwrfail_pmm.h"
+#include "sm_relay_pmm.h"
+#include "sm_gpio.h"
+#include "sm_kernel.h"
+#include "NuMicro.h"
+
+#include <string.h>
+
+/* Each region goes in with a word of tag and size */
+_Static_assert(sizeof(sm_pwrfail_record_t) + 3 * 4 + sizeof(uint32_t) + SM_PWRFAIL_PMM_CNT_NUM * sizeof(uint32_t) +
+		sizeof(sm_pwrfail_pmm_log_t) <= SM_PWRFAIL_SIZE, "sm_pwrfail_pmm: the regions fit in SM_PWRFAIL_SIZE");
+
+static uint32_t g_pwrfail_pmm_relay;
+static uint32_t g_pwrfail_pmm_counter[SM_PWRFAIL_PMM_CNT_NUM];
+static sm_pwrfail_pmm_log_t g_pwrfail_pmm_log;
+
+static void sm_pwrfail_pmm_restore(uint16_t _tag, void* _data, uint16_t _size){
+	const sm_pwrfail_record_t* record = sm_pwrfail_last();
+	const void* region;
+	uint16_t size;
+
+	if(!record)
+		return;
+	region = sm_pwrfail_region(record, _tag, &size);
+	if(region && size == _size)
+		memcpy(_data, region, _size);
+}
+
+/* The relays as driven, then all open: what is left of the hold-up goes to
+ * the flash, not to the coils */
+static void sm_pwrfail_pmm_hook(void* _arg){
+	uint32_t relay = 0;
+
+	(void)_arg;
+	for(uint8_t i = 0; i < SM_RELAY_PMM_NUM; i++){
+		if(sm_relay_get(i) > 0)
+			relay |= 1UL << i;
+	}
+	g_pwrfail_pmm_relay = relay;
+	sm_relay_trip();
+
+	g_pwrfail_pmm_counter[SM_PWRFAIL_PMM_CNT_PWRFAIL]++;
+	sm_pwrfail_pmm_event(SM_PWRFAIL_PMM_EVT_PWRFAIL, (uint16_t)relay);
+}
+
+int32_t sm_pwrfail_pmm_init(uint8_t _priority){
+	if(sm_pwrfail_init(SYS_BODCTL_BODVL_3_0V, 0) < 0)
+		return -1;
+
+	sm_pwrfail_pmm_restore(SM_PWRFAIL_PMM_COUNTERS, g_pwrfail_pmm_counter, sizeof(g_pwrfail_pmm_counter));
+	sm_pwrfail_pmm_restore(SM_PWRFAIL_PMM_EVENTS, &g_pwrfail_pmm_log, sizeof(g_pwrfail_pmm_log));
+
+	if(sm_pwrfail_add(SM_PWRFAIL_PMM_RELAY, &g_pwrfail_pmm_relay, sizeof(g_pwrfail_pmm_relay)) < 0 ||
+			sm_pwrfail_add(SM_PWRFAIL_PMM_COUNTERS, g_pwrfail_pmm_counter, sizeof(g_pwrfail_pmm_counter)) < 0 ||
+			sm_pwrfail_add(SM_PWRFAIL_PMM_EVENTS, &g_pwrfail_pmm_log, sizeof(g_pwrfail_pmm_log)) < 0)
+		return -1;
+	sm_pwrfail_set_hook(sm_pwrfail_pmm_hook, NULL);
+
+	/* Both status signals are high while their source is up */
+	if(sm_pwrfail_watch(io_status_ac.m_port, io_status_ac.m_pin, 1, _priority) < 0 ||
+			sm_pwrfail_watch(io_status_ac_dc.m_port, io_status_ac_dc.m_pin, 1, _priority) < 0)
+		return -1;
+
+	return 0;
+}
+
+void sm_pwrfail_pmm_count(sm_pwrfail_pmm_counter_t _counter){
+	uint32_t primask;
+
+	if(_counter >= SM_PWRFAIL_PMM_CNT_NUM)
+		return;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	g_pwrfail_pmm_counter[_counter]++;
+	__set_PRIMASK(primask);
+}
+
+void sm_pwrfail_pmm_event(sm_pwrfail_pmm_event_t _event, uint16_t _arg){
+	sm_pwrfail_pmm_entry_t* entry;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	entry = &g_pwrfail_pmm_log.m_entry[g_pwrfail_pmm_log.m_count % SM_PWRFAIL_PMM_EVENT_NUM];
+	entry->m_ms = sm_kernel_ticks();
+	entry->m_event = (uint16_t)_event;
+	entry->m_arg = _arg;
+	g_pwrfail_pmm_log.m_count++;
+	__set_PRIMASK(primask);
+}
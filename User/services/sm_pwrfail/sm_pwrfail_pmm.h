@@ -0,0 +1,60 @@
+/*
+ * sm_pwrfail_pmm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_PWRFAIL_SM_PWRFAIL_PMM_H_
+#define SERVICES_SM_PWRFAIL_SM_PWRFAIL_PMM_H_
+
+#include "sm_pwrfail.h"
+
+#define SM_PWRFAIL_PMM_EVENT_NUM    16
+
+/* Region tags of the PMM's records */
+typedef enum{
+	SM_PWRFAIL_PMM_RELAY = 1,       /* uint32_t, bit SM_RELAY_PMM_x set when driven on */
+	SM_PWRFAIL_PMM_COUNTERS,        /* uint32_t[SM_PWRFAIL_PMM_CNT_NUM] */
+	SM_PWRFAIL_PMM_EVENTS,          /* sm_pwrfail_pmm_log_t */
+}sm_pwrfail_pmm_tag_t;
+
+typedef enum{
+	SM_PWRFAIL_PMM_CNT_BOOT = 0,
+	SM_PWRFAIL_PMM_CNT_PWRFAIL,
+	SM_PWRFAIL_PMM_CNT_STACK_FAULT,
+	SM_PWRFAIL_PMM_CNT_FW_UPDATE,
+	SM_PWRFAIL_PMM_CNT_USB_OPEN,
+	SM_PWRFAIL_PMM_CNT_NUM
+}sm_pwrfail_pmm_counter_t;
+
+typedef enum{
+	SM_PWRFAIL_PMM_EVT_BOOT = 1,    /* arg: SYS->RSTSTS */
+	SM_PWRFAIL_PMM_EVT_PWRFAIL,     /* arg: the relays as in SM_PWRFAIL_PMM_RELAY */
+	SM_PWRFAIL_PMM_EVT_STACK_FAULT, /* arg: sm_kernel_stack_fault() */
+	SM_PWRFAIL_PMM_EVT_FW_UPDATE,   /* arg: SM_FW_UPDATE_STATE */
+	SM_PWRFAIL_PMM_EVT_USB,         /* arg: 1 opened, 0 closed */
+}sm_pwrfail_pmm_event_t;
+
+typedef struct sm_pwrfail_pmm_entry{
+	uint32_t m_ms;                  /* sm_kernel_ticks() */
+	uint16_t m_event;
+	uint16_t m_arg;
+}sm_pwrfail_pmm_entry_t;
+
+/* The last SM_PWRFAIL_PMM_EVENT_NUM events, entry m_count % NUM is the next */
+typedef struct sm_pwrfail_pmm_log{
+	uint32_t m_count;
+	sm_pwrfail_pmm_entry_t m_entry[SM_PWRFAIL_PMM_EVENT_NUM];
+}sm_pwrfail_pmm_log_t;
+
+/* BOD at 3.0 V on the 3.3 V rail, io_status_ac and io_status_ac_dc watched.
+ * The counters and the event log carry on from the last record. The flush
+ * trips the relays once their states are captured. After sm_defer_init() */
+int32_t sm_pwrfail_pmm_init(uint8_t _priority);
+
+/* Any context */
+void sm_pwrfail_pmm_count(sm_pwrfail_pmm_counter_t _counter);
+void sm_pwrfail_pmm_event(sm_pwrfail_pmm_event_t _event, uint16_t _arg);
+
+#endif /* SERVICES_SM_PWRFAIL_SM_PWRFAIL_PMM_H_ */
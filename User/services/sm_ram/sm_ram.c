@@ -0,0 +1,126 @@
+/*
+ * sm_ram.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_ram.h"
+#include "NuMicro.h"
+#include "sm_fmt.h"
+
+/* gcc_arm.ld / gcc_arm_common.ld */
+extern uint32_t __data_start__[];
+extern uint32_t __data_end__[];
+extern uint32_t __ramfunc_start__[];
+extern uint32_t __ramfunc_end__[];
+extern uint32_t __bss_end__[];
+extern uint32_t __pool_start__[];
+extern uint32_t __pool_end__[];
+extern uint32_t __noinit_start__[];
+extern uint32_t __noinit_end__[];
+extern uint32_t __HeapBase[];
+extern uint32_t __HeapLimit[];
+extern uint32_t __StackLimit[];
+extern uint32_t __StackTop[];
+
+static uint8_t g_ram_overrun;
+
+void sm_ram_paint(void* _base, uint32_t _size){
+	uint32_t* word = (uint32_t*)_base;
+
+	for(uint32_t i = 0; i < _size / 4; i++)
+		word[i] = SM_RAM_STACK_PAINT;
+}
+
+/* Stacks grow down: the first word from the bottom that lost the paint is
+ * the deepest one ever used */
+uint32_t sm_ram_high_water(const void* _base, uint32_t _size){
+	const uint32_t* word = (const uint32_t*)_base;
+	uint32_t num = _size / 4;
+	uint32_t i = 0;
+
+	while(i < num && word[i] == SM_RAM_STACK_PAINT)
+		i++;
+
+	return (num - i) * 4;
+}
+
+uint32_t sm_ram_stack_used(void){
+	return sm_ram_high_water(__StackLimit, (uint32_t)__StackTop - (uint32_t)__StackLimit);
+}
+
+int32_t sm_ram_stack_check(void){
+	const uint32_t* guard = (const uint32_t*)__StackLimit;
+	uint32_t sp = __get_MSP();
+
+	if(g_ram_overrun)
+		return -1;
+
+	if(sp < (uint32_t)__StackLimit + SM_RAM_STACK_GUARD_SIZE){
+		g_ram_overrun = 1;
+		return -1;
+	}
+
+	for(uint32_t i = 0; i < SM_RAM_STACK_GUARD_SIZE / 4; i++){
+		if(guard[i] != SM_RAM_STACK_PAINT){
+			g_ram_overrun = 1;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int32_t sm_ram_get_map(sm_ram_map_t* _map){
+	if(!_map)
+		return -1;
+
+	_map->m_ram_start = SRAM_BASE;
+	_map->m_ram_size = (uint32_t)__StackTop - SRAM_BASE;
+	_map->m_data_start = (uint32_t)__data_start__;
+	_map->m_data_size = (uint32_t)__data_end__ - (uint32_t)__data_start__;
+	_map->m_ramfunc_start = (uint32_t)__ramfunc_start__;
+	_map->m_ramfunc_size = (uint32_t)__ramfunc_end__ - (uint32_t)__ramfunc_start__;
+	_map->m_pool_start = (uint32_t)__pool_start__;
+	_map->m_pool_size = (uint32_t)__pool_end__ - (uint32_t)__pool_start__;
+	/* The pools open .bss */
+	_map->m_bss_start = (uint32_t)__pool_end__;
+	_map->m_bss_size = (uint32_t)__bss_end__ - (uint32_t)__pool_end__;
+	_map->m_noinit_start = (uint32_t)__noinit_start__;
+	_map->m_noinit_size = (uint32_t)__noinit_end__ - (uint32_t)__noinit_start__;
+	_map->m_heap_start = (uint32_t)__HeapBase;
+	_map->m_heap_size = (uint32_t)__HeapLimit - (uint32_t)__HeapBase;
+	_map->m_free_size = (uint32_t)__StackLimit - (uint32_t)__HeapLimit;
+	_map->m_stack_start = (uint32_t)__StackLimit;
+	_map->m_stack_size = (uint32_t)__StackTop - (uint32_t)__StackLimit;
+	_map->m_stack_used = sm_ram_stack_used();
+	return 0;
+}
+
+static void sm_ram_print(sm_fmt_write_fn_t _write, void* _arg, const char* _name, uint32_t _start, uint32_t _size){
+	sm_fmt_print(_write, _arg, "  %-6s 0x%08lX %6lu\r\n", _name, (unsigned long)_start, (unsigned long)_size);
+}
+
+int32_t sm_ram_report(sm_fmt_write_fn_t _write, void* _arg){
+	sm_ram_map_t map;
+
+	if(!_write || sm_ram_get_map(&map) < 0)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "ram: %lu bytes at 0x%08lX\r\n", (unsigned long)map.m_ram_size,
+			(unsigned long)map.m_ram_start);
+
+	sm_ram_print(_write, _arg, ".data", map.m_data_start, map.m_data_size);
+	sm_ram_print(_write, _arg, ".ramfn", map.m_ramfunc_start, map.m_ramfunc_size);
+	sm_ram_print(_write, _arg, ".bss", map.m_bss_start, map.m_bss_size);
+	sm_ram_print(_write, _arg, "pools", map.m_pool_start, map.m_pool_size);
+	sm_ram_print(_write, _arg, "noinit", map.m_noinit_start, map.m_noinit_size);
+	sm_ram_print(_write, _arg, "heap", map.m_heap_start, map.m_heap_size);
+	sm_ram_print(_write, _arg, "free", map.m_heap_start + map.m_heap_size, map.m_free_size);
+	sm_ram_print(_write, _arg, "stack", map.m_stack_start, map.m_stack_size);
+
+	sm_fmt_print(_write, _arg, "  stack used %lu (%lu%%), guard %s\r\n", (unsigned long)map.m_stack_used,
+			(unsigned long)(map.m_stack_size ? map.m_stack_used * 100 / map.m_stack_size : 0),
+			sm_ram_stack_check() < 0 ? "HIT" : "ok");
+	return 0;
+}
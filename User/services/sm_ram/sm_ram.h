@@ -0,0 +1,71 @@
+/*
+ * sm_ram.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_RAM_SM_RAM_H_
+#define SERVICES_SM_RAM_SM_RAM_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * RAM budget of the 16K part: the layout gcc_arm_common.ld produced, and the
+ * main stack use. Reset_Handler paints the stack with SM_RAM_STACK_PAINT, so
+ * the deepest use since reset is the lowest word that lost the pattern. The
+ * lowest SM_RAM_STACK_GUARD_SIZE bytes are the guard: once they are touched
+ * the stack is about to run into the heap and .bss below it.
+ *
+ * The M23 here has no stack limit register, so sm_ram_stack_check() has to be
+ * called periodically, from the scheduler tick.
+ */
+
+/* Keep equal to the pattern in startup_M253.S */
+#define SM_RAM_STACK_PAINT          0xC5C5C5C5UL
+#define SM_RAM_STACK_GUARD_SIZE     32
+
+/* Put a static buffer in the pool area, shown apart from .bss in the map */
+#define SM_RAM_POOL                 __attribute__((section(".bss.sm_pool")))
+
+/* Leave a static out of the start-up clear: it keeps its value over a
+ * software or watchdog reset and is garbage after power-on, so check it */
+#define SM_RAM_NOINIT               __attribute__((section(".noinit")))
+
+typedef struct sm_ram_map{
+	uint32_t m_ram_start;
+	uint32_t m_ram_size;
+	uint32_t m_data_start;
+	uint32_t m_data_size;
+	uint32_t m_ramfunc_start;
+	uint32_t m_ramfunc_size;
+	uint32_t m_bss_start;
+	uint32_t m_bss_size;
+	uint32_t m_pool_start;
+	uint32_t m_pool_size;
+	uint32_t m_noinit_start;
+	uint32_t m_noinit_size;
+	uint32_t m_heap_start;
+	uint32_t m_heap_size;
+	uint32_t m_free_size;        /* between the heap and the stack */
+	uint32_t m_stack_start;
+	uint32_t m_stack_size;
+	uint32_t m_stack_used;       /* high-water mark */
+}sm_ram_map_t;
+
+int32_t sm_ram_get_map(sm_ram_map_t* _map);
+
+/* Deepest main stack use since reset, in bytes */
+uint32_t sm_ram_stack_used(void);
+
+/* Return -1 once the guard is touched or SP is inside it. Latched until reset */
+int32_t sm_ram_stack_check(void);
+
+/* Same painting and high-water scan, for any other stack (thread stacks) */
+void sm_ram_paint(void* _base, uint32_t _size);
+uint32_t sm_ram_high_water(const void* _base, uint32_t _size);
+
+int32_t sm_ram_report(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_RAM_SM_RAM_H_ */
@@ -0,0 +1,465 @@
+/*
+ * sm_relay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_relay.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+#define SM_RELAY_TIMER              TIMER1
+#define SM_RELAY_TIMER_MODULE       TMR1_MODULE
+#define SM_RELAY_TIMER_IRQn         TMR1_IRQn
+#define SM_RELAY_TIMER_HZ           1000000UL
+#define SM_RELAY_TIMER_MASK         0xFFFFFFUL
+/* Compare values 0 and 1 are not allowed, nor is one the counter is about to pass */
+#define SM_RELAY_CMP_MIN            2
+/* Longest compare step: the 24 bit count has to be folded into the time
+ * before it wraps, every 16.7s, even with nothing to switch */
+#define SM_RELAY_KEEPALIVE_US       8000000UL
+/* Time stamps older than this are pulled up to it at every step, so that the
+ * elapsed times stay far from the 32 bit wrap (71 min) however long a relay
+ * rests. The minimum times, inrush and gaps have to be shorter */
+#define SM_RELAY_AGE_MAX_US         0x40000000UL
+
+typedef struct sm_relay_state{
+	volatile uint32_t* m_out;       /* the pin's bit access register */
+	uint8_t m_on;                   /* as driven */
+	uint8_t m_target;
+	uint8_t m_pending;
+	uint8_t m_after;                /* transfer partner to switch first, or SM_RELAY_NONE */
+	uint32_t m_gap_us;              /* then wait this long after it */
+	uint32_t m_requested;
+	uint32_t m_switched;
+	uint32_t m_count;
+	uint32_t m_late_max;            /* worst switch after the due time */
+}sm_relay_state_t;
+
+typedef struct sm_relay{
+	const sm_relay_desc_t* m_desc;
+	const sm_relay_rule_t* m_rule;
+	uint8_t m_num;
+	uint8_t m_rule_num;
+	uint32_t m_now;
+	uint32_t m_last_cnt;
+	uint32_t m_inrush_at;           /* the last close */
+	uint32_t m_inrush_us;           /* no close this long after it, 0 once over */
+	uint32_t m_trips;
+	sm_relay_state_t m_relay[SM_RELAY_MAX];
+}sm_relay_t;
+
+static sm_relay_t g_relay;
+
+/* Time left of _us counted from _since, 0 once over; then *_late takes how
+ * long ago it ran out if that is less */
+static uint32_t sm_relay_left(uint32_t _since, uint32_t _us, uint32_t _now, uint32_t* _late){
+	uint32_t elapsed = _now - _since;
+
+	if(elapsed < _us)
+		return _us - elapsed;
+	if(elapsed - _us < *_late)
+		*_late = elapsed - _us;
+	return 0;
+}
+
+static void sm_relay_age(uint32_t* _stamp, uint32_t _now){
+	if(_now - *_stamp > SM_RELAY_AGE_MAX_US)
+		*_stamp = _now - SM_RELAY_AGE_MAX_US;
+}
+
+/* Fold the counter into the time. Interrupts off */
+static uint32_t sm_relay_update(void){
+	uint32_t cnt = SM_RELAY_TIMER->CNT & SM_RELAY_TIMER_MASK;
+
+	g_relay.m_now += (cnt - g_relay.m_last_cnt) & SM_RELAY_TIMER_MASK;
+	g_relay.m_last_cnt = cnt;
+	return g_relay.m_now;
+}
+
+static void sm_relay_drive(uint8_t _id, uint8_t _on, uint32_t _now){
+	sm_relay_state_t* relay = &g_relay.m_relay[_id];
+
+	*relay->m_out = (uint32_t)(_on ^ g_relay.m_desc[_id].m_active_low);
+	relay->m_on = _on;
+	relay->m_switched = _now;
+	relay->m_count++;
+	if(_on){
+		g_relay.m_inrush_at = _now;
+		g_relay.m_inrush_us = g_relay.m_desc[_id].m_inrush_us;
+	}
+}
+
+/* What the relays as they are now allow for _id going to its target: 0 to
+ * wait for another relay to move first */
+static uint8_t sm_relay_allowed(uint8_t _id, uint8_t _on){
+	for(uint8_t r = 0; r < g_relay.m_rule_num; r++){
+		const sm_relay_rule_t* rule = &g_relay.m_rule[r];
+
+		if(rule->m_type == SM_RELAY_EXCLUSIVE){
+			if(_on && ((rule->m_a == _id && g_relay.m_relay[rule->m_b].m_on) ||
+					(rule->m_b == _id && g_relay.m_relay[rule->m_a].m_on)))
+				return 0;
+		}else{
+			if(_on && rule->m_a == _id && !g_relay.m_relay[rule->m_b].m_on)
+				return 0;
+			if(!_on && rule->m_b == _id && g_relay.m_relay[rule->m_a].m_on)
+				return 0;
+		}
+	}
+	return 1;
+}
+
+/* Whether the targets would break a rule with _id at _on */
+static uint8_t sm_relay_conflict(uint8_t _id, uint8_t _on){
+	for(uint8_t r = 0; r < g_relay.m_rule_num; r++){
+		const sm_relay_rule_t* rule = &g_relay.m_rule[r];
+
+		if(rule->m_type == SM_RELAY_EXCLUSIVE){
+			if(_on && ((rule->m_a == _id && g_relay.m_relay[rule->m_b].m_target) ||
+					(rule->m_b == _id && g_relay.m_relay[rule->m_a].m_target)))
+				return 1;
+		}else{
+			if(_on && rule->m_a == _id && !g_relay.m_relay[rule->m_b].m_target)
+				return 1;
+			if(!_on && rule->m_b == _id && g_relay.m_relay[rule->m_a].m_target)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+static uint32_t sm_relay_max(uint32_t _a, uint32_t _b){
+	return _a > _b ? _a : _b;
+}
+
+/* Microseconds until _id may switch, 0 when it may now with *_late how late
+ * that is; *_blocked set when it waits on another relay */
+static uint32_t sm_relay_due(uint8_t _id, uint32_t _now, uint8_t* _blocked, uint32_t* _late){
+	const sm_relay_desc_t* desc = &g_relay.m_desc[_id];
+	const sm_relay_state_t* relay = &g_relay.m_relay[_id];
+	uint32_t wait;
+
+	*_blocked = 0;
+	*_late = _now - relay->m_requested;
+	if(relay->m_target){
+		wait = sm_relay_left(relay->m_switched, desc->m_min_off_us, _now, _late);
+		wait = sm_relay_max(wait, sm_relay_left(g_relay.m_inrush_at, g_relay.m_inrush_us, _now, _late));
+	}else{
+		wait = sm_relay_left(relay->m_switched, desc->m_min_on_us, _now, _late);
+	}
+
+	if(relay->m_after != SM_RELAY_NONE){
+		const sm_relay_state_t* first = &g_relay.m_relay[relay->m_after];
+
+		if(first->m_pending){
+			*_blocked = 1;
+			return 0;
+		}
+		wait = sm_relay_max(wait, sm_relay_left(first->m_switched, relay->m_gap_us, _now, _late));
+	}
+
+	if(!sm_relay_allowed(_id, relay->m_target)){
+		*_blocked = 1;
+		return 0;
+	}
+	return wait;
+}
+
+static void sm_relay_program(uint32_t _now, uint32_t _next){
+	uint32_t delta = _next - _now;
+	uint32_t cmp;
+	uint32_t cnt;
+
+	if((int32_t)delta < SM_RELAY_CMP_MIN)
+		delta = SM_RELAY_CMP_MIN;
+	if(delta > SM_RELAY_KEEPALIVE_US)
+		delta = SM_RELAY_KEEPALIVE_US;
+
+	cnt = SM_RELAY_TIMER->CNT & SM_RELAY_TIMER_MASK;
+	cmp = (cnt + delta) & SM_RELAY_TIMER_MASK;
+	if(cmp < SM_RELAY_CMP_MIN)
+		cmp = SM_RELAY_CMP_MIN;
+	SM_RELAY_TIMER->CMP = cmp;
+
+	/* Passed while it was written: run the handler again rather than wait a lap */
+	if(((cmp - (SM_RELAY_TIMER->CNT & SM_RELAY_TIMER_MASK)) & SM_RELAY_TIMER_MASK) > delta)
+		NVIC_SetPendingIRQ(SM_RELAY_TIMER_IRQn);
+}
+
+/* Switch whatever is due, then aim the timer at the next. Interrupts off */
+static void sm_relay_step(void){
+	uint32_t now = sm_relay_update();
+	uint32_t next = SM_RELAY_KEEPALIVE_US;
+	uint8_t switched;
+
+	for(uint8_t i = 0; i < g_relay.m_num; i++){
+		sm_relay_age(&g_relay.m_relay[i].m_requested, now);
+		sm_relay_age(&g_relay.m_relay[i].m_switched, now);
+	}
+	if(now - g_relay.m_inrush_at >= g_relay.m_inrush_us)
+		g_relay.m_inrush_us = 0;
+
+	do{
+		switched = 0;
+		for(uint8_t i = 0; i < g_relay.m_num; i++){
+			sm_relay_state_t* relay = &g_relay.m_relay[i];
+			uint8_t blocked;
+			uint32_t wait;
+			uint32_t late;
+
+			if(!relay->m_pending)
+				continue;
+
+			wait = sm_relay_due(i, now, &blocked, &late);
+			if(blocked)
+				continue;
+
+			if(wait){
+				if(wait < next)
+					next = wait;
+				continue;
+			}
+
+			if(late > relay->m_late_max)
+				relay->m_late_max = late;
+			relay->m_pending = 0;
+			sm_relay_drive(i, relay->m_target, now);
+			switched = 1;
+		}
+	}while(switched);
+
+	sm_relay_program(now, now + next);
+}
+
+void TMR1_IRQHandler(void){
+	uint32_t primask = __get_PRIMASK();
+
+	SM_RELAY_TIMER->INTSTS = TIMER_INTSTS_TIF_Msk;
+
+	__disable_irq();
+	sm_relay_step();
+	__set_PRIMASK(primask);
+}
+
+int32_t sm_relay_init(const sm_relay_desc_t* _relay, uint8_t _num, const sm_relay_rule_t* _rule, uint8_t _rule_num,
+		uint8_t _priority){
+	uint32_t locked;
+
+	if(!_relay || !_num || _num > SM_RELAY_MAX || (_rule_num && !_rule))
+		return -1;
+
+	for(uint8_t i = 0; i < _num; i++){
+		if(_relay[i].m_min_on_us > SM_RELAY_AGE_MAX_US || _relay[i].m_min_off_us > SM_RELAY_AGE_MAX_US ||
+				_relay[i].m_inrush_us > SM_RELAY_AGE_MAX_US)
+			return -1;
+	}
+
+	for(uint8_t r = 0; r < _rule_num; r++){
+		if(_rule[r].m_a >= _num || _rule[r].m_b >= _num || _rule[r].m_a == _rule[r].m_b)
+			return -1;
+	}
+
+	locked = SYS_IsRegLocked();
+	if(locked)
+		SYS_UnlockReg();
+
+	CLK_EnableModuleClock(SM_RELAY_TIMER_MODULE);
+	CLK_SetModuleClock(SM_RELAY_TIMER_MODULE, CLK_CLKSEL1_TMR1SEL_HIRC, 0);
+
+	if(locked)
+		SYS_LockReg();
+
+	NVIC_DisableIRQ(SM_RELAY_TIMER_IRQn);
+	SM_RELAY_TIMER->CTL = 0;
+	SM_RELAY_TIMER->INTSTS = TIMER_INTSTS_TIF_Msk;
+	TIMER_ResetCounter(SM_RELAY_TIMER);
+
+	g_relay.m_desc = _relay;
+	g_relay.m_rule = _rule;
+	g_relay.m_num = _num;
+	g_relay.m_rule_num = _rule_num;
+	g_relay.m_now = 0;
+	g_relay.m_last_cnt = 0;
+	g_relay.m_inrush_at = 0;
+	g_relay.m_inrush_us = 0;
+	g_relay.m_trips = 0;
+
+	for(uint8_t i = 0; i < _num; i++){
+		sm_relay_state_t* relay = &g_relay.m_relay[i];
+		uint32_t pin = 0;
+		uint32_t port = ((uint32_t)_relay[i].m_port - (uint32_t)PA) / ((uint32_t)PB - (uint32_t)PA);
+
+		while(pin < 16 && !(_relay[i].m_pin & (1UL << pin)))
+			pin++;
+
+		relay->m_out = &GPIO_PIN_DATA(port, pin);
+		*relay->m_out = _relay[i].m_active_low;
+		GPIO_SetMode(_relay[i].m_port, _relay[i].m_pin, GPIO_MODE_OUTPUT);
+
+		relay->m_on = 0;
+		relay->m_target = 0;
+		relay->m_pending = 0;
+		relay->m_after = SM_RELAY_NONE;
+		relay->m_gap_us = 0;
+		relay->m_requested = 0;
+		/* A relay may have opened just before the reset: its minimum off time
+		 * counts from here */
+		relay->m_switched = 0;
+		relay->m_count = 0;
+		relay->m_late_max = 0;
+	}
+
+	SM_RELAY_TIMER->CMP = SM_RELAY_KEEPALIVE_US;
+	SM_RELAY_TIMER->CTL = TIMER_CONTINUOUS_MODE | TIMER_CTL_INTEN_Msk | TIMER_CTL_CNTEN_Msk |
+			(__HIRC / SM_RELAY_TIMER_HZ - 1);
+
+	NVIC_SetPriority(SM_RELAY_TIMER_IRQn, _priority);
+	NVIC_EnableIRQ(SM_RELAY_TIMER_IRQn);
+
+	return 0;
+}
+
+/* Set _id heading for _on. Interrupts off */
+static void sm_relay_command(uint8_t _id, uint8_t _on, uint8_t _after, uint32_t _gap_us, uint32_t _now){
+	sm_relay_state_t* relay = &g_relay.m_relay[_id];
+
+	relay->m_target = _on;
+	relay->m_after = _after;
+	relay->m_gap_us = _gap_us;
+	relay->m_requested = _now;
+	relay->m_pending = relay->m_on != _on;
+}
+
+int32_t sm_relay_set(uint8_t _id, uint8_t _on){
+	uint32_t primask;
+	int32_t rc = -1;
+
+	if(_id >= g_relay.m_num)
+		return -1;
+
+	_on = _on ? 1 : 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(!sm_relay_conflict(_id, _on)){
+		sm_relay_command(_id, _on, SM_RELAY_NONE, 0, sm_relay_update());
+		rc = 0;
+	}
+	__set_PRIMASK(primask);
+
+	/* The switch itself is the timer interrupt's */
+	if(!rc)
+		NVIC_SetPendingIRQ(SM_RELAY_TIMER_IRQn);
+	return rc;
+}
+
+int32_t sm_relay_transfer(uint8_t _from, uint8_t _to, sm_relay_transfer_t _mode, uint32_t _gap_us){
+	uint32_t primask;
+	uint32_t now;
+	uint8_t from_target;
+	int32_t rc = -1;
+
+	if(_from >= g_relay.m_num || _to >= g_relay.m_num || _from == _to || _gap_us > SM_RELAY_AGE_MAX_US)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Judge the second against the targets with the first already going off */
+	from_target = g_relay.m_relay[_from].m_target;
+	g_relay.m_relay[_from].m_target = 0;
+
+	if(!sm_relay_conflict(_from, 0) && !sm_relay_conflict(_to, 1)){
+		now = sm_relay_update();
+		if(_mode == SM_RELAY_MBB){
+			/* An overlap of an exclusive pair would never come */
+			for(uint8_t r = 0; r < g_relay.m_rule_num; r++){
+				const sm_relay_rule_t* rule = &g_relay.m_rule[r];
+
+				if(rule->m_type == SM_RELAY_EXCLUSIVE && ((rule->m_a == _from && rule->m_b == _to) ||
+						(rule->m_a == _to && rule->m_b == _from)))
+					goto out;
+			}
+			sm_relay_command(_to, 1, SM_RELAY_NONE, 0, now);
+			sm_relay_command(_from, 0, _to, _gap_us, now);
+		}else{
+			sm_relay_command(_from, 0, SM_RELAY_NONE, 0, now);
+			sm_relay_command(_to, 1, _from, _gap_us, now);
+		}
+		rc = 0;
+	}
+
+out:
+	if(rc)
+		g_relay.m_relay[_from].m_target = from_target;
+	__set_PRIMASK(primask);
+
+	if(!rc)
+		NVIC_SetPendingIRQ(SM_RELAY_TIMER_IRQn);
+	return rc;
+}
+
+void sm_relay_trip(void){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t now;
+
+	__disable_irq();
+	now = sm_relay_update();
+	for(uint8_t i = 0; i < g_relay.m_num; i++){
+		sm_relay_state_t* relay = &g_relay.m_relay[i];
+
+		relay->m_target = 0;
+		relay->m_pending = 0;
+		if(relay->m_on)
+			sm_relay_drive(i, 0, now);
+	}
+	g_relay.m_trips++;
+	__set_PRIMASK(primask);
+}
+
+int32_t sm_relay_get(uint8_t _id){
+	if(_id >= g_relay.m_num)
+		return -1;
+	return g_relay.m_relay[_id].m_on;
+}
+
+uint8_t sm_relay_busy(void){
+	uint8_t busy = 0;
+
+	for(uint8_t i = 0; i < g_relay.m_num; i++)
+		busy += g_relay.m_relay[i].m_pending;
+	return busy;
+}
+
+uint32_t sm_relay_now(void){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t now;
+
+	__disable_irq();
+	now = sm_relay_update();
+	__set_PRIMASK(primask);
+
+	return now;
+}
+
+int32_t sm_relay_dump(sm_fmt_write_fn_t _write, void* _arg){
+	if(!_write)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "relay: %lu us, trips %lu\r\n", (unsigned long)sm_relay_now(),
+			(unsigned long)g_relay.m_trips);
+
+	for(uint8_t i = 0; i < g_relay.m_num; i++){
+		const sm_relay_state_t* relay = &g_relay.m_relay[i];
+
+		sm_fmt_print(_write, _arg, "  %-8s %-3s%s switched %lu, late max %lu us\r\n",
+				g_relay.m_desc[i].m_name ? g_relay.m_desc[i].m_name : "?", relay->m_on ? "on" : "off",
+				relay->m_pending ? (relay->m_target ? " ->on " : " ->off") : "      ",
+				(unsigned long)relay->m_count, (unsigned long)relay->m_late_max);
+	}
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * sm_relay.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_RELAY_SM_RELAY_H_
+#define SERVICES_SM_RELAY_SM_RELAY_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+
+/*
+ * Relay sequencer. The relays and the rules between them are tables given at
+ * init; a request only says where a relay should go, and the TIMER1
+ * interrupt switches it once everything allows it:
+ *
+ * - minimum on and off times, against contact wear and chatter;
+ * - inrush staggering: after a relay closes, no other closes for its
+ *   m_inrush_us;
+ * - interlocks: EXCLUSIVE pairs are never on together, a REQUIRES relay is
+ *   only on while the one it needs is; a request that breaks one is refused,
+ *   and a switch that the physical state does not allow yet waits for it;
+ * - transfers from one relay to another, break-before-make or
+ *   make-before-break, with the gap or the overlap between the two.
+ *
+ * Outputs change from the timer interrupt only, at its NVIC priority, at
+ * most a few microseconds after they are due whatever the main loop does.
+ * TIMER1 counts microseconds from HIRC in continuous mode, so HCLK profile
+ * changes do not move it. sm_relay_trip() is the exception: everything off
+ * at once, from the caller, minimum times ignored.
+ */
+
+#define SM_RELAY_MAX                8
+#define SM_RELAY_NONE               0xFF
+
+typedef struct sm_relay_desc{
+	const char* m_name;
+	void* m_port;
+	uint32_t m_pin;                 /* BITn, as in sm_gpio_define.h */
+	uint8_t m_active_low;
+	uint32_t m_min_on_us;
+	uint32_t m_min_off_us;
+	uint32_t m_inrush_us;           /* no other relay closes this long after this one did */
+}sm_relay_desc_t;
+
+typedef enum{
+	SM_RELAY_EXCLUSIVE = 0,         /* m_a and m_b never on together */
+	SM_RELAY_REQUIRES,              /* m_a on only while m_b is */
+}sm_relay_rule_type_t;
+
+typedef struct sm_relay_rule{
+	uint8_t m_type;
+	uint8_t m_a;
+	uint8_t m_b;
+}sm_relay_rule_t;
+
+typedef enum{
+	SM_RELAY_BBM = 0,               /* open the first, then close the second after the gap */
+	SM_RELAY_MBB,                   /* close the second, then open the first after the overlap */
+}sm_relay_transfer_t;
+
+/* The tables are kept, not copied. All relays start off. -1 for a minimum
+ * time or inrush over 2^30 us (17 min), elapsed times are kept below that */
+int32_t sm_relay_init(const sm_relay_desc_t* _relay, uint8_t _num, const sm_relay_rule_t* _rule, uint8_t _rule_num,
+		uint8_t _priority);
+
+/* Thread or interrupt. -1 when an interlock forbids the target */
+int32_t sm_relay_set(uint8_t _id, uint8_t _on);
+
+/* -1 when an interlock forbids it, or for a _gap_us over 2^30 */
+int32_t sm_relay_transfer(uint8_t _from, uint8_t _to, sm_relay_transfer_t _mode, uint32_t _gap_us);
+
+/* Everything off now */
+void sm_relay_trip(void);
+
+/* Output as driven, -1 for a bad id */
+int32_t sm_relay_get(uint8_t _id);
+/* Relays still on their way to a target */
+uint8_t sm_relay_busy(void);
+
+/* Microseconds since init, the sequencer's clock */
+uint32_t sm_relay_now(void);
+
+int32_t sm_relay_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SERVICES_SM_RELAY_SM_RELAY_H_ */
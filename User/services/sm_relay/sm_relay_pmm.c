@@ -0,0 +1,42 @@
+/*
+ * sm_relay_pmm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_relay_pmm.h"
+#include "NuMicro.h"
+
+/*
+ * Pins as in sm_gpio_define.h. The times are conservative defaults for
+ * signal relays and a fan, to be tuned against the parts' datasheets.
+ */
+static const sm_relay_desc_t g_relay_pmm[SM_RELAY_PMM_NUM] = {
+	[SM_RELAY_PMM_BSS] = {
+		.m_name = "bss", .m_port = PA, .m_pin = BIT0,
+		.m_min_on_us = 100000, .m_min_off_us = 200000, .m_inrush_us = 20000,
+	},
+	[SM_RELAY_PMM_FAN] = {
+		.m_name = "fan", .m_port = PA, .m_pin = BIT1,
+		.m_min_on_us = 2000000, .m_min_off_us = 2000000, .m_inrush_us = 50000,
+	},
+	[SM_RELAY_PMM_CHR] = {
+		.m_name = "chr", .m_port = PA, .m_pin = BIT4,
+		.m_min_on_us = 100000, .m_min_off_us = 200000, .m_inrush_us = 20000,
+	},
+	/* A logic enable, no contacts */
+	[SM_RELAY_PMM_CHARGER] = {
+		.m_name = "charger", .m_port = PA, .m_pin = BIT11,
+	},
+};
+
+static const sm_relay_rule_t g_relay_pmm_rule[] = {
+	/* The charger runs only behind its closed relay: enabled after, disabled before */
+	{SM_RELAY_REQUIRES, SM_RELAY_PMM_CHARGER, SM_RELAY_PMM_CHR},
+};
+
+int32_t sm_relay_pmm_init(uint8_t _priority){
+	return sm_relay_init(g_relay_pmm, SM_RELAY_PMM_NUM, g_relay_pmm_rule,
+			sizeof(g_relay_pmm_rule) / sizeof(g_relay_pmm_rule[0]), _priority);
+}
@@ -0,0 +1,24 @@
+/*
+ * sm_relay_pmm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SERVICES_SM_RELAY_SM_RELAY_PMM_H_
+#define SERVICES_SM_RELAY_SM_RELAY_PMM_H_
+
+#include "sm_relay.h"
+
+/* The PMM's outputs, ids for sm_relay_set() */
+typedef enum{
+	SM_RELAY_PMM_BSS = 0,           /* io_ctrl_rl_bss */
+	SM_RELAY_PMM_FAN,               /* io_ctrl_rl_fan */
+	SM_RELAY_PMM_CHR,               /* io_ctrl_rl_chr */
+	SM_RELAY_PMM_CHARGER,           /* io_charger_on */
+	SM_RELAY_PMM_NUM
+}sm_relay_pmm_t;
+
+int32_t sm_relay_pmm_init(uint8_t _priority);
+
+#endif /* SERVICES_SM_RELAY_SM_RELAY_PMM_H_ */
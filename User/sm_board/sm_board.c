@@ -6,9 +6,31 @@
  */
 
 #include "sm_board.h"
+#include "sm_defer.h"
 
 int32_t sm_board_init(){
+	uint32_t locked = SYS_IsRegLocked();
 
+	if(locked)
+		SYS_UnlockReg();
 
-	return 0;
+	/* Debug UART0 (uart_debug) on PA6 RXD / PA7 TXD, from HIRC so that an
+	 * HCLK profile switch leaves its baud rate alone */
+	CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+	CLK_EnableModuleClock(UART0_MODULE);
+	SYS->GPA_MFPL = (SYS->GPA_MFPL & ~(SYS_GPA_MFPL_PA6MFP_Msk | SYS_GPA_MFPL_PA7MFP_Msk)) |
+			SYS_GPA_MFPL_PA6MFP_UART0_RXD | SYS_GPA_MFPL_PA7MFP_UART0_TXD;
+
+	/* RS485 port 1 (uart_rs485_1) on PA2 RXD / PA3 TXD, driver enable on PA5
+	 * (io_rs485_en_1); HIRC as well */
+	CLK_SetModuleClock(UART1_MODULE, CLK_CLKSEL1_UART1SEL_HIRC, CLK_CLKDIV0_UART1(1));
+	CLK_EnableModuleClock(UART1_MODULE);
+	SYS->GPA_MFPL = (SYS->GPA_MFPL & ~(SYS_GPA_MFPL_PA2MFP_Msk | SYS_GPA_MFPL_PA3MFP_Msk)) |
+			SYS_GPA_MFPL_PA2MFP_UART1_RXD | SYS_GPA_MFPL_PA3MFP_UART1_TXD;
+
+	if(locked)
+		SYS_LockReg();
+
+	/* The GPIO, UART and power-fail interrupts post their bottom halves here */
+	return sm_defer_init();
 }
@@ -12,4 +12,7 @@
 #include "NuMicro.h"
 #include "sm_gpio.h"
 
+/* Clocks and pins of the board's ports, before their drivers are created */
+int32_t sm_board_init(void);
+
 #endif /* SM_BOARD_SM_BOARD_H_ */
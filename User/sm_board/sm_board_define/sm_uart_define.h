@@ -16,15 +16,16 @@
 typedef struct sm_uart{
 	void* m_instance;
 	uint16_t m_fifo_size;
-	uint16_t m_baudrate;
+	uint32_t m_baudrate;
 	uint8_t m_priority;
 }uart_t;
 
 
-uart_t uart_debug = {.m_instance = UART0, .m_fifo_size = 0, .m_baudrate = 9600};
+/* In sm_uart.c: this header comes with sm_uart.h into every user */
+extern uart_t uart_debug;
 
-uart_t uart_rs485_1 = {.m_instance = UART1, .m_fifo_size = 256, .m_baudrate = 9600};
+extern uart_t uart_rs485_1;
 
-uart_t uart_rs485_2 = {.m_instance = UART2, .m_fifo_size = 256, .m_baudrate = 9600};
+extern uart_t uart_rs485_2;
 
 #endif /* SM_BOARD_SM_UART_SM_UART_DEFINE_H_ */
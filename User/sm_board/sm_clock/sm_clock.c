@@ -0,0 +1,144 @@
+/*
+ * sm_clock.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_clock.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+typedef struct sm_clock_client{
+	sm_clock_notify_fn_t m_fn;
+	void* m_arg;
+}sm_clock_client_t;
+
+typedef struct sm_clock{
+	sm_clock_profile_t m_profile;       /* running */
+	sm_clock_profile_t m_base;          /* asked for by sm_clock_set(), once nothing holds */
+	uint32_t m_holds;
+	sm_clock_client_t m_client[SM_CLOCK_CLIENT_MAX];
+}sm_clock_t;
+
+/* The reset handler has HCLK at HIRC/1 before the C runtime starts */
+static sm_clock_t g_clock = {
+	.m_profile = SM_CLOCK_FULL,
+	.m_base = SM_CLOCK_FULL,
+};
+
+static const uint32_t g_clock_div[SM_CLOCK_PROFILE_NUM] = {SM_CLOCK_LOW_DIV, 1};
+
+static void sm_clock_notify(sm_clock_event_t _event, uint32_t _hclk){
+	for(uint8_t i = 0; i < SM_CLOCK_CLIENT_MAX; i++){
+		if(g_clock.m_client[i].m_fn)
+			g_clock.m_client[i].m_fn(_event, _hclk, g_clock.m_client[i].m_arg);
+	}
+}
+
+int32_t sm_clock_init(void){
+	uint32_t div = ((CLK->CLKDIV0 & CLK_CLKDIV0_HCLKDIV_Msk) >> CLK_CLKDIV0_HCLKDIV_Pos) + 1;
+
+	SystemCoreClockUpdate();
+	g_clock.m_profile = (CLK->CLKSEL0 & CLK_CLKSEL0_HCLKSEL_Msk) == CLK_CLKSEL0_HCLKSEL_HIRC && div == 1 ?
+			SM_CLOCK_FULL : SM_CLOCK_LOW;
+	g_clock.m_base = g_clock.m_profile;
+	g_clock.m_holds = 0;
+
+	return 0;
+}
+
+int32_t sm_clock_register(sm_clock_notify_fn_t _fn, void* _arg){
+	uint32_t primask;
+	int32_t id = -1;
+
+	if(!_fn)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < SM_CLOCK_CLIENT_MAX; i++){
+		if(!g_clock.m_client[i].m_fn){
+			g_clock.m_client[i].m_arg = _arg;
+			g_clock.m_client[i].m_fn = _fn;
+			id = i;
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return id;
+}
+
+int32_t sm_clock_unregister(int32_t _id){
+	if(_id < 0 || _id >= SM_CLOCK_CLIENT_MAX)
+		return -1;
+
+	g_clock.m_client[_id].m_fn = NULL;
+	return 0;
+}
+
+static int32_t sm_clock_switch(sm_clock_profile_t _profile){
+	uint32_t primask;
+	uint32_t locked;
+	uint32_t hclk;
+
+	if(_profile == g_clock.m_profile)
+		return 0;
+
+	hclk = __HIRC / g_clock_div[_profile];
+	sm_clock_notify(SM_CLOCK_PRE, hclk);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	locked = SYS_IsRegLocked();
+	if(locked)
+		SYS_UnlockReg();
+
+	/* FMC access cycles stay at the 48MHz setting of SystemInit, good for both */
+	CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(g_clock_div[_profile]));
+
+	if(locked)
+		SYS_LockReg();
+
+	g_clock.m_profile = _profile;
+	sm_clock_notify(SM_CLOCK_POST, SystemCoreClock);
+
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int32_t sm_clock_set(sm_clock_profile_t _profile){
+	if(_profile >= SM_CLOCK_PROFILE_NUM)
+		return -1;
+
+	g_clock.m_base = _profile;
+	if(g_clock.m_holds)
+		return 0;
+	return sm_clock_switch(_profile);
+}
+
+sm_clock_profile_t sm_clock_get(void){
+	return g_clock.m_profile;
+}
+
+uint32_t sm_clock_hclk(void){
+	return SystemCoreClock;
+}
+
+int32_t sm_clock_hold(void){
+	if(g_clock.m_holds++)
+		return 0;
+	return sm_clock_switch(SM_CLOCK_FULL);
+}
+
+int32_t sm_clock_release(void){
+	if(!g_clock.m_holds)
+		return -1;
+	if(--g_clock.m_holds)
+		return 0;
+	return sm_clock_switch(g_clock.m_base);
+}
@@ -0,0 +1,70 @@
+/*
+ * sm_clock.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_CLOCK_SM_CLOCK_H_
+#define SM_BOARD_SM_CLOCK_SM_CLOCK_H_
+
+#include "stdint.h"
+
+/*
+ * HCLK profiles at run time, on top of CLK_SetHCLK(). Both come from HIRC:
+ * full speed is 48MHz, low power divides it by SM_CLOCK_LOW_DIV. PCLK0/1
+ * follow HCLK, so everything timed from them has to be set again: drivers
+ * register a callback and get
+ *
+ *   SM_CLOCK_PRE    before the switch, interrupts on: let the bus go idle
+ *   SM_CLOCK_POST   right after it, interrupts off: write the new dividers
+ *
+ * Between the switch and the last POST callback nothing else runs, so no
+ * peripheral is ever seen with a divider for the other clock. Keep POST short,
+ * it is register writes only.
+ *
+ * sm_clock_hold() / sm_clock_release() count the users of full speed (firmware
+ * update, bulk transfers): the first hold goes up, the last release comes back
+ * to the profile of the last sm_clock_set(), which only takes effect once
+ * nothing holds. Call them, and sm_clock_set(), from thread level: the PRE
+ * callbacks wait for their bus.
+ */
+
+#ifndef SM_CLOCK_LOW_DIV
+#define SM_CLOCK_LOW_DIV            4       /* 12MHz */
+#endif
+
+#ifndef SM_CLOCK_CLIENT_MAX
+#define SM_CLOCK_CLIENT_MAX         8
+#endif
+
+typedef enum{
+	SM_CLOCK_LOW,
+	SM_CLOCK_FULL,
+	SM_CLOCK_PROFILE_NUM
+}sm_clock_profile_t;
+
+typedef enum{
+	SM_CLOCK_PRE,
+	SM_CLOCK_POST
+}sm_clock_event_t;
+
+/* _hclk: the clock being switched to (PRE) or now running (POST) */
+typedef void (*sm_clock_notify_fn_t)(sm_clock_event_t _event, uint32_t _hclk, void* _arg);
+
+/* Take the profile HCLK is in now (full speed until then, as the reset
+ * handler leaves it). Register clients before or after */
+int32_t sm_clock_init(void);
+
+/* Return the client id, or -1 when the table is full */
+int32_t sm_clock_register(sm_clock_notify_fn_t _fn, void* _arg);
+int32_t sm_clock_unregister(int32_t _id);
+
+int32_t sm_clock_set(sm_clock_profile_t _profile);
+sm_clock_profile_t sm_clock_get(void);
+uint32_t sm_clock_hclk(void);
+
+int32_t sm_clock_hold(void);
+int32_t sm_clock_release(void);
+
+#endif /* SM_BOARD_SM_CLOCK_SM_CLOCK_H_ */
@@ -0,0 +1,84 @@
+/*
+ * sm_crc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_crc.h"
+
+/* The unit reflects each input byte and we read the checksum back raw (no
+ * reverse, no complement), which is exactly the state a new run can be seeded
+ * with. The reflection and complement of CRC-32 are applied once in final(). */
+#define SM_CRC32_ATTRIBUTE   (CRC_WDATA_RVS)
+
+static uint32_t sm_crc_reflect(uint32_t _value){
+	uint32_t ret = 0;
+	for(uint8_t i = 0; i < 32; i++){
+		ret = (ret << 1) | (_value & 1UL);
+		_value >>= 1;
+	}
+	return ret;
+}
+
+int32_t sm_crc_init(void){
+	CLK_EnableModuleClock(CRC_MODULE);
+	return 0;
+}
+
+/* One masked run of the unit, seeded with _crc */
+static uint32_t sm_crc32_run(uint32_t _crc, const uint8_t* _data, uint32_t _len){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t ret;
+
+	__disable_irq();
+
+	CRC_Open(CRC_32, SM_CRC32_ATTRIBUTE, _crc, CRC_CPU_WDATA_8);
+
+	while(_len && ((uint32_t)_data & 0x03UL)){
+		CRC_WRITE_DATA(*_data++);
+		_len--;
+	}
+
+	if(_len >= 4){
+		CRC_SET_WDATA_LEN(CRC_CPU_WDATA_32);
+		while(_len >= 4){
+			CRC_WRITE_DATA(*(const uint32_t*)_data);
+			_data += 4;
+			_len -= 4;
+		}
+		CRC_SET_WDATA_LEN(CRC_CPU_WDATA_8);
+	}
+
+	while(_len--){
+		CRC_WRITE_DATA(*_data++);
+	}
+
+	ret = CRC_GetChecksum();
+
+	__set_PRIMASK(primask);
+	return ret;
+}
+
+/* The unit is shared, so each run masks interrupts, but only for
+ * SM_CRC32_CHUNK bytes: the raw checksum seeds the next run */
+uint32_t sm_crc32_update(uint32_t _crc, const void* _data, uint32_t _len){
+	const uint8_t* data = (const uint8_t*)_data;
+
+	while(_len){
+		uint32_t len = _len < SM_CRC32_CHUNK ? _len : SM_CRC32_CHUNK;
+
+		_crc = sm_crc32_run(_crc, data, len);
+		data += len;
+		_len -= len;
+	}
+	return _crc;
+}
+
+uint32_t sm_crc32_final(uint32_t _crc){
+	return ~sm_crc_reflect(_crc);
+}
+
+uint32_t sm_crc32(const void* _data, uint32_t _len){
+	return sm_crc32_final(sm_crc32_update(SM_CRC32_INIT, _data, _len));
+}
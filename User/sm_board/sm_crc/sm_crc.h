@@ -0,0 +1,34 @@
+/*
+ * sm_crc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_CRC_SM_CRC_H_
+#define SM_BOARD_SM_CRC_SM_CRC_H_
+
+#include "stdint.h"
+#include "NuMicro.h"
+
+/* Running value to seed a new CRC-32 (IEEE 802.3) stream */
+#define SM_CRC32_INIT        0xFFFFFFFFUL
+
+/* Most bytes fed with interrupts masked, about 3 us at 48MHz */
+#ifndef SM_CRC32_CHUNK
+#define SM_CRC32_CHUNK       256
+#endif
+
+int32_t sm_crc_init(void);
+
+/* _crc is the raw running value: start with SM_CRC32_INIT, feed the return of
+ * the previous update back in, then pass the last one to sm_crc32_final().
+ * The hardware unit holds no state between calls, so independent streams can
+ * be interleaved (e.g. KV store records while a firmware image is received). */
+uint32_t sm_crc32_update(uint32_t _crc, const void* _data, uint32_t _len);
+
+uint32_t sm_crc32_final(uint32_t _crc);
+
+uint32_t sm_crc32(const void* _data, uint32_t _len);
+
+#endif /* SM_BOARD_SM_CRC_SM_CRC_H_ */
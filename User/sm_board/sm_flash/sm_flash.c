@@ -0,0 +1,327 @@
+/*
+ * sm_flash.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_flash.h"
+#include "sm_crc.h"
+#include "sm_ramfunc.h"
+
+#include <string.h>
+
+static uint32_t sm_flash_begin(void){
+	uint32_t locked = SYS_IsRegLocked();
+
+	if(locked)
+		SYS_UnlockReg();
+
+	FMC_Open();
+	FMC_ENABLE_AP_UPDATE();
+
+	return locked;
+}
+
+static int32_t sm_flash_end(uint32_t _locked){
+	int32_t ret = 0;
+
+	if(FMC_GET_FAIL_FLAG()){
+		FMC_CLR_FAIL_FLAG();
+		ret = -1;
+	}
+
+	FMC_DISABLE_AP_UPDATE();
+	FMC_Close();
+
+	if(_locked)
+		SYS_LockReg();
+
+	return ret;
+}
+
+/* One ISP command, waited for from SRAM: the CPU keeps running (and taking
+ * SRAM interrupts) instead of stalling on a flash fetch until it is done.
+ * ISPFF is left for sm_flash_end() */
+SM_RAMFUNC static int32_t sm_flash_isp(uint32_t _cmd, uint32_t _addr, uint32_t _data){
+	FMC->ISPCMD = _cmd;
+	FMC->ISPADDR = _addr;
+	FMC->ISPDAT = _data;
+	FMC->ISPTRG = FMC_ISPTRG_ISPGO_Msk;
+
+	while(FMC->ISPTRG & FMC_ISPTRG_ISPGO_Msk){}
+
+	return (FMC->ISPCTL & FMC_ISPCTL_ISPFF_Msk) ? -1 : 0;
+}
+
+/* Same feeding protocol as FMC_Write128(), for any multiple of 4 words: keep
+ * MPDAT0..3 topped up while MPBUSY holds, and if the run stops early (an
+ * interrupt starved it) restart from the last 16 bytes the FMC completed. */
+SM_RAMFUNC static void sm_flash_multi_program(uint32_t _addr, const uint32_t* _data, uint32_t _words){
+	uint32_t primask = __get_PRIMASK();
+	uint32_t idx = 0;
+
+	while(idx < _words){
+		uint8_t stalled = 0;
+
+		FMC->ISPCMD = FMC_ISPCMD_MULTI_PROG;
+		FMC->ISPADDR = _addr + idx * 4;
+		FMC->MPDAT0 = _data[idx];
+		FMC->MPDAT1 = _data[idx + 1];
+		FMC->MPDAT2 = _data[idx + 2];
+		FMC->MPDAT3 = _data[idx + 3];
+		FMC->ISPTRG = 0x1u;
+		idx += 4;
+
+		while(idx < _words && !stalled){
+			__set_PRIMASK(1);
+
+			while(FMC->MPSTS & (3u << FMC_MPSTS_D0_Pos)){
+				if(!(FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk)){
+					stalled = 1;
+					break;
+				}
+			}
+
+			if(!stalled){
+				FMC->MPDAT0 = _data[idx];
+				FMC->MPDAT1 = _data[idx + 1];
+
+				while(FMC->MPSTS & (3u << FMC_MPSTS_D2_Pos)){
+					if(!(FMC->MPSTS & FMC_MPSTS_MPBUSY_Msk)){
+						stalled = 1;
+						break;
+					}
+				}
+			}
+
+			if(!stalled){
+				FMC->MPDAT2 = _data[idx + 2];
+				FMC->MPDAT3 = _data[idx + 3];
+				idx += 4;
+			}
+
+			__set_PRIMASK(primask);
+		}
+
+		if(stalled){
+			idx = ((FMC->MPADDR & ~0xFUL) - _addr) / 4;
+			continue;
+		}
+
+		while(FMC->ISPSTS & FMC_ISPSTS_ISPBUSY_Msk){}
+	}
+}
+
+int32_t sm_flash_init(void){
+	uint32_t locked = SYS_IsRegLocked();
+
+	if(locked)
+		SYS_UnlockReg();
+
+	CLK_EnableModuleClock(ISP_MODULE);
+
+	if(locked)
+		SYS_LockReg();
+
+	return 0;
+}
+
+int32_t sm_flash_erase(uint32_t _addr){
+	if(_addr & (SM_FLASH_PAGE_SIZE - 1))
+		return -1;
+
+	uint32_t locked = sm_flash_begin();
+	int32_t ret = sm_flash_isp(FMC_ISPCMD_PAGE_ERASE, _addr, 0);
+
+	if(sm_flash_end(locked) < 0)
+		ret = -1;
+
+	return ret;
+}
+
+int32_t sm_flash_write(uint32_t _addr, const uint32_t* _data, uint32_t _words){
+	if((_addr & 0x03UL) || !_data)
+		return -1;
+
+	uint32_t locked = sm_flash_begin();
+
+	while(_words && (_addr & 0x0FUL)){
+		sm_flash_isp(FMC_ISPCMD_PROGRAM, _addr, *_data++);
+		_addr += 4;
+		_words--;
+	}
+
+	/* One MULTI_PROG run is at most SM_FLASH_BURST_WORDS and stays in its page */
+	while(_words >= 4){
+		uint32_t burst = (SM_FLASH_PAGE_SIZE - (_addr & (SM_FLASH_PAGE_SIZE - 1))) / 4;
+
+		if(burst > SM_FLASH_BURST_WORDS)
+			burst = SM_FLASH_BURST_WORDS;
+		if(burst > (_words & ~0x03UL))
+			burst = _words & ~0x03UL;
+
+		sm_flash_multi_program(_addr, _data, burst);
+		_addr += burst * 4;
+		_data += burst;
+		_words -= burst;
+	}
+
+	while(_words--){
+		sm_flash_isp(FMC_ISPCMD_PROGRAM, _addr, *_data++);
+		_addr += 4;
+	}
+
+	return sm_flash_end(locked);
+}
+
+int32_t sm_flash_is_erased(uint32_t _addr, uint32_t _size){
+	const uint32_t* word = (const uint32_t*)_addr;
+
+	for(uint32_t i = 0; i < _size / 4; i++){
+		if(word[i] != SM_FLASH_ERASED_WORD)
+			return 0;
+	}
+	return 1;
+}
+
+/* The ISP checksum command runs the same CRC-32 as sm_crc32() over whole pages */
+int32_t sm_flash_verify(uint32_t _addr, uint32_t _size, uint32_t _crc){
+	uint32_t locked = sm_flash_begin();
+	uint32_t sum = FMC_GetChkSum(_addr, _size);
+	int32_t ret = sm_flash_end(locked);
+
+	if(ret < 0 || sum == 0xFFFFFFFFUL || sum != _crc)
+		return -1;
+
+	return 0;
+}
+
+int32_t sm_flash_stream_open(sm_flash_stream_t* _this, uint32_t _addr, uint32_t _size){
+	if(!_this || (_addr & (SM_FLASH_PAGE_SIZE - 1)))
+		return -1;
+
+	memset(_this, 0, sizeof(sm_flash_stream_t));
+	_this->m_addr = _addr;
+	_this->m_end = _addr + _size;
+	_this->m_crc[0] = SM_CRC32_INIT;
+
+	sm_flash_init();
+	sm_crc_init();
+	return 0;
+}
+
+int32_t sm_flash_stream_process(sm_flash_stream_t* _this){
+	if(!_this || _this->m_error)
+		return -1;
+
+	if(!_this->m_prog_pending)
+		return 0;
+
+	uint8_t prog = (uint8_t)(_this->m_fill ^ 1);
+	uint32_t addr = _this->m_prog_addr;
+
+	if(!_this->m_prog_erased){
+		if(!sm_flash_is_erased(addr, SM_FLASH_PAGE_SIZE) && sm_flash_erase(addr) < 0){
+			_this->m_error = -1;
+			return -1;
+		}
+		_this->m_prog_erased = 1;
+		return 1;
+	}
+
+	if(_this->m_prog_offset < SM_FLASH_PAGE_SIZE / 4){
+		uint32_t locked = sm_flash_begin();
+
+		sm_flash_multi_program(addr + _this->m_prog_offset * 4,
+				&_this->m_buf[prog][_this->m_prog_offset], SM_FLASH_BURST_WORDS);
+
+		if(sm_flash_end(locked) < 0){
+			_this->m_error = -1;
+			return -1;
+		}
+
+		_this->m_prog_offset += SM_FLASH_BURST_WORDS;
+		return 1;
+	}
+
+	if(sm_flash_verify(addr, SM_FLASH_PAGE_SIZE, sm_crc32_final(_this->m_crc[prog])) < 0){
+		_this->m_error = -1;
+		return -1;
+	}
+
+	_this->m_prog_pending = 0;
+	return 0;
+}
+
+static int32_t sm_flash_stream_submit(sm_flash_stream_t* _this){
+	while(_this->m_prog_pending){
+		if(sm_flash_stream_process(_this) < 0)
+			return -1;
+	}
+
+	_this->m_prog_addr = _this->m_addr;
+	_this->m_prog_offset = 0;
+	_this->m_prog_erased = 0;
+	_this->m_prog_pending = 1;
+
+	_this->m_fill ^= 1;
+	_this->m_fill_len = 0;
+	_this->m_crc[_this->m_fill] = SM_CRC32_INIT;
+	_this->m_addr += SM_FLASH_PAGE_SIZE;
+	return 0;
+}
+
+int32_t sm_flash_stream_put(sm_flash_stream_t* _this, const void* _data, uint32_t _len){
+	const uint8_t* data = (const uint8_t*)_data;
+	uint32_t left = _len;
+
+	if(!_this || _this->m_error)
+		return -1;
+
+	while(left){
+		if(_this->m_addr >= _this->m_end)
+			return -1;
+
+		uint32_t chunk = SM_FLASH_PAGE_SIZE - _this->m_fill_len;
+		if(chunk > left)
+			chunk = left;
+
+		uint8_t* dst = (uint8_t*)_this->m_buf[_this->m_fill] + _this->m_fill_len;
+		memcpy(dst, data, chunk);
+		_this->m_crc[_this->m_fill] = sm_crc32_update(_this->m_crc[_this->m_fill], dst, chunk);
+
+		_this->m_fill_len += chunk;
+		data += chunk;
+		left -= chunk;
+
+		if(_this->m_fill_len == SM_FLASH_PAGE_SIZE && sm_flash_stream_submit(_this) < 0)
+			return -1;
+	}
+
+	return (int32_t)_len;
+}
+
+int32_t sm_flash_stream_close(sm_flash_stream_t* _this){
+	if(!_this || _this->m_error)
+		return -1;
+
+	if(_this->m_fill_len){
+		uint32_t pad = SM_FLASH_PAGE_SIZE - _this->m_fill_len;
+		uint8_t* dst = (uint8_t*)_this->m_buf[_this->m_fill] + _this->m_fill_len;
+
+		memset(dst, 0xFF, pad);
+		_this->m_crc[_this->m_fill] = sm_crc32_update(_this->m_crc[_this->m_fill], dst, pad);
+		_this->m_fill_len = SM_FLASH_PAGE_SIZE;
+
+		if(sm_flash_stream_submit(_this) < 0)
+			return -1;
+	}
+
+	while(_this->m_prog_pending){
+		if(sm_flash_stream_process(_this) < 0)
+			return -1;
+	}
+
+	return 0;
+}
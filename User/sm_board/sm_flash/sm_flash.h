@@ -0,0 +1,68 @@
+/*
+ * sm_flash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_FLASH_SM_FLASH_H_
+#define SM_BOARD_SM_FLASH_SM_FLASH_H_
+
+#include "stdint.h"
+#include "NuMicro.h"
+
+#define SM_FLASH_PAGE_SIZE        FMC_FLASH_PAGE_SIZE
+#define SM_FLASH_ERASED_WORD      0xFFFFFFFFUL
+
+/* Most words one FMC_ISPCMD_MULTI_PROG run takes (128 bytes), within a page */
+#define SM_FLASH_BURST_WORDS      32
+
+int32_t sm_flash_init(void);
+
+int32_t sm_flash_erase(uint32_t _addr);
+
+/* _addr must be word aligned and the target words erased. The 16-byte aligned
+ * middle of the range goes through the multi-word program command, in runs of
+ * up to SM_FLASH_BURST_WORDS split at page boundaries */
+int32_t sm_flash_write(uint32_t _addr, const uint32_t* _data, uint32_t _words);
+
+int32_t sm_flash_is_erased(uint32_t _addr, uint32_t _size);
+
+/* Return 0 if the FMC checksum of the pages at _addr matches _crc, the
+ * sm_crc32() of the same data */
+int32_t sm_flash_verify(uint32_t _addr, uint32_t _size, uint32_t _crc);
+
+/*
+ * Streaming page writer.
+ *
+ * Two page buffers: put() fills one (running its CRC as data arrives) while
+ * process() erases and programs the other in SM_FLASH_BURST_WORDS steps, so
+ * the caller can keep receiving between bursts. Each page is checked against
+ * the FMC checksum once programmed instead of being read back word by word.
+ */
+typedef struct sm_flash_stream{
+	uint32_t m_buf[2][SM_FLASH_PAGE_SIZE / 4];
+	uint32_t m_crc[2];
+	uint32_t m_addr;          /* page the fill buffer goes to */
+	uint32_t m_end;
+	uint32_t m_prog_addr;
+	uint16_t m_fill_len;      /* bytes */
+	uint16_t m_prog_offset;   /* words */
+	uint8_t m_fill;
+	uint8_t m_prog_pending;
+	uint8_t m_prog_erased;
+	int8_t m_error;
+}sm_flash_stream_t;
+
+int32_t sm_flash_stream_open(sm_flash_stream_t* _this, uint32_t _addr, uint32_t _size);
+
+/* Block only when both buffers are in use. Return _len or -1 */
+int32_t sm_flash_stream_put(sm_flash_stream_t* _this, const void* _data, uint32_t _len);
+
+/* One erase or program burst. Return 1 while a page is in flight, 0 when idle */
+int32_t sm_flash_stream_process(sm_flash_stream_t* _this);
+
+/* Pad the last page with 0xFF and program everything that is left */
+int32_t sm_flash_stream_close(sm_flash_stream_t* _this);
+
+#endif /* SM_BOARD_SM_FLASH_SM_FLASH_H_ */
@@ -6,17 +6,92 @@
  */
 
 #include "sm_gpio.h"
+#include "sm_defer.h"
 #include "stddef.h"
 #include "stdlib.h"
 
+#define SM_GPIO_PORT_NUM    6
+
+/* The TYPE bit GPIO_INT_HIGH and GPIO_INT_LOW set */
+#define SM_GPIO_INT_LEVEL   0x01000000UL
+
 typedef struct sm_gpio_impl{
 	void* m_port;
 	uint32_t m_pin;
 	uint8_t m_mode;
+	uint8_t m_irq_prio;                 /* sm_defer level of the callback */
+	sm_gpio_irq_fn_t m_irq;
+	void* m_irq_arg;
 }sm_gpio_impl_t;
 
 #define impl(x) ((sm_gpio_impl_t*)(x))
 
+static sm_gpio_impl_t* g_gpio_irq[SM_GPIO_PORT_NUM][SM_GPIO_IRQ_MAX];
+
+static int8_t sm_gpio_port_index(void* _port){
+	if(_port == PA) return 0;
+	if(_port == PB) return 1;
+	if(_port == PC) return 2;
+	if(_port == PD) return 3;
+	if(_port == PE) return 4;
+	if(_port == PF) return 5;
+	return -1;
+}
+
+/* m_pin is a BITn mask, the bit access window wants n */
+static uint8_t sm_gpio_pin_index(uint32_t _pin){
+	uint8_t n = 0;
+
+	while(n < 16 && !(_pin & (1UL << n)))
+		n++;
+	return n;
+}
+
+static void sm_gpio_irq_bottom(void* _arg, uint32_t _level){
+	sm_gpio_impl_t* this = _arg;
+
+	if(this->m_irq)
+		this->m_irq(this, _level, this->m_irq_arg);
+}
+
+/* Top half: acknowledge, sample, post. The rest is the callback's, at PendSV */
+static void sm_gpio_isr(GPIO_T* _port, uint8_t _index){
+	uint32_t src = _port->INTSRC;
+	uint32_t pin = _port->PIN;
+
+	_port->INTSRC = src;
+	for(uint8_t i = 0; i < SM_GPIO_IRQ_MAX; i++){
+		sm_gpio_impl_t* this = g_gpio_irq[_index][i];
+
+		if(this && (src & this->m_pin))
+			sm_defer_post((sm_defer_prio_t)this->m_irq_prio, sm_gpio_irq_bottom, this, pin & this->m_pin);
+	}
+}
+
+void GPA_IRQHandler(void){
+	sm_gpio_isr(PA, 0);
+}
+
+void GPB_IRQHandler(void){
+	sm_gpio_isr(PB, 1);
+}
+
+void GPC_IRQHandler(void){
+	sm_gpio_isr(PC, 2);
+}
+
+void GPD_IRQHandler(void){
+	sm_gpio_isr(PD, 3);
+}
+
+void GPE_IRQHandler(void){
+	sm_gpio_isr(PE, 4);
+}
+
+void GPF_IRQHandler(void){
+	sm_gpio_isr(PF, 5);
+}
+
 sm_gpio_t* sm_gpio_create(void* _port, uint32_t _pin, uint8_t _mode){
 
 	sm_gpio_impl_t* this = malloc(sizeof(sm_gpio_impl_t));
@@ -26,6 +101,9 @@ sm_gpio_t* sm_gpio_create(void* _port, uint32_t _pin, uint8_t _mode){
 	this->m_port = _port;
 	this->m_pin = _pin;
 	this->m_mode = _mode;
+	this->m_irq_prio = SM_DEFER_NORMAL;
+	this->m_irq = NULL;
+	this->m_irq_arg = NULL;
 	GPIO_SetMode(_port, _pin, _mode);
 
 	return this;
@@ -45,7 +123,7 @@ int32_t sm_gpio_write(sm_gpio_t* _this, int8_t _value){
 	if(this->m_port == PE) port_index = 4;
 	if(this->m_port == PF) port_index = 5;
 
-	GPIO_PIN_DATA(port_index, this->m_pin) = _value;
+	GPIO_PIN_DATA(port_index, sm_gpio_pin_index(this->m_pin)) = _value;
 	return 0;
 }
 
@@ -63,7 +141,7 @@ int32_t sm_gpio_read(sm_gpio_t* _this){
 	if(this->m_port == PE) port_index = 4;
 	if(this->m_port == PF) port_index = 5;
 
-	return GPIO_PIN_DATA(port_index, this->m_pin);
+	return GPIO_PIN_DATA(port_index, sm_gpio_pin_index(this->m_pin));
 }
 
 int32_t sm_gpio_toggle(sm_gpio_t* _this){
@@ -75,11 +153,83 @@ int32_t sm_gpio_toggle(sm_gpio_t* _this){
 	return 0;
 }
 
+int32_t sm_gpio_enable_interrupt(sm_gpio_t* _this, uint32_t _attr, uint8_t _priority, uint8_t _prio,
+		sm_gpio_irq_fn_t _fn, void* _arg){
+	sm_gpio_impl_t* this = impl(_this);
+	int8_t index;
+	int8_t slot = -1;
+	uint32_t primask;
+
+	/* A level stays up after the source is cleared: it would never let PendSV run */
+	if(!this || !_fn || _prio >= SM_DEFER_PRIO_NUM || (_attr & SM_GPIO_INT_LEVEL))
+		return -1;
+
+	index = sm_gpio_port_index(this->m_port);
+	if(index < 0)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < SM_GPIO_IRQ_MAX; i++){
+		if(g_gpio_irq[index][i] == this){
+			slot = (int8_t)i;
+			break;
+		}
+		if(slot < 0 && !g_gpio_irq[index][i])
+			slot = (int8_t)i;
+	}
+	if(slot >= 0){
+		this->m_irq_prio = _prio;
+		this->m_irq = _fn;
+		this->m_irq_arg = _arg;
+		g_gpio_irq[index][slot] = this;
+	}
+	__set_PRIMASK(primask);
+
+	if(slot < 0)
+		return -1;
+
+	for(uint32_t n = 0; n < 16; n++){
+		if(this->m_pin & (1UL << n))
+			GPIO_EnableInt(this->m_port, n, _attr);
+	}
+	NVIC_SetPriority((IRQn_Type)(GPA_IRQn + index), _priority);
+	NVIC_EnableIRQ((IRQn_Type)(GPA_IRQn + index));
+
+	return 0;
+}
+
+int32_t sm_gpio_disable_interrupt(sm_gpio_t* _this){
+	sm_gpio_impl_t* this = impl(_this);
+	int8_t index;
+
+	if(!this)
+		return -1;
+
+	index = sm_gpio_port_index(this->m_port);
+	if(index < 0)
+		return -1;
+
+	for(uint32_t n = 0; n < 16; n++){
+		if(this->m_pin & (1UL << n))
+			GPIO_DisableInt(this->m_port, n);
+	}
+	for(uint8_t i = 0; i < SM_GPIO_IRQ_MAX; i++){
+		if(g_gpio_irq[index][i] == this)
+			g_gpio_irq[index][i] = NULL;
+	}
+	/* An item already posted still runs: it finds no callback */
+	this->m_irq = NULL;
+
+	return 0;
+}
+
 int32_t sm_gpio_destroy(sm_gpio_t* _this){
 	sm_gpio_impl_t* this = impl(_this);
 	if(!this)
 		return -1;
 
+	sm_gpio_disable_interrupt(this);
 	free(this);
 	return 0;
 }
@@ -11,8 +11,15 @@
 
 #include "sm_gpio_define.h"
 
+#ifndef SM_GPIO_IRQ_MAX
+#define SM_GPIO_IRQ_MAX     4
+#endif
+
 typedef void sm_gpio_t;
 
+/* _level: the pins as the interrupt sampled them, non zero when any is high */
+typedef void (*sm_gpio_irq_fn_t)(sm_gpio_t* _this, uint32_t _level, void* _arg);
+
 sm_gpio_t* sm_gpio_create(void* _port, uint32_t _pin, uint8_t _mode);
 
 int32_t sm_gpio_write(sm_gpio_t* _this, int8_t _value);
@@ -21,6 +28,17 @@ int32_t sm_gpio_read(sm_gpio_t* _this);
 
 int32_t sm_gpio_toggle(sm_gpio_t* _this);
 
+/*
+ * Edge interrupt on the pins, _attr GPIO_INT_RISING, GPIO_INT_FALLING or
+ * GPIO_INT_BOTH_EDGE. The port interrupt, at NVIC _priority, only clears the
+ * source, samples the port and posts _fn to sm_defer at level _prio: a
+ * protection input wants SM_DEFER_HIGH. Up to SM_GPIO_IRQ_MAX per port.
+ */
+int32_t sm_gpio_enable_interrupt(sm_gpio_t* _this, uint32_t _attr, uint8_t _priority, uint8_t _prio,
+		sm_gpio_irq_fn_t _fn, void* _arg);
+
+int32_t sm_gpio_disable_interrupt(sm_gpio_t* _this);
+
 int32_t sm_gpio_destroy(sm_gpio_t* _this);
 
 #endif /* SM_BOARD_SM_GPIO_SM_GPIO_H_ */
@@ -0,0 +1,317 @@
+/*
+ * sm_i2c.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_i2c.h"
+#include "sm_clock.h"
+
+#include <stdlib.h>
+
+#define SM_I2C_NUM              2
+
+/* Bounded wait for the STOP in flight before the next START */
+#define SM_I2C_STOP_SPIN        1000
+
+/* Bounded wait for the transfer on the bus before a clock change */
+#define SM_I2C_IDLE_SPIN        100000
+
+typedef struct sm_i2c_impl{
+	void* m_instance;
+	uint32_t m_bus_clock;
+	uint32_t m_bus_target;          /* asked for at create, m_bus_clock is what PCLK gives */
+	int8_t m_clock_id;
+	uint8_t m_priority;
+	uint8_t m_reading;              /* the current transfer is in its read phase */
+	volatile uint8_t m_running;     /* a transfer owns the bus, STOP not sent yet */
+	uint8_t m_held;                 /* clock change: queue, do not start */
+	sm_i2c_xfer_t* volatile m_head; /* transfer on the bus */
+	sm_i2c_xfer_t* m_tail;
+}sm_i2c_impl_t;
+
+#define impl(x) ((sm_i2c_impl_t*)(x))
+
+static sm_i2c_impl_t* g_i2c_list[SM_I2C_NUM];
+
+static int8_t sm_i2c_index(void* _instance){
+	if(_instance == I2C0)
+		return 0;
+	if(_instance == I2C1)
+		return 1;
+	return -1;
+}
+
+static void sm_i2c_start(I2C_T* _i2c){
+	for(uint32_t i = 0; i < SM_I2C_STOP_SPIN && (_i2c->CTL0 & I2C_CTL0_STO_Msk); i++);
+	I2C_START(_i2c);
+}
+
+static uint8_t sm_i2c_write_byte(const sm_i2c_xfer_t* _xfer, uint16_t _index){
+	if(_index < _xfer->m_reg_len)
+		return (uint8_t)(_xfer->m_reg >> (8 * (_xfer->m_reg_len - 1 - _index)));
+	return _xfer->m_tx[_index - _xfer->m_reg_len];
+}
+
+/* Retire the transfer on the bus and hand the bus to the next one: repeated
+ * START when this one ended well and asked for no STOP, STOP + START if not */
+static void sm_i2c_finish(I2C_T* _i2c, sm_i2c_impl_t* _this, int32_t _status){
+	sm_i2c_xfer_t* xfer = _this->m_head;
+
+	_this->m_head = xfer->m_next;
+	if(!_this->m_head)
+		_this->m_tail = NULL;
+	_this->m_reading = 0;
+
+	if(_this->m_head && !_this->m_held && _status == SM_I2C_OK && !(xfer->m_flags & SM_I2C_FLAG_STOP)){
+		I2C_SET_CONTROL_REG(_i2c, I2C_CTL_STA_SI);
+	}else{
+		I2C_SET_CONTROL_REG(_i2c, I2C_CTL_STO_SI);
+		if(_this->m_head && !_this->m_held)
+			sm_i2c_start(_i2c);
+		else
+			_this->m_running = 0;
+	}
+
+	/* The callback may submit again, the queue is already consistent */
+	xfer->m_status = _status;
+	if(xfer->m_done)
+		xfer->m_done(xfer, xfer->m_arg);
+}
+
+/* One SI event of the master state machine in i2c.c */
+static void sm_i2c_isr(I2C_T* _i2c, sm_i2c_impl_t* _this){
+	sm_i2c_xfer_t* xfer = _this ? _this->m_head : NULL;
+	uint32_t ctrl = I2C_CTL_SI;
+	uint16_t write_len;
+
+	if(I2C_GET_TIMEOUT_FLAG(_i2c)){
+		I2C_ClearTimeoutFlag(_i2c);
+		if(xfer)
+			sm_i2c_finish(_i2c, _this, SM_I2C_ERR_TIMEOUT);
+		return;
+	}
+
+	if(!(_i2c->CTL0 & I2C_CTL0_SI_Msk))
+		return;
+
+	if(!xfer){
+		I2C_SET_CONTROL_REG(_i2c, I2C_CTL_STO_SI);
+		return;
+	}
+
+	write_len = (uint16_t)(xfer->m_reg_len + xfer->m_tx_len);
+
+	switch(I2C_GET_STATUS(_i2c)){
+	case 0x08:                      /* START */
+	case 0x10:                      /* repeated START */
+		xfer->m_count = 0;
+		if(_this->m_reading || (!write_len && xfer->m_rx_len)){
+			_this->m_reading = 1;
+			I2C_SET_DATA(_i2c, (uint8_t)((xfer->m_addr << 1) | 0x01));
+		}else{
+			I2C_SET_DATA(_i2c, (uint8_t)(xfer->m_addr << 1));
+		}
+		break;
+
+	case 0x18:                      /* SLA+W ACK */
+	case 0x28:                      /* data ACK */
+		if(xfer->m_count < write_len){
+			I2C_SET_DATA(_i2c, sm_i2c_write_byte(xfer, xfer->m_count));
+			xfer->m_count++;
+		}else if(xfer->m_rx_len){
+			_this->m_reading = 1;
+			ctrl = I2C_CTL_STA_SI;
+		}else{
+			sm_i2c_finish(_i2c, _this, SM_I2C_OK);
+			return;
+		}
+		break;
+
+	case 0x40:                      /* SLA+R ACK */
+		ctrl = xfer->m_rx_len > 1 ? I2C_CTL_SI_AA : I2C_CTL_SI;
+		break;
+
+	case 0x50:                      /* data received, ACK sent */
+		if(xfer->m_count < xfer->m_rx_len)
+			xfer->m_rx[xfer->m_count++] = (uint8_t)I2C_GET_DATA(_i2c);
+		ctrl = xfer->m_count + 1 < xfer->m_rx_len ? I2C_CTL_SI_AA : I2C_CTL_SI;
+		break;
+
+	case 0x58:                      /* last byte received, NACK sent */
+		if(xfer->m_count < xfer->m_rx_len)
+			xfer->m_rx[xfer->m_count++] = (uint8_t)I2C_GET_DATA(_i2c);
+		sm_i2c_finish(_i2c, _this, SM_I2C_OK);
+		return;
+
+	case 0x20:                      /* SLA+W NACK */
+	case 0x30:                      /* data NACK */
+	case 0x48:                      /* SLA+R NACK */
+		sm_i2c_finish(_i2c, _this, SM_I2C_ERR_NACK);
+		return;
+
+	case 0x38:                      /* arbitration lost */
+	case 0x00:                      /* bus error */
+	default:
+		sm_i2c_finish(_i2c, _this, SM_I2C_ERR_BUS);
+		return;
+	}
+
+	I2C_SET_CONTROL_REG(_i2c, ctrl);
+}
+
+/* Change SCL between transfers, not in the middle of a byte: from PRE on,
+ * submissions are queued without a START and the queue stops at the end of
+ * the transfer on the bus; POST starts it again at the new SCL */
+static void sm_i2c_clock(sm_clock_event_t _event, uint32_t _hclk, void* _arg){
+	sm_i2c_impl_t* this = _arg;
+	uint32_t primask;
+
+	(void)_hclk;
+	if(_event == SM_CLOCK_PRE){
+		primask = __get_PRIMASK();
+		__disable_irq();
+		this->m_held = 1;
+		__set_PRIMASK(primask);
+
+		for(uint32_t i = 0; i < SM_I2C_IDLE_SPIN && this->m_running; i++);
+		return;
+	}
+
+	this->m_bus_clock = I2C_SetBusClockFreq(this->m_instance, this->m_bus_target);
+	this->m_held = 0;
+	if(this->m_head && !this->m_running){
+		this->m_running = 1;
+		this->m_reading = 0;
+		sm_i2c_start(this->m_instance);
+	}
+}
+
+void I2C0_IRQHandler(void){
+	sm_i2c_isr(I2C0, g_i2c_list[0]);
+}
+
+void I2C1_IRQHandler(void){
+	sm_i2c_isr(I2C1, g_i2c_list[1]);
+}
+
+sm_i2c_t* sm_i2c_create(void* _instance, uint32_t _bus_clock, uint8_t _priority){
+	int8_t index = sm_i2c_index(_instance);
+	IRQn_Type irq = index == 0 ? I2C0_IRQn : I2C1_IRQn;
+
+	if(index < 0)
+		return NULL;
+
+	sm_i2c_impl_t* this = malloc(sizeof(sm_i2c_impl_t));
+
+	if(!this)
+		return NULL;
+
+	this->m_instance = _instance;
+	this->m_bus_clock = I2C_Open(_instance, _bus_clock);
+	this->m_bus_target = _bus_clock;
+	this->m_priority = _priority;
+	this->m_reading = 0;
+	this->m_running = 0;
+	this->m_held = 0;
+	this->m_head = NULL;
+	this->m_tail = NULL;
+	g_i2c_list[index] = this;
+	this->m_clock_id = (int8_t)sm_clock_register(sm_i2c_clock, this);
+
+	/* A slave holding SCL ends the transfer instead of the bus */
+	I2C_EnableTimeout(_instance, 1);
+	I2C_EnableInt(_instance);
+	NVIC_SetPriority(irq, _priority);
+	NVIC_EnableIRQ(irq);
+
+	return this;
+}
+
+int32_t sm_i2c_submit(sm_i2c_t* _this, sm_i2c_xfer_t* _xfer){
+	sm_i2c_impl_t* this = impl(_this);
+	uint32_t primask;
+
+	if(!this || !_xfer || _xfer->m_reg_len > 2 || (_xfer->m_tx_len && !_xfer->m_tx) ||
+			(_xfer->m_rx_len && !_xfer->m_rx))
+		return -1;
+
+	_xfer->m_status = SM_I2C_PENDING;
+	_xfer->m_count = 0;
+	_xfer->m_next = NULL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(this->m_tail){
+		this->m_tail->m_next = _xfer;
+		this->m_tail = _xfer;
+	}else{
+		this->m_head = _xfer;
+		this->m_tail = _xfer;
+		if(!this->m_held && !this->m_running){
+			this->m_running = 1;
+			this->m_reading = 0;
+			sm_i2c_start(this->m_instance);
+		}
+	}
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+void sm_i2c_xfer_read_reg(sm_i2c_xfer_t* _xfer, uint8_t _addr, uint16_t _reg, uint8_t _reg_len, uint8_t* _buf,
+		uint16_t _len){
+	_xfer->m_addr = _addr;
+	_xfer->m_flags = 0;
+	_xfer->m_reg = _reg;
+	_xfer->m_reg_len = _reg_len;
+	_xfer->m_tx = NULL;
+	_xfer->m_tx_len = 0;
+	_xfer->m_rx = _buf;
+	_xfer->m_rx_len = _len;
+}
+
+void sm_i2c_xfer_write_reg(sm_i2c_xfer_t* _xfer, uint8_t _addr, uint16_t _reg, uint8_t _reg_len, const uint8_t* _buf,
+		uint16_t _len){
+	_xfer->m_addr = _addr;
+	_xfer->m_flags = SM_I2C_FLAG_STOP;
+	_xfer->m_reg = _reg;
+	_xfer->m_reg_len = _reg_len;
+	_xfer->m_tx = _buf;
+	_xfer->m_tx_len = _len;
+	_xfer->m_rx = NULL;
+	_xfer->m_rx_len = 0;
+}
+
+uint8_t sm_i2c_is_busy(sm_i2c_t* _this){
+	sm_i2c_impl_t* this = impl(_this);
+
+	return this && this->m_head != NULL;
+}
+
+int32_t sm_i2c_wait(sm_i2c_xfer_t* _xfer){
+	if(!_xfer)
+		return -1;
+
+	while(_xfer->m_status == SM_I2C_PENDING);
+	return _xfer->m_status;
+}
+
+int32_t sm_i2c_destroy(sm_i2c_t* _this){
+	sm_i2c_impl_t* this = impl(_this);
+	int8_t index;
+
+	if(!this || this->m_head)
+		return -1;
+
+	index = sm_i2c_index(this->m_instance);
+	NVIC_DisableIRQ(index == 0 ? I2C0_IRQn : I2C1_IRQn);
+	I2C_DisableInt(this->m_instance);
+	I2C_Close(this->m_instance);
+	sm_clock_unregister(this->m_clock_id);
+	g_i2c_list[index] = NULL;
+	free(this);
+
+	return 0;
+}
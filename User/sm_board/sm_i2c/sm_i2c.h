@@ -0,0 +1,81 @@
+/*
+ * sm_i2c.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_I2C_SM_I2C_H_
+#define SM_BOARD_SM_I2C_SM_I2C_H_
+
+#include "stdint.h"
+#include "NuMicro.h"
+
+/*
+ * Interrupt driven I2C master. The status machine of I2C_ReadMultiBytes*()
+ * and friends in i2c.c runs from I2C0/I2C1_IRQHandler instead of spinning on
+ * SI: callers queue transfer descriptors and get a callback, from the
+ * interrupt, when each one is done.
+ *
+ * A transfer is an optional register address (0..2 bytes, MSB first), an
+ * optional write payload, then an optional read after a repeated START.
+ * Queued transfers follow each other with a repeated START, so a run of
+ * register reads goes out back to back without the main loop; set
+ * SM_I2C_FLAG_STOP on one that needs a real STOP after it (EEPROM writes).
+ *
+ * Descriptors belong to the caller and must stay alive until m_status is no
+ * longer SM_I2C_PENDING.
+ */
+
+#define SM_I2C_PENDING          1
+#define SM_I2C_OK               0
+#define SM_I2C_ERR_NACK         (-1)
+#define SM_I2C_ERR_BUS          (-2)    /* bus error or arbitration lost */
+#define SM_I2C_ERR_TIMEOUT      (-3)
+
+#define SM_I2C_FLAG_STOP        0x01
+
+typedef void sm_i2c_t;
+
+typedef struct sm_i2c_xfer sm_i2c_xfer_t;
+
+typedef void (*sm_i2c_done_fn_t)(sm_i2c_xfer_t* _xfer, void* _arg);
+
+struct sm_i2c_xfer{
+	uint8_t m_addr;             /* 7 bit */
+	uint8_t m_flags;
+	uint8_t m_reg_len;          /* 0, 1 or 2 */
+	uint16_t m_reg;
+	const uint8_t* m_tx;
+	uint16_t m_tx_len;
+	uint8_t* m_rx;
+	uint16_t m_rx_len;
+	sm_i2c_done_fn_t m_done;
+	void* m_arg;
+
+	/* Owned by the driver */
+	volatile int32_t m_status;
+	uint16_t m_count;
+	sm_i2c_xfer_t* m_next;
+};
+
+sm_i2c_t* sm_i2c_create(void* _instance, uint32_t _bus_clock, uint8_t _priority);
+
+/* Queue _xfer, start the bus if it is idle. Safe from interrupts and from
+ * the completion callbacks */
+int32_t sm_i2c_submit(sm_i2c_t* _this, sm_i2c_xfer_t* _xfer);
+
+/* Fill a register read / write descriptor */
+void sm_i2c_xfer_read_reg(sm_i2c_xfer_t* _xfer, uint8_t _addr, uint16_t _reg, uint8_t _reg_len, uint8_t* _buf,
+		uint16_t _len);
+void sm_i2c_xfer_write_reg(sm_i2c_xfer_t* _xfer, uint8_t _addr, uint16_t _reg, uint8_t _reg_len, const uint8_t* _buf,
+		uint16_t _len);
+
+uint8_t sm_i2c_is_busy(sm_i2c_t* _this);
+
+/* Spin until _xfer is done, for init code that has nothing else to do */
+int32_t sm_i2c_wait(sm_i2c_xfer_t* _xfer);
+
+int32_t sm_i2c_destroy(sm_i2c_t* _this);
+
+#endif /* SM_BOARD_SM_I2C_SM_I2C_H_ */
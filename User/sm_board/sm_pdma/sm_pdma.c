@@ -0,0 +1,376 @@
+/*
+ * sm_pdma.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_pdma.h"
+#include "sm_clock.h"
+#include "sm_fmt.h"
+
+#include <string.h>
+
+#define SM_PDMA_PAGE_MSK            0xFFFF0000UL
+
+typedef struct sm_pdma_ch{
+	uint8_t m_used;
+	uint32_t m_request;
+	sm_pdma_fn_t m_fn;
+	void* m_arg;
+	uint32_t m_start;
+	uint32_t m_timeout_us;          /* request timeout, set again on a clock change */
+	sm_pdma_stats_t m_stats;
+}sm_pdma_ch_t;
+
+typedef struct sm_pdma{
+	uint8_t m_init;
+	uint32_t (*m_clock)(void);
+	sm_pdma_ch_t m_ch[SM_PDMA_CH_NUM];
+}sm_pdma_t;
+
+static sm_pdma_t g_pdma;
+
+static uint8_t sm_pdma_valid(int32_t _ch){
+	return _ch >= 0 && _ch < SM_PDMA_CH_NUM && g_pdma.m_ch[_ch].m_used;
+}
+
+static void sm_pdma_set_request(uint8_t _ch, uint32_t _request){
+	volatile uint32_t* reg = _ch < 4 ? &PDMA->REQSEL0_3 : &PDMA->REQSEL4_7;
+	uint32_t shift = (_ch & 3) * 8;
+
+	*reg = (*reg & ~(PDMA_REQSEL0_3_REQSRC0_Msk << shift)) | (_request << shift);
+}
+
+/* Every list shares the SCATBA page, the first one to run picks it */
+static int32_t sm_pdma_check_page(uint32_t _addr){
+	if(!PDMA->SCATBA)
+		PDMA->SCATBA = _addr & SM_PDMA_PAGE_MSK;
+	return (_addr & SM_PDMA_PAGE_MSK) == PDMA->SCATBA ? 0 : -1;
+}
+
+static void sm_pdma_begin(uint8_t _ch){
+	sm_pdma_ch_t* ch = &g_pdma.m_ch[_ch];
+
+	ch->m_stats.m_starts++;
+	ch->m_start = g_pdma.m_clock ? g_pdma.m_clock() : 0;
+}
+
+static void sm_pdma_end(sm_pdma_ch_t* _ch){
+	uint32_t time;
+
+	_ch->m_stats.m_done++;
+	if(!g_pdma.m_clock)
+		return;
+
+	time = g_pdma.m_clock() - _ch->m_start;
+	_ch->m_stats.m_last = time;
+	_ch->m_stats.m_busy += time;
+	if(time > _ch->m_stats.m_max)
+		_ch->m_stats.m_max = time;
+}
+
+void PDMA_IRQHandler(void){
+	uint32_t intsts = PDMA_GET_INT_STATUS(PDMA);
+	uint32_t tdsts = PDMA_GET_TD_STS(PDMA);
+	uint32_t abtsts = PDMA_GET_ABORT_STS(PDMA);
+
+	PDMA_CLR_TD_FLAG(PDMA, tdsts);
+	if(intsts & PDMA_INTSTS_ABTIF_Msk)
+		PDMA_CLR_ABORT_FLAG(PDMA, abtsts);
+
+	for(uint8_t i = 0; i < SM_PDMA_CH_NUM; i++){
+		sm_pdma_ch_t* ch = &g_pdma.m_ch[i];
+		uint32_t bit = 1UL << i;
+		uint32_t events = 0;
+
+		if(tdsts & bit){
+			/* The controller leaves OPMODE idle after the last table only */
+			if((PDMA->DSCT[i].CTL & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_STOP){
+				events |= SM_PDMA_EVT_DONE;
+				sm_pdma_end(ch);
+			}else{
+				events |= SM_PDMA_EVT_TABLE;
+				ch->m_stats.m_tables++;
+			}
+		}
+
+		if(i < SM_PDMA_TIMEOUT_CH_NUM && (intsts & (PDMA_INTSTS_REQTOF0_Msk << i))){
+			PDMA_CLR_TMOUT_FLAG(PDMA, i);
+			events |= SM_PDMA_EVT_TIMEOUT;
+			ch->m_stats.m_timeouts++;
+		}
+
+		if((intsts & PDMA_INTSTS_ABTIF_Msk) && (abtsts & bit)){
+			/* An abort leaves the channel off, it takes a new start */
+			events |= SM_PDMA_EVT_ABORT;
+			ch->m_stats.m_aborts++;
+		}
+
+		if(events && ch->m_used && ch->m_fn)
+			ch->m_fn(i, events, ch->m_arg);
+	}
+}
+
+/* Count and prescaler for _us at the current HCLK. TOUTEN is left as it is */
+static void sm_pdma_write_timeout(int32_t _ch, uint32_t _us){
+	uint32_t toc;
+	uint32_t psc = 0;
+	uint32_t shift;
+
+	toc = (uint32_t)(((uint64_t)_us * (SystemCoreClock / 1000000)) >> 8);
+	while(toc > 0xFFFF && psc < 7){
+		toc >>= 1;
+		psc++;
+	}
+	if(toc > 0xFFFF)
+		toc = 0xFFFF;
+	if(!toc)
+		toc = 1;
+
+	shift = (uint32_t)_ch * PDMA_TOUTPSC_TOUTPSC1_Pos;
+	PDMA->TOUTPSC = (PDMA->TOUTPSC & ~(PDMA_TOUTPSC_TOUTPSC0_Msk << shift)) | (psc << shift);
+	if(_ch == 0)
+		PDMA->TOC0_1 = (PDMA->TOC0_1 & ~PDMA_TOC0_1_TOC0_Msk) | toc;
+	else
+		PDMA->TOC0_1 = (PDMA->TOC0_1 & ~PDMA_TOC0_1_TOC1_Msk) | (toc << PDMA_TOC0_1_TOC1_Pos);
+}
+
+/* A count in HCLK units means another time at the new clock */
+static void sm_pdma_clock(sm_clock_event_t _event, uint32_t _hclk, void* _arg){
+	(void)_hclk;
+	(void)_arg;
+	if(_event != SM_CLOCK_POST)
+		return;
+
+	for(int32_t ch = 0; ch < SM_PDMA_TIMEOUT_CH_NUM; ch++){
+		if(g_pdma.m_ch[ch].m_used && g_pdma.m_ch[ch].m_timeout_us)
+			sm_pdma_write_timeout(ch, g_pdma.m_ch[ch].m_timeout_us);
+	}
+}
+
+int32_t sm_pdma_init(uint8_t _priority){
+	if(g_pdma.m_init)
+		return 0;
+
+	CLK_EnableModuleClock(PDMA_MODULE);
+	sm_clock_register(sm_pdma_clock, NULL);
+
+	NVIC_SetPriority(PDMA_IRQn, _priority);
+	NVIC_EnableIRQ(PDMA_IRQn);
+	g_pdma.m_init = 1;
+
+	return 0;
+}
+
+void sm_pdma_set_clock(uint32_t (*_clock)(void)){
+	g_pdma.m_clock = _clock;
+}
+
+int32_t sm_pdma_alloc(uint32_t _request, uint8_t _caps, sm_pdma_fn_t _fn, void* _arg){
+	uint32_t primask;
+	int32_t found = -1;
+
+	if(!g_pdma.m_init)
+		return -1;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(_caps & SM_PDMA_CAP_TIMEOUT){
+		for(int32_t i = 0; i < SM_PDMA_TIMEOUT_CH_NUM && found < 0; i++){
+			if(!g_pdma.m_ch[i].m_used)
+				found = i;
+		}
+	}else{
+		for(int32_t i = SM_PDMA_CH_NUM - 1; i >= 0 && found < 0; i--){
+			if(!g_pdma.m_ch[i].m_used)
+				found = i;
+		}
+	}
+	if(found >= 0){
+		memset(&g_pdma.m_ch[found], 0, sizeof(sm_pdma_ch_t));
+		g_pdma.m_ch[found].m_used = 1;
+		g_pdma.m_ch[found].m_request = _request;
+		g_pdma.m_ch[found].m_fn = _fn;
+		g_pdma.m_ch[found].m_arg = _arg;
+	}
+	__set_PRIMASK(primask);
+
+	if(found < 0)
+		return -1;
+
+	PDMA->DSCT[found].CTL = PDMA_OP_STOP;
+	sm_pdma_set_request((uint8_t)found, _request);
+	PDMA->CHCTL |= 1UL << found;
+	PDMA->INTEN |= 1UL << found;
+
+	return found;
+}
+
+int32_t sm_pdma_free(int32_t _ch){
+	if(!sm_pdma_valid(_ch))
+		return -1;
+
+	sm_pdma_stop(_ch);
+	if(_ch < SM_PDMA_TIMEOUT_CH_NUM){
+		sm_pdma_enable_timeout(_ch, 0);
+		PDMA->TOUTIEN &= ~(1UL << _ch);
+	}
+	PDMA->INTEN &= ~(1UL << _ch);
+	PDMA->CHCTL &= ~(1UL << _ch);
+	g_pdma.m_ch[_ch].m_used = 0;
+
+	return 0;
+}
+
+void sm_pdma_list_init(sm_pdma_list_t* _list, sm_pdma_desc_t* _desc, uint8_t _max){
+	_list->m_desc = _desc;
+	_list->m_max = _max;
+	_list->m_num = 0;
+}
+
+/* The new table ends the list; the one before it now links to it */
+int32_t sm_pdma_list_add(sm_pdma_list_t* _list, uint32_t _src, uint32_t _dst, uint32_t _count, uint32_t _flags,
+		uint8_t _notify){
+	sm_pdma_desc_t* desc;
+
+	if(!_list || _list->m_num >= _list->m_max || !_count ||
+			_count > (PDMA_DSCT_CTL_TXCNT_Msk >> PDMA_DSCT_CTL_TXCNT_Pos) + 1)
+		return -1;
+
+	desc = &_list->m_desc[_list->m_num];
+	desc->m_ctl = ((_count - 1) << PDMA_DSCT_CTL_TXCNT_Pos) |
+			(_flags & ~(PDMA_DSCT_CTL_OPMODE_Msk | PDMA_DSCT_CTL_TBINTDIS_Msk | PDMA_DSCT_CTL_TXCNT_Msk)) |
+			(_notify ? PDMA_TBINTDIS_ENABLE : PDMA_TBINTDIS_DISABLE) | PDMA_OP_BASIC;
+	desc->m_src = _src;
+	desc->m_dst = _dst;
+	desc->m_next = 0;
+
+	if(_list->m_num){
+		sm_pdma_desc_t* prev = &_list->m_desc[_list->m_num - 1];
+
+		prev->m_ctl = (prev->m_ctl & ~PDMA_DSCT_CTL_OPMODE_Msk) | PDMA_OP_SCATTER;
+		prev->m_next = (uint32_t)desc & ~SM_PDMA_PAGE_MSK;
+	}
+	_list->m_num++;
+
+	return _list->m_num - 1;
+}
+
+int32_t sm_pdma_list_loop(sm_pdma_list_t* _list){
+	sm_pdma_desc_t* last;
+
+	if(!_list || !_list->m_num)
+		return -1;
+
+	last = &_list->m_desc[_list->m_num - 1];
+	last->m_ctl = (last->m_ctl & ~PDMA_DSCT_CTL_OPMODE_Msk) | PDMA_OP_SCATTER;
+	last->m_next = (uint32_t)&_list->m_desc[0] & ~SM_PDMA_PAGE_MSK;
+
+	return 0;
+}
+
+int32_t sm_pdma_start(int32_t _ch, const sm_pdma_list_t* _list){
+	uint32_t first;
+
+	if(!sm_pdma_valid(_ch) || !_list || !_list->m_num || sm_pdma_is_busy(_ch))
+		return -1;
+
+	first = (uint32_t)&_list->m_desc[0];
+	if(sm_pdma_check_page(first) < 0)
+		return -1;
+
+	sm_pdma_begin((uint8_t)_ch);
+	/* In scatter-gather mode DSCT only links to the first table */
+	PDMA->DSCT[_ch].NEXT = first & ~SM_PDMA_PAGE_MSK;
+	PDMA->DSCT[_ch].CTL = PDMA_OP_SCATTER;
+	if(g_pdma.m_ch[_ch].m_request == PDMA_MEM)
+		PDMA->SWREQ = 1UL << _ch;
+
+	return 0;
+}
+
+int32_t sm_pdma_start_basic(int32_t _ch, uint32_t _src, uint32_t _dst, uint32_t _count, uint32_t _flags){
+	if(!sm_pdma_valid(_ch) || !_count || _count > (PDMA_DSCT_CTL_TXCNT_Msk >> PDMA_DSCT_CTL_TXCNT_Pos) + 1 ||
+			sm_pdma_is_busy(_ch))
+		return -1;
+
+	sm_pdma_begin((uint8_t)_ch);
+	PDMA->DSCT[_ch].SA = _src;
+	PDMA->DSCT[_ch].DA = _dst;
+	PDMA->DSCT[_ch].CTL = ((_count - 1) << PDMA_DSCT_CTL_TXCNT_Pos) |
+			(_flags & ~(PDMA_DSCT_CTL_OPMODE_Msk | PDMA_DSCT_CTL_TXCNT_Msk)) | PDMA_OP_BASIC;
+	if(g_pdma.m_ch[_ch].m_request == PDMA_MEM)
+		PDMA->SWREQ = 1UL << _ch;
+
+	return 0;
+}
+
+int32_t sm_pdma_stop(int32_t _ch){
+	if(!sm_pdma_valid(_ch))
+		return -1;
+
+	PDMA->CHRST = 1UL << _ch;
+	PDMA->DSCT[_ch].CTL = PDMA_OP_STOP;
+	PDMA_CLR_TD_FLAG(PDMA, 1UL << _ch);
+	PDMA->CHCTL |= 1UL << _ch;
+
+	return 0;
+}
+
+uint8_t sm_pdma_is_busy(int32_t _ch){
+	if(!sm_pdma_valid(_ch))
+		return 0;
+	return (PDMA->DSCT[_ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk) != PDMA_OP_STOP;
+}
+
+/* The timeout clock is HCLK / 2^(8 + prescaler) into a 16 bit count */
+int32_t sm_pdma_set_timeout(int32_t _ch, uint32_t _us){
+	if(!sm_pdma_valid(_ch) || _ch >= SM_PDMA_TIMEOUT_CH_NUM)
+		return -1;
+
+	g_pdma.m_ch[_ch].m_timeout_us = _us;
+	sm_pdma_write_timeout(_ch, _us);
+	PDMA->TOUTEN &= ~(1UL << _ch);
+	PDMA_CLR_TMOUT_FLAG(PDMA, _ch);
+	PDMA_EnableInt(PDMA, (uint32_t)_ch, PDMA_INT_TIMEOUT);
+
+	return 0;
+}
+
+void sm_pdma_enable_timeout(int32_t _ch, uint8_t _on){
+	if(_ch < 0 || _ch >= SM_PDMA_TIMEOUT_CH_NUM)
+		return;
+
+	if(_on)
+		PDMA->TOUTEN |= 1UL << _ch;
+	else
+		PDMA->TOUTEN &= ~(1UL << _ch);
+}
+
+const sm_pdma_stats_t* sm_pdma_get_stats(int32_t _ch){
+	if(_ch < 0 || _ch >= SM_PDMA_CH_NUM)
+		return NULL;
+	return &g_pdma.m_ch[_ch].m_stats;
+}
+
+int32_t sm_pdma_dump(sm_fmt_write_fn_t _write, void* _arg){
+	if(!_write)
+		return -1;
+
+	sm_fmt_print(_write, _arg, "pdma: ch req  starts    done  tables tmo abt     last      max\r\n");
+
+	for(uint8_t i = 0; i < SM_PDMA_CH_NUM; i++){
+		const sm_pdma_ch_t* ch = &g_pdma.m_ch[i];
+
+		if(!ch->m_used)
+			continue;
+
+		sm_fmt_print(_write, _arg, "      %2u %3lu %7lu %7lu %7lu %3lu %3lu %8lu %8lu\r\n", i,
+				(unsigned long)ch->m_request, (unsigned long)ch->m_stats.m_starts, (unsigned long)ch->m_stats.m_done,
+				(unsigned long)ch->m_stats.m_tables, (unsigned long)ch->m_stats.m_timeouts,
+				(unsigned long)ch->m_stats.m_aborts, (unsigned long)ch->m_stats.m_last,
+				(unsigned long)ch->m_stats.m_max);
+	}
+	return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * sm_pdma.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_PDMA_SM_PDMA_H_
+#define SM_BOARD_SM_PDMA_SM_PDMA_H_
+
+#include "stdint.h"
+#include "sm_fmt.h"
+#include "NuMicro.h"
+
+/*
+ * PDMA channel manager. Drivers ask for a channel by request source instead
+ * of hard-coding one, build scatter-gather lists with the list helpers and
+ * get their events from the one PDMA_IRQHandler. Only channels 0 and 1 have
+ * the request timeout: ask for SM_PDMA_CAP_TIMEOUT to get one of them, other
+ * requests are served from channel 4 down so they stay free.
+ *
+ * Tables are the ones the controller fetches, so they must stay in SRAM
+ * while the channel runs; all lists share the 64K page of PDMA_SCATBA.
+ *
+ * With a clock set (sm_pdma_set_clock(sm_prof_cycles) for instance) every
+ * transfer is timed from start to done.
+ */
+
+#define SM_PDMA_CH_NUM              5
+#define SM_PDMA_TIMEOUT_CH_NUM      2
+
+#define SM_PDMA_CAP_TIMEOUT         0x01
+
+/* Events passed to the channel callback */
+#define SM_PDMA_EVT_TABLE           0x01    /* a table asking for it finished, the list goes on */
+#define SM_PDMA_EVT_DONE            0x02    /* the last table finished, channel idle */
+#define SM_PDMA_EVT_TIMEOUT         0x04
+#define SM_PDMA_EVT_ABORT           0x08
+
+typedef void (*sm_pdma_fn_t)(int32_t _ch, uint32_t _events, void* _arg);
+
+/* One scatter-gather table, as the controller fetches it */
+typedef struct sm_pdma_desc{
+	uint32_t m_ctl;
+	uint32_t m_src;
+	uint32_t m_dst;
+	uint32_t m_next;            /* offset in the PDMA_SCATBA page */
+}sm_pdma_desc_t;
+
+typedef struct sm_pdma_list{
+	sm_pdma_desc_t* m_desc;
+	uint8_t m_max;
+	uint8_t m_num;
+}sm_pdma_list_t;
+
+typedef struct sm_pdma_stats{
+	uint32_t m_starts;
+	uint32_t m_done;
+	uint32_t m_tables;
+	uint32_t m_timeouts;
+	uint32_t m_aborts;
+	uint32_t m_last;            /* start to done, in clock ticks */
+	uint32_t m_max;
+	uint64_t m_busy;            /* sum of start to done */
+}sm_pdma_stats_t;
+
+/* Clock and interrupt. Later calls keep the first priority */
+int32_t sm_pdma_init(uint8_t _priority);
+
+void sm_pdma_set_clock(uint32_t (*_clock)(void));
+
+/* Return the channel, -1 when none with _caps is free */
+int32_t sm_pdma_alloc(uint32_t _request, uint8_t _caps, sm_pdma_fn_t _fn, void* _arg);
+int32_t sm_pdma_free(int32_t _ch);
+
+/*
+ * Lists. _flags are the DSCT_CTL transfer bits of pdma.h (PDMA_WIDTH_*,
+ * PDMA_SAR_* / PDMA_DAR_*, PDMA_REQ_*, PDMA_BURST_*); _count is in transfers
+ * of that width. A table with _notify raises SM_PDMA_EVT_TABLE when it ends.
+ */
+void sm_pdma_list_init(sm_pdma_list_t* _list, sm_pdma_desc_t* _desc, uint8_t _max);
+int32_t sm_pdma_list_add(sm_pdma_list_t* _list, uint32_t _src, uint32_t _dst, uint32_t _count, uint32_t _flags,
+		uint8_t _notify);
+/* Link the last table back to the first: the channel never stops */
+int32_t sm_pdma_list_loop(sm_pdma_list_t* _list);
+
+int32_t sm_pdma_start(int32_t _ch, const sm_pdma_list_t* _list);
+int32_t sm_pdma_start_basic(int32_t _ch, uint32_t _src, uint32_t _dst, uint32_t _count, uint32_t _flags);
+int32_t sm_pdma_stop(int32_t _ch);
+uint8_t sm_pdma_is_busy(int32_t _ch);
+
+/* Request timeout of channel 0 or 1: set it, then turn it on and off */
+int32_t sm_pdma_set_timeout(int32_t _ch, uint32_t _us);
+void sm_pdma_enable_timeout(int32_t _ch, uint8_t _on);
+
+const sm_pdma_stats_t* sm_pdma_get_stats(int32_t _ch);
+
+int32_t sm_pdma_dump(sm_fmt_write_fn_t _write, void* _arg);
+
+#endif /* SM_BOARD_SM_PDMA_SM_PDMA_H_ */
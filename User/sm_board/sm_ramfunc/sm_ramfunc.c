@@ -0,0 +1,41 @@
+/*
+ * sm_ramfunc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_ramfunc.h"
+#include "NuMicro.h"
+
+#define SM_RAMFUNC_VECTOR_NUM     (16 + 64)
+
+extern uint32_t __Vectors_Size[];
+
+/* VTOR wants the table aligned to its size rounded up to a power of two;
+ * gcc_arm_common.ld puts .ram_vectors first in SRAM so this costs no padding */
+static uint32_t g_ram_vectors[SM_RAMFUNC_VECTOR_NUM] __attribute__((section(".ram_vectors"), aligned(512)));
+
+int32_t sm_ramfunc_vectors_init(void){
+	const uint32_t* table = (const uint32_t*)SCB->VTOR;
+	uint32_t num = (uint32_t)__Vectors_Size / 4;
+	uint32_t primask = __get_PRIMASK();
+
+	if(num > SM_RAMFUNC_VECTOR_NUM)
+		return -1;
+
+	if(table == g_ram_vectors)
+		return 0;
+
+	__disable_irq();
+
+	for(uint32_t i = 0; i < num; i++)
+		g_ram_vectors[i] = table[i];
+
+	SCB->VTOR = (uint32_t)g_ram_vectors;
+	__DSB();
+	__ISB();
+
+	__set_PRIMASK(primask);
+	return 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * sm_ramfunc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_RAMFUNC_SM_RAMFUNC_H_
+#define SM_BOARD_SM_RAMFUNC_SM_RAMFUNC_H_
+
+#include "stdint.h"
+
+/*
+ * Code run from SRAM: no flash wait states, and it keeps running while the
+ * FMC erases or programs APROM. gcc_arm_common.ld links .ramfunc into SRAM
+ * and the startup copy table loads it. SRAM is out of BL range from flash,
+ * so the calls go through a register (long_call).
+ *
+ * An interrupt taken while the FMC is busy still stalls on its vector fetch
+ * until sm_ramfunc_vectors_init() has moved the table to SRAM.
+ */
+#if defined(__arm__)
+#define SM_RAMFUNC          __attribute__((section(".ramfunc"), noinline, long_call))
+#else
+#define SM_RAMFUNC
+#endif
+
+/* Copy the active vector table to SRAM and point VTOR at it */
+int32_t sm_ramfunc_vectors_init(void);
+
+#endif /* SM_BOARD_SM_RAMFUNC_SM_RAMFUNC_H_ */
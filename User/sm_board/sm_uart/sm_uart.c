@@ -6,22 +6,221 @@
  */
 
 #include "sm_uart.h"
+#include "sm_ramfunc.h"
+#include "sm_pdma.h"
+#include "sm_clock.h"
+#include "sm_defer.h"
 
 #include <stdlib.h>
 
+#define SM_UART_NUM    5
+
+#define SM_UART_DMA_NONE          0xFF
+
+/* Bounded wait for the TX FIFO to drain before a clock change */
+#define SM_UART_DRAIN_SPIN        100000
+
 typedef struct sm_uart_impl{
 	void* m_instance;
 	uint16_t m_fifo_size;
 	uint8_t* m_fifo;
-	uint16_t m_fifo_head;
-	uint16_t m_fifo_tail;
-	uint16_t m_baudrate;
+	volatile uint16_t m_fifo_head;     /* written by the RX interrupt only */
+	volatile uint16_t m_fifo_tail;
+	uint32_t m_baudrate;
 	uint8_t m_priority;
+	int8_t m_clock_id;
+
+	/* PDMA receive */
+	uint8_t m_dma_ch;
+	volatile uint8_t m_dma_table;      /* table PDMA is filling, as far as the interrupts know */
+	uint16_t m_dma_idle_head;          /* head at the last idle report */
+	sm_uart_idle_fn_t m_idle;
+	void* m_idle_arg;
+	int8_t m_idle_defer;               /* sm_defer level of the idle callback, -1 in the interrupt */
+	sm_pdma_desc_t m_dma_desc[2];
 }sm_uart_impl_t;
 
 #define impl(x) ((sm_uart_impl_t*)(x))
 
-sm_uart_t* sm_uart_create(void* _instance, uint16_t _baudrate, uint16_t _fifo_size){
+uart_t uart_debug = {.m_instance = UART0, .m_fifo_size = 64, .m_baudrate = 9600};
+
+uart_t uart_rs485_1 = {.m_instance = UART1, .m_fifo_size = 256, .m_baudrate = 9600};
+
+uart_t uart_rs485_2 = {.m_instance = UART2, .m_fifo_size = 256, .m_baudrate = 9600};
+
+static sm_uart_impl_t* g_uart_list[SM_UART_NUM];
+
+static const IRQn_Type g_uart_irqn[SM_UART_NUM] = {UART0_IRQn, UART1_IRQn, UART2_IRQn, UART3_IRQn, UART4_IRQn};
+
+static int8_t sm_uart_index(void* _instance){
+	if(_instance == UART0)
+		return 0;
+	if(_instance == UART1)
+		return 1;
+	if(_instance == UART2)
+		return 2;
+	if(_instance == UART3)
+		return 3;
+	if(_instance == UART4)
+		return 4;
+	return -1;
+}
+
+/*
+ * Where PDMA writes next. CURSCAT names the table the controller holds and
+ * TXCNT what is left of it; the transfer done flag, pending or already seen by
+ * the interrupt, tells a table still being filled from one just finished.
+ * Call with interrupts off.
+ */
+static uint16_t sm_uart_dma_head(sm_uart_impl_t* _this){
+	uint8_t ch = _this->m_dma_ch;
+	uint16_t half = (uint16_t)(_this->m_fifo_size / 2);
+	uint32_t cur = PDMA->CURSCAT[ch];
+	uint8_t done = (PDMA->TDSTS >> ch) & 1;
+	uint8_t table;
+	uint32_t left;
+
+	if(cur == (uint32_t)&_this->m_dma_desc[0])
+		table = 0;
+	else if(cur == (uint32_t)&_this->m_dma_desc[1])
+		table = 1;
+	else
+		return 0;                      /* the first table is not even fetched */
+
+	/* Same table and no flag, or the next one with the flag still up: filling */
+	if((table == _this->m_dma_table) != done){
+		left = ((PDMA->DSCT[ch].CTL & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1;
+		return (uint16_t)(table * half + half - left);
+	}
+	return table ? 0 : half;
+}
+
+/* Line quiet: timeout off, wake on the next byte. A byte that slipped in
+ * before the RX interrupt was back on would not raise it, look once more */
+static void sm_uart_dma_sleep(UART_T* _uart, sm_uart_impl_t* _this, uint16_t _head){
+	sm_pdma_enable_timeout(_this->m_dma_ch, 0);
+	UART_ENABLE_INT(_uart, UART_INTEN_RDAIEN_Msk);
+
+	if(sm_uart_dma_head(_this) != _head){
+		UART_DISABLE_INT(_uart, UART_INTEN_RDAIEN_Msk);
+		sm_pdma_enable_timeout(_this->m_dma_ch, 1);
+	}
+}
+
+static void sm_uart_idle_bottom(void* _arg, uint32_t _len){
+	sm_uart_impl_t* this = _arg;
+
+	this->m_idle(this, (uint16_t)_len, this->m_idle_arg);
+}
+
+static void sm_uart_dma_event(int32_t _ch, uint32_t _events, void* _arg){
+	sm_uart_impl_t* this = _arg;
+	uint16_t head;
+	uint16_t len;
+
+	(void)_ch;
+	/* The manager took the done flag down, the next table is the one filling */
+	if(_events & SM_PDMA_EVT_TABLE)
+		this->m_dma_table ^= 1;
+
+	if(!(_events & SM_PDMA_EVT_TIMEOUT))
+		return;
+
+	head = sm_uart_dma_head(this);
+	sm_uart_dma_sleep(this->m_instance, this, head);
+
+	if(head == this->m_dma_idle_head)
+		return;
+	this->m_dma_idle_head = head;
+
+	len = (uint16_t)(head >= this->m_fifo_tail ? head - this->m_fifo_tail :
+			this->m_fifo_size - this->m_fifo_tail + head);
+	if(!this->m_idle)
+		return;
+
+	/* A full queue must not lose the end of a frame: run it here then */
+	if(this->m_idle_defer < 0 ||
+			sm_defer_post((sm_defer_prio_t)this->m_idle_defer, sm_uart_idle_bottom, this, len) < 0)
+		this->m_idle(this, len, this->m_idle_arg);
+}
+
+/* Drain the RX FIFO into the ring buffer; when it is full the byte is lost.
+ * Runs from SRAM with the handlers below, it is the hottest path we have.
+ * Under PDMA it is only the wake-up: the first byte of a burst arms the
+ * timeout that will report its end, straight on the register to stay in SRAM */
+SM_RAMFUNC static void sm_uart_rx_isr(UART_T* _uart, sm_uart_impl_t* _this){
+	if(_this && _this->m_dma_ch != SM_UART_DMA_NONE){
+		UART_DISABLE_INT(_uart, UART_INTEN_RDAIEN_Msk);
+		PDMA->TOUTEN |= 1UL << _this->m_dma_ch;
+		return;
+	}
+
+	while(!UART_GET_RX_EMPTY(_uart)){
+		uint8_t byte = (uint8_t)UART_READ(_uart);
+
+		if(!_this || !_this->m_fifo_size)
+			continue;
+
+		uint16_t head = _this->m_fifo_head;
+		uint16_t next = (uint16_t)(head + 1);
+
+		if(next == _this->m_fifo_size)
+			next = 0;
+		if(next == _this->m_fifo_tail)
+			continue;
+
+		_this->m_fifo[head] = byte;
+		_this->m_fifo_head = next;
+	}
+}
+
+SM_RAMFUNC void UART0_IRQHandler(void){
+	sm_uart_rx_isr(UART0, g_uart_list[0]);
+}
+
+SM_RAMFUNC void UART1_IRQHandler(void){
+	sm_uart_rx_isr(UART1, g_uart_list[1]);
+}
+
+SM_RAMFUNC void UART2_IRQHandler(void){
+	sm_uart_rx_isr(UART2, g_uart_list[2]);
+}
+
+SM_RAMFUNC void UART3_IRQHandler(void){
+	sm_uart_rx_isr(UART3, g_uart_list[3]);
+}
+
+SM_RAMFUNC void UART4_IRQHandler(void){
+	sm_uart_rx_isr(UART4, g_uart_list[4]);
+}
+
+/* The baud divisor of a PCLK clocked UART is for the old HCLK. UART_Open sets
+ * the line and the FIFO levels back to its defaults as well, keep ours */
+static void sm_uart_clock(sm_clock_event_t _event, uint32_t _hclk, void* _arg){
+	sm_uart_impl_t* this = _arg;
+	UART_T* uart = this->m_instance;
+	uint32_t line;
+	uint32_t fifo;
+
+	(void)_hclk;
+	if(_event == SM_CLOCK_PRE){
+		for(uint32_t i = 0; i < SM_UART_DRAIN_SPIN && !UART_IS_TX_EMPTY(uart); i++);
+		return;
+	}
+
+	line = uart->LINE;
+	fifo = uart->FIFO & (UART_FIFO_RFITL_Msk | UART_FIFO_RTSTRGLV_Msk);
+	UART_Open(uart, this->m_baudrate);
+	uart->LINE = line;
+	uart->FIFO = (uart->FIFO & ~(UART_FIFO_RFITL_Msk | UART_FIFO_RTSTRGLV_Msk)) | fifo;
+}
+
+sm_uart_t* sm_uart_create(void* _instance, uint32_t _baudrate, uint16_t _fifo_size){
+	int8_t index = sm_uart_index(_instance);
+
+	if(index < 0)
+		return NULL;
+
 	sm_uart_impl_t* this = malloc(sizeof(sm_uart_impl_t));
 
 	if(!this)
@@ -37,8 +236,18 @@ sm_uart_t* sm_uart_create(void* _instance, uint16_t _baudrate, uint16_t _fifo_si
 	this->m_instance = _instance;
 	this->m_baudrate = _baudrate;
 	this->m_fifo_size = _fifo_size;
+	this->m_fifo_head = 0;
+	this->m_fifo_tail = 0;
+	this->m_dma_ch = SM_UART_DMA_NONE;
+	this->m_dma_table = 0;
+	this->m_dma_idle_head = 0;
+	this->m_idle = NULL;
+	this->m_idle_arg = NULL;
+	this->m_idle_defer = -1;
 
 	UART_Open(_instance, _baudrate);
+	this->m_clock_id = (int8_t)sm_clock_register(sm_uart_clock, this);
+	g_uart_list[index] = this;
 
 	return this;
 }
@@ -106,6 +315,145 @@ int32_t sm_uart_disable_interrupt(sm_uart_t* _this, uint8_t _priority){
 
 }
 
+int32_t sm_uart_enable_dma_rx(sm_uart_t* _this, uint32_t _idle_us, uint8_t _priority, sm_uart_idle_fn_t _idle,
+		void* _arg){
+	sm_uart_impl_t* this = impl(_this);
+	UART_T* uart;
+	int8_t index;
+	int32_t ch;
+	uint16_t half;
+	sm_pdma_list_t list;
+
+	if(!this || this->m_dma_ch != SM_UART_DMA_NONE || !this->m_fifo_size || (this->m_fifo_size & 1))
+		return -1;
+
+	uart = this->m_instance;
+	index = sm_uart_index(uart);
+	half = (uint16_t)(this->m_fifo_size / 2);
+
+	sm_pdma_init(_priority);
+	ch = sm_pdma_alloc(PDMA_UART0_RX + (uint32_t)index * 2, SM_PDMA_CAP_TIMEOUT, sm_uart_dma_event, this);
+	if(ch < 0)
+		return -1;
+
+	NVIC_DisableIRQ(g_uart_irqn[index]);
+	UART_DISABLE_INT(uart, UART_INTEN_RDAIEN_Msk);
+
+	this->m_dma_table = 0;
+	this->m_dma_idle_head = 0;
+	this->m_fifo_head = 0;
+	this->m_fifo_tail = 0;
+	this->m_idle = _idle;
+	this->m_idle_arg = _arg;
+
+	/* Two halves that link to each other: PDMA never stops */
+	sm_pdma_list_init(&list, this->m_dma_desc, 2);
+	for(uint8_t i = 0; i < 2; i++){
+		sm_pdma_list_add(&list, (uint32_t)&uart->DAT, (uint32_t)&this->m_fifo[i * half], half,
+				PDMA_WIDTH_8 | PDMA_SAR_FIX | PDMA_DAR_INC | PDMA_REQ_SINGLE | PDMA_BURST_1, 1);
+	}
+	sm_pdma_list_loop(&list);
+
+	if(sm_pdma_set_timeout(ch, _idle_us) < 0 || sm_pdma_start(ch, &list) < 0){
+		sm_pdma_free(ch);
+		NVIC_EnableIRQ(g_uart_irqn[index]);
+		return -1;
+	}
+	this->m_dma_ch = (uint8_t)ch;
+
+	UART_PDMA_ENABLE(uart, UART_INTEN_RXPDMAEN_Msk);
+	UART_ENABLE_INT(uart, UART_INTEN_RDAIEN_Msk);
+	NVIC_SetPriority(g_uart_irqn[index], _priority);
+	NVIC_EnableIRQ(g_uart_irqn[index]);
+
+	return 0;
+}
+
+int32_t sm_uart_defer_idle(sm_uart_t* _this, int8_t _prio){
+	sm_uart_impl_t* this = impl(_this);
+
+	if(!this || _prio >= SM_DEFER_PRIO_NUM)
+		return -1;
+
+	this->m_idle_defer = _prio < 0 ? -1 : _prio;
+	return 0;
+}
+
+static uint16_t sm_uart_head(sm_uart_impl_t* _this){
+	uint32_t primask;
+	uint16_t head;
+
+	if(_this->m_dma_ch == SM_UART_DMA_NONE)
+		return _this->m_fifo_head;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	head = sm_uart_dma_head(_this);
+	__set_PRIMASK(primask);
+
+	return head;
+}
+
+int32_t sm_uart_available(sm_uart_t* _this){
+	sm_uart_impl_t* this = impl(_this);
+	uint16_t head;
+	uint16_t tail;
+
+	if(!this)
+		return -1;
+
+	head = sm_uart_head(this);
+	tail = this->m_fifo_tail;
+
+	return head >= tail ? head - tail : this->m_fifo_size - tail + head;
+}
+
+int32_t sm_uart_read(sm_uart_t* _this, uint8_t* _buf, uint16_t _len){
+	sm_uart_impl_t* this = impl(_this);
+	uint16_t n = 0;
+
+	if(!this || !_buf)
+		return -1;
+
+	uint16_t head = sm_uart_head(this);
+	uint16_t tail = this->m_fifo_tail;
+
+	while(n < _len && tail != head){
+		_buf[n++] = this->m_fifo[tail];
+		if(++tail == this->m_fifo_size)
+			tail = 0;
+	}
+	this->m_fifo_tail = tail;
+
+	return n;
+}
+
+int32_t sm_uart_write(sm_uart_t* _this, const uint8_t* _buf, uint16_t _len){
+	sm_uart_impl_t* this = impl(_this);
+	UART_T* uart;
+
+	if(!this || !_buf)
+		return -1;
+
+	uart = this->m_instance;
+	for(uint16_t i = 0; i < _len; i++){
+		while(UART_IS_TX_FULL(uart));
+		UART_WRITE(uart, _buf[i]);
+	}
+
+	return _len;
+}
+
+int32_t sm_uart_flush(sm_uart_t* _this){
+	sm_uart_impl_t* this = impl(_this);
+
+	if(!this)
+		return -1;
+
+	UART_WAIT_TX_EMPTY((UART_T*)this->m_instance);
+	return 0;
+}
+
 int32_t sm_uart_destroy(sm_uart_t* _this){
 
 	return 0;
@@ -12,12 +12,49 @@
 
 typedef void sm_uart_t;
 
-sm_uart_t* sm_uart_create(void* _instance, uint16_t _baudrate, uint16_t _fifo_size);
+/* _len: bytes waiting to be read when the line went quiet */
+typedef void (*sm_uart_idle_fn_t)(sm_uart_t* _this, uint16_t _len, void* _arg);
+
+sm_uart_t* sm_uart_create(void* _instance, uint32_t _baudrate, uint16_t _fifo_size);
 
 int32_t sm_uart_enable_interrupt(sm_uart_t* _this, uint8_t _priority);
 
 int32_t sm_uart_disable_interrupt(sm_uart_t* _this, uint8_t _priority);
 
+/*
+ * Receive through PDMA instead of one interrupt per FIFO threshold. A channel
+ * with a request timeout (0 or 1, from sm_pdma) writes the FIFO given at
+ * create as a circular buffer of two scatter-gather tables. The
+ * timeout marks the end of a burst: _idle runs from PDMA_IRQHandler once the
+ * line has been quiet for _idle_us. While it is quiet the timeout is off and
+ * the RX interrupt waits for the first byte of the next burst, so a burst
+ * costs two interrupts plus one per half buffer, whatever its length.
+ *
+ * The FIFO size must be even. A lap of the buffer before the bytes are read
+ * overwrites them, size it for the longest burst plus the read latency.
+ */
+int32_t sm_uart_enable_dma_rx(sm_uart_t* _this, uint32_t _idle_us, uint8_t _priority, sm_uart_idle_fn_t _idle,
+		void* _arg);
+
+/* Run _idle as an sm_defer bottom half at level _prio (sm_defer_prio_t)
+ * instead of in PDMA_IRQHandler; -1 goes back to the interrupt. _len is the
+ * one the interrupt saw, more bytes may have come by the time it runs */
+int32_t sm_uart_defer_idle(sm_uart_t* _this, int8_t _prio);
+
+/* Bytes waiting in the FIFO */
+int32_t sm_uart_available(sm_uart_t* _this);
+
+/* Take up to _len bytes the RX interrupt or PDMA has queued, return how many */
+int32_t sm_uart_read(sm_uart_t* _this, uint8_t* _buf, uint16_t _len);
+
+/* Put _len bytes in the TX FIFO, waiting for room: no TX interrupt, no
+ * buffer. Return _len */
+int32_t sm_uart_write(sm_uart_t* _this, const uint8_t* _buf, uint16_t _len);
+
+/* Wait for the last byte written to leave the shift register: an RS485
+ * driver enable may drop after this */
+int32_t sm_uart_flush(sm_uart_t* _this);
+
 int32_t sm_uart_destroy(sm_uart_t* _this);
 
 #endif /* SM_BOARD_SM_UART_SM_UART_H_ */
@@ -0,0 +1,569 @@
+/*
+ * sm_usb_cdc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_usb_cdc.h"
+#include "NuMicro.h"
+
+#include <stddef.h>
+
+/* Endpoint numbers of the controller and the addresses the host sees */
+#define SM_USB_CDC_EP_CTRL_IN       EP0
+#define SM_USB_CDC_EP_CTRL_OUT      EP1
+#define SM_USB_CDC_EP_BULK_IN       EP2
+#define SM_USB_CDC_EP_BULK_OUT      EP3
+#define SM_USB_CDC_EP_INT_IN        EP4
+
+#define SM_USB_CDC_ADDR_BULK_IN     1
+#define SM_USB_CDC_ADDR_BULK_OUT    2
+#define SM_USB_CDC_ADDR_INT_IN      3
+
+/* USB SRAM, 512 bytes; segments are 8 byte aligned */
+#define SM_USB_CDC_BUF_SETUP        0x000
+#define SM_USB_CDC_BUF_CTRL_IN      0x008
+#define SM_USB_CDC_BUF_CTRL_OUT     0x048
+#define SM_USB_CDC_BUF_BULK_IN0     0x088
+#define SM_USB_CDC_BUF_BULK_IN1     0x0C8
+#define SM_USB_CDC_BUF_BULK_OUT0    0x108
+#define SM_USB_CDC_BUF_BULK_OUT1    0x148
+#define SM_USB_CDC_BUF_INT_IN       0x188
+
+/* CDC class requests */
+#define SM_USB_CDC_SET_LINE_CODING          0x20
+#define SM_USB_CDC_GET_LINE_CODING          0x21
+#define SM_USB_CDC_SET_CONTROL_LINE_STATE   0x22
+
+/* CDC notification on the interrupt IN endpoint: 8-byte header, 2-byte state */
+#define SM_USB_CDC_SERIAL_STATE             0x20
+#define SM_USB_CDC_SERIAL_STATE_LEN         10
+
+#define SM_USB_CDC_DTR              0x01
+
+/* SERIAL_STATE bits */
+#define SM_USB_CDC_STATE_DCD        0x01
+#define SM_USB_CDC_STATE_DSR        0x02
+
+typedef struct sm_usb_cdc{
+	volatile uint8_t m_configured;
+	volatile uint8_t m_line_state;
+	sm_usb_cdc_line_coding_t m_line_coding;
+
+	uint8_t m_rx[SM_USB_CDC_RX_SIZE];
+	volatile uint16_t m_rx_head;        /* written by the interrupt only */
+	volatile uint16_t m_rx_tail;
+	uint8_t m_rx_cur;                   /* buffer the armed OUT packet lands in */
+	volatile uint8_t m_rx_armed;
+
+	uint8_t m_tx[SM_USB_CDC_TX_SIZE];
+	volatile uint16_t m_tx_head;
+	volatile uint16_t m_tx_tail;        /* moved under the critical section only */
+	uint8_t m_tx_cur;                   /* buffer of the IN packet on the bus */
+	uint8_t m_tx_busy;
+	int16_t m_tx_next;                  /* length loaded in the other buffer, -1 none */
+	uint16_t m_tx_last;                 /* length of the last packet sent */
+
+	uint16_t m_serial_state;
+	uint8_t m_int_pending;              /* m_serial_state not sent yet */
+	uint8_t m_int_busy;
+}sm_usb_cdc_t;
+
+static sm_usb_cdc_t g_usb_cdc = {
+		.m_line_coding = {115200, 0, 0, 8},
+		.m_tx_next = -1,
+};
+
+static const uint16_t g_usb_cdc_in_buf[2] = {SM_USB_CDC_BUF_BULK_IN0, SM_USB_CDC_BUF_BULK_IN1};
+static const uint16_t g_usb_cdc_out_buf[2] = {SM_USB_CDC_BUF_BULK_OUT0, SM_USB_CDC_BUF_BULK_OUT1};
+
+/*
+ * Descriptors
+ */
+static const uint8_t g_usb_cdc_device_desc[LEN_DEVICE] = {
+		LEN_DEVICE, DESC_DEVICE,
+		0x00, 0x02,                 /* bcdUSB 2.00 */
+		0x02, 0x00, 0x00,           /* CDC, subclass and protocol per interface */
+		SM_USB_CDC_EP0_SIZE,
+		SM_USB_CDC_VID & 0xFF, SM_USB_CDC_VID >> 8,
+		SM_USB_CDC_PID & 0xFF, SM_USB_CDC_PID >> 8,
+		0x00, 0x01,                 /* bcdDevice 1.00 */
+		0x01, 0x02, 0x03,           /* manufacturer, product, serial strings */
+		0x01                        /* one configuration */
+};
+
+#define SM_USB_CDC_CONFIG_LEN       (LEN_CONFIG + LEN_INTERFACE + 5 + 5 + 4 + 5 + LEN_ENDPOINT + \
+		LEN_INTERFACE + LEN_ENDPOINT + LEN_ENDPOINT)
+
+static const uint8_t g_usb_cdc_config_desc[SM_USB_CDC_CONFIG_LEN] = {
+		LEN_CONFIG, DESC_CONFIG,
+		SM_USB_CDC_CONFIG_LEN & 0xFF, SM_USB_CDC_CONFIG_LEN >> 8,
+		0x02,                       /* communication and data interfaces */
+		0x01, 0x00,
+		0xC0,                       /* self powered: the board runs from its own supply */
+		0x32,                       /* 100 mA, for the PHY regulator on VBUS */
+
+		/* Interface 0: communication, ACM */
+		LEN_INTERFACE, DESC_INTERFACE, 0x00, 0x00, 0x01, 0x02, 0x02, 0x01, 0x00,
+		/* Header functional descriptor, CDC 1.10 */
+		0x05, 0x24, 0x00, 0x10, 0x01,
+		/* Call management: no call management, data interface 1 */
+		0x05, 0x24, 0x01, 0x00, 0x01,
+		/* ACM: line coding and control line state requests */
+		0x04, 0x24, 0x02, 0x02,
+		/* Union: master 0, slave 1 */
+		0x05, 0x24, 0x06, 0x00, 0x01,
+		/* Notification endpoint */
+		LEN_ENDPOINT, DESC_ENDPOINT, EP_INPUT | SM_USB_CDC_ADDR_INT_IN, EP_INT,
+		SM_USB_CDC_INT_SIZE, 0x00, 0x0A,
+
+		/* Interface 1: data */
+		LEN_INTERFACE, DESC_INTERFACE, 0x01, 0x00, 0x02, 0x0A, 0x00, 0x00, 0x00,
+		LEN_ENDPOINT, DESC_ENDPOINT, EP_INPUT | SM_USB_CDC_ADDR_BULK_IN, EP_BULK,
+		SM_USB_CDC_BULK_SIZE, 0x00, 0x00,
+		LEN_ENDPOINT, DESC_ENDPOINT, EP_OUTPUT | SM_USB_CDC_ADDR_BULK_OUT, EP_BULK,
+		SM_USB_CDC_BULK_SIZE, 0x00, 0x00,
+};
+
+static const uint8_t g_usb_cdc_lang_desc[] = {4, DESC_STRING, 0x09, 0x04};
+
+static const uint8_t g_usb_cdc_vendor_desc[] = {
+		2 + 2 * 8, DESC_STRING,
+		'N', 0, 'u', 0, 'v', 0, 'o', 0, 't', 0, 'o', 0, 'n', 0, ' ', 0
+};
+
+static const uint8_t g_usb_cdc_product_desc[] = {
+		2 + 2 * 12, DESC_STRING,
+		'B', 0, 'S', 0, 'S', 0, ' ', 0, 'S', 0, 'e', 0, 'r', 0, 'v', 0, 'i', 0, 'c', 0, 'e', 0, ' ', 0
+};
+
+static const uint8_t g_usb_cdc_serial_desc[] = {
+		2 + 2 * 8, DESC_STRING,
+		'0', 0, '0', 0, '0', 0, '0', 0, '0', 0, '0', 0, '0', 0, '1', 0
+};
+
+/* usbd.c only reads through these */
+static uint8_t* const g_usb_cdc_string_desc[4] = {
+		(uint8_t*)g_usb_cdc_lang_desc,
+		(uint8_t*)g_usb_cdc_vendor_desc,
+		(uint8_t*)g_usb_cdc_product_desc,
+		(uint8_t*)g_usb_cdc_serial_desc,
+};
+
+const S_USBD_INFO_T gsInfo = {
+		(uint8_t*)g_usb_cdc_device_desc,
+		(uint8_t*)g_usb_cdc_config_desc,
+		(uint8_t**)g_usb_cdc_string_desc,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+};
+
+/*
+ * Bulk OUT
+ */
+static uint16_t sm_usb_cdc_rx_free(void){
+	uint16_t head = g_usb_cdc.m_rx_head;
+	uint16_t tail = g_usb_cdc.m_rx_tail;
+
+	return (uint16_t)(tail > head ? tail - head - 1 : SM_USB_CDC_RX_SIZE - 1 - (head - tail));
+}
+
+static void sm_usb_cdc_rx_arm(void){
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_BULK_OUT, g_usb_cdc_out_buf[g_usb_cdc.m_rx_cur]);
+	USBD_SET_PAYLOAD_LEN(SM_USB_CDC_EP_BULK_OUT, SM_USB_CDC_BULK_SIZE);
+	g_usb_cdc.m_rx_armed = 1;
+}
+
+/* A packet is in m_rx_cur. Let the host fill the other buffer first, if the
+ * ring can take a whole packet after this one, then copy this one out */
+static void sm_usb_cdc_rx_isr(void){
+	const uint8_t* src = (const uint8_t*)(USBD_BUF_BASE + g_usb_cdc_out_buf[g_usb_cdc.m_rx_cur]);
+	uint16_t len = (uint16_t)USBD_GET_PAYLOAD_LEN(SM_USB_CDC_EP_BULK_OUT);
+	uint16_t head = g_usb_cdc.m_rx_head;
+
+	g_usb_cdc.m_rx_armed = 0;
+	g_usb_cdc.m_rx_cur ^= 1;
+	if(sm_usb_cdc_rx_free() >= len + SM_USB_CDC_BULK_SIZE)
+		sm_usb_cdc_rx_arm();
+
+	for(uint16_t i = 0; i < len; i++){
+		g_usb_cdc.m_rx[head] = src[i];
+		if(++head == SM_USB_CDC_RX_SIZE)
+			head = 0;
+	}
+	g_usb_cdc.m_rx_head = head;
+}
+
+/*
+ * Bulk IN, always entered with the USB interrupt held off
+ */
+static int16_t sm_usb_cdc_tx_load(uint8_t _buf){
+	uint8_t* dst = (uint8_t*)(USBD_BUF_BASE + g_usb_cdc_in_buf[_buf]);
+	uint16_t tail = g_usb_cdc.m_tx_tail;
+	uint16_t head = g_usb_cdc.m_tx_head;
+	int16_t len = 0;
+
+	while(len < SM_USB_CDC_BULK_SIZE && tail != head){
+		dst[len++] = g_usb_cdc.m_tx[tail];
+		if(++tail == SM_USB_CDC_TX_SIZE)
+			tail = 0;
+	}
+	g_usb_cdc.m_tx_tail = tail;
+
+	return len ? len : -1;
+}
+
+static void sm_usb_cdc_tx_pump(void){
+	if(!g_usb_cdc.m_configured)
+		return;
+
+	if(g_usb_cdc.m_tx_next < 0)
+		g_usb_cdc.m_tx_next = sm_usb_cdc_tx_load(g_usb_cdc.m_tx_cur ^ 1);
+
+	if(g_usb_cdc.m_tx_busy)
+		return;
+
+	if(g_usb_cdc.m_tx_next >= 0){
+		g_usb_cdc.m_tx_cur ^= 1;
+		g_usb_cdc.m_tx_last = (uint16_t)g_usb_cdc.m_tx_next;
+		USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_BULK_IN, g_usb_cdc_in_buf[g_usb_cdc.m_tx_cur]);
+		USBD_SET_PAYLOAD_LEN(SM_USB_CDC_EP_BULK_IN, g_usb_cdc.m_tx_last);
+		g_usb_cdc.m_tx_busy = 1;
+		/* Load the buffer that just went idle while this one is on the bus */
+		g_usb_cdc.m_tx_next = sm_usb_cdc_tx_load(g_usb_cdc.m_tx_cur ^ 1);
+	}else if(g_usb_cdc.m_tx_last == SM_USB_CDC_BULK_SIZE){
+		/* A full packet does not end the transfer for the host, close it */
+		g_usb_cdc.m_tx_last = 0;
+		USBD_SET_PAYLOAD_LEN(SM_USB_CDC_EP_BULK_IN, 0);
+		g_usb_cdc.m_tx_busy = 1;
+	}
+}
+
+/*
+ * Interrupt IN: SERIAL_STATE, always entered with the USB interrupt held off.
+ * Only the last state is kept, a change while one is on the bus follows it
+ */
+static void sm_usb_cdc_notify_pump(void){
+	uint8_t* dst = (uint8_t*)(USBD_BUF_BASE + SM_USB_CDC_BUF_INT_IN);
+
+	if(!g_usb_cdc.m_configured || g_usb_cdc.m_int_busy || !g_usb_cdc.m_int_pending)
+		return;
+
+	dst[0] = 0xA1;                      /* class, interface, device to host */
+	dst[1] = SM_USB_CDC_SERIAL_STATE;
+	dst[2] = 0x00;
+	dst[3] = 0x00;
+	dst[4] = 0x00;                      /* communication interface */
+	dst[5] = 0x00;
+	dst[6] = 0x02;
+	dst[7] = 0x00;
+	dst[8] = (uint8_t)g_usb_cdc.m_serial_state;
+	dst[9] = (uint8_t)(g_usb_cdc.m_serial_state >> 8);
+
+	g_usb_cdc.m_int_pending = 0;
+	g_usb_cdc.m_int_busy = 1;
+	USBD_SET_PAYLOAD_LEN(SM_USB_CDC_EP_INT_IN, SM_USB_CDC_SERIAL_STATE_LEN);
+}
+
+static void sm_usb_cdc_notify(uint16_t _state){
+	g_usb_cdc.m_serial_state = _state;
+	g_usb_cdc.m_int_pending = 1;
+	sm_usb_cdc_notify_pump();
+}
+
+/*
+ * Control pipe
+ */
+static void sm_usb_cdc_class_request(void){
+	uint8_t setup[8];
+
+	USBD_GetSetupPacket(setup);
+
+	if(setup[0] & EP_INPUT){
+		switch(setup[1]){
+		case SM_USB_CDC_GET_LINE_CODING:
+			USBD_MemCopy((uint8_t*)(USBD_BUF_BASE + USBD_GET_EP_BUF_ADDR(EP0)), (uint8_t*)&g_usb_cdc.m_line_coding,
+					sizeof(g_usb_cdc.m_line_coding));
+			USBD_SET_DATA1(EP0);
+			USBD_SET_PAYLOAD_LEN(EP0, sizeof(g_usb_cdc.m_line_coding));
+			/* Status stage */
+			USBD_SET_DATA1(EP1);
+			USBD_SET_PAYLOAD_LEN(EP1, 0);
+			break;
+		default:
+			USBD_SET_EP_STALL(EP0);
+			USBD_SET_EP_STALL(EP1);
+			break;
+		}
+		return;
+	}
+
+	switch(setup[1]){
+	case SM_USB_CDC_SET_CONTROL_LINE_STATE:
+		g_usb_cdc.m_line_state = setup[2];
+		USBD_SET_DATA1(EP0);
+		USBD_SET_PAYLOAD_LEN(EP0, 0);
+		/* Carrier up while the terminal holds DTR, some hosts wait for it */
+		sm_usb_cdc_notify((setup[2] & SM_USB_CDC_DTR) ? (SM_USB_CDC_STATE_DCD | SM_USB_CDC_STATE_DSR) : 0);
+		break;
+	case SM_USB_CDC_SET_LINE_CODING:
+		USBD_PrepareCtrlOut((uint8_t*)&g_usb_cdc.m_line_coding, sizeof(g_usb_cdc.m_line_coding));
+		USBD_SET_DATA1(EP0);
+		USBD_SET_PAYLOAD_LEN(EP0, 0);
+		break;
+	default:
+		USBD_SET_EP_STALL(EP0);
+		USBD_SET_EP_STALL(EP1);
+		break;
+	}
+}
+
+/* SET_CONFIGURATION: start both directions over on DATA0 */
+static void sm_usb_cdc_set_config(void){
+	USBD_SET_DATA0(SM_USB_CDC_EP_BULK_IN);
+	USBD_SET_DATA0(SM_USB_CDC_EP_BULK_OUT);
+	USBD_SET_DATA0(SM_USB_CDC_EP_INT_IN);
+
+	g_usb_cdc.m_rx_cur = 0;
+	g_usb_cdc.m_tx_busy = 0;
+	g_usb_cdc.m_tx_last = 0;
+	if(g_usb_cdc.m_tx_next >= 0){
+		/* Whatever was loaded goes back on the bus first */
+		g_usb_cdc.m_tx_cur ^= 1;
+		USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_BULK_IN, g_usb_cdc_in_buf[g_usb_cdc.m_tx_cur]);
+		USBD_SET_PAYLOAD_LEN(SM_USB_CDC_EP_BULK_IN, (uint16_t)g_usb_cdc.m_tx_next);
+		g_usb_cdc.m_tx_last = (uint16_t)g_usb_cdc.m_tx_next;
+		g_usb_cdc.m_tx_next = -1;
+		g_usb_cdc.m_tx_busy = 1;
+	}
+	g_usb_cdc.m_configured = 1;
+
+	g_usb_cdc.m_int_busy = 0;
+
+	if(sm_usb_cdc_rx_free() >= SM_USB_CDC_BULK_SIZE)
+		sm_usb_cdc_rx_arm();
+	sm_usb_cdc_tx_pump();
+	sm_usb_cdc_notify_pump();
+}
+
+static void sm_usb_cdc_bus_reset(void){
+	g_usb_cdc.m_configured = 0;
+	g_usb_cdc.m_line_state = 0;
+	g_usb_cdc.m_rx_armed = 0;
+	g_usb_cdc.m_tx_busy = 0;
+	g_usb_cdc.m_int_busy = 0;
+	g_usb_cdc.m_int_pending = 0;
+}
+
+/* HIRC auto trim against SOF; the hardware gives up on a clock error or after
+ * the retry limit, so start it again on the next frame */
+static void sm_usb_cdc_trim(uint32_t _intsts){
+	if(SYS->HIRCTRIMSTS & (SYS_HIRCTRIMSTS_TFAILIF_Msk | SYS_HIRCTRIMSTS_CLKERIF_Msk)){
+		SYS->HIRCTRIMSTS = SYS_HIRCTRIMSTS_TFAILIF_Msk | SYS_HIRCTRIMSTS_CLKERIF_Msk;
+		SYS->HIRCTRIMCTL = 0;
+	}
+
+	if((_intsts & USBD_INTSTS_SOFIF_Msk) && !(SYS->HIRCTRIMCTL & SYS_HIRCTRIMCTL_FREQSEL_Msk)){
+		USBD_CLR_INT_FLAG(USBD_INTSTS_SOFIF_Msk);
+		SYS->HIRCTRIMCTL = SYS_HIRCTRIMCTL_REFCKSEL_Msk | (1 << SYS_HIRCTRIMCTL_FREQSEL_Pos);
+	}
+}
+
+void USBD_IRQHandler(void){
+	uint32_t intsts = USBD_GET_INT_FLAG();
+	uint32_t state = USBD_GET_BUS_STATE();
+
+	if(intsts & USBD_INTSTS_FLDET){
+		USBD_CLR_INT_FLAG(USBD_INTSTS_FLDET);
+		if(USBD_IS_ATTACHED()){
+			USBD_ENABLE_USB();
+		}else{
+			USBD_DISABLE_USB();
+			sm_usb_cdc_bus_reset();
+		}
+	}
+
+	if(intsts & USBD_INTSTS_WAKEUP)
+		USBD_CLR_INT_FLAG(USBD_INTSTS_WAKEUP);
+
+	if(intsts & USBD_INTSTS_BUS){
+		USBD_CLR_INT_FLAG(USBD_INTSTS_BUS);
+
+		if(state & USBD_STATE_USBRST){
+			USBD_ENABLE_USB();
+			USBD_SwReset();
+			sm_usb_cdc_bus_reset();
+		}
+		if(state & USBD_STATE_SUSPEND){
+			/* Only the bus clock stops, the host may resume us */
+			USBD_DISABLE_PHY();
+		}
+		if(state & USBD_STATE_RESUME){
+			USBD_ENABLE_USB();
+		}
+	}
+
+	if(intsts & USBD_INTSTS_USB){
+		if(intsts & USBD_INTSTS_SETUP){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_SETUP);
+			USBD_STOP_TRANSACTION(EP0);
+			USBD_STOP_TRANSACTION(EP1);
+			USBD_ProcessSetupPacket();
+		}
+
+		if(intsts & USBD_INTSTS_EP0){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_EP0);
+			USBD_CtrlIn();
+		}
+
+		if(intsts & USBD_INTSTS_EP1){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_EP1);
+			USBD_CtrlOut();
+		}
+
+		if(intsts & USBD_INTSTS_EP2){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_EP2);
+			g_usb_cdc.m_tx_busy = 0;
+			sm_usb_cdc_tx_pump();
+		}
+
+		if(intsts & USBD_INTSTS_EP3){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_EP3);
+			sm_usb_cdc_rx_isr();
+		}
+
+		if(intsts & USBD_INTSTS_EP4){
+			USBD_CLR_INT_FLAG(USBD_INTSTS_EP4);
+			g_usb_cdc.m_int_busy = 0;
+			sm_usb_cdc_notify_pump();
+		}
+	}
+
+	sm_usb_cdc_trim(intsts);
+}
+
+int32_t sm_usb_cdc_init(uint8_t _priority){
+	uint32_t locked = SYS_IsRegLocked();
+
+	if(locked)
+		SYS_UnlockReg();
+
+	/* USB runs straight from HIRC, no divider. USB_VBUS, USB_D- and USB_D+
+	 * are dedicated pins on the M253, there is no multi-function setting to
+	 * make; attach and detach come from the VBUS detect (FLDET) */
+	CLK_EnableModuleClock(USBD_MODULE);
+
+	if(locked)
+		SYS_LockReg();
+
+	USBD_Open(&gsInfo, sm_usb_cdc_class_request, NULL);
+	USBD_SetConfigCallback(sm_usb_cdc_set_config);
+
+	USBD->STBUFSEG = SM_USB_CDC_BUF_SETUP;
+
+	USBD_CONFIG_EP(SM_USB_CDC_EP_CTRL_IN, USBD_CFG_CSTALL | USBD_CFG_EPMODE_IN | 0);
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_CTRL_IN, SM_USB_CDC_BUF_CTRL_IN);
+	USBD_CONFIG_EP(SM_USB_CDC_EP_CTRL_OUT, USBD_CFG_CSTALL | USBD_CFG_EPMODE_OUT | 0);
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_CTRL_OUT, SM_USB_CDC_BUF_CTRL_OUT);
+
+	USBD_CONFIG_EP(SM_USB_CDC_EP_BULK_IN, USBD_CFG_EPMODE_IN | SM_USB_CDC_ADDR_BULK_IN);
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_BULK_IN, SM_USB_CDC_BUF_BULK_IN0);
+	USBD_CONFIG_EP(SM_USB_CDC_EP_BULK_OUT, USBD_CFG_EPMODE_OUT | SM_USB_CDC_ADDR_BULK_OUT);
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_BULK_OUT, SM_USB_CDC_BUF_BULK_OUT0);
+	USBD_CONFIG_EP(SM_USB_CDC_EP_INT_IN, USBD_CFG_EPMODE_IN | SM_USB_CDC_ADDR_INT_IN);
+	USBD_SET_EP_BUF_ADDR(SM_USB_CDC_EP_INT_IN, SM_USB_CDC_BUF_INT_IN);
+
+	USBD_Start();
+
+	NVIC_SetPriority(USBD_IRQn, _priority);
+	NVIC_EnableIRQ(USBD_IRQn);
+	return 0;
+}
+
+uint8_t sm_usb_cdc_is_open(void){
+	return g_usb_cdc.m_configured && (g_usb_cdc.m_line_state & SM_USB_CDC_DTR);
+}
+
+const sm_usb_cdc_line_coding_t* sm_usb_cdc_get_line_coding(void){
+	return &g_usb_cdc.m_line_coding;
+}
+
+int32_t sm_usb_cdc_write(const uint8_t* _buf, uint16_t _len){
+	uint16_t head = g_usb_cdc.m_tx_head;
+	uint16_t n = 0;
+	uint32_t primask;
+
+	if(!_buf)
+		return -1;
+
+	while(n < _len){
+		uint16_t next = (uint16_t)(head + 1);
+
+		if(next == SM_USB_CDC_TX_SIZE)
+			next = 0;
+		if(next == g_usb_cdc.m_tx_tail)
+			break;
+
+		g_usb_cdc.m_tx[head] = _buf[n++];
+		head = next;
+	}
+	g_usb_cdc.m_tx_head = head;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	sm_usb_cdc_tx_pump();
+	__set_PRIMASK(primask);
+
+	return n;
+}
+
+int32_t sm_usb_cdc_read(uint8_t* _buf, uint16_t _len){
+	uint16_t tail = g_usb_cdc.m_rx_tail;
+	uint16_t n = 0;
+	uint32_t primask;
+
+	if(!_buf)
+		return -1;
+
+	while(n < _len && tail != g_usb_cdc.m_rx_head){
+		_buf[n++] = g_usb_cdc.m_rx[tail];
+		if(++tail == SM_USB_CDC_RX_SIZE)
+			tail = 0;
+	}
+	g_usb_cdc.m_rx_tail = tail;
+
+	/* The OUT endpoint NAKs while the ring is short of a packet */
+	if(!g_usb_cdc.m_rx_armed && sm_usb_cdc_rx_free() >= SM_USB_CDC_BULK_SIZE){
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if(g_usb_cdc.m_configured && !g_usb_cdc.m_rx_armed)
+			sm_usb_cdc_rx_arm();
+		__set_PRIMASK(primask);
+	}
+
+	return n;
+}
+
+uint16_t sm_usb_cdc_tx_pending(void){
+	uint16_t head = g_usb_cdc.m_tx_head;
+	uint16_t tail = g_usb_cdc.m_tx_tail;
+
+	return (uint16_t)(head >= tail ? head - tail : SM_USB_CDC_TX_SIZE - tail + head);
+}
+
+void sm_usb_cdc_print(const char* _str, uint32_t _len, void* _arg){
+	(void)_arg;
+
+	while(_len && sm_usb_cdc_is_open()){
+		uint16_t chunk = (uint16_t)(_len > SM_USB_CDC_TX_SIZE ? SM_USB_CDC_TX_SIZE : _len);
+		int32_t n = sm_usb_cdc_write((const uint8_t*)_str, chunk);
+
+		if(n < 0)
+			return;
+		_str += n;
+		_len -= (uint32_t)n;
+	}
+}
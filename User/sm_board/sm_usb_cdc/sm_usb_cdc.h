@@ -0,0 +1,68 @@
+/*
+ * sm_usb_cdc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef SM_BOARD_SM_USB_CDC_SM_USB_CDC_H_
+#define SM_BOARD_SM_USB_CDC_SM_USB_CDC_H_
+
+#include "stdint.h"
+
+/*
+ * USB CDC-ACM virtual COM port on the full-speed device controller, the
+ * service port that replaces uart_debug for log dumps and bulk transfers.
+ *
+ * The class sits on the control pipe of usbd.c. Bulk IN and bulk OUT each own
+ * two packet buffers in the USB SRAM and swap them per transaction: the next
+ * IN packet is loaded while the current one is on the bus, and the OUT
+ * endpoint is re-armed on the second buffer before the first one is copied
+ * out. Both directions are fed from ring buffers, so the caller never waits
+ * on the host unless it asks to.
+ *
+ * HIRC is trimmed to 48 MHz against the host SOF once the bus is up, the part
+ * needs no crystal for USB.
+ */
+
+#define SM_USB_CDC_VID              0x0416
+#define SM_USB_CDC_PID              0x50A1
+
+#define SM_USB_CDC_EP0_SIZE         64
+#define SM_USB_CDC_BULK_SIZE        64
+#define SM_USB_CDC_INT_SIZE         16      /* a SERIAL_STATE notification in one packet */
+
+/* Ring buffers, a power of two is not required */
+#define SM_USB_CDC_RX_SIZE          256
+#define SM_USB_CDC_TX_SIZE          512
+
+/* Same layout as the CDC SET_LINE_CODING payload */
+typedef struct __attribute__((packed)) sm_usb_cdc_line_coding{
+	uint32_t m_baudrate;
+	uint8_t m_stop_bits;       /* 0: 1, 1: 1.5, 2: 2 */
+	uint8_t m_parity;          /* 0: none, 1: odd, 2: even, 3: mark, 4: space */
+	uint8_t m_data_bits;
+}sm_usb_cdc_line_coding_t;
+
+/* Clock, endpoints and pull-up. HIRC must already be running */
+int32_t sm_usb_cdc_init(uint8_t _priority);
+
+/* Host configured the device and holds DTR, i.e. a terminal has the port open */
+uint8_t sm_usb_cdc_is_open(void);
+
+const sm_usb_cdc_line_coding_t* sm_usb_cdc_get_line_coding(void);
+
+/* Queue up to _len bytes for the host, return how many fit */
+int32_t sm_usb_cdc_write(const uint8_t* _buf, uint16_t _len);
+
+/* Take up to _len bytes the host sent, return how many */
+int32_t sm_usb_cdc_read(uint8_t* _buf, uint16_t _len);
+
+/* Bytes still queued for the host */
+uint16_t sm_usb_cdc_tx_pending(void);
+
+/* Write callback for the report dumpers (sm_ram_report, sm_prof_dump...):
+ * waits for room while the port is open, drops the text when it is not */
+void sm_usb_cdc_print(const char* _str, uint32_t _len, void* _arg);
+
+#endif /* SM_BOARD_SM_USB_CDC_SM_USB_CDC_H_ */
@@ -0,0 +1,173 @@
+/*
+ * sm_ac_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_ac on synthetic EADC blocks, as the PDMA half-buffers would bring them:
+ * a voltage and a current channel around the ADC mid-scale, with a little
+ * noise, at several mains frequencies. The last window of each has to give
+ * the frequency and both RMS values; then the voltage goes flat and the lost
+ * mains have to be reported within a SM_AC_FREQ_MIN period of the last
+ * crossing, and the mains that come back measured again. Exits non-zero on
+ * a miss.
+ */
+
+#include "sm_sim.h"
+#include "sm_ac.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define AC_RATE                 5000    /* frames per second */
+#define AC_CHANNELS             2
+#define AC_CYCLES               10
+#define AC_HYSTERESIS           40
+#define AC_SCALE                1000    /* uV or uA per count: the RMS in counts */
+#define AC_BLOCK                50      /* frames of a half-buffer, 10 ms */
+#define AC_MID                  2048
+#define AC_NOISE                8       /* counts, peak */
+#define AC_FREQ_TOL             10      /* mHz */
+#define AC_RMS_TOL              2       /* mV, mA */
+/* The last crossing came at most a period before the mains went; the loss
+ * is a period at SM_AC_FREQ_MIN later, seen at the end of a block */
+#define AC_LOST_MAX             (AC_RATE / SM_AC_FREQ_MIN + AC_RATE / SM_AC_FREQ_MIN + AC_BLOCK)
+
+static sm_ac_t g_ac;
+static uint16_t g_block[AC_BLOCK * AC_CHANNELS];
+static double g_phase;
+static uint32_t g_noise = 1;
+static uint32_t g_frames;               /* before the block in sm_ac_process() */
+static uint32_t g_windows;
+static uint32_t g_lost_at;
+static int g_errors;
+
+static const sm_ac_config_t g_config = {
+	.m_rate = AC_RATE,
+	.m_channels = AC_CHANNELS,
+	.m_cycles = AC_CYCLES,
+	.m_hysteresis = AC_HYSTERESIS,
+	.m_scale = {AC_SCALE, AC_SCALE},
+};
+
+static void ac_window(const sm_ac_result_t* _result, void* _arg){
+	(void)_arg;
+
+	g_windows++;
+	if((_result->m_flags & SM_AC_LOST) && !g_lost_at)
+		g_lost_at = g_frames + AC_BLOCK;
+}
+
+static int32_t ac_noise(void){
+	g_noise = g_noise * 1103515245UL + 12345UL;
+	return (int32_t)((g_noise >> 16) % (2 * AC_NOISE + 1)) - AC_NOISE;
+}
+
+/* _seconds of _freq Hz, _amp_v and _amp_i counts peak; 0 Hz is a flat line */
+static void ac_feed(double _freq, double _amp_v, double _amp_i, double _seconds){
+	uint32_t blocks = (uint32_t)(_seconds * AC_RATE / AC_BLOCK);
+
+	for(uint32_t b = 0; b < blocks; b++){
+		for(uint32_t f = 0; f < AC_BLOCK; f++){
+			g_block[f * AC_CHANNELS] = (uint16_t)(AC_MID + lround(_amp_v * sin(g_phase)) + ac_noise());
+			g_block[f * AC_CHANNELS + 1] = (uint16_t)(AC_MID + lround(_amp_i * sin(g_phase - 0.5)) + ac_noise());
+			g_phase = fmod(g_phase + 2 * M_PI * _freq / AC_RATE, 2 * M_PI);
+		}
+		sm_ac_process(&g_ac, g_block, AC_BLOCK);
+		g_frames += AC_BLOCK;
+	}
+}
+
+static void ac_expect(const char* _what, uint32_t _freq, uint32_t _rms_v, uint32_t _rms_i){
+	sm_ac_result_t result;
+	int32_t ok;
+
+	if(sm_ac_get(&g_ac, &result) < 0){
+		printf("ac: %-18s no window\n", _what);
+		g_errors++;
+		return;
+	}
+
+	ok = !(result.m_flags & SM_AC_LOST) && labs((long)result.m_freq - (long)_freq) <= AC_FREQ_TOL &&
+			labs((long)result.m_rms[0] - (long)_rms_v) <= AC_RMS_TOL &&
+			labs((long)result.m_rms[1] - (long)_rms_i) <= AC_RMS_TOL && result.m_cycles == AC_CYCLES;
+	printf("ac: %-18s %6lu mHz, rms %4lu / %4lu, %u cycles in %u frames%s\n", _what, (unsigned long)result.m_freq,
+			(unsigned long)result.m_rms[0], (unsigned long)result.m_rms[1], result.m_cycles, result.m_samples,
+			ok ? "" : "  <- expected");
+	if(!ok){
+		printf("ac: %-18s %6lu mHz, rms %4lu / %4lu\n", "", (unsigned long)_freq, (unsigned long)_rms_v,
+				(unsigned long)_rms_i);
+		g_errors++;
+	}
+}
+
+static void ac_isqrt(uint64_t _value, uint32_t _root){
+	if(sm_ac_isqrt(_value) != _root){
+		printf("ac: isqrt(%llu) %lu, expected %lu\n", (unsigned long long)_value, (unsigned long)sm_ac_isqrt(_value),
+				(unsigned long)_root);
+		g_errors++;
+	}
+}
+
+int main(int _argc, char** _argv){
+	static const struct{
+		const char* m_name;
+		double m_freq;
+		double m_amp_v;
+		double m_amp_i;
+	}cases[] = {
+		{"50 Hz", 50.0, 1000, 500},
+		{"49.7 Hz", 49.7, 1000, 500},
+		{"60 Hz", 60.0, 1400, 200},
+		{"45.5 Hz", 45.5, 600, 1200},
+	};
+	sm_ac_result_t result;
+	uint32_t windows;
+	uint32_t stop;
+
+	if(sm_sim_init(_argc, _argv) < 0)
+		return 1;
+
+	ac_isqrt(0, 0);
+	ac_isqrt(1, 1);
+	ac_isqrt(3, 1);
+	ac_isqrt(4, 2);
+	ac_isqrt(99, 9);
+	ac_isqrt(0xFFFFFFFE00000001ULL, 0xFFFFFFFFUL);
+	ac_isqrt(0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFUL);
+
+	if(sm_ac_init(&g_ac, &g_config, ac_window, NULL) < 0){
+		printf("ac: init failed\n");
+		return 1;
+	}
+
+	/* A second each: the last window is all of the new frequency */
+	for(uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++){
+		ac_feed(cases[i].m_freq, cases[i].m_amp_v, cases[i].m_amp_i, 1.0);
+		ac_expect(cases[i].m_name, (uint32_t)lround(cases[i].m_freq * 1000),
+				(uint32_t)lround(cases[i].m_amp_v / M_SQRT2), (uint32_t)lround(cases[i].m_amp_i / M_SQRT2));
+	}
+
+	/* The mains go: a flat line at mid-scale, the noise stays */
+	stop = g_frames;
+	windows = g_windows;
+	ac_feed(0, 0, 0, 0.2);
+	if(!g_lost_at || g_lost_at - stop > AC_LOST_MAX || sm_ac_get(&g_ac, &result) < 0 ||
+			!(result.m_flags & SM_AC_LOST) || result.m_freq){
+		printf("ac: lost mains not reported within %u frames\n", AC_LOST_MAX);
+		g_errors++;
+	}else{
+		printf("ac: %-18s after %lu ms, %lu windows closed\n", "lost mains",
+				(unsigned long)((g_lost_at - stop) * 1000UL / AC_RATE), (unsigned long)(g_windows - windows));
+	}
+
+	/* And come back */
+	ac_feed(50.0, 1000, 500, 1.0);
+	ac_expect("back, 50 Hz", 50000, 707, 354);
+
+	printf(g_errors ? "FAILED\n" : "OK\n");
+	return g_errors ? 1 : 0;
+}
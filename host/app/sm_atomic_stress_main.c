@@ -0,0 +1,213 @@
+/*
+ * sm_atomic_stress_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_atomic under real concurrency: host threads on several cores play the
+ * interrupts and the thread, against the same sources as the target, the
+ * exclusive pair turned into compare-and-swap (SM_HOST_THREADS). A single
+ * core only interleaves at instruction boundaries; this is the harder case.
+ * A side that has to wait yields, so it also runs on one host CPU.
+ */
+
+#include "sm_atomic.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define STRESS_THREADS      4
+#define STRESS_COUNT        1000000UL
+#define STRESS_RING         64
+
+typedef struct stress_msg{
+	uint32_t m_producer;
+	uint32_t m_seq;
+}stress_msg_t;
+
+static sm_atomic_t g_counter;
+static sm_atomic_t g_flags;
+static sm_atomic_t g_flags_raised[STRESS_THREADS];
+static sm_atomic_t g_done;
+
+static sm_atomic_spsc_t g_spsc;
+static uint8_t g_spsc_buf[SM_ATOMIC_SPSC_SIZE(sizeof(uint32_t), STRESS_RING)];
+
+static sm_atomic_mpsc_t g_mpsc;
+static uint32_t g_mpsc_buf[SM_ATOMIC_MPSC_WORDS(sizeof(stress_msg_t), STRESS_RING)];
+
+static sm_atomic_seq_t g_seq;
+static volatile uint32_t g_shared[4];
+
+static int g_errors;
+
+static void stress_run(void* (*_fn)(void*), uint32_t _threads, void* (*_consumer)(void*)){
+	pthread_t thread[STRESS_THREADS + 1];
+
+	for(uint32_t i = 0; i < _threads; i++)
+		pthread_create(&thread[i], NULL, _fn, (void*)(uintptr_t)i);
+	if(_consumer)
+		pthread_create(&thread[_threads], NULL, _consumer, NULL);
+
+	for(uint32_t i = 0; i < _threads; i++)
+		pthread_join(thread[i], NULL);
+	g_done = 1;
+	if(_consumer)
+		pthread_join(thread[_threads], NULL);
+	g_done = 0;
+}
+
+static void* stress_counter(void* _arg){
+	for(uint32_t i = 0; i < STRESS_COUNT; i++)
+		sm_atomic_add(&g_counter, (i & 1) ? 3 : -1);
+	return NULL;
+}
+
+/* Each producer owns a bit; it counts the times it raised it from clear */
+static void* stress_flags_producer(void* _arg){
+	uint32_t id = (uint32_t)(uintptr_t)_arg;
+
+	for(uint32_t i = 0; i < STRESS_COUNT / 4; i++){
+		if(!(sm_atomic_flags_set(&g_flags, 1UL << id) & (1UL << id)))
+			g_flags_raised[id]++;
+	}
+	return NULL;
+}
+
+static uint32_t g_flags_taken[STRESS_THREADS];
+
+static void stress_flags_take(void){
+	uint32_t got = sm_atomic_flags_take(&g_flags, 0xFFFFFFFFUL);
+
+	for(uint32_t b = 0; b < STRESS_THREADS; b++){
+		if(got & (1UL << b))
+			g_flags_taken[b]++;
+	}
+}
+
+static void* stress_flags_consumer(void* _arg){
+	while(!g_done)
+		stress_flags_take();
+	stress_flags_take();
+	return NULL;
+}
+
+static void* stress_spsc_producer(void* _arg){
+	for(uint32_t i = 0; i < STRESS_COUNT; i++){
+		while(sm_atomic_spsc_push(&g_spsc, &i) < 0)
+			sched_yield();
+	}
+	return NULL;
+}
+
+static void* stress_spsc_consumer(void* _arg){
+	uint32_t expect = 0;
+	uint32_t value;
+
+	while(expect < STRESS_COUNT){
+		if(sm_atomic_spsc_pop(&g_spsc, &value) < 0){
+			sched_yield();
+			continue;
+		}
+		if(value != expect++)
+			g_errors++;
+	}
+	return NULL;
+}
+
+static void* stress_mpsc_producer(void* _arg){
+	stress_msg_t msg = {.m_producer = (uint32_t)(uintptr_t)_arg};
+
+	for(msg.m_seq = 0; msg.m_seq < STRESS_COUNT / 4; msg.m_seq++){
+		while(sm_atomic_mpsc_push(&g_mpsc, &msg) < 0)
+			sched_yield();
+	}
+	return NULL;
+}
+
+static void* stress_mpsc_consumer(void* _arg){
+	uint32_t next[STRESS_THREADS] = {0};
+	uint32_t total = 0;
+	stress_msg_t msg;
+
+	while(total < STRESS_THREADS * (STRESS_COUNT / 4)){
+		if(sm_atomic_mpsc_pop(&g_mpsc, &msg) < 0){
+			sched_yield();
+			continue;
+		}
+		total++;
+		/* Per producer, in order and none lost */
+		if(msg.m_producer >= STRESS_THREADS || msg.m_seq != next[msg.m_producer]++)
+			g_errors++;
+	}
+	return NULL;
+}
+
+static void* stress_seq_writer(void* _arg){
+	for(uint32_t i = 1; i <= STRESS_COUNT; i++){
+		sm_atomic_seq_write_begin(&g_seq);
+		for(uint32_t k = 0; k < 4; k++)
+			g_shared[k] = i * (k + 1);
+		sm_atomic_seq_write_end(&g_seq);
+	}
+	return NULL;
+}
+
+static void* stress_seq_reader(void* _arg){
+	uint32_t copy[4];
+	uint32_t seq;
+
+	while(!g_done){
+		do{
+			seq = sm_atomic_seq_read_begin(&g_seq);
+			for(uint32_t k = 0; k < 4; k++)
+				copy[k] = g_shared[k];
+		}while(sm_atomic_seq_read_retry(&g_seq, seq));
+
+		for(uint32_t k = 1; k < 4; k++){
+			if(copy[k] != copy[0] * (k + 1))
+				g_errors++;
+		}
+	}
+	return NULL;
+}
+
+static void stress_report(const char* _name, int _ok){
+	printf("%-8s %s\n", _name, _ok ? "ok" : "FAIL");
+	if(!_ok)
+		g_errors++;
+}
+
+int main(void){
+	int flags_ok = 1;
+	int errors;
+
+	stress_run(stress_counter, STRESS_THREADS, NULL);
+	stress_report("counter", g_counter == STRESS_THREADS * STRESS_COUNT);
+
+	stress_run(stress_flags_producer, STRESS_THREADS, stress_flags_consumer);
+	for(uint32_t b = 0; b < STRESS_THREADS; b++)
+		flags_ok &= g_flags_raised[b] == g_flags_taken[b];
+	stress_report("flags", flags_ok);
+
+	errors = g_errors;
+	sm_atomic_spsc_init(&g_spsc, g_spsc_buf, sizeof(uint32_t), STRESS_RING);
+	stress_run(stress_spsc_producer, 1, stress_spsc_consumer);
+	stress_report("spsc", g_errors == errors && !sm_atomic_spsc_count(&g_spsc));
+
+	errors = g_errors;
+	sm_atomic_mpsc_init(&g_mpsc, g_mpsc_buf, sizeof(stress_msg_t), STRESS_RING);
+	stress_run(stress_mpsc_producer, STRESS_THREADS, stress_mpsc_consumer);
+	stress_report("mpsc", g_errors == errors && !sm_atomic_mpsc_count(&g_mpsc));
+
+	errors = g_errors;
+	sm_atomic_seq_init(&g_seq);
+	stress_run(stress_seq_writer, 1, stress_seq_reader);
+	stress_report("seqlock", g_errors == errors);
+
+	printf("%s\n", g_errors ? "FAIL" : "OK");
+	return g_errors ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * sm_bus_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_bus references and ownership on the simulator: a slab runs out and
+ * fills again, a message goes back only after its last subscriber released
+ * it, a retained one outlives its release, one published to nobody goes
+ * straight back, and a subscriber with a full queue misses a message that
+ * the others get and that still goes back. The free slots are counted by
+ * allocating the slab empty. Exits non-zero on a miss.
+ */
+
+#include "sm_sim.h"
+#include "sm_bus.h"
+
+#include <stdio.h>
+
+#define BUS_GPIO_ID             0x100
+#define BUS_TIME                1234
+
+typedef struct bus_slots{
+	sm_bus_topic_t m_topic;
+	uint8_t m_slots;
+	const char* m_name;
+}bus_slots_t;
+
+static const bus_slots_t g_slots[] = {
+	{SM_BUS_ADC, 4, "ADC"},
+	{SM_BUS_GPIO, 8, "GPIO"},
+	{SM_BUS_CAN, 8, "CAN"},
+	{SM_BUS_MODBUS, 2, "MODBUS"},
+};
+
+/* ADC: g_sub[0] and g_sub[1]. GPIO and CAN: g_sub[2], left to fill up, and g_sub[3] */
+static sm_bus_sub_t g_sub[4];
+static uint32_t g_notified[4];
+static int g_errors;
+
+static void bus_notify(void* _arg){
+	g_notified[(sm_bus_sub_t*)_arg - g_sub]++;
+}
+
+static uint32_t bus_clock(void){
+	return BUS_TIME;
+}
+
+/* Slots of _topic not in flight */
+static uint32_t bus_free(sm_bus_topic_t _topic){
+	void* msg[32];
+	uint32_t n = 0;
+
+	while(n < 32 && (msg[n] = sm_bus_alloc(_topic)))
+		n++;
+	for(uint32_t i = 0; i < n; i++)
+		sm_bus_release(msg[i]);
+	return n;
+}
+
+static void bus_expect(const char* _what, int32_t _ok){
+	printf("bus: %-40s %s\n", _what, _ok ? "ok" : "FAILED");
+	if(!_ok)
+		g_errors++;
+}
+
+static void bus_expect_free(const char* _what, sm_bus_topic_t _topic, uint32_t _free){
+	uint32_t free = bus_free(_topic);
+
+	if(free != _free){
+		printf("bus: %-40s %lu %s slots free, expected %lu\n", _what, (unsigned long)free, g_slots[_topic].m_name,
+				(unsigned long)_free);
+		g_errors++;
+		return;
+	}
+	printf("bus: %-40s %lu %s slots free\n", _what, (unsigned long)free, g_slots[_topic].m_name);
+}
+
+int main(int _argc, char** _argv){
+	sm_bus_modbus_t* modbus[3];
+	const sm_bus_adc_t* adc[2];
+	const void* msg;
+	sm_bus_adc_t* out;
+	sm_bus_can_t* can;
+	uint32_t taken;
+	int32_t ok;
+
+	if(sm_sim_init(_argc, _argv) < 0)
+		return 1;
+
+	if(sm_bus_init() < 0){
+		printf("bus: init failed\n");
+		return 1;
+	}
+	sm_bus_set_clock(bus_clock);
+
+	for(uint32_t t = 0; t < sizeof(g_slots) / sizeof(g_slots[0]); t++)
+		bus_expect_free(g_slots[t].m_name, g_slots[t].m_topic, g_slots[t].m_slots);
+
+	/* A slab runs out and fills again */
+	modbus[0] = SM_BUS_ALLOC(MODBUS);
+	modbus[1] = SM_BUS_ALLOC(MODBUS);
+	modbus[2] = SM_BUS_ALLOC(MODBUS);
+	bus_expect("MODBUS exhausted after its 2 slots", modbus[0] && modbus[1] && modbus[0] != modbus[1] && !modbus[2]);
+	bus_expect("topic of a message", sm_bus_topic(modbus[0]) == SM_BUS_MODBUS);
+	sm_bus_release(modbus[0]);
+	bus_expect_free("one released", SM_BUS_MODBUS, 1);
+	sm_bus_release(modbus[1]);
+
+	/* Nobody subscribed: publish drops the only reference */
+	modbus[0] = SM_BUS_ALLOC(MODBUS);
+	bus_expect("publish without subscribers", modbus[0] && sm_bus_publish(modbus[0]) == 0);
+	bus_expect_free("  back to the slab", SM_BUS_MODBUS, 2);
+
+	/* Two subscribers: the slot waits for both */
+	ok = sm_bus_subscribe(&g_sub[0], SM_BUS_ADC, bus_notify, &g_sub[0]) == 0 &&
+			sm_bus_subscribe(&g_sub[1], SM_BUS_ADC, bus_notify, &g_sub[1]) == 0 &&
+			sm_bus_subscribe(&g_sub[2], SM_BUS_GPIO, bus_notify, &g_sub[2]) == 0 &&
+			sm_bus_subscribe(&g_sub[2], SM_BUS_CAN, bus_notify, &g_sub[2]) == 0 &&
+			sm_bus_subscribe(&g_sub[3], SM_BUS_GPIO, bus_notify, &g_sub[3]) == 0 &&
+			sm_bus_subscribe(&g_sub[3], SM_BUS_CAN, bus_notify, &g_sub[3]) == 0;
+	bus_expect("subscribe", ok);
+
+	out = SM_BUS_ALLOC(ADC);
+	out->m_value[0] = 42;
+	sm_bus_publish(out);
+	bus_expect("ADC delivered to both", g_notified[0] == 1 && g_notified[1] == 1);
+	bus_expect_free("  in flight", SM_BUS_ADC, 3);
+
+	adc[0] = sm_bus_take(&g_sub[0]);
+	adc[1] = sm_bus_take(&g_sub[1]);
+	bus_expect("  the same message", adc[0] == out && adc[1] == out && adc[0]->m_value[0] == 42);
+	bus_expect("  one each", !sm_bus_take(&g_sub[0]) && !sm_bus_take(&g_sub[1]));
+	sm_bus_release(adc[0]);
+	bus_expect_free("  first released", SM_BUS_ADC, 3);
+
+	/* A retained message outlives the release it came with */
+	sm_bus_retain(adc[1]);
+	sm_bus_release(adc[1]);
+	bus_expect_free("  second released, retained", SM_BUS_ADC, 3);
+	sm_bus_release(adc[1]);
+	bus_expect_free("  retain released", SM_BUS_ADC, 4);
+
+	/* GPIO events fill g_sub[2], g_sub[3] is drained as they come */
+	ok = 1;
+	for(uint32_t i = 0; i < SM_BUS_SUB_QUEUE; i++){
+		sm_bus_on_gpio(NULL, i & 1, (void*)(uintptr_t)(BUS_GPIO_ID + i));
+		msg = sm_bus_take(&g_sub[3]);
+		ok &= msg && ((const sm_bus_gpio_t*)msg)->m_id == BUS_GPIO_ID + i;
+		sm_bus_release(msg);
+	}
+	bus_expect("GPIO events to a full queue", ok && g_notified[2] == SM_BUS_SUB_QUEUE &&
+			g_notified[3] == SM_BUS_SUB_QUEUE);
+	bus_expect_free("  held by the full queue", SM_BUS_GPIO, 8 - SM_BUS_SUB_QUEUE);
+
+	/* The full queue misses the CAN frame, the other subscriber has it */
+	can = SM_BUS_ALLOC(CAN);
+	can->m_id = 7;
+	sm_bus_publish(can);
+	bus_expect("CAN missed by the full queue", g_sub[2].m_missed == 1 && g_notified[2] == SM_BUS_SUB_QUEUE);
+	msg = sm_bus_take(&g_sub[3]);
+	bus_expect("  delivered to the other", msg == can && sm_bus_topic(msg) == SM_BUS_CAN);
+	sm_bus_release(msg);
+	bus_expect_free("  released", SM_BUS_CAN, 8);
+
+	/* The full queue in order, then every slot is back */
+	taken = 0;
+	ok = 1;
+	while((msg = sm_bus_take(&g_sub[2]))){
+		const sm_bus_gpio_t* gpio = msg;
+
+		ok &= sm_bus_topic(msg) == SM_BUS_GPIO && gpio->m_id == BUS_GPIO_ID + taken && gpio->m_level == (taken & 1) &&
+				gpio->m_time == BUS_TIME;
+		sm_bus_release(msg);
+		taken++;
+	}
+	bus_expect("full queue drained in order", ok && taken == SM_BUS_SUB_QUEUE);
+	for(uint32_t t = 0; t < sizeof(g_slots) / sizeof(g_slots[0]); t++)
+		bus_expect_free(g_slots[t].m_name, g_slots[t].m_topic, g_slots[t].m_slots);
+
+	printf(g_errors ? "FAILED\n" : "OK\n");
+	return g_errors ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+/*
+ * sm_fw_pack_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * tools/sm_fw_pack.py against sm_fw_decoder, run by make -C host pack:
+ *
+ *   sm_fw_pack_check gen <dir>     write <dir>/fw_old.bin and fw_new.bin
+ *   sm_fw_pack_check <dir>         decode <dir>/fw_plain.pack and, against
+ *                                  fw_old.bin, fw_delta.pack
+ *
+ * The two images look like firmware: code-like bytes, tables of similar
+ * words, strings and erased fill. The new one moves code around, patches
+ * words and grows, so a delta has old copies, matches and literals. Each
+ * payload goes through the decoder whole and in chunks of several sizes,
+ * tokens split anywhere, and the output has to equal fw_new.bin byte for
+ * byte. Exits non-zero on a difference.
+ */
+
+#include "sm_fw_decoder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PACK_OLD_SIZE           (16 * 1024)
+#define PACK_NEW_MAX            (20 * 1024)
+#define PACK_PATH_MAX           256
+
+typedef struct pack_out{
+	uint8_t m_buf[PACK_NEW_MAX];
+	uint32_t m_len;
+}pack_out_t;
+
+static uint8_t g_old[PACK_OLD_SIZE];
+static uint8_t g_new[PACK_NEW_MAX];
+static uint32_t g_new_len;
+static pack_out_t g_out;
+static uint32_t g_rand = 0x1234567UL;
+static int g_errors;
+
+/* Chunk sizes the payload is fed in; 0 is the whole payload at once */
+static const uint32_t g_chunks[] = {0, 1, 2, 3, 4, 5, 7, 64, 230, 257};
+
+static uint32_t pack_rand(void){
+	g_rand = g_rand * 1103515245UL + 12345UL;
+	return g_rand >> 8;
+}
+
+static void pack_gen_old(void){
+	uint32_t i = 0;
+
+	/* Vector table: handler addresses close to each other */
+	for(; i < 192; i += 4){
+		uint32_t addr = 0x00000400UL + (pack_rand() & 0x3FFCUL) + 1;
+
+		memcpy(&g_old[i], &addr, 4);
+	}
+	while(i < PACK_OLD_SIZE - 1024){
+		uint32_t kind = pack_rand() % 8;
+		uint32_t len = 16 + pack_rand() % 240;
+
+		if(i + len > PACK_OLD_SIZE - 1024)
+			len = PACK_OLD_SIZE - 1024 - i;
+
+		if(kind == 0){
+			/* Strings */
+			static const char* const words[] = {"sm_", "uart", "init", "fail", "relay", " %lu", "\r\n", "ok"};
+
+			for(uint32_t end = i + len; i < end; ){
+				const char* w = words[pack_rand() % 8];
+				uint32_t n = (uint32_t)strlen(w);
+
+				if(i + n > end)
+					n = end - i;
+				memcpy(&g_old[i], w, n);
+				i += n;
+			}
+		}else if(kind == 1){
+			/* A literal pool: similar words */
+			for(uint32_t end = i + (len & ~3UL); i < end; i += 4){
+				uint32_t word = 0x40000000UL | (pack_rand() & 0x0000FF00UL);
+
+				memcpy(&g_old[i], &word, 4);
+			}
+		}else{
+			/* Code: 16 bit instructions from a small set of opcodes */
+			for(uint32_t end = i + (len & ~1UL); i < end; i += 2){
+				uint16_t op = (uint16_t)(((pack_rand() % 6) << 11) | (pack_rand() & 0x07FF));
+
+				memcpy(&g_old[i], &op, 2);
+			}
+		}
+	}
+	/* Erased flash at the end */
+	memset(&g_old[i], 0xFF, PACK_OLD_SIZE - i);
+}
+
+/* The old image with a function grown, words patched, a block moved and a
+ * new tail */
+static void pack_gen_new(void){
+	uint32_t n = 0;
+
+	memcpy(&g_new[n], g_old, 4096);
+	n += 4096;
+	for(uint32_t k = 0; k < 300; k++)
+		g_new[n++] = (uint8_t)pack_rand();
+	memcpy(&g_new[n], &g_old[4096], 6000);
+	n += 6000;
+	memcpy(&g_new[n], &g_old[12000], 2000);
+	n += 2000;
+	memcpy(&g_new[n], &g_old[10096], 1904);
+	n += 1904;
+	memcpy(&g_new[n], &g_old[14000], PACK_OLD_SIZE - 14000);
+	n += PACK_OLD_SIZE - 14000;
+	for(uint32_t k = 0; k < 1500; k++)
+		g_new[n++] = (uint8_t)(k % 7 == 0 ? pack_rand() : 0x20 + k % 13);
+	for(uint32_t k = 0; k < 40; k++){
+		uint32_t at = pack_rand() % (n - 4);
+
+		g_new[at] ^= 0x5A;
+	}
+	g_new_len = n;
+}
+
+static int32_t pack_write(const char* _dir, const char* _name, const uint8_t* _data, uint32_t _len){
+	char path[PACK_PATH_MAX];
+	FILE* f;
+	int32_t ok;
+
+	snprintf(path, sizeof(path), "%s/%s", _dir, _name);
+	f = fopen(path, "wb");
+	if(!f)
+		return -1;
+	ok = fwrite(_data, 1, _len, f) == _len;
+	fclose(f);
+	return ok ? 0 : -1;
+}
+
+static uint8_t* pack_read(const char* _dir, const char* _name, uint32_t* _len){
+	char path[PACK_PATH_MAX];
+	uint8_t* data;
+	long size;
+	FILE* f;
+
+	snprintf(path, sizeof(path), "%s/%s", _dir, _name);
+	f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(size > 0 ? (size_t)size : 1);
+	if(data && fread(data, 1, (size_t)size, f) != (size_t)size){
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	*_len = (uint32_t)size;
+	return data;
+}
+
+static int32_t pack_output(void* _arg, const void* _data, uint32_t _len){
+	pack_out_t* out = _arg;
+
+	if(out->m_len + _len > sizeof(out->m_buf))
+		return -1;
+	memcpy(&out->m_buf[out->m_len], _data, _len);
+	out->m_len += _len;
+	return 0;
+}
+
+/* _payload in _chunk bytes at a time into g_out. -1 when the decoder refused it */
+static int32_t pack_decode(const uint8_t* _payload, uint32_t _len, const uint8_t* _old, uint32_t _old_size,
+		uint32_t _chunk){
+	sm_fw_decoder_t decoder;
+	int32_t status = 0;
+
+	g_out.m_len = 0;
+	sm_fw_decoder_init(&decoder, _old, _old_size, pack_output, &g_out);
+	for(uint32_t pos = 0; pos < _len && !status; pos += _chunk)
+		status = sm_fw_decoder_put(&decoder, &_payload[pos], _len - pos < _chunk ? _len - pos : _chunk);
+	if(!status)
+		status = sm_fw_decoder_done(&decoder);
+	if(!status && sm_fw_decoder_get_out_len(&decoder) != g_out.m_len)
+		status = -1;
+	return status;
+}
+
+static void pack_check(const char* _what, const uint8_t* _payload, uint32_t _len, const uint8_t* _old,
+		uint32_t _old_size, const uint8_t* _expect, uint32_t _expect_len){
+	for(uint32_t c = 0; c < sizeof(g_chunks) / sizeof(g_chunks[0]); c++){
+		uint32_t chunk = g_chunks[c] ? g_chunks[c] : _len;
+		int32_t status = pack_decode(_payload, _len, _old, _old_size, chunk);
+		uint32_t diff;
+
+		for(diff = 0; diff < g_out.m_len && diff < _expect_len && g_out.m_buf[diff] == _expect[diff]; diff++);
+		if(status < 0 || g_out.m_len != _expect_len || diff != _expect_len){
+			printf("pack: %-6s chunks of %5lu: status %ld, %lu bytes of %lu, first difference at %lu\n", _what,
+					(unsigned long)chunk, (long)status, (unsigned long)g_out.m_len, (unsigned long)_expect_len,
+					(unsigned long)diff);
+			g_errors++;
+		}
+	}
+	printf("pack: %-6s %5lu bytes to %5lu, %u chunkings\n", _what, (unsigned long)_len, (unsigned long)_expect_len,
+			(unsigned)(sizeof(g_chunks) / sizeof(g_chunks[0])));
+}
+
+int main(int _argc, char** _argv){
+	uint8_t* plain;
+	uint8_t* delta;
+	uint8_t* image;
+	uint8_t* old;
+	uint32_t plain_len;
+	uint32_t delta_len;
+	uint32_t image_len;
+	uint32_t old_len;
+
+	if(_argc == 3 && !strcmp(_argv[1], "gen")){
+		pack_gen_old();
+		pack_gen_new();
+		if(pack_write(_argv[2], "fw_old.bin", g_old, PACK_OLD_SIZE) < 0 ||
+				pack_write(_argv[2], "fw_new.bin", g_new, g_new_len) < 0){
+			printf("pack: cannot write the images to %s\n", _argv[2]);
+			return 1;
+		}
+		return 0;
+	}
+	if(_argc != 2){
+		printf("usage: %s gen <dir> | %s <dir>\n", _argv[0], _argv[0]);
+		return 1;
+	}
+
+	image = pack_read(_argv[1], "fw_new.bin", &image_len);
+	old = pack_read(_argv[1], "fw_old.bin", &old_len);
+	plain = pack_read(_argv[1], "fw_plain.pack", &plain_len);
+	delta = pack_read(_argv[1], "fw_delta.pack", &delta_len);
+	if(!image || !old || !plain || !delta){
+		printf("pack: images or payloads missing in %s\n", _argv[1]);
+		return 1;
+	}
+
+	pack_check("plain", plain, plain_len, NULL, 0, image, image_len);
+	pack_check("delta", delta, delta_len, old, old_len, image, image_len);
+
+	/* Without its old image a delta cannot decode */
+	if(pack_decode(delta, delta_len, NULL, 0, delta_len) == 0){
+		printf("pack: delta decoded without its old image\n");
+		g_errors++;
+	}
+	if(delta_len * 2 > plain_len){
+		printf("pack: delta of %lu bytes is not below half the plain %lu\n", (unsigned long)delta_len,
+				(unsigned long)plain_len);
+		g_errors++;
+	}
+
+	printf(g_errors ? "FAILED\n" : "OK\n");
+	return g_errors ? 1 : 0;
+}
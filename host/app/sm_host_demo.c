@@ -0,0 +1,240 @@
+/*
+ * sm_host_demo.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "NuMicro.h"
+#include "sm_sim.h"
+#include "sm_crc.h"
+#include "sm_flash.h"
+#include "sm_kv.h"
+#include "sm_prof.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Runs the board drivers and services on the simulator and prints what the
+ * chip would have done, with the virtual time each step took. The second run,
+ * after NVIC_SystemReset(), checks that the key/value store kept its data.
+ */
+
+#define SM_HOST_DEMO_KEY_BOOTS        (SM_KV_KEY_USER_BASE + 0)
+#define SM_HOST_DEMO_CRC_SIZE         4096
+#define SM_HOST_DEMO_CRC_EXPECTED     0xD3B3C7BCUL    /* zlib crc32() of the same bytes */
+#define SM_HOST_DEMO_UART_BAUD        115200
+#define SM_HOST_DEMO_TICK_HZ          1000
+
+static volatile uint32_t g_tick;
+static volatile uint32_t g_echoed;
+static uint32_t g_led_edges;
+static uint8_t g_crc_buf[SM_HOST_DEMO_CRC_SIZE];
+static int32_t g_prof_tmr0;
+static int32_t g_prof_uart0;
+static int32_t g_prof_crc;
+
+void TMR0_IRQHandler(void){
+	SM_PROF_ISR_ENTER(g_prof_tmr0);
+	TIMER_ClearIntFlag(TIMER0);
+	g_tick++;
+	PF15 ^= 1;
+	SM_PROF_ISR_EXIT(g_prof_tmr0);
+}
+
+/* Echo what UART0 receives */
+void UART0_IRQHandler(void){
+	SM_PROF_ISR_ENTER(g_prof_uart0);
+	while(!UART_GET_RX_EMPTY(UART0)){
+		uint8_t byte = (uint8_t)UART_READ(UART0);
+		UART_WRITE(UART0, byte);
+		g_echoed++;
+	}
+	SM_PROF_ISR_EXIT(g_prof_uart0);
+}
+
+static void sm_host_demo_led_hook(uint8_t _port, uint8_t _pin, uint8_t _level, void* _arg){
+	(void)_level;
+	(void)_arg;
+
+	if(_port == 5 && _pin == 15)
+		g_led_edges++;
+}
+
+static double sm_host_demo_us(uint64_t _from){
+	return (double)(sm_sim_now() - _from) / SM_SIM_NS_PER_US;
+}
+
+static void sm_host_demo_clock_init(void){
+	SYS_UnlockReg();
+
+	CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+	CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+	CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+
+	CLK_EnableModuleClock(UART0_MODULE);
+	CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL1_UART0SEL_HIRC, CLK_CLKDIV0_UART0(1));
+	CLK_EnableModuleClock(TMR0_MODULE);
+	CLK_SetModuleClock(TMR0_MODULE, CLK_CLKSEL1_TMR0SEL_HIRC, 0);
+	CLK_EnableModuleClock(GPF_MODULE);
+
+	SystemCoreClockUpdate();
+	SYS_LockReg();
+}
+
+static int32_t sm_host_demo_tick(void){
+	uint64_t start = sm_sim_now();
+
+	sm_sim_gpio_set_hook(sm_host_demo_led_hook, NULL);
+	GPIO_SetMode(PF, BIT15, GPIO_MODE_OUTPUT);
+
+	TIMER_Open(TIMER0, TIMER_PERIODIC_MODE, SM_HOST_DEMO_TICK_HZ);
+	TIMER_EnableInt(TIMER0);
+	NVIC_EnableIRQ(TMR0_IRQn);
+	TIMER_Start(TIMER0);
+
+	while(g_tick < 100)
+		__WFI();
+
+	TIMER_Stop(TIMER0);
+	NVIC_DisableIRQ(TMR0_IRQn);
+
+	printf("tick : %u TMR0 interrupts, %u LED edges in %.0f us\n", (unsigned)g_tick, (unsigned)g_led_edges,
+			sm_host_demo_us(start));
+	return g_led_edges == g_tick ? 0 : -1;
+}
+
+static int32_t sm_host_demo_uart(void){
+	static const char message[] = "hello M253";
+	char echo[sizeof(message)] = {0};
+	uint64_t start = sm_sim_now();
+	uint32_t len;
+
+	UART_Open(UART0, SM_HOST_DEMO_UART_BAUD);
+	UART_EnableInt(UART0, UART_INTEN_RDAIEN_Msk);
+	NVIC_EnableIRQ(UART0_IRQn);
+
+	sm_sim_uart_inject(0, message, sizeof(message) - 1);
+	while(g_echoed < sizeof(message) - 1)
+		__WFI();
+
+	NVIC_DisableIRQ(UART0_IRQn);
+	UART_WAIT_TX_EMPTY(UART0);
+	len = sm_sim_uart_take(0, echo, sizeof(message) - 1);
+
+	printf("uart : echoed \"%s\" at %u baud in %.0f us\n", echo, SM_HOST_DEMO_UART_BAUD, sm_host_demo_us(start));
+	return len == sizeof(message) - 1 && !memcmp(echo, message, len) ? 0 : -1;
+}
+
+static int32_t sm_host_demo_crc(void){
+	uint64_t start;
+	uint32_t crc;
+
+	for(uint32_t i = 0; i < SM_HOST_DEMO_CRC_SIZE; i++)
+		g_crc_buf[i] = (uint8_t)(i * 7);
+
+	SYS_UnlockReg();
+	sm_crc_init();
+	SYS_LockReg();
+
+	start = sm_sim_now();
+	{
+		SM_PROF_SCOPE(g_prof_crc);
+		crc = sm_crc32(g_crc_buf, SM_HOST_DEMO_CRC_SIZE);
+	}
+
+	printf("crc  : CRC-32 of %u bytes = 0x%08X in %.1f us\n", SM_HOST_DEMO_CRC_SIZE, (unsigned)crc,
+			sm_host_demo_us(start));
+	if(crc != SM_HOST_DEMO_CRC_EXPECTED){
+		printf("crc  : expected 0x%08X\n", (unsigned)SM_HOST_DEMO_CRC_EXPECTED);
+		return -1;
+	}
+	return 0;
+}
+
+static int32_t sm_host_demo_flash(void){
+	static sm_flash_stream_t stream;
+	uint32_t addr = 0x10000;
+	uint32_t programs = sm_sim_flash_program_count();
+	uint64_t start = sm_sim_now();
+
+	if(sm_flash_stream_open(&stream, addr, sizeof(g_crc_buf)) < 0 ||
+			sm_flash_stream_put(&stream, g_crc_buf, sizeof(g_crc_buf)) < 0 ||
+			sm_flash_stream_close(&stream) < 0)
+		return -1;
+
+	printf("flash: %u bytes streamed, %u words programmed in %.0f us\n", (unsigned)sizeof(g_crc_buf),
+			(unsigned)(sm_sim_flash_program_count() - programs), sm_host_demo_us(start));
+	return memcmp((const void*)addr, g_crc_buf, sizeof(g_crc_buf)) ? -1 : 0;
+}
+
+static void sm_host_demo_print(const char* _str, uint32_t _len, void* _arg){
+	(void)_arg;
+	fwrite(_str, 1, _len, stdout);
+}
+
+static int32_t sm_host_demo_kv(uint32_t* _boots){
+	uint64_t start = sm_sim_now();
+	uint32_t boots = 0;
+
+	if(sm_flash_init() < 0 || sm_kv_init() < 0)
+		return -1;
+
+	sm_kv_read(SM_HOST_DEMO_KEY_BOOTS, &boots, sizeof(boots));
+	boots++;
+	if(sm_kv_write(SM_HOST_DEMO_KEY_BOOTS, &boots, sizeof(boots)) < 0)
+		return -1;
+
+	printf("kv   : boot %u recorded in %.0f us\n", (unsigned)boots, sm_host_demo_us(start));
+	*_boots = boots;
+	return 0;
+}
+
+int main(int argc, char** argv){
+	uint32_t boots;
+	int32_t ret = 0;
+
+	if(sm_sim_init(argc, argv) < 0)
+		return 1;
+
+	SystemInit();
+	sm_host_demo_clock_init();
+
+	printf("reset %u, HCLK %u Hz\n", (unsigned)sm_sim_get_reset_count(), (unsigned)SystemCoreClock);
+
+	if(sm_host_demo_kv(&boots) < 0){
+		printf("kv   : FAILED\n");
+		return 1;
+	}
+
+	if(sm_sim_get_reset_count() == 0){
+		sm_prof_init();
+		g_prof_tmr0 = sm_prof_isr("tmr0");
+		g_prof_uart0 = sm_prof_isr("uart0");
+		g_prof_crc = sm_prof_region("crc32");
+
+		ret |= sm_host_demo_tick();
+		ret |= sm_host_demo_uart();
+		ret |= sm_host_demo_crc();
+		ret |= sm_host_demo_flash();
+		sm_prof_dump(sm_host_demo_print, NULL);
+
+		if(ret){
+			printf("FAILED\n");
+			return 1;
+		}
+
+		printf("reset: NVIC_SystemReset() at %.0f us\n", sm_host_demo_us(0));
+		NVIC_SystemReset();
+	}
+
+	/* Second run: RAM started over, flash did not */
+	if(boots != 2){
+		printf("kv   : expected boot 2 after reset, FAILED\n");
+		return 1;
+	}
+
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * sm_libc_bench_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_libc_bench() on the host: the same sizes and alignments as on the
+ * target, timed in nanoseconds against the host libc. It checks the bench
+ * itself and gives the byte loop baseline; the Cortex-M23 figures come from
+ * the board.
+ */
+
+#include "sm_libc.h"
+
+#include <stdio.h>
+#include <time.h>
+
+static uint8_t g_buf[16 * 1024];
+
+static uint32_t sm_libc_bench_clock(void){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+static void sm_libc_bench_print(const char* _str, uint32_t _len, void* _arg){
+	fwrite(_str, 1, _len, stdout);
+}
+
+int main(void){
+	int32_t rc = sm_libc_bench(g_buf, sizeof(g_buf), sm_libc_bench_clock, sm_libc_bench_print, NULL);
+
+	printf("%s\n", rc < 0 ? "FAIL" : "OK");
+	return rc < 0 ? 1 : 0;
+}
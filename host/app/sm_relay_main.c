@@ -0,0 +1,164 @@
+/*
+ * sm_relay_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_relay timing on the simulator, TIMER1 and the relay pins as on the
+ * board: minimum on and off times, inrush staggering, an exclusive pair and
+ * a break-before-make transfer, each switch checked against when it was due
+ * from the pin change itself. Then the relays rest for longer than half and
+ * than the whole 32 bit microsecond clock, and a request after the rest has
+ * to switch at once. Exits non-zero on a miss.
+ */
+
+#include "NuMicro.h"
+#include "sm_sim.h"
+#include "sm_relay.h"
+
+#include <stdio.h>
+
+#define RELAY_PORT              1       /* PB */
+#define RELAY_PRIORITY          1
+#define RELAY_MIN_ON_US         1000000UL
+#define RELAY_MIN_OFF_US        500000UL
+#define RELAY_INRUSH_US         100000UL
+#define RELAY_GAP_US            50000UL
+/* Interrupt entry and the register accesses of a step */
+#define RELAY_SLACK_NS          (50 * SM_SIM_NS_PER_US)
+#define RELAY_WAIT_NS           (5 * SM_SIM_NS_PER_S)
+
+enum{
+	RELAY_MAIN = 0,
+	RELAY_BYPASS,
+	RELAY_FAN,
+	RELAY_NUM
+};
+
+static const sm_relay_desc_t g_relays[RELAY_NUM] = {
+	{"main", PB, BIT0, 0, RELAY_MIN_ON_US, RELAY_MIN_OFF_US, RELAY_INRUSH_US},
+	{"bypass", PB, BIT1, 0, RELAY_MIN_ON_US, RELAY_MIN_OFF_US, RELAY_INRUSH_US},
+	{"fan", PB, BIT2, 1, 0, 0, 0},
+};
+
+static const sm_relay_rule_t g_rules[] = {
+	{SM_RELAY_EXCLUSIVE, RELAY_MAIN, RELAY_BYPASS},
+};
+
+static uint64_t g_switched[RELAY_NUM];
+static int g_errors;
+
+static void relay_pin(uint8_t _port, uint8_t _pin, uint8_t _level, void* _arg){
+	(void)_arg;
+
+	if(_port == RELAY_PORT && _pin < RELAY_NUM)
+		g_switched[_pin] = sm_sim_now();
+}
+
+static void relay_clock_init(void){
+	SYS_UnlockReg();
+
+	CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+	CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+	CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+	CLK_EnableModuleClock(GPB_MODULE);
+
+	SystemCoreClockUpdate();
+	SYS_LockReg();
+}
+
+/* Wait for _id to reach _on, then check it did _due_ns after _from */
+static void relay_expect(const char* _what, uint8_t _id, uint8_t _on, uint64_t _from, uint64_t _due_ns){
+	uint64_t start = sm_sim_now();
+	uint64_t at;
+
+	while(sm_relay_get(_id) != _on && sm_sim_now() - start < RELAY_WAIT_NS)
+		sm_sim_advance(SM_SIM_NS_PER_MS);
+
+	at = g_switched[_id];
+	if(sm_relay_get(_id) != _on || at < _from + _due_ns || at > _from + _due_ns + RELAY_SLACK_NS){
+		printf("relay: %-28s expected after %8.3f ms, %s %8.3f ms\n", _what, (double)_due_ns / SM_SIM_NS_PER_MS,
+				sm_relay_get(_id) == _on ? "switched after" : "not switched in",
+				(double)((sm_relay_get(_id) == _on ? at : sm_sim_now()) - _from) / SM_SIM_NS_PER_MS);
+		g_errors++;
+	}else{
+		printf("relay: %-28s after %8.3f ms\n", _what, (double)(at - _from) / SM_SIM_NS_PER_MS);
+	}
+}
+
+/* Rest _ns with main on, then an off request has to switch at once */
+static void relay_rest(const char* _what, uint64_t _ns){
+	uint64_t now;
+
+	sm_sim_advance(_ns);
+	now = sm_sim_now();
+	sm_relay_set(RELAY_MAIN, 0);
+	relay_expect(_what, RELAY_MAIN, 0, now, 0);
+
+	sm_relay_set(RELAY_MAIN, 1);
+	relay_expect("  and back on", RELAY_MAIN, 1, now, RELAY_MIN_OFF_US * SM_SIM_NS_PER_US);
+}
+
+int main(int _argc, char** _argv){
+	uint64_t t;
+
+	if(sm_sim_init(_argc, _argv) < 0)
+		return 1;
+
+	SystemInit();
+	relay_clock_init();
+	sm_sim_gpio_set_hook(relay_pin, NULL);
+
+	t = sm_sim_now();
+	if(sm_relay_init(g_relays, RELAY_NUM, g_rules, sizeof(g_rules) / sizeof(g_rules[0]), RELAY_PRIORITY) < 0){
+		printf("relay: init failed\n");
+		return 1;
+	}
+
+	/* Off since init: minimum off time first */
+	sm_relay_set(RELAY_MAIN, 1);
+	relay_expect("on, min off from init", RELAY_MAIN, 1, t, RELAY_MIN_OFF_US * SM_SIM_NS_PER_US);
+
+	/* Right after, the fan waits for the main relay's inrush */
+	t = g_switched[RELAY_MAIN];
+	sm_relay_set(RELAY_FAN, 1);
+	relay_expect("fan on, inrush", RELAY_FAN, 1, t, RELAY_INRUSH_US * SM_SIM_NS_PER_US);
+
+	sm_relay_set(RELAY_MAIN, 0);
+	relay_expect("off, min on", RELAY_MAIN, 0, t, RELAY_MIN_ON_US * SM_SIM_NS_PER_US);
+
+	/* The exclusive pair */
+	sm_relay_set(RELAY_MAIN, 1);
+	relay_expect("on, min off", RELAY_MAIN, 1, g_switched[RELAY_MAIN], RELAY_MIN_OFF_US * SM_SIM_NS_PER_US);
+	if(sm_relay_set(RELAY_BYPASS, 1) == 0){
+		printf("relay: bypass on accepted with main on\n");
+		g_errors++;
+	}
+
+	/* Break before make, once main has been on long enough */
+	sm_sim_advance(RELAY_MIN_ON_US * SM_SIM_NS_PER_US);
+	t = sm_sim_now();
+	sm_relay_transfer(RELAY_MAIN, RELAY_BYPASS, SM_RELAY_BBM, RELAY_GAP_US);
+	relay_expect("transfer, main off", RELAY_MAIN, 0, t, 0);
+	relay_expect("transfer, bypass on after gap", RELAY_BYPASS, 1, g_switched[RELAY_MAIN],
+			RELAY_GAP_US * SM_SIM_NS_PER_US);
+	sm_sim_advance(RELAY_MIN_ON_US * SM_SIM_NS_PER_US);
+	sm_relay_transfer(RELAY_BYPASS, RELAY_MAIN, SM_RELAY_BBM, 0);
+	relay_expect("transfer back", RELAY_MAIN, 1, g_switched[RELAY_BYPASS], 0);
+
+	/* Past the signed and the unsigned wrap of the microsecond clock */
+	relay_rest("off after 2^31 us on", (1ULL << 31) * SM_SIM_NS_PER_US + 2 * SM_SIM_NS_PER_S);
+	relay_rest("off after 2^32 us on", (1ULL << 32) * SM_SIM_NS_PER_US + 500 * SM_SIM_NS_PER_MS);
+
+	sm_relay_trip();
+	if(sm_relay_get(RELAY_MAIN) || sm_relay_get(RELAY_FAN) || sm_relay_busy()){
+		printf("relay: not all off after a trip\n");
+		g_errors++;
+	}
+
+	printf("relay: %lu TIMER1 interrupts\n", (unsigned long)sm_sim_irq_count(TMR1_IRQn));
+	printf(g_errors ? "FAILED\n" : "OK\n");
+	return g_errors ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * sm_uart_dma_main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+/*
+ * sm_uart receiving through circular PDMA on the simulator: bursts of
+ * growing length go into UART1 at 230400 baud, a 64-byte buffer takes them,
+ * wraps included, and each one has to come out of sm_uart_read() intact after
+ * the idle callback reported it; then a line goes out through
+ * sm_uart_write(). Exits non-zero on a mismatch.
+ */
+
+#include "NuMicro.h"
+#include "sm_sim.h"
+#include "sm_uart.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UART_DMA_BAUD           230400
+#define UART_DMA_FIFO           64
+#define UART_DMA_IDLE_US        500
+#define UART_DMA_BURSTS         4
+#define UART_DMA_BURST_FIRST    10
+#define UART_DMA_BURST_STEP     17
+#define UART_DMA_GAP_NS         (5 * SM_SIM_NS_PER_MS)
+#define UART_DMA_WAIT_NS        (50 * SM_SIM_NS_PER_MS)
+
+static volatile uint32_t g_idle;
+static volatile uint16_t g_idle_len;
+
+static void uart_dma_idle(sm_uart_t* _this, uint16_t _len, void* _arg){
+	(void)_this;
+	(void)_arg;
+
+	g_idle_len = _len;
+	g_idle++;
+}
+
+static void uart_dma_clock_init(void){
+	SYS_UnlockReg();
+
+	CLK_EnableXtalRC(CLK_PWRCTL_HIRCEN_Msk);
+	CLK_WaitClockReady(CLK_STATUS_HIRCSTB_Msk);
+	CLK_SetHCLK(CLK_CLKSEL0_HCLKSEL_HIRC, CLK_CLKDIV0_HCLK(1));
+
+	CLK_EnableModuleClock(UART1_MODULE);
+	CLK_SetModuleClock(UART1_MODULE, CLK_CLKSEL1_UART1SEL_HIRC, CLK_CLKDIV0_UART1(1));
+
+	SystemCoreClockUpdate();
+	SYS_LockReg();
+}
+
+int main(int _argc, char** _argv){
+	uint8_t sent[UART_DMA_FIFO];
+	uint8_t got[UART_DMA_FIFO * 2];
+	sm_uart_t* uart;
+	int errors = 0;
+
+	if(sm_sim_init(_argc, _argv) < 0)
+		return 1;
+
+	SystemInit();
+	uart_dma_clock_init();
+
+	uart = sm_uart_create(UART1, UART_DMA_BAUD, UART_DMA_FIFO);
+	if(!uart || sm_uart_enable_dma_rx(uart, UART_DMA_IDLE_US, 1, uart_dma_idle, NULL) < 0){
+		printf("uart : no PDMA receive\n");
+		return 1;
+	}
+
+	for(uint32_t burst = 0; burst < UART_DMA_BURSTS; burst++){
+		uint32_t len = UART_DMA_BURST_FIRST + burst * UART_DMA_BURST_STEP;
+		uint32_t idle = g_idle;
+		uint64_t start = sm_sim_now();
+		int32_t n;
+
+		for(uint32_t i = 0; i < len; i++)
+			sent[i] = (uint8_t)('a' + (burst * 3 + i) % 26);
+
+		sm_sim_uart_inject(1, sent, len);
+		while(g_idle == idle && sm_sim_now() - start < UART_DMA_WAIT_NS)
+			__WFI();
+
+		n = sm_uart_read(uart, got, sizeof(got));
+		if(g_idle == idle || n != (int32_t)len || g_idle_len != len || memcmp(got, sent, len)){
+			printf("uart : burst of %lu bytes, idle %s, reported %u, read %ld\n", (unsigned long)len,
+					g_idle == idle ? "missing" : "seen", g_idle_len, (long)n);
+			errors++;
+		}else{
+			printf("uart : burst of %2lu bytes read intact, idle after %.0f us\n", (unsigned long)len,
+					(double)(sm_sim_now() - start) / SM_SIM_NS_PER_US);
+		}
+
+		sm_sim_advance(UART_DMA_GAP_NS);
+	}
+
+	/* And back out, through the TX FIFO */
+	{
+		static const char line[] = "sm_uart_write: more than the 16-byte TX FIFO\r\n";
+		uint32_t n;
+
+		sm_uart_write(uart, (const uint8_t*)line, sizeof(line) - 1);
+		sm_sim_advance(UART_DMA_GAP_NS);
+		n = sm_sim_uart_take(1, got, sizeof(got));
+		if(n != sizeof(line) - 1 || memcmp(got, line, n)){
+			printf("uart : wrote %u bytes, %lu went out\n", (unsigned)(sizeof(line) - 1), (unsigned long)n);
+			errors++;
+		}else{
+			printf("uart : %lu bytes written out intact\n", (unsigned long)n);
+		}
+	}
+
+	printf("uart : %lu UART1 interrupts, %lu PDMA interrupts for %d bursts\n",
+			(unsigned long)sm_sim_irq_count(UART1_IRQn), (unsigned long)sm_sim_irq_count(PDMA_IRQn), UART_DMA_BURSTS);
+
+	printf(errors ? "FAILED\n" : "OK\n");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,13 @@
+/*
+ * arm_cmse.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef HOST_INCLUDE_ARM_CMSE_H_
+#define HOST_INCLUDE_ARM_CMSE_H_
+
+/* Host build: no TrustZone, the simulated core is always Non-secure */
+
+#endif /* HOST_INCLUDE_ARM_CMSE_H_ */
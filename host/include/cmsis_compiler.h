@@ -0,0 +1,225 @@
+/*
+ * cmsis_compiler.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef HOST_INCLUDE_CMSIS_COMPILER_H_
+#define HOST_INCLUDE_CMSIS_COMPILER_H_
+
+/* Takes the guard of the Arm header, which core_cm23.h would find first */
+#define __CMSIS_COMPILER_H
+
+/*
+ * Host replacement for Library/CMSIS/Include/cmsis_compiler.h, force-included
+ * into every host build unit. core_cm23.h and the StdDriver keep their
+ * sources unchanged: the attributes map to plain GCC ones and every core
+ * intrinsic that has an architectural side effect (PRIMASK, IPSR, WFI, the
+ * exclusive monitor) goes to the simulated core in host/sim/sm_sim_core.c.
+ */
+
+#include <stdint.h>
+
+#ifndef __ASM
+#define __ASM                                  __asm
+#endif
+#ifndef __INLINE
+#define __INLINE                               inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE                        static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE                   __attribute__((always_inline)) static inline
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN                            __attribute__((noreturn))
+#endif
+#ifndef __USED
+#define __USED                                 __attribute__((used))
+#endif
+#ifndef __WEAK
+#define __WEAK                                 __attribute__((weak))
+#endif
+#ifndef __PACKED
+#define __PACKED                               __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT                        struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_UNION
+#define __PACKED_UNION                         union __attribute__((packed, aligned(1)))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)                           __attribute__((aligned(x)))
+#endif
+#ifndef __RESTRICT
+#define __RESTRICT                             __restrict
+#endif
+#ifndef __COMPILER_BARRIER
+#define __COMPILER_BARRIER()                   __asm volatile("" ::: "memory")
+#endif
+
+#define __UNALIGNED_UINT16_READ(addr)          (*(const uint16_t*)(const void*)(addr))
+#define __UNALIGNED_UINT16_WRITE(addr, val)    (void)(*(uint16_t*)(void*)(addr) = (val))
+#define __UNALIGNED_UINT32_READ(addr)          (*(const uint32_t*)(const void*)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val)    (void)(*(uint32_t*)(void*)(addr) = (val))
+#define __UNALIGNED_UINT32(x)                  (*(uint32_t*)(x))
+
+/* Simulated core, host/sim/sm_sim_core.c */
+uint32_t sm_sim_core_get_primask(void);
+void sm_sim_core_set_primask(uint32_t _primask);
+uint32_t sm_sim_core_get_ipsr(void);
+uint32_t sm_sim_core_get_reg(uint32_t _reg);
+void sm_sim_core_set_reg(uint32_t _reg, uint32_t _value);
+void sm_sim_core_wait(void);
+void sm_sim_core_event(void);
+uint32_t sm_sim_core_ldrex(volatile void* _addr, uint32_t _size);
+uint32_t sm_sim_core_strex(volatile void* _addr, uint32_t _value, uint32_t _size);
+void sm_sim_core_clrex(void);
+__NO_RETURN void sm_sim_core_bkpt(uint32_t _value);
+
+#define SM_SIM_CORE_REG_CONTROL                0
+#define SM_SIM_CORE_REG_MSP                    1
+#define SM_SIM_CORE_REG_PSP                    2
+#define SM_SIM_CORE_REG_MSPLIM                 3
+#define SM_SIM_CORE_REG_PSPLIM                 4
+#define SM_SIM_CORE_REG_NUM                    5
+
+__STATIC_FORCEINLINE void __enable_irq(void)                 { sm_sim_core_set_primask(0); }
+__STATIC_FORCEINLINE void __disable_irq(void)                { sm_sim_core_set_primask(1); }
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)            { return sm_sim_core_get_primask(); }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)    { sm_sim_core_set_primask(priMask & 1U); }
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void)               { return sm_sim_core_get_ipsr(); }
+__STATIC_FORCEINLINE uint32_t __get_xPSR(void)               { return sm_sim_core_get_ipsr(); }
+__STATIC_FORCEINLINE uint32_t __get_APSR(void)               { return 0; }
+
+__STATIC_FORCEINLINE uint32_t __get_CONTROL(void)            { return sm_sim_core_get_reg(SM_SIM_CORE_REG_CONTROL); }
+__STATIC_FORCEINLINE void __set_CONTROL(uint32_t control)    { sm_sim_core_set_reg(SM_SIM_CORE_REG_CONTROL, control); }
+__STATIC_FORCEINLINE uint32_t __get_MSP(void)                { return sm_sim_core_get_reg(SM_SIM_CORE_REG_MSP); }
+__STATIC_FORCEINLINE void __set_MSP(uint32_t topOfMainStack) { sm_sim_core_set_reg(SM_SIM_CORE_REG_MSP, topOfMainStack); }
+__STATIC_FORCEINLINE uint32_t __get_PSP(void)                { return sm_sim_core_get_reg(SM_SIM_CORE_REG_PSP); }
+__STATIC_FORCEINLINE void __set_PSP(uint32_t topOfProcStack) { sm_sim_core_set_reg(SM_SIM_CORE_REG_PSP, topOfProcStack); }
+__STATIC_FORCEINLINE uint32_t __get_MSPLIM(void)             { return sm_sim_core_get_reg(SM_SIM_CORE_REG_MSPLIM); }
+__STATIC_FORCEINLINE void __set_MSPLIM(uint32_t limit)       { sm_sim_core_set_reg(SM_SIM_CORE_REG_MSPLIM, limit); }
+__STATIC_FORCEINLINE uint32_t __get_PSPLIM(void)             { return sm_sim_core_get_reg(SM_SIM_CORE_REG_PSPLIM); }
+__STATIC_FORCEINLINE void __set_PSPLIM(uint32_t limit)       { sm_sim_core_set_reg(SM_SIM_CORE_REG_PSPLIM, limit); }
+
+#define __NOP()                                __COMPILER_BARRIER()
+#define __WFI()                                sm_sim_core_wait()
+#define __WFE()                                sm_sim_core_wait()
+#define __SEV()                                sm_sim_core_event()
+#define __BKPT(value)                          sm_sim_core_bkpt(value)
+
+__STATIC_FORCEINLINE void __ISB(void)                        { __COMPILER_BARRIER(); }
+__STATIC_FORCEINLINE void __DSB(void)                        { __sync_synchronize(); }
+__STATIC_FORCEINLINE void __DMB(void)                        { __sync_synchronize(); }
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value)          { return __builtin_bswap32(value); }
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value){
+	return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+__STATIC_FORCEINLINE int32_t __REVSH(int32_t value)          { return (int16_t)__builtin_bswap16((uint16_t)value); }
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2){
+	op2 %= 32U;
+	return op2 ? (op1 >> op2) | (op1 << (32U - op2)) : op1;
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value){
+	uint32_t result = 0;
+	for(uint32_t i = 0; i < 32U; i++){
+		result = (result << 1) | (value & 1U);
+		value >>= 1;
+	}
+	return result;
+}
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value)           { return value ? (uint8_t)__builtin_clz(value) : 32U; }
+
+#define __SSAT(ARG1, ARG2) \
+({ \
+	int32_t __arg = (ARG1), __max = (int32_t)((1UL << ((ARG2) - 1)) - 1); \
+	__arg > __max ? __max : (__arg < -__max - 1 ? -__max - 1 : __arg); \
+})
+
+#define __USAT(ARG1, ARG2) \
+({ \
+	int32_t __arg = (ARG1); uint32_t __max = (1UL << (ARG2)) - 1; \
+	__arg < 0 ? 0U : ((uint32_t)__arg > __max ? __max : (uint32_t)__arg); \
+})
+
+#if defined(SM_HOST_THREADS)
+
+/*
+ * Threaded host programs (make stress) run without the simulated core: the
+ * exclusive pair becomes a compare-and-swap against the value LDREX read, per
+ * thread. The lock-free code only ever stores what it derived from that
+ * value, for which the two are the same.
+ */
+static __thread volatile void* g_sm_host_excl_addr;
+static __thread uint32_t g_sm_host_excl_value;
+
+__STATIC_FORCEINLINE uint32_t sm_host_ldrex(volatile void* addr, uint32_t size){
+	uint32_t value = size == 1 ? __atomic_load_n((volatile uint8_t*)addr, __ATOMIC_SEQ_CST) :
+			size == 2 ? __atomic_load_n((volatile uint16_t*)addr, __ATOMIC_SEQ_CST) :
+			__atomic_load_n((volatile uint32_t*)addr, __ATOMIC_SEQ_CST);
+
+	g_sm_host_excl_addr = addr;
+	g_sm_host_excl_value = value;
+	return value;
+}
+
+__STATIC_FORCEINLINE uint32_t sm_host_strex(volatile void* addr, uint32_t value, uint32_t size){
+	uint32_t expected = g_sm_host_excl_value;
+	int done;
+
+	if(g_sm_host_excl_addr != addr)
+		return 1;
+	g_sm_host_excl_addr = 0;
+
+	if(size == 1){
+		uint8_t e = (uint8_t)expected;
+		done = __atomic_compare_exchange_n((volatile uint8_t*)addr, &e, (uint8_t)value, 0, __ATOMIC_SEQ_CST,
+				__ATOMIC_SEQ_CST);
+	}else if(size == 2){
+		uint16_t e = (uint16_t)expected;
+		done = __atomic_compare_exchange_n((volatile uint16_t*)addr, &e, (uint16_t)value, 0, __ATOMIC_SEQ_CST,
+				__ATOMIC_SEQ_CST);
+	}else{
+		done = __atomic_compare_exchange_n((volatile uint32_t*)addr, &expected, value, 0, __ATOMIC_SEQ_CST,
+				__ATOMIC_SEQ_CST);
+	}
+	return done ? 0 : 1;
+}
+
+__STATIC_FORCEINLINE void sm_host_clrex(void)                { g_sm_host_excl_addr = 0; }
+
+#define sm_sim_core_ldrex                      sm_host_ldrex
+#define sm_sim_core_strex                      sm_host_strex
+#define sm_sim_core_clrex                      sm_host_clrex
+
+#endif
+
+/* Exclusive monitor: cleared on every exception entry and return, as on the core */
+__STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t* addr)   { return (uint8_t)sm_sim_core_ldrex(addr, 1); }
+__STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t* addr) { return (uint16_t)sm_sim_core_ldrex(addr, 2); }
+__STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t* addr) { return sm_sim_core_ldrex(addr, 4); }
+__STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t* addr)   { return sm_sim_core_strex(addr, value, 1); }
+__STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t* addr) { return sm_sim_core_strex(addr, value, 2); }
+__STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t* addr) { return sm_sim_core_strex(addr, value, 4); }
+__STATIC_FORCEINLINE void __CLREX(void)                      { sm_sim_core_clrex(); }
+
+__STATIC_FORCEINLINE uint8_t __LDAEXB(volatile uint8_t* ptr)    { return (uint8_t)sm_sim_core_ldrex(ptr, 1); }
+__STATIC_FORCEINLINE uint16_t __LDAEXH(volatile uint16_t* ptr)  { return (uint16_t)sm_sim_core_ldrex(ptr, 2); }
+__STATIC_FORCEINLINE uint32_t __LDAEX(volatile uint32_t* ptr)   { return sm_sim_core_ldrex(ptr, 4); }
+__STATIC_FORCEINLINE uint32_t __STLEXB(uint8_t value, volatile uint8_t* ptr)   { return sm_sim_core_strex(ptr, value, 1); }
+__STATIC_FORCEINLINE uint32_t __STLEXH(uint16_t value, volatile uint16_t* ptr) { return sm_sim_core_strex(ptr, value, 2); }
+__STATIC_FORCEINLINE uint32_t __STLEX(uint32_t value, volatile uint32_t* ptr)  { return sm_sim_core_strex(ptr, value, 4); }
+
+__STATIC_FORCEINLINE uint8_t __LDAB(volatile uint8_t* ptr)      { uint8_t v = *ptr; __DMB(); return v; }
+__STATIC_FORCEINLINE uint16_t __LDAH(volatile uint16_t* ptr)    { uint16_t v = *ptr; __DMB(); return v; }
+__STATIC_FORCEINLINE uint32_t __LDA(volatile uint32_t* ptr)     { uint32_t v = *ptr; __DMB(); return v; }
+__STATIC_FORCEINLINE void __STLB(uint8_t value, volatile uint8_t* ptr)   { __DMB(); *ptr = value; }
+__STATIC_FORCEINLINE void __STLH(uint16_t value, volatile uint16_t* ptr) { __DMB(); *ptr = value; }
+__STATIC_FORCEINLINE void __STL(uint32_t value, volatile uint32_t* ptr)  { __DMB(); *ptr = value; }
+
+#endif /* HOST_INCLUDE_CMSIS_COMPILER_H_ */
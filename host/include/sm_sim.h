@@ -0,0 +1,95 @@
+/*
+ * sm_sim.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef HOST_INCLUDE_SM_SIM_H_
+#define HOST_INCLUDE_SM_SIM_H_
+
+#include "stdint.h"
+
+/*
+ * Host simulator: runs the unmodified firmware sources on Linux x86-64.
+ *
+ * The peripheral window (0x40000000) and the System Control Space
+ * (0xE000E000) are mapped at their M253 addresses but kept inaccessible, so
+ * every register access from the drivers faults. The fault handler lets the
+ * register model refresh the value, single-steps the access and then hands a
+ * write to the model, which is how W1C flags, FIFOs and ISP triggers behave
+ * as on the chip without touching Library/StdDriver or User/.
+ *
+ * Time is virtual: every register access costs sm_sim_set_access_cost() ns,
+ * a register polled in a loop lets time jump to the next model event, and
+ * WFI sleeps until one. Interrupts are taken between two register accesses,
+ * following NVIC enables, priorities and PRIMASK, and call the regular
+ * xxx_IRQHandler() symbols of the firmware.
+ *
+ * APROM is a 128K array also mapped read only at its real address, so
+ * flash pointers work (except the first 4K, below the host mmap_min_addr).
+ * It lives in the file named by SM_SIM_FLASH if set, and survives
+ * NVIC_SystemReset(), which restarts the process like a chip reset.
+ *
+ * Buffers given to PDMA or compared as uint32_t must sit below 4G: the host
+ * build links with -no-pie and such buffers are static, as on the target.
+ */
+
+#define SM_SIM_NS_PER_US              1000ULL
+#define SM_SIM_NS_PER_MS              1000000ULL
+#define SM_SIM_NS_PER_S               1000000000ULL
+
+#define SM_SIM_UART_NUM               5
+#define SM_SIM_GPIO_PORT_NUM          6
+#define SM_SIM_EADC_CHANNEL_NUM       16
+
+typedef void (*sm_sim_event_fn_t)(void* _arg);
+typedef void (*sm_sim_uart_tx_fn_t)(uint8_t _uart, uint8_t _byte, void* _arg);
+typedef void (*sm_sim_gpio_fn_t)(uint8_t _port, uint8_t _pin, uint8_t _level, void* _arg);
+typedef uint16_t (*sm_sim_eadc_fn_t)(uint8_t _channel, uint64_t _now, void* _arg);
+
+/* Map the peripherals, install the fault handlers and reset every model */
+int32_t sm_sim_init(int _argc, char** _argv);
+
+/* Number of NVIC_SystemReset() the process went through */
+uint32_t sm_sim_get_reset_count(void);
+
+__attribute__((noreturn)) void sm_sim_exit(int32_t _code);
+
+/* Virtual time, ns since power on */
+uint64_t sm_sim_now(void);
+
+/* Let _ns of virtual time pass, taking the interrupts that fall due */
+void sm_sim_advance(uint64_t _ns);
+
+/* Cost of one register access, 0 freezes time outside sm_sim_advance() */
+void sm_sim_set_access_cost(uint32_t _ns);
+
+/* Call _fn from the simulated hardware after _delay_ns (stimulus for tests) */
+int32_t sm_sim_schedule(uint64_t _delay_ns, sm_sim_event_fn_t _fn, void* _arg);
+
+/* Raise an interrupt as a peripheral would (CANFD0 frames, BOD, ...) */
+void sm_sim_irq_pend(int32_t _irqn);
+
+/* Exceptions taken so far, by exception number (IRQn + 16) */
+uint32_t sm_sim_irq_count(int32_t _irqn);
+
+/* UART: received bytes arrive at the programmed baud rate */
+int32_t sm_sim_uart_inject(uint8_t _uart, const void* _data, uint32_t _len);
+uint32_t sm_sim_uart_take(uint8_t _uart, void* _buf, uint32_t _max);
+void sm_sim_uart_set_tx_hook(uint8_t _uart, sm_sim_uart_tx_fn_t _fn, void* _arg);
+
+/* GPIO: level driven onto input pins, and output changes */
+void sm_sim_gpio_set_input(uint8_t _port, uint8_t _pin, uint8_t _level);
+uint8_t sm_sim_gpio_get(uint8_t _port, uint8_t _pin);
+void sm_sim_gpio_set_hook(sm_sim_gpio_fn_t _fn, void* _arg);
+
+/* EADC: sample source, called at each conversion */
+void sm_sim_eadc_set_source(sm_sim_eadc_fn_t _fn, void* _arg);
+
+/* Flash backdoor (APROM, 128K) */
+uint8_t* sm_sim_flash(void);
+uint32_t sm_sim_flash_program_count(void);
+uint32_t sm_sim_flash_erase_count(void);
+
+#endif /* HOST_INCLUDE_SM_SIM_H_ */
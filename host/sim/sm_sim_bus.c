@@ -0,0 +1,228 @@
+/*
+ * sm_sim_bus.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*
+ * Register windows are backed by one shared memory object mapped twice: at the
+ * M253 address with no access rights (the bus the firmware sees) and anywhere
+ * read/write (the backdoor the models use). A CPU access faults, the handler
+ * opens that page for exactly one instruction with the x86 trap flag, and the
+ * single-step trap closes it again and reports the access to the model.
+ */
+
+#define SM_SIM_PAGE_SIZE              0x1000UL
+#define SM_SIM_TRAP_FLAG              0x100
+#define SM_SIM_PF_WRITE               0x2
+
+typedef struct sm_sim_window{
+	uint32_t m_base;
+	uint32_t m_size;
+	uint8_t* m_backdoor;
+}sm_sim_window_t;
+
+typedef struct sm_sim_bus_impl{
+	sm_sim_window_t m_window[2];
+	const sm_sim_model_t* m_model;
+	uint32_t m_addr;
+	uint8_t m_is_write;
+	uint8_t m_pending;
+}sm_sim_bus_impl_t;
+
+static sm_sim_bus_impl_t g_bus;
+
+const sm_sim_model_t* const g_sm_sim_models[] = {
+		&g_sm_sim_scs,
+		&g_sm_sim_sys,
+		&g_sm_sim_gpio,
+		&g_sm_sim_pdma,
+		&g_sm_sim_fmc,
+		&g_sm_sim_canfd,
+		&g_sm_sim_crc,
+		&g_sm_sim_eadc,
+		&g_sm_sim_timer,
+		&g_sm_sim_uart,
+};
+
+const uint32_t g_sm_sim_model_num = sizeof(g_sm_sim_models) / sizeof(g_sm_sim_models[0]);
+
+static sm_sim_window_t* sm_sim_bus_window(uintptr_t _addr){
+	for(uint32_t i = 0; i < 2; i++){
+		sm_sim_window_t* window = &g_bus.m_window[i];
+
+		if(_addr >= window->m_base && _addr - window->m_base < window->m_size)
+			return window;
+	}
+	return NULL;
+}
+
+static const sm_sim_model_t* sm_sim_bus_model(uint32_t _addr){
+	for(uint32_t i = 0; i < g_sm_sim_model_num; i++){
+		const sm_sim_model_t* model = g_sm_sim_models[i];
+
+		if(_addr >= model->m_base && _addr - model->m_base < model->m_size)
+			return model;
+	}
+	return NULL;
+}
+
+static void* sm_sim_bus_page(uint32_t _addr){
+	return (void*)(uintptr_t)(_addr & ~(SM_SIM_PAGE_SIZE - 1));
+}
+
+static void sm_sim_bus_fault(int _sig, siginfo_t* _info, void* _context){
+	ucontext_t* context = (ucontext_t*)_context;
+	uintptr_t fault = (uintptr_t)_info->si_addr;
+	(void)_sig;
+
+	if(!sm_sim_bus_window(fault) || g_bus.m_pending){
+		/* A real crash: let it happen again with the default action */
+		fprintf(stderr, "sm_sim: fault at 0x%lx\n", (unsigned long)fault);
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+
+	g_bus.m_addr = (uint32_t)fault;
+	g_bus.m_is_write = (context->uc_mcontext.gregs[REG_ERR] & SM_SIM_PF_WRITE) ? 1 : 0;
+	g_bus.m_model = sm_sim_bus_model(g_bus.m_addr);
+	g_bus.m_pending = 1;
+
+	if(g_bus.m_model && g_bus.m_model->m_read)
+		g_bus.m_model->m_read(g_bus.m_addr & ~0x3UL, g_bus.m_is_write);
+
+	mprotect(sm_sim_bus_page(g_bus.m_addr), SM_SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+	context->uc_mcontext.gregs[REG_EFL] |= SM_SIM_TRAP_FLAG;
+}
+
+static void sm_sim_bus_step(int _sig, siginfo_t* _info, void* _context){
+	ucontext_t* context = (ucontext_t*)_context;
+	(void)_sig;
+	(void)_info;
+
+	context->uc_mcontext.gregs[REG_EFL] &= ~SM_SIM_TRAP_FLAG;
+
+	if(!g_bus.m_pending)
+		return;
+
+	uint32_t addr = g_bus.m_addr;
+	uint8_t is_write = g_bus.m_is_write;
+	const sm_sim_model_t* model = g_bus.m_model;
+
+	mprotect(sm_sim_bus_page(addr), SM_SIM_PAGE_SIZE, PROT_NONE);
+	g_bus.m_pending = 0;
+
+	if(is_write && model && model->m_write){
+		uint32_t word = addr & ~0x3UL;
+		model->m_write(word, *(volatile uint32_t*)sm_sim_reg(word));
+	}
+
+	if(sm_sim_reset_requested())
+		sm_sim_reset();
+
+	/* Interrupts are taken here, between two accesses */
+	sm_sim_core_access(addr, is_write);
+}
+
+static int32_t sm_sim_bus_map(sm_sim_window_t* _window, int _fd, off_t _offset){
+	void* bus = mmap((void*)(uintptr_t)_window->m_base, _window->m_size, PROT_NONE,
+			MAP_SHARED | MAP_FIXED_NOREPLACE, _fd, _offset);
+
+	if(bus != (void*)(uintptr_t)_window->m_base)
+		return -1;
+
+	_window->m_backdoor = mmap(NULL, _window->m_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, _offset);
+	if(_window->m_backdoor == MAP_FAILED)
+		return -1;
+
+	return 0;
+}
+
+int32_t sm_sim_bus_init(void){
+	int fd = memfd_create("sm_sim_regs", MFD_CLOEXEC);
+
+	if(fd < 0 || ftruncate(fd, SM_SIM_PERIPH_SIZE + SM_SIM_SCS_SIZE) < 0)
+		return -1;
+
+	g_bus.m_window[0].m_base = SM_SIM_PERIPH_BASE;
+	g_bus.m_window[0].m_size = SM_SIM_PERIPH_SIZE;
+	g_bus.m_window[1].m_base = SM_SIM_SCS_BASE;
+	g_bus.m_window[1].m_size = SM_SIM_SCS_SIZE;
+
+	if(sm_sim_bus_map(&g_bus.m_window[0], fd, 0) < 0 ||
+			sm_sim_bus_map(&g_bus.m_window[1], fd, SM_SIM_PERIPH_SIZE) < 0){
+		close(fd);
+		return -1;
+	}
+	close(fd);
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	sigemptyset(&action.sa_mask);
+
+	/* NODEFER: an interrupt taken in the step handler accesses registers too */
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;
+	action.sa_sigaction = sm_sim_bus_fault;
+	if(sigaction(SIGSEGV, &action, NULL) < 0)
+		return -1;
+
+	action.sa_sigaction = sm_sim_bus_step;
+	if(sigaction(SIGTRAP, &action, NULL) < 0)
+		return -1;
+
+	return 0;
+}
+
+void* sm_sim_reg(uint32_t _addr){
+	sm_sim_window_t* window = sm_sim_bus_window(_addr);
+
+	if(!window)
+		return NULL;
+
+	return window->m_backdoor + (_addr - window->m_base);
+}
+
+uint32_t sm_sim_bus_read(uint32_t _addr, uint8_t _size){
+	const void* src = (const void*)(uintptr_t)_addr;
+	uint32_t value = 0;
+
+	if(sm_sim_bus_window(_addr)){
+		const sm_sim_model_t* model = sm_sim_bus_model(_addr);
+
+		if(model && model->m_read)
+			model->m_read(_addr & ~0x3UL, 0);
+
+		src = sm_sim_reg(_addr);
+	}
+
+	memcpy(&value, src, _size);
+	return value;
+}
+
+void sm_sim_bus_write(uint32_t _addr, uint32_t _value, uint8_t _size){
+	if(!sm_sim_bus_window(_addr)){
+		memcpy((void*)(uintptr_t)_addr, &_value, _size);
+		return;
+	}
+
+	const sm_sim_model_t* model = sm_sim_bus_model(_addr);
+	uint32_t word = _addr & ~0x3UL;
+
+	if(model && model->m_read)
+		model->m_read(word, 1);
+
+	memcpy(sm_sim_reg(_addr), &_value, _size);
+
+	if(model && model->m_write)
+		model->m_write(word, *(volatile uint32_t*)sm_sim_reg(word));
+}
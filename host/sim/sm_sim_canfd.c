@@ -0,0 +1,123 @@
+/*
+ * sm_sim_canfd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * CANFD0, enough for the driver to configure and send: INIT/CCE take effect at
+ * once, a TX buffer added with TXBAR stays pending in TXBRP for one frame time,
+ * then sets TXBTO and IR.TC. IR drives the two interrupt lines through
+ * IE/ILS/ILE. The message RAM is plain memory; nothing is ever received.
+ */
+
+#define SM_SIM_CANFD_SIZE             0x200UL
+#define SM_SIM_CANFD_FRAME_NS         (250 * SM_SIM_NS_PER_US)   /* about 125 bits at 500 kbit/s */
+
+typedef struct sm_sim_canfd_impl{
+	uint32_t m_ir;
+	uint32_t m_txbrp;
+	uint32_t m_txbto;
+	uint64_t m_done;
+}sm_sim_canfd_impl_t;
+
+static sm_sim_canfd_impl_t g_canfd;
+
+static CANFD_T* sm_sim_canfd_regs(void){
+	return SM_SIM_REG(CANFD_T, CANFD_BASE);
+}
+
+static void sm_sim_canfd_refresh(void){
+	CANFD_T* regs = sm_sim_canfd_regs();
+	uint32_t active = g_canfd.m_ir & regs->IE;
+
+	regs->IR = g_canfd.m_ir;
+	regs->TXBRP = g_canfd.m_txbrp;
+	regs->TXBTO = g_canfd.m_txbto;
+	regs->TXBAR = 0;
+
+	sm_sim_irq_set_level(CANFD0_IRQ0_IRQn, (active & ~regs->ILS) && (regs->ILE & CANFD_ILE_ENT0_Msk));
+	sm_sim_irq_set_level(CANFD0_IRQ1_IRQn, (active & regs->ILS) && (regs->ILE & CANFD_ILE_ENT1_Msk));
+}
+
+static void sm_sim_canfd_reset(void){
+	memset(sm_sim_reg(CANFD_BASE), 0, SM_SIM_CANFD_SIZE);
+	memset(&g_canfd, 0, sizeof(g_canfd));
+
+	sm_sim_canfd_regs()->CCCR = CANFD_CCCR_INIT_Msk;
+	sm_sim_canfd_refresh();
+}
+
+static void sm_sim_canfd_write(uint32_t _addr, uint32_t _value){
+	CANFD_T* regs = sm_sim_canfd_regs();
+
+	switch(_addr - CANFD_BASE){
+	case offsetof(CANFD_T, CCCR):
+		/* CCE can only be set in INIT */
+		if(!(_value & CANFD_CCCR_INIT_Msk))
+			regs->CCCR = _value & ~CANFD_CCCR_CCE_Msk;
+		break;
+
+	case offsetof(CANFD_T, IR):
+		g_canfd.m_ir &= ~_value;
+		break;
+
+	case offsetof(CANFD_T, TXBAR):
+		if(!(regs->CCCR & CANFD_CCCR_INIT_Msk)){
+			if(!g_canfd.m_txbrp)
+				g_canfd.m_done = sm_sim_now() + SM_SIM_CANFD_FRAME_NS;
+			g_canfd.m_txbrp |= _value;
+			g_canfd.m_txbto &= ~_value;
+		}
+		break;
+
+	case offsetof(CANFD_T, TXBCR):
+		g_canfd.m_txbrp &= ~_value;
+		regs->TXBCF |= _value;
+		regs->TXBCR = 0;
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_canfd_refresh();
+}
+
+static uint64_t sm_sim_canfd_next_event(void){
+	return g_canfd.m_txbrp ? g_canfd.m_done : SM_SIM_EVENT_NONE;
+}
+
+/* Buffers go out one per frame time, lowest index first */
+static void sm_sim_canfd_update(uint64_t _now){
+	CANFD_T* regs = sm_sim_canfd_regs();
+
+	while(g_canfd.m_txbrp && g_canfd.m_done <= _now){
+		uint32_t buffer = g_canfd.m_txbrp & (~g_canfd.m_txbrp + 1);
+
+		g_canfd.m_txbrp &= ~buffer;
+		g_canfd.m_txbto |= buffer;
+		if(regs->TXBTIE & buffer)
+			g_canfd.m_ir |= CANFD_IR_TC_Msk;
+
+		g_canfd.m_done += SM_SIM_CANFD_FRAME_NS;
+	}
+
+	sm_sim_canfd_refresh();
+}
+
+const sm_sim_model_t g_sm_sim_canfd = {
+		.m_name = "CANFD",
+		.m_base = CANFD_BASE,
+		.m_size = SM_SIM_CANFD_SIZE,
+		.m_reset = sm_sim_canfd_reset,
+		.m_write = sm_sim_canfd_write,
+		.m_next_event = sm_sim_canfd_next_event,
+		.m_update = sm_sim_canfd_update,
+};
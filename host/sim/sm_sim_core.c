@@ -0,0 +1,804 @@
+/*
+ * sm_sim_core.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Simulated Cortex-M23 core: virtual time, NVIC/SCB/SysTick, exception entry
+ * and the intrinsics of host/include/cmsis_compiler.h.
+ */
+
+#define SM_SIM_ACCESS_NS_DEFAULT      42      /* two HCLK cycles at 48MHz */
+#define SM_SIM_POLL_LIMIT             4       /* same register read in a row before time skips */
+#define SM_SIM_SCHEDULE_NUM           16
+#define SM_SIM_NEST_MAX               16
+#define SM_SIM_PRIO_THREAD            256
+
+#define SM_SIM_EXC_NMI                2
+#define SM_SIM_EXC_HARDFAULT          3
+#define SM_SIM_EXC_SVCALL             11
+#define SM_SIM_EXC_PENDSV             14
+#define SM_SIM_EXC_SYSTICK            15
+#define SM_SIM_EXC_IRQ(irqn)          ((uint32_t)((irqn) + 16))
+
+#define SM_SIM_AIRCR_VECTKEY          0x05FAUL
+
+typedef void (*sm_sim_handler_t)(void);
+
+#define SM_SIM_WEAK_HANDLER(name)     extern void name(void) __attribute__((weak));
+SM_SIM_WEAK_HANDLER(NMI_Handler)
+SM_SIM_WEAK_HANDLER(HardFault_Handler)
+SM_SIM_WEAK_HANDLER(SVC_Handler)
+SM_SIM_WEAK_HANDLER(PendSV_Handler)
+SM_SIM_WEAK_HANDLER(SysTick_Handler)
+SM_SIM_WEAK_HANDLER(BOD_IRQHandler)
+SM_SIM_WEAK_HANDLER(IRCTRIM_IRQHandler)
+SM_SIM_WEAK_HANDLER(PWRWU_IRQHandler)
+SM_SIM_WEAK_HANDLER(CLKFAIL_IRQHandler)
+SM_SIM_WEAK_HANDLER(RTC_IRQHandler)
+SM_SIM_WEAK_HANDLER(WDT_IRQHandler)
+SM_SIM_WEAK_HANDLER(WWDT_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT0_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT1_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT2_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT3_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT4_IRQHandler)
+SM_SIM_WEAK_HANDLER(EINT5_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPA_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPB_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPC_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPD_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPE_IRQHandler)
+SM_SIM_WEAK_HANDLER(GPF_IRQHandler)
+SM_SIM_WEAK_HANDLER(SPI0_IRQHandler)
+SM_SIM_WEAK_HANDLER(CANFD0_IRQ0_IRQHandler)
+SM_SIM_WEAK_HANDLER(CANFD0_IRQ1_IRQHandler)
+SM_SIM_WEAK_HANDLER(TMR0_IRQHandler)
+SM_SIM_WEAK_HANDLER(TMR1_IRQHandler)
+SM_SIM_WEAK_HANDLER(TMR2_IRQHandler)
+SM_SIM_WEAK_HANDLER(TMR3_IRQHandler)
+SM_SIM_WEAK_HANDLER(UART0_IRQHandler)
+SM_SIM_WEAK_HANDLER(UART1_IRQHandler)
+SM_SIM_WEAK_HANDLER(I2C0_IRQHandler)
+SM_SIM_WEAK_HANDLER(I2C1_IRQHandler)
+SM_SIM_WEAK_HANDLER(PDMA_IRQHandler)
+SM_SIM_WEAK_HANDLER(EADC_INT0_IRQHandler)
+SM_SIM_WEAK_HANDLER(EADC_INT1_IRQHandler)
+SM_SIM_WEAK_HANDLER(BPWM0_IRQHandler)
+SM_SIM_WEAK_HANDLER(EADC_INT2_IRQHandler)
+SM_SIM_WEAK_HANDLER(EADC_INT3_IRQHandler)
+SM_SIM_WEAK_HANDLER(UART2_IRQHandler)
+SM_SIM_WEAK_HANDLER(UART3_IRQHandler)
+SM_SIM_WEAK_HANDLER(USCI0_IRQHandler)
+SM_SIM_WEAK_HANDLER(UART4_IRQHandler)
+SM_SIM_WEAK_HANDLER(USBD_IRQHandler)
+
+static const sm_sim_handler_t g_sm_sim_handlers[SM_SIM_EXC_NUM] = {
+		[SM_SIM_EXC_NMI] = NMI_Handler,
+		[SM_SIM_EXC_HARDFAULT] = HardFault_Handler,
+		[SM_SIM_EXC_SVCALL] = SVC_Handler,
+		[SM_SIM_EXC_PENDSV] = PendSV_Handler,
+		[SM_SIM_EXC_SYSTICK] = SysTick_Handler,
+		[SM_SIM_EXC_IRQ(BOD_IRQn)] = BOD_IRQHandler,
+		[SM_SIM_EXC_IRQ(IRCTRIM_IRQn)] = IRCTRIM_IRQHandler,
+		[SM_SIM_EXC_IRQ(PWRWU_IRQn)] = PWRWU_IRQHandler,
+		[SM_SIM_EXC_IRQ(CLKFAIL_IRQn)] = CLKFAIL_IRQHandler,
+		[SM_SIM_EXC_IRQ(RTC_IRQn)] = RTC_IRQHandler,
+		[SM_SIM_EXC_IRQ(WDT_IRQn)] = WDT_IRQHandler,
+		[SM_SIM_EXC_IRQ(WWDT_IRQn)] = WWDT_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT0_IRQn)] = EINT0_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT1_IRQn)] = EINT1_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT2_IRQn)] = EINT2_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT3_IRQn)] = EINT3_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT4_IRQn)] = EINT4_IRQHandler,
+		[SM_SIM_EXC_IRQ(EINT5_IRQn)] = EINT5_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPA_IRQn)] = GPA_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPB_IRQn)] = GPB_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPC_IRQn)] = GPC_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPD_IRQn)] = GPD_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPE_IRQn)] = GPE_IRQHandler,
+		[SM_SIM_EXC_IRQ(GPF_IRQn)] = GPF_IRQHandler,
+		[SM_SIM_EXC_IRQ(SPI0_IRQn)] = SPI0_IRQHandler,
+		[SM_SIM_EXC_IRQ(CANFD0_IRQ0_IRQn)] = CANFD0_IRQ0_IRQHandler,
+		[SM_SIM_EXC_IRQ(CANFD0_IRQ1_IRQn)] = CANFD0_IRQ1_IRQHandler,
+		[SM_SIM_EXC_IRQ(TMR0_IRQn)] = TMR0_IRQHandler,
+		[SM_SIM_EXC_IRQ(TMR1_IRQn)] = TMR1_IRQHandler,
+		[SM_SIM_EXC_IRQ(TMR2_IRQn)] = TMR2_IRQHandler,
+		[SM_SIM_EXC_IRQ(TMR3_IRQn)] = TMR3_IRQHandler,
+		[SM_SIM_EXC_IRQ(UART0_IRQn)] = UART0_IRQHandler,
+		[SM_SIM_EXC_IRQ(UART1_IRQn)] = UART1_IRQHandler,
+		[SM_SIM_EXC_IRQ(I2C0_IRQn)] = I2C0_IRQHandler,
+		[SM_SIM_EXC_IRQ(I2C1_IRQn)] = I2C1_IRQHandler,
+		[SM_SIM_EXC_IRQ(PDMA_IRQn)] = PDMA_IRQHandler,
+		[SM_SIM_EXC_IRQ(EADC_INT0_IRQn)] = EADC_INT0_IRQHandler,
+		[SM_SIM_EXC_IRQ(EADC_INT1_IRQn)] = EADC_INT1_IRQHandler,
+		[SM_SIM_EXC_IRQ(BPWM0_IRQn)] = BPWM0_IRQHandler,
+		[SM_SIM_EXC_IRQ(EADC_INT2_IRQn)] = EADC_INT2_IRQHandler,
+		[SM_SIM_EXC_IRQ(EADC_INT3_IRQn)] = EADC_INT3_IRQHandler,
+		[SM_SIM_EXC_IRQ(UART2_IRQn)] = UART2_IRQHandler,
+		[SM_SIM_EXC_IRQ(UART3_IRQn)] = UART3_IRQHandler,
+		[SM_SIM_EXC_IRQ(USCI0_IRQn)] = USCI0_IRQHandler,
+		[SM_SIM_EXC_IRQ(UART4_IRQn)] = UART4_IRQHandler,
+		[SM_SIM_EXC_IRQ(USBD_IRQn)] = USBD_IRQHandler,
+};
+
+/* Image vector table SystemInit() points VTOR at, never executed */
+uint32_t __Vectors[SM_SIM_EXC_NUM];
+
+typedef struct sm_sim_schedule{
+	uint64_t m_at;
+	sm_sim_event_fn_t m_fn;
+	void* m_arg;
+}sm_sim_schedule_t;
+
+typedef struct sm_sim_core_impl{
+	uint64_t m_now;
+	uint32_t m_access_ns;
+	uint32_t m_primask;
+	uint32_t m_reg[SM_SIM_CORE_REG_NUM];
+
+	uint64_t m_enable;
+	uint64_t m_level;
+	uint8_t m_pending[SM_SIM_EXC_NUM];
+	uint8_t m_nest;
+	uint8_t m_active[SM_SIM_NEST_MAX];
+	int32_t m_active_prio[SM_SIM_NEST_MAX];
+	uint32_t m_count[SM_SIM_EXC_NUM];
+	uint32_t m_taken;
+
+	volatile void* m_excl_addr;
+	uint8_t m_excl_valid;
+
+	uint32_t m_poll_addr;
+	uint32_t m_poll_count;
+
+	uint32_t m_st_ctrl;
+	uint32_t m_st_load;
+	uint32_t m_st_hz;
+	uint64_t m_st_base;
+	uint32_t m_st_base_val;
+	uint64_t m_st_zero;           /* cycles after m_st_base of the next 1 -> 0 */
+
+	sm_sim_schedule_t m_schedule[SM_SIM_SCHEDULE_NUM];
+
+	uint8_t m_reset_request;
+	uint32_t m_reset_count;
+	char** m_argv;
+}sm_sim_core_impl_t;
+
+static sm_sim_core_impl_t g_core;
+
+uint64_t sm_sim_cycles_to_ns(uint64_t _cycles, uint32_t _hz){
+	if(!_hz)
+		return SM_SIM_EVENT_NONE;
+
+	return (_cycles / _hz) * SM_SIM_NS_PER_S + (_cycles % _hz) * SM_SIM_NS_PER_S / _hz;
+}
+
+uint64_t sm_sim_ns_to_cycles(uint64_t _ns, uint32_t _hz){
+	return (_ns / SM_SIM_NS_PER_S) * _hz + (_ns % SM_SIM_NS_PER_S) * _hz / SM_SIM_NS_PER_S;
+}
+
+/*
+ * Exceptions
+ */
+
+static int32_t sm_sim_core_priority(uint32_t _exc){
+	if(_exc == SM_SIM_EXC_NMI)
+		return -2;
+	if(_exc == SM_SIM_EXC_HARDFAULT)
+		return -1;
+
+	if(_exc >= 16){
+		uint32_t irq = _exc - 16;
+		return (int32_t)((SM_SIM_REG(NVIC_Type, NVIC_BASE)->IPR[irq >> 2] >> ((irq & 3) * 8)) & 0xFF) >>
+				(8 - __NVIC_PRIO_BITS);
+	}
+
+	return (int32_t)((SM_SIM_REG(SCB_Type, SCB_BASE)->SHPR[(_exc - 8) >> 2] >> ((_exc & 3) * 8)) & 0xFF) >>
+			(8 - __NVIC_PRIO_BITS);
+}
+
+static uint8_t sm_sim_core_enabled(uint32_t _exc){
+	if(_exc < 16)
+		return 1;
+
+	return (g_core.m_enable >> (_exc - 16)) & 1;
+}
+
+static int32_t sm_sim_core_current_priority(void){
+	int32_t prio = SM_SIM_PRIO_THREAD;
+
+	for(uint8_t i = 0; i < g_core.m_nest; i++){
+		if(g_core.m_active_prio[i] < prio)
+			prio = g_core.m_active_prio[i];
+	}
+	return prio;
+}
+
+/* Highest priority pending and enabled exception, ties to the lowest number */
+static int32_t sm_sim_core_highest_pending(int32_t* _prio){
+	int32_t best = -1;
+	int32_t best_prio = SM_SIM_PRIO_THREAD;
+
+	for(uint32_t exc = SM_SIM_EXC_NMI; exc < SM_SIM_EXC_NUM; exc++){
+		if(!g_core.m_pending[exc] || !sm_sim_core_enabled(exc))
+			continue;
+
+		int32_t prio = sm_sim_core_priority(exc);
+		if(prio < best_prio){
+			best = (int32_t)exc;
+			best_prio = prio;
+		}
+	}
+
+	if(_prio)
+		*_prio = best_prio;
+	return best;
+}
+
+void sm_sim_core_dispatch(void){
+	while(!g_core.m_primask && g_core.m_nest < SM_SIM_NEST_MAX){
+		int32_t prio;
+		int32_t exc = sm_sim_core_highest_pending(&prio);
+
+		if(exc < 0 || prio >= sm_sim_core_current_priority())
+			return;
+
+		sm_sim_handler_t handler = g_sm_sim_handlers[exc];
+		if(!handler){
+			fprintf(stderr, "sm_sim: no handler for exception %d\n", exc);
+			sm_sim_exit(1);
+		}
+
+		g_core.m_pending[exc] = 0;
+		g_core.m_active[g_core.m_nest] = (uint8_t)exc;
+		g_core.m_active_prio[g_core.m_nest] = prio;
+		g_core.m_nest++;
+		g_core.m_count[exc]++;
+		g_core.m_taken++;
+		g_core.m_excl_valid = 0;
+
+		handler();
+
+		g_core.m_nest--;
+		g_core.m_excl_valid = 0;
+
+		/* A level still held on exception return pends again */
+		if(exc >= 16 && ((g_core.m_level >> (exc - 16)) & 1))
+			g_core.m_pending[exc] = 1;
+	}
+}
+
+void sm_sim_irq_set_level(int32_t _irqn, uint8_t _level){
+	uint64_t bit = 1ULL << _irqn;
+
+	if(_level){
+		if(!(g_core.m_level & bit))
+			g_core.m_pending[SM_SIM_EXC_IRQ(_irqn)] = 1;
+		g_core.m_level |= bit;
+	}else{
+		g_core.m_level &= ~bit;
+	}
+}
+
+void sm_sim_irq_pend(int32_t _irqn){
+	if(_irqn < -14 || _irqn >= 64)
+		return;
+
+	g_core.m_pending[SM_SIM_EXC_IRQ(_irqn)] = 1;
+}
+
+uint32_t sm_sim_irq_count(int32_t _irqn){
+	if(_irqn < -14 || _irqn >= 64)
+		return 0;
+
+	return g_core.m_count[SM_SIM_EXC_IRQ(_irqn)];
+}
+
+/*
+ * SysTick, counting HCLK or the CLKSEL0.STCLKSEL reference
+ */
+
+static uint32_t sm_sim_systick_hz(void){
+	if(g_core.m_st_ctrl & SysTick_CTRL_CLKSOURCE_Msk)
+		return sm_sim_clk_hclk();
+
+	switch((SM_SIM_REG(CLK_T, CLK_BASE)->CLKSEL0 & CLK_CLKSEL0_STCLKSEL_Msk) >> CLK_CLKSEL0_STCLKSEL_Pos){
+	case 0:  return __HXT;
+	case 1:  return __LXT;
+	case 2:  return __HXT / 2;
+	case 3:  return sm_sim_clk_hclk() / 2;
+	default: return __HIRC / 2;
+	}
+}
+
+static uint8_t sm_sim_systick_running(void){
+	return (g_core.m_st_ctrl & SysTick_CTRL_ENABLE_Msk) && g_core.m_st_load;
+}
+
+static uint32_t sm_sim_systick_value(uint64_t _now){
+	if(!sm_sim_systick_running())
+		return g_core.m_st_base_val;
+
+	uint64_t cycles = sm_sim_ns_to_cycles(_now - g_core.m_st_base, g_core.m_st_hz);
+	uint64_t period = (uint64_t)g_core.m_st_load + 1;
+
+	if(cycles <= g_core.m_st_base_val)
+		return (uint32_t)(g_core.m_st_base_val - cycles);
+
+	return (uint32_t)(g_core.m_st_load - (cycles - g_core.m_st_base_val - 1) % period);
+}
+
+static void sm_sim_systick_restart(uint64_t _now, uint32_t _value){
+	g_core.m_st_base_val = _value;
+	g_core.m_st_base = _now;
+	g_core.m_st_hz = sm_sim_systick_hz();
+	g_core.m_st_zero = _value ? _value : (uint64_t)g_core.m_st_load + 1;
+}
+
+/* Count on from the current value, after a clock change */
+static void sm_sim_systick_rebase(uint64_t _now){
+	sm_sim_systick_restart(_now, sm_sim_systick_value(_now));
+}
+
+static uint64_t sm_sim_systick_next(void){
+	if(!sm_sim_systick_running() || !(g_core.m_st_ctrl & SysTick_CTRL_TICKINT_Msk))
+		return SM_SIM_EVENT_NONE;
+
+	return g_core.m_st_base + sm_sim_cycles_to_ns(g_core.m_st_zero, g_core.m_st_hz);
+}
+
+static void sm_sim_systick_update(uint64_t _now){
+	if(!sm_sim_systick_running())
+		return;
+
+	if(g_core.m_st_hz != sm_sim_systick_hz())
+		sm_sim_systick_rebase(_now);
+
+	uint64_t cycles = sm_sim_ns_to_cycles(_now - g_core.m_st_base, g_core.m_st_hz);
+	if(cycles < g_core.m_st_zero)
+		return;
+
+	/* Wraps the handler could not keep up with collapse into one, as on the core */
+	uint64_t period = (uint64_t)g_core.m_st_load + 1;
+	g_core.m_st_zero += ((cycles - g_core.m_st_zero) / period + 1) * period;
+	g_core.m_st_ctrl |= SysTick_CTRL_COUNTFLAG_Msk;
+
+	if(g_core.m_st_ctrl & SysTick_CTRL_TICKINT_Msk)
+		g_core.m_pending[SM_SIM_EXC_SYSTICK] = 1;
+}
+
+/*
+ * System Control Space register model
+ */
+
+static void sm_sim_scs_reset(void){
+	memset(sm_sim_reg(SM_SIM_SCS_BASE), 0, SM_SIM_SCS_SIZE);
+
+	SCB_Type* scb = SM_SIM_REG(SCB_Type, SCB_BASE);
+	SM_SIM_RO(scb->CPUID) = 0x411FD200UL;
+	scb->AIRCR = 0xFA050000UL;
+
+	SM_SIM_RO(SM_SIM_REG(SysTick_Type, SysTick_BASE)->CALIB) = 0x80000000UL;
+}
+
+static void sm_sim_scs_read(uint32_t _addr, uint8_t _is_write){
+	NVIC_Type* nvic = SM_SIM_REG(NVIC_Type, NVIC_BASE);
+	SCB_Type* scb = SM_SIM_REG(SCB_Type, SCB_BASE);
+	SysTick_Type* systick = SM_SIM_REG(SysTick_Type, SysTick_BASE);
+
+	if(_addr >= SM_SIM_ADDR(&NVIC->ISER[0]) && _addr < SM_SIM_ADDR(&NVIC->IPR[0])){
+		for(uint32_t i = 0; i < 2; i++){
+			uint32_t pending = 0, active = 0;
+
+			for(uint32_t bit = 0; bit < 32; bit++){
+				pending |= (uint32_t)g_core.m_pending[16 + i * 32 + bit] << bit;
+			}
+			for(uint8_t n = 0; n < g_core.m_nest; n++){
+				uint32_t irq = (uint32_t)g_core.m_active[n] - 16;
+				if(g_core.m_active[n] >= 16 && irq / 32 == i)
+					active |= 1UL << (irq % 32);
+			}
+
+			nvic->ISER[i] = nvic->ICER[i] = (uint32_t)(g_core.m_enable >> (i * 32));
+			nvic->ISPR[i] = nvic->ICPR[i] = pending;
+			nvic->IABR[i] = active;
+		}
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SCB->ICSR)){
+		int32_t pending = sm_sim_core_highest_pending(NULL);
+		uint32_t icsr = sm_sim_core_get_ipsr();
+
+		if(pending > 0)
+			icsr |= (uint32_t)pending << SCB_ICSR_VECTPENDING_Pos;
+		if(g_core.m_level)
+			icsr |= SCB_ICSR_ISRPENDING_Msk;
+		if(g_core.m_pending[SM_SIM_EXC_PENDSV])
+			icsr |= SCB_ICSR_PENDSVSET_Msk;
+		if(g_core.m_pending[SM_SIM_EXC_SYSTICK])
+			icsr |= SCB_ICSR_PENDSTSET_Msk;
+
+		scb->ICSR = icsr;
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SysTick->CTRL)){
+		sm_sim_systick_update(g_core.m_now);
+		systick->CTRL = g_core.m_st_ctrl;
+
+		/* COUNTFLAG clears when read */
+		if(!_is_write)
+			g_core.m_st_ctrl &= ~SysTick_CTRL_COUNTFLAG_Msk;
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SysTick->VAL)){
+		systick->VAL = sm_sim_systick_value(g_core.m_now);
+		return;
+	}
+}
+
+static void sm_sim_scs_write(uint32_t _addr, uint32_t _value){
+	NVIC_Type* nvic = SM_SIM_REG(NVIC_Type, NVIC_BASE);
+	SCB_Type* scb = SM_SIM_REG(SCB_Type, SCB_BASE);
+	SysTick_Type* systick = SM_SIM_REG(SysTick_Type, SysTick_BASE);
+
+	for(uint32_t i = 0; i < 2; i++){
+		if(_addr == SM_SIM_ADDR(&NVIC->ISER[i])){
+			g_core.m_enable |= (uint64_t)_value << (i * 32);
+		}else if(_addr == SM_SIM_ADDR(&NVIC->ICER[i])){
+			g_core.m_enable &= ~((uint64_t)_value << (i * 32));
+		}else if(_addr == SM_SIM_ADDR(&NVIC->ISPR[i]) || _addr == SM_SIM_ADDR(&NVIC->ICPR[i])){
+			uint8_t set = _addr == SM_SIM_ADDR(&NVIC->ISPR[i]);
+
+			for(uint32_t bit = 0; bit < 32; bit++){
+				if(!(_value & (1UL << bit)))
+					continue;
+
+				uint32_t irq = i * 32 + bit;
+				/* A held level pends again straight away */
+				g_core.m_pending[16 + irq] = set || ((g_core.m_level >> irq) & 1);
+			}
+		}else{
+			continue;
+		}
+
+		nvic->ISER[i] = nvic->ICER[i] = (uint32_t)(g_core.m_enable >> (i * 32));
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SCB->ICSR)){
+		if(_value & SCB_ICSR_PENDSVSET_Msk)
+			g_core.m_pending[SM_SIM_EXC_PENDSV] = 1;
+		if(_value & SCB_ICSR_PENDSVCLR_Msk)
+			g_core.m_pending[SM_SIM_EXC_PENDSV] = 0;
+		if(_value & SCB_ICSR_PENDSTSET_Msk)
+			g_core.m_pending[SM_SIM_EXC_SYSTICK] = 1;
+		if(_value & SCB_ICSR_PENDSTCLR_Msk)
+			g_core.m_pending[SM_SIM_EXC_SYSTICK] = 0;
+		if(_value & SCB_ICSR_PENDNMISET_Msk)
+			g_core.m_pending[SM_SIM_EXC_NMI] = 1;
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SCB->AIRCR)){
+		if((_value >> SCB_AIRCR_VECTKEY_Pos) == SM_SIM_AIRCR_VECTKEY && (_value & SCB_AIRCR_SYSRESETREQ_Msk))
+			g_core.m_reset_request = 1;
+
+		scb->AIRCR = 0xFA050000UL | (_value & ~SCB_AIRCR_VECTKEY_Msk & ~SCB_AIRCR_SYSRESETREQ_Msk);
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SysTick->CTRL)){
+		sm_sim_systick_update(g_core.m_now);
+
+		uint32_t value = sm_sim_systick_value(g_core.m_now);
+		g_core.m_st_ctrl = (g_core.m_st_ctrl & SysTick_CTRL_COUNTFLAG_Msk) |
+				(_value & (SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_CLKSOURCE_Msk));
+		sm_sim_systick_restart(g_core.m_now, value);
+		systick->CTRL = g_core.m_st_ctrl;
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SysTick->LOAD)){
+		g_core.m_st_load = _value & SysTick_LOAD_RELOAD_Msk;
+		systick->LOAD = g_core.m_st_load;
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&SysTick->VAL)){
+		/* Any write clears the counter and COUNTFLAG, it reloads on the next clock */
+		g_core.m_st_ctrl &= ~SysTick_CTRL_COUNTFLAG_Msk;
+		sm_sim_systick_restart(g_core.m_now, 0);
+		systick->VAL = 0;
+		return;
+	}
+}
+
+static uint64_t sm_sim_scs_next_event(void){
+	return sm_sim_systick_next();
+}
+
+static void sm_sim_scs_update(uint64_t _now){
+	sm_sim_systick_update(_now);
+}
+
+const sm_sim_model_t g_sm_sim_scs = {
+		.m_name = "SCS",
+		.m_base = SM_SIM_SCS_BASE,
+		.m_size = SM_SIM_SCS_SIZE,
+		.m_reset = sm_sim_scs_reset,
+		.m_read = sm_sim_scs_read,
+		.m_write = sm_sim_scs_write,
+		.m_next_event = sm_sim_scs_next_event,
+		.m_update = sm_sim_scs_update,
+};
+
+/*
+ * Virtual time
+ */
+
+static uint64_t sm_sim_core_next_event(void){
+	uint64_t next = SM_SIM_EVENT_NONE;
+
+	for(uint32_t i = 0; i < g_sm_sim_model_num; i++){
+		if(!g_sm_sim_models[i]->m_next_event)
+			continue;
+
+		uint64_t event = g_sm_sim_models[i]->m_next_event();
+		if(event < next)
+			next = event;
+	}
+
+	for(uint32_t i = 0; i < SM_SIM_SCHEDULE_NUM; i++){
+		if(g_core.m_schedule[i].m_fn && g_core.m_schedule[i].m_at < next)
+			next = g_core.m_schedule[i].m_at;
+	}
+	return next;
+}
+
+static void sm_sim_core_update(void){
+	for(uint32_t i = 0; i < g_sm_sim_model_num; i++){
+		if(g_sm_sim_models[i]->m_update)
+			g_sm_sim_models[i]->m_update(g_core.m_now);
+	}
+
+	for(uint32_t i = 0; i < SM_SIM_SCHEDULE_NUM; i++){
+		sm_sim_schedule_t* event = &g_core.m_schedule[i];
+
+		if(event->m_fn && event->m_at <= g_core.m_now){
+			sm_sim_event_fn_t fn = event->m_fn;
+			event->m_fn = NULL;
+			fn(event->m_arg);
+		}
+	}
+}
+
+uint64_t sm_sim_now(void){
+	return g_core.m_now;
+}
+
+/* Step from event to event so that every interrupt is taken at its own time */
+void sm_sim_advance(uint64_t _ns){
+	uint64_t target = g_core.m_now + _ns;
+
+	for(;;){
+		uint64_t next = sm_sim_core_next_event();
+
+		if(next > target){
+			if(target > g_core.m_now)
+				g_core.m_now = target;
+
+			sm_sim_core_update();
+			sm_sim_core_dispatch();
+			return;
+		}
+
+		if(next > g_core.m_now)
+			g_core.m_now = next;
+
+		sm_sim_core_update();
+		sm_sim_core_dispatch();
+	}
+}
+
+void sm_sim_set_access_cost(uint32_t _ns){
+	g_core.m_access_ns = _ns;
+}
+
+int32_t sm_sim_schedule(uint64_t _delay_ns, sm_sim_event_fn_t _fn, void* _arg){
+	for(uint32_t i = 0; i < SM_SIM_SCHEDULE_NUM; i++){
+		if(!g_core.m_schedule[i].m_fn){
+			g_core.m_schedule[i].m_at = g_core.m_now + _delay_ns;
+			g_core.m_schedule[i].m_arg = _arg;
+			g_core.m_schedule[i].m_fn = _fn;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* Let time jump to the next event, nothing else can change meanwhile */
+static void sm_sim_core_idle(void){
+	uint64_t next = sm_sim_core_next_event();
+
+	if(next != SM_SIM_EVENT_NONE && next > g_core.m_now)
+		sm_sim_advance(next - g_core.m_now);
+}
+
+void sm_sim_core_access(uint32_t _addr, uint8_t _is_write){
+	if(!_is_write && _addr == g_core.m_poll_addr){
+		if(++g_core.m_poll_count >= SM_SIM_POLL_LIMIT){
+			g_core.m_poll_count = 0;
+			sm_sim_core_idle();
+		}
+	}else{
+		g_core.m_poll_addr = _is_write ? 0 : _addr;
+		g_core.m_poll_count = 0;
+	}
+
+	sm_sim_advance(g_core.m_access_ns);
+}
+
+/*
+ * Intrinsics
+ */
+
+uint32_t sm_sim_core_get_primask(void){
+	return g_core.m_primask;
+}
+
+void sm_sim_core_set_primask(uint32_t _primask){
+	g_core.m_primask = _primask;
+
+	if(!_primask)
+		sm_sim_core_dispatch();
+}
+
+uint32_t sm_sim_core_get_ipsr(void){
+	return g_core.m_nest ? g_core.m_active[g_core.m_nest - 1] : 0;
+}
+
+uint32_t sm_sim_core_get_reg(uint32_t _reg){
+	return _reg < SM_SIM_CORE_REG_NUM ? g_core.m_reg[_reg] : 0;
+}
+
+void sm_sim_core_set_reg(uint32_t _reg, uint32_t _value){
+	if(_reg < SM_SIM_CORE_REG_NUM)
+		g_core.m_reg[_reg] = _value;
+}
+
+/* WFI: sleep until an exception is taken, or would be without PRIMASK */
+void sm_sim_core_wait(void){
+	uint32_t taken = g_core.m_taken;
+
+	for(;;){
+		int32_t prio;
+
+		if(g_core.m_taken != taken)
+			return;
+
+		if(sm_sim_core_highest_pending(&prio) >= 0 && prio < sm_sim_core_current_priority())
+			return;
+
+		uint64_t next = sm_sim_core_next_event();
+		if(next == SM_SIM_EVENT_NONE){
+			fprintf(stderr, "sm_sim: WFI with nothing left to wake the core\n");
+			sm_sim_exit(2);
+		}
+
+		sm_sim_advance(next > g_core.m_now ? next - g_core.m_now : 0);
+	}
+}
+
+void sm_sim_core_event(void){
+}
+
+uint32_t sm_sim_core_ldrex(volatile void* _addr, uint32_t _size){
+	uint32_t value = 0;
+
+	g_core.m_excl_addr = _addr;
+	g_core.m_excl_valid = 1;
+	memcpy(&value, (const void*)_addr, _size);
+	return value;
+}
+
+uint32_t sm_sim_core_strex(volatile void* _addr, uint32_t _value, uint32_t _size){
+	if(!g_core.m_excl_valid || g_core.m_excl_addr != _addr)
+		return 1;
+
+	g_core.m_excl_valid = 0;
+	memcpy((void*)_addr, &_value, _size);
+	return 0;
+}
+
+void sm_sim_core_clrex(void){
+	g_core.m_excl_valid = 0;
+}
+
+void sm_sim_core_bkpt(uint32_t _value){
+	fprintf(stderr, "sm_sim: BKPT %u at %llu ns\n", (unsigned)_value, (unsigned long long)g_core.m_now);
+	sm_sim_exit(3);
+}
+
+/*
+ * Reset and process control
+ */
+
+void sm_sim_core_reset(void){
+	memset(&g_core.m_pending, 0, sizeof(g_core.m_pending));
+	g_core.m_access_ns = SM_SIM_ACCESS_NS_DEFAULT;
+	g_core.m_enable = 0;
+	g_core.m_level = 0;
+	g_core.m_nest = 0;
+	g_core.m_primask = 0;
+	g_core.m_st_ctrl = 0;
+	g_core.m_st_load = 0;
+	g_core.m_st_base_val = 0;
+}
+
+void sm_sim_request_reset(void){
+	g_core.m_reset_request = 1;
+}
+
+uint8_t sm_sim_reset_requested(void){
+	return g_core.m_reset_request;
+}
+
+/* A chip reset restarts the process: RAM starts over, flash is handed on */
+void sm_sim_reset(void){
+	char count[16];
+
+	snprintf(count, sizeof(count), "%u", g_core.m_reset_count + 1);
+	setenv("SM_SIM_RESETS", count, 1);
+	setenv("SM_SIM_FLASH_FD", sm_sim_fmc_exec_env(), 1);
+
+	fflush(NULL);
+	execv("/proc/self/exe", g_core.m_argv);
+
+	fprintf(stderr, "sm_sim: reset failed\n");
+	_exit(1);
+}
+
+uint32_t sm_sim_get_reset_count(void){
+	return g_core.m_reset_count;
+}
+
+void sm_sim_exit(int32_t _code){
+	fflush(NULL);
+	_exit(_code);
+}
+
+int32_t sm_sim_init(int _argc, char** _argv){
+	const char* resets = getenv("SM_SIM_RESETS");
+	(void)_argc;
+
+	memset(&g_core, 0, sizeof(g_core));
+	g_core.m_argv = _argv;
+	g_core.m_reset_count = resets ? (uint32_t)strtoul(resets, NULL, 10) : 0;
+
+	if(sm_sim_bus_init() < 0 || sm_sim_fmc_init() < 0){
+		fprintf(stderr, "sm_sim: cannot map the M253 address space\n");
+		return -1;
+	}
+
+	sm_sim_core_reset();
+	for(uint32_t i = 0; i < g_sm_sim_model_num; i++){
+		if(g_sm_sim_models[i]->m_reset)
+			g_sm_sim_models[i]->m_reset();
+	}
+
+	return 0;
+}
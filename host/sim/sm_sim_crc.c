@@ -0,0 +1,122 @@
+/*
+ * sm_sim_crc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * CRC generator: an MSB first shift register for the CCITT, CRC-8, CRC-16 and
+ * CRC-32 polynomials, with the write data and checksum reverse/complement
+ * options of CTL. One write is DATLEN wide, reversed as a whole with DATREV.
+ */
+
+#define SM_SIM_CRC_SIZE               0x10UL
+
+typedef struct sm_sim_crc_impl{
+	uint32_t m_state;
+}sm_sim_crc_impl_t;
+
+static sm_sim_crc_impl_t g_crc;
+
+static const uint32_t g_crc_poly[4] = {0x1021UL, 0x07UL, 0x8005UL, 0x04C11DB7UL};
+static const uint8_t g_crc_width[4] = {16, 8, 16, 32};
+
+static uint32_t sm_sim_crc_reverse(uint32_t _value, uint8_t _bits){
+	uint32_t ret = 0;
+
+	for(uint8_t i = 0; i < _bits; i++){
+		ret = (ret << 1) | (_value & 1UL);
+		_value >>= 1;
+	}
+	return ret;
+}
+
+static uint32_t sm_sim_crc_mask(uint8_t _bits){
+	return _bits == 32 ? 0xFFFFFFFFUL : (1UL << _bits) - 1;
+}
+
+static void sm_sim_crc_refresh(void){
+	CRC_T* regs = SM_SIM_REG(CRC_T, CRC_BASE);
+	uint32_t mode = (regs->CTL & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos;
+	uint8_t width = g_crc_width[mode];
+	uint32_t sum = g_crc.m_state & sm_sim_crc_mask(width);
+
+	if(regs->CTL & CRC_CTL_CHKSREV_Msk)
+		sum = sm_sim_crc_reverse(sum, width);
+	if(regs->CTL & CRC_CTL_CHKSFMT_Msk)
+		sum = ~sum & sm_sim_crc_mask(width);
+
+	SM_SIM_RO(regs->CHECKSUM) = sum;
+}
+
+static void sm_sim_crc_feed(uint32_t _data){
+	CRC_T* regs = SM_SIM_REG(CRC_T, CRC_BASE);
+	uint32_t ctl = regs->CTL;
+	uint32_t mode = (ctl & CRC_CTL_CRCMODE_Msk) >> CRC_CTL_CRCMODE_Pos;
+	uint8_t width = g_crc_width[mode];
+	uint8_t bits = (uint8_t)(8U << ((ctl & CRC_CTL_DATLEN_Msk) >> CRC_CTL_DATLEN_Pos));
+	uint32_t top = 1UL << (width - 1);
+
+	if(bits > 32)
+		bits = 32;
+
+	_data &= sm_sim_crc_mask(bits);
+	if(ctl & CRC_CTL_DATFMT_Msk)
+		_data = ~_data & sm_sim_crc_mask(bits);
+	if(ctl & CRC_CTL_DATREV_Msk)
+		_data = sm_sim_crc_reverse(_data, bits);
+
+	for(int8_t i = (int8_t)(bits - 1); i >= 0; i--){
+		uint8_t in = (uint8_t)((_data >> i) & 1);
+		uint8_t out = (g_crc.m_state & top) != 0;
+
+		g_crc.m_state <<= 1;
+		if(in ^ out)
+			g_crc.m_state ^= g_crc_poly[mode];
+	}
+	g_crc.m_state &= sm_sim_crc_mask(width);
+}
+
+static void sm_sim_crc_reset(void){
+	memset(sm_sim_reg(CRC_BASE), 0, SM_SIM_CRC_SIZE);
+	memset(&g_crc, 0, sizeof(g_crc));
+	SM_SIM_REG(CRC_T, CRC_BASE)->SEED = 0xFFFFFFFFUL;
+	sm_sim_crc_refresh();
+}
+
+static void sm_sim_crc_write(uint32_t _addr, uint32_t _value){
+	CRC_T* regs = SM_SIM_REG(CRC_T, CRC_BASE);
+
+	switch(_addr - CRC_BASE){
+	case offsetof(CRC_T, CTL):
+		if(_value & CRC_CTL_CHKSINIT_Msk){
+			g_crc.m_state = regs->SEED;
+			regs->CTL = _value & ~CRC_CTL_CHKSINIT_Msk;
+		}
+		break;
+
+	case offsetof(CRC_T, DAT):
+		if(regs->CTL & CRC_CTL_CRCEN_Msk)
+			sm_sim_crc_feed(_value);
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_crc_refresh();
+}
+
+const sm_sim_model_t g_sm_sim_crc = {
+		.m_name = "CRC",
+		.m_base = CRC_BASE,
+		.m_size = SM_SIM_CRC_SIZE,
+		.m_reset = sm_sim_crc_reset,
+		.m_write = sm_sim_crc_write,
+};
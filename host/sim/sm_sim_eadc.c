@@ -0,0 +1,204 @@
+/*
+ * sm_sim_eadc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * EADC sample modules 0..15: software, timer and ADINT0/1 triggers, one
+ * conversion at a time in module order, each taking SM_SIM_EADC_CONV_NS. The
+ * result comes from the source set with sm_sim_eadc_set_source() (12 bit,
+ * mid-scale without one). ADIF0..3 follow INTSRC, PDMACTL requests PDMA with
+ * the result in CURDAT. No compare, no external trigger.
+ */
+
+#define SM_SIM_EADC_SIZE              0x200UL
+#define SM_SIM_EADC_MODULE_NUM        16
+#define SM_SIM_EADC_INT_NUM           4
+#define SM_SIM_EADC_CONV_NS           (1 * SM_SIM_NS_PER_US)
+#define SM_SIM_EADC_TRGSEL_ADINT0     2
+#define SM_SIM_EADC_TRGSEL_TIMER0     4
+
+typedef struct sm_sim_eadc_impl{
+	uint32_t m_pending;
+	int8_t m_converting;
+	uint64_t m_done;
+	uint32_t m_status2;
+	uint32_t m_dat[SM_SIM_EADC_MODULE_NUM];
+	sm_sim_eadc_fn_t m_source;
+	void* m_source_arg;
+}sm_sim_eadc_impl_t;
+
+static sm_sim_eadc_impl_t g_eadc;
+
+static const int32_t g_eadc_irqn[SM_SIM_EADC_INT_NUM] = {EADC_INT0_IRQn, EADC_INT1_IRQn, EADC_INT2_IRQn,
+		EADC_INT3_IRQn};
+
+static EADC_T* sm_sim_eadc_regs(void){
+	return SM_SIM_REG(EADC_T, EADC_BASE);
+}
+
+static void sm_sim_eadc_refresh(void){
+	EADC_T* regs = sm_sim_eadc_regs();
+	uint32_t status2 = g_eadc.m_status2;
+
+	if(g_eadc.m_converting >= 0)
+		status2 |= EADC_STATUS2_BUSY_Msk;
+
+	regs->STATUS2 = status2;
+	regs->PENDSTS = g_eadc.m_pending;
+
+	for(uint8_t n = 0; n < SM_SIM_EADC_INT_NUM; n++){
+		sm_sim_irq_set_level(g_eadc_irqn[n], ((g_eadc.m_status2 >> n) & 1) &&
+				(regs->CTL & (1UL << (EADC_CTL_ADCIEN0_Pos + n))));
+	}
+}
+
+/* Start the lowest pending module, if the converter is free */
+static void sm_sim_eadc_start(uint64_t _now){
+	if(g_eadc.m_converting >= 0 || !g_eadc.m_pending || !(sm_sim_eadc_regs()->CTL & EADC_CTL_ADCEN_Msk))
+		return;
+
+	for(int8_t module = 0; module < SM_SIM_EADC_MODULE_NUM; module++){
+		if(g_eadc.m_pending & (1UL << module)){
+			g_eadc.m_pending &= ~(1UL << module);
+			g_eadc.m_converting = module;
+			g_eadc.m_done = _now + SM_SIM_EADC_CONV_NS;
+			return;
+		}
+	}
+}
+
+static void sm_sim_eadc_trigger(uint32_t _trgsel){
+	EADC_T* regs = sm_sim_eadc_regs();
+
+	for(uint8_t module = 0; module < SM_SIM_EADC_MODULE_NUM; module++){
+		if(((regs->SCTL[module] & EADC_SCTL_TRGSEL_Msk) >> EADC_SCTL_TRGSEL_Pos) == _trgsel)
+			g_eadc.m_pending |= 1UL << module;
+	}
+}
+
+static void sm_sim_eadc_complete(uint8_t _module, uint64_t _now){
+	EADC_T* regs = sm_sim_eadc_regs();
+	uint8_t channel = (uint8_t)(regs->SCTL[_module] & EADC_SCTL_CHSEL_Msk);
+	uint32_t result = g_eadc.m_source ? g_eadc.m_source(channel, _now, g_eadc.m_source_arg) : 0x800;
+	uint32_t dat = (result & 0xFFF) | EADC_DAT_VALID_Msk;
+
+	if(g_eadc.m_dat[_module] & EADC_DAT_VALID_Msk)
+		dat |= EADC_DAT_OV_Msk;
+	g_eadc.m_dat[_module] = dat;
+	SM_SIM_RO(regs->DAT[_module]) = dat;
+	SM_SIM_RO(regs->CURDAT) = result & 0xFFF;
+
+	for(uint8_t n = 0; n < SM_SIM_EADC_INT_NUM; n++){
+		if(!(regs->INTSRC[n] & (1UL << _module)))
+			continue;
+
+		g_eadc.m_status2 |= 1UL << n;
+		if(n < 2)
+			sm_sim_eadc_trigger(SM_SIM_EADC_TRGSEL_ADINT0 + n);
+	}
+
+	if(regs->PDMACTL & (1UL << _module))
+		sm_sim_pdma_request((uint8_t)PDMA_EADC_RX);
+}
+
+void sm_sim_eadc_timer_trigger(uint8_t _timer){
+	sm_sim_eadc_trigger(SM_SIM_EADC_TRGSEL_TIMER0 + _timer);
+	sm_sim_eadc_start(sm_sim_now());
+	sm_sim_eadc_refresh();
+}
+
+static void sm_sim_eadc_reset(void){
+	sm_sim_eadc_fn_t source = g_eadc.m_source;
+	void* source_arg = g_eadc.m_source_arg;
+
+	memset(sm_sim_reg(EADC_BASE), 0, SM_SIM_EADC_SIZE);
+	memset(&g_eadc, 0, sizeof(g_eadc));
+	g_eadc.m_converting = -1;
+	g_eadc.m_source = source;
+	g_eadc.m_source_arg = source_arg;
+	sm_sim_eadc_refresh();
+}
+
+/* Reading a result clears VALID and OV, after this read has seen them */
+static void sm_sim_eadc_read(uint32_t _addr, uint8_t _is_write){
+	uint32_t module = (_addr - EADC_BASE) / 4;
+
+	if(_is_write || module >= SM_SIM_EADC_MODULE_NUM)
+		return;
+
+	*(volatile uint32_t*)sm_sim_reg(_addr) = g_eadc.m_dat[module];
+	g_eadc.m_dat[module] &= ~(EADC_DAT_VALID_Msk | EADC_DAT_OV_Msk);
+}
+
+static void sm_sim_eadc_write(uint32_t _addr, uint32_t _value){
+	EADC_T* regs = sm_sim_eadc_regs();
+
+	switch(_addr - EADC_BASE){
+	case offsetof(EADC_T, SWTRG):
+		g_eadc.m_pending |= _value & 0xFFFF;
+		regs->SWTRG = 0;
+		break;
+
+	case offsetof(EADC_T, STATUS2):
+		g_eadc.m_status2 &= ~_value;
+		break;
+
+	case offsetof(EADC_T, PENDSTS):
+		g_eadc.m_pending &= ~_value;
+		break;
+
+	case offsetof(EADC_T, CTL):
+		if(_value & EADC_CTL_ADCRST_Msk){
+			g_eadc.m_pending = 0;
+			g_eadc.m_converting = -1;
+			regs->CTL = _value & ~EADC_CTL_ADCRST_Msk;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_eadc_start(sm_sim_now());
+	sm_sim_eadc_refresh();
+}
+
+static uint64_t sm_sim_eadc_next_event(void){
+	return g_eadc.m_converting >= 0 ? g_eadc.m_done : SM_SIM_EVENT_NONE;
+}
+
+static void sm_sim_eadc_update(uint64_t _now){
+	while(g_eadc.m_converting >= 0 && g_eadc.m_done <= _now){
+		uint64_t done = g_eadc.m_done;
+
+		sm_sim_eadc_complete((uint8_t)g_eadc.m_converting, done);
+		g_eadc.m_converting = -1;
+		sm_sim_eadc_start(done);
+	}
+
+	sm_sim_eadc_refresh();
+}
+
+const sm_sim_model_t g_sm_sim_eadc = {
+		.m_name = "EADC",
+		.m_base = EADC_BASE,
+		.m_size = SM_SIM_EADC_SIZE,
+		.m_reset = sm_sim_eadc_reset,
+		.m_read = sm_sim_eadc_read,
+		.m_write = sm_sim_eadc_write,
+		.m_next_event = sm_sim_eadc_next_event,
+		.m_update = sm_sim_eadc_update,
+};
+
+void sm_sim_eadc_set_source(sm_sim_eadc_fn_t _fn, void* _arg){
+	g_eadc.m_source_arg = _arg;
+	g_eadc.m_source = _fn;
+}
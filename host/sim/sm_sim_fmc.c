@@ -0,0 +1,416 @@
+/*
+ * sm_sim_fmc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * FMC and the flash behind it. APROM, LDROM and the CONFIG words live in one
+ * shared memory object (or the SM_SIM_FLASH file) that is handed on across a
+ * simulated reset. APROM is also mapped read only at its M253 address, minus
+ * the first page the host will not map, so flash pointers read as on the chip.
+ *
+ * ISP commands keep ISPTRG/ISPBUSY set for their flash time. Programming can
+ * only clear bits. The multi-word program command takes one MPDATn slot every
+ * SM_SIM_FMC_MULTI_WORD_NS and ends when it finds the next slot empty, which
+ * is how both the normal end and an underrun look to the firmware. A run
+ * longer than SM_SIM_FMC_MULTI_MAX words or across a page sets ISPFF.
+ */
+
+#define SM_SIM_FMC_SIZE               0x100UL
+#define SM_SIM_FMC_MAP_BASE           0x1000UL
+
+#define SM_SIM_FMC_LDROM_OFFSET       FMC_APROM_SIZE
+#define SM_SIM_FMC_CONFIG_OFFSET      (SM_SIM_FMC_LDROM_OFFSET + FMC_LDROM_SIZE)
+#define SM_SIM_FMC_CONFIG_SIZE        0x1000UL
+#define SM_SIM_FMC_STORE_SIZE         (SM_SIM_FMC_CONFIG_OFFSET + SM_SIM_FMC_CONFIG_SIZE)
+
+#define SM_SIM_FMC_PROGRAM_NS         (20 * SM_SIM_NS_PER_US)
+#define SM_SIM_FMC_MULTI_WORD_NS      (8 * SM_SIM_NS_PER_US)
+#define SM_SIM_FMC_MULTI_MAX          32
+#define SM_SIM_FMC_ERASE_NS           (4 * SM_SIM_NS_PER_MS)
+#define SM_SIM_FMC_READ_NS            (1 * SM_SIM_NS_PER_US)
+#define SM_SIM_FMC_CHECKSUM_PAGE_NS   (10 * SM_SIM_NS_PER_US)
+
+#define SM_SIM_FMC_CID                0x000000DAUL
+#define SM_SIM_FMC_PID                0x01253000UL
+
+typedef struct sm_sim_fmc_impl{
+	int m_fd;
+	uint8_t* m_store;
+	char m_env[16];
+
+	uint32_t m_ispctl;
+	uint8_t m_busy;
+	uint64_t m_done;
+	uint32_t m_checksum;
+	uint32_t m_vecmap;
+
+	uint8_t m_mp_run;
+	uint8_t m_mp_full;            /* MPDATn holding a word not programmed yet */
+	uint8_t m_mp_slot;
+	uint8_t m_mp_words;           /* programmed in this run */
+	uint32_t m_mp_addr;
+	uint32_t m_mp_last;
+	uint64_t m_mp_next;
+
+	uint32_t m_program_count;
+	uint32_t m_erase_count;
+}sm_sim_fmc_impl_t;
+
+static sm_sim_fmc_impl_t g_fmc = {.m_fd = -1};
+
+static FMC_T* sm_sim_fmc_regs(void){
+	return SM_SIM_REG(FMC_T, FMC_BASE);
+}
+
+/* Backdoor to the word at a flash address, with the update enable it needs */
+static uint32_t* sm_sim_fmc_word(uint32_t _addr, uint32_t* _enable){
+	_addr &= ~0x3UL;
+
+	if(_addr < FMC_APROM_END){
+		*_enable = FMC_ISPCTL_APUEN_Msk;
+		return (uint32_t*)(g_fmc.m_store + _addr);
+	}
+	if(_addr >= FMC_LDROM_BASE && _addr < FMC_LDROM_END){
+		*_enable = FMC_ISPCTL_LDUEN_Msk;
+		return (uint32_t*)(g_fmc.m_store + SM_SIM_FMC_LDROM_OFFSET + (_addr - FMC_LDROM_BASE));
+	}
+	if(_addr >= FMC_CONFIG_BASE && _addr < FMC_CONFIG_BASE + SM_SIM_FMC_CONFIG_SIZE){
+		*_enable = FMC_ISPCTL_CFGUEN_Msk;
+		return (uint32_t*)(g_fmc.m_store + SM_SIM_FMC_CONFIG_OFFSET + (_addr - FMC_CONFIG_BASE));
+	}
+	return NULL;
+}
+
+static uint8_t sm_sim_fmc_program(uint32_t _addr, uint32_t _data){
+	uint32_t enable;
+	uint32_t* word = sm_sim_fmc_word(_addr, &enable);
+
+	if(!word || !(g_fmc.m_ispctl & enable))
+		return 0;
+
+	*word &= _data;
+	g_fmc.m_program_count++;
+	return 1;
+}
+
+static uint8_t sm_sim_fmc_erase(uint32_t _addr){
+	uint32_t enable;
+	uint32_t* word = sm_sim_fmc_word(_addr & FMC_PAGE_ADDR_MASK, &enable);
+
+	if(!word || !(g_fmc.m_ispctl & enable))
+		return 0;
+
+	memset(word, 0xFF, FMC_FLASH_PAGE_SIZE);
+	g_fmc.m_erase_count++;
+	return 1;
+}
+
+/* Same CRC-32 as the ISP checksum command */
+static uint32_t sm_sim_fmc_crc32(const uint8_t* _data, uint32_t _len){
+	uint32_t crc = 0xFFFFFFFFUL;
+
+	for(uint32_t i = 0; i < _len; i++){
+		crc ^= _data[i];
+		for(uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320UL : 0);
+	}
+	return ~crc;
+}
+
+static void sm_sim_fmc_refresh(void){
+	FMC_T* regs = sm_sim_fmc_regs();
+	uint32_t mpsts = (uint32_t)g_fmc.m_mp_full << FMC_MPSTS_D0_Pos;
+
+	if(g_fmc.m_mp_run)
+		mpsts |= FMC_MPSTS_MPBUSY_Msk | FMC_MPSTS_PPGO_Msk;
+	if(g_fmc.m_ispctl & FMC_ISPCTL_ISPFF_Msk)
+		mpsts |= FMC_MPSTS_ISPFF_Msk;
+
+	regs->ISPCTL = g_fmc.m_ispctl;
+	regs->ISPTRG = g_fmc.m_busy ? FMC_ISPTRG_ISPGO_Msk : 0;
+	regs->ISPSTS = (g_fmc.m_busy ? FMC_ISPSTS_ISPBUSY_Msk : 0) | (g_fmc.m_ispctl & FMC_ISPCTL_ISPFF_Msk) |
+			(g_fmc.m_vecmap << FMC_ISPSTS_VECMAP_Pos);
+	SM_SIM_RO(regs->MPSTS) = mpsts;
+	SM_SIM_RO(regs->MPADDR) = g_fmc.m_mp_last;
+}
+
+static void sm_sim_fmc_fail(void){
+	g_fmc.m_ispctl |= FMC_ISPCTL_ISPFF_Msk;
+}
+
+static void sm_sim_fmc_command(uint64_t _now){
+	FMC_T* regs = sm_sim_fmc_regs();
+	uint32_t addr = regs->ISPADDR;
+	uint32_t enable;
+	uint32_t* word;
+	uint64_t duration = SM_SIM_FMC_READ_NS;
+
+	if(!(g_fmc.m_ispctl & FMC_ISPCTL_ISPEN_Msk)){
+		sm_sim_fmc_fail();
+		return;
+	}
+
+	switch(regs->ISPCMD){
+	case FMC_ISPCMD_READ:
+		word = sm_sim_fmc_word(addr, &enable);
+		if(word){
+			regs->ISPDAT = *word;
+		}else{
+			sm_sim_fmc_fail();
+		}
+		break;
+
+	case FMC_ISPCMD_READ_UID:
+		regs->ISPDAT = 0x53494D00UL | (addr & 0xFF);
+		break;
+
+	case FMC_ISPCMD_READ_CID:
+		regs->ISPDAT = SM_SIM_FMC_CID;
+		break;
+
+	case FMC_ISPCMD_READ_PID:
+		regs->ISPDAT = SM_SIM_FMC_PID;
+		break;
+
+	case FMC_ISPCMD_PROGRAM:
+		if(!sm_sim_fmc_program(addr, regs->ISPDAT))
+			sm_sim_fmc_fail();
+		duration = SM_SIM_FMC_PROGRAM_NS;
+		break;
+
+	case FMC_ISPCMD_PAGE_ERASE:
+		if(!sm_sim_fmc_erase(addr))
+			sm_sim_fmc_fail();
+		duration = SM_SIM_FMC_ERASE_NS;
+		break;
+
+	case FMC_ISPCMD_CAL_CHECKSUM:{
+		uint32_t len = regs->ISPDAT;
+
+		if((addr % FMC_FLASH_PAGE_SIZE) || (len % FMC_FLASH_PAGE_SIZE) || !sm_sim_fmc_word(addr, &enable) ||
+				!sm_sim_fmc_word(addr + len - 1, &enable)){
+			sm_sim_fmc_fail();
+			break;
+		}
+		g_fmc.m_checksum = sm_sim_fmc_crc32((const uint8_t*)sm_sim_fmc_word(addr, &enable), len);
+		duration = (len / FMC_FLASH_PAGE_SIZE) * SM_SIM_FMC_CHECKSUM_PAGE_NS;
+		break;
+	}
+
+	case FMC_ISPCMD_CHECKSUM:
+		regs->ISPDAT = g_fmc.m_checksum;
+		break;
+
+	case FMC_ISPCMD_READ_ALL1:
+	case FMC_ISPCMD_RUN_ALL1:
+		regs->ISPDAT = 0xA11FFFFFUL;
+		break;
+
+	case FMC_ISPCMD_VECMAP:
+		g_fmc.m_vecmap = addr >> FMC_ISPSTS_VECMAP_Pos;
+		break;
+
+	case FMC_ISPCMD_MULTI_PROG:
+		/* MPDAT0..3 were loaded before the trigger */
+		g_fmc.m_mp_run = 1;
+		g_fmc.m_mp_full = 0xF;
+		g_fmc.m_mp_slot = 0;
+		g_fmc.m_mp_words = 0;
+		g_fmc.m_mp_addr = addr;
+		g_fmc.m_mp_next = _now + SM_SIM_FMC_MULTI_WORD_NS;
+		g_fmc.m_busy = 1;
+		return;
+
+	default:
+		sm_sim_fmc_fail();
+		return;
+	}
+
+	g_fmc.m_busy = 1;
+	g_fmc.m_done = _now + duration;
+}
+
+static void sm_sim_fmc_reset(void){
+	memset(sm_sim_reg(FMC_BASE), 0, SM_SIM_FMC_SIZE);
+	g_fmc.m_ispctl = 0;
+	g_fmc.m_busy = 0;
+	g_fmc.m_mp_run = 0;
+	g_fmc.m_mp_full = 0;
+	g_fmc.m_vecmap = 0;
+	sm_sim_fmc_refresh();
+}
+
+static void sm_sim_fmc_write(uint32_t _addr, uint32_t _value){
+	uint8_t unlocked = SM_SIM_REG(SYS_T, SYS_BASE)->REGLCTL & 1;
+
+	switch(_addr - FMC_BASE){
+	case offsetof(FMC_T, ISPCTL):
+		/* Write protected; ISPFF is write 1 to clear */
+		if(unlocked){
+			uint32_t ispff = g_fmc.m_ispctl & ~_value & FMC_ISPCTL_ISPFF_Msk;
+			g_fmc.m_ispctl = (_value & ~FMC_ISPCTL_ISPFF_Msk) | ispff;
+		}
+		break;
+
+	case offsetof(FMC_T, ISPTRG):
+		if(unlocked && (_value & FMC_ISPTRG_ISPGO_Msk) && !g_fmc.m_busy)
+			sm_sim_fmc_command(sm_sim_now());
+		break;
+
+	case offsetof(FMC_T, MPDAT0):
+	case offsetof(FMC_T, MPDAT1):
+	case offsetof(FMC_T, MPDAT2):
+	case offsetof(FMC_T, MPDAT3):
+		if(g_fmc.m_mp_run)
+			g_fmc.m_mp_full |= (uint8_t)(1U << ((_addr - SM_SIM_ADDR(&FMC->MPDAT0)) / 4));
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_fmc_refresh();
+}
+
+static uint64_t sm_sim_fmc_next_event(void){
+	if(g_fmc.m_mp_run)
+		return g_fmc.m_mp_next;
+
+	return g_fmc.m_busy ? g_fmc.m_done : SM_SIM_EVENT_NONE;
+}
+
+static void sm_sim_fmc_update(uint64_t _now){
+	volatile uint32_t* mpdat = &sm_sim_fmc_regs()->MPDAT0;
+
+	while(g_fmc.m_mp_run && g_fmc.m_mp_next <= _now){
+		uint8_t bit = (uint8_t)(1U << g_fmc.m_mp_slot);
+
+		if(!(g_fmc.m_mp_full & bit)){
+			/* Nothing to program next: the run is over */
+			g_fmc.m_mp_run = 0;
+			g_fmc.m_busy = 0;
+			break;
+		}
+
+		if(g_fmc.m_mp_words == SM_SIM_FMC_MULTI_MAX ||
+				(g_fmc.m_mp_words && !(g_fmc.m_mp_addr & (FMC_FLASH_PAGE_SIZE - 1)))){
+			sm_sim_fmc_fail();
+			g_fmc.m_mp_run = 0;
+			g_fmc.m_busy = 0;
+			break;
+		}
+
+		if(!sm_sim_fmc_program(g_fmc.m_mp_addr, mpdat[g_fmc.m_mp_slot]))
+			sm_sim_fmc_fail();
+		g_fmc.m_mp_words++;
+
+		g_fmc.m_mp_full &= (uint8_t)~bit;
+		g_fmc.m_mp_last = g_fmc.m_mp_addr;
+		g_fmc.m_mp_addr += 4;
+		g_fmc.m_mp_slot = (g_fmc.m_mp_slot + 1) & 3;
+		g_fmc.m_mp_next += SM_SIM_FMC_MULTI_WORD_NS;
+	}
+
+	if(!g_fmc.m_mp_run && g_fmc.m_busy && g_fmc.m_done <= _now)
+		g_fmc.m_busy = 0;
+
+	sm_sim_fmc_refresh();
+}
+
+const sm_sim_model_t g_sm_sim_fmc = {
+		.m_name = "FMC",
+		.m_base = FMC_BASE,
+		.m_size = SM_SIM_FMC_SIZE,
+		.m_reset = sm_sim_fmc_reset,
+		.m_write = sm_sim_fmc_write,
+		.m_next_event = sm_sim_fmc_next_event,
+		.m_update = sm_sim_fmc_update,
+};
+
+/* Flash contents: handed on by a reset, else the SM_SIM_FLASH file, else blank */
+static int sm_sim_fmc_open(uint8_t* _blank){
+	const char* inherited = getenv("SM_SIM_FLASH_FD");
+	const char* path = getenv("SM_SIM_FLASH");
+	struct stat st;
+	int fd;
+
+	*_blank = 0;
+
+	if(inherited)
+		return atoi(inherited);
+
+	if(path){
+		fd = open(path, O_RDWR | O_CREAT, 0644);
+		if(fd < 0 || fstat(fd, &st) < 0)
+			return -1;
+
+		*_blank = st.st_size == 0;
+	}else{
+		fd = memfd_create("sm_sim_flash", 0);
+		*_blank = 1;
+	}
+
+	if(fd >= 0 && ftruncate(fd, SM_SIM_FMC_STORE_SIZE) < 0){
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int32_t sm_sim_fmc_init(void){
+	uint8_t blank;
+
+	g_fmc.m_fd = sm_sim_fmc_open(&blank);
+	if(g_fmc.m_fd < 0)
+		return -1;
+
+	g_fmc.m_store = mmap(NULL, SM_SIM_FMC_STORE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, g_fmc.m_fd, 0);
+	if(g_fmc.m_store == MAP_FAILED)
+		return -1;
+
+	if(blank){
+		memset(g_fmc.m_store, 0xFF, SM_SIM_FMC_STORE_SIZE);
+		/* CONFIG0: boot from APROM, no lock */
+		*(uint32_t*)(g_fmc.m_store + SM_SIM_FMC_CONFIG_OFFSET) = 0xFFFFFF7FUL;
+	}
+
+	void* bus = mmap((void*)SM_SIM_FMC_MAP_BASE, FMC_APROM_END - SM_SIM_FMC_MAP_BASE, PROT_READ,
+			MAP_SHARED | MAP_FIXED_NOREPLACE, g_fmc.m_fd, SM_SIM_FMC_MAP_BASE);
+	if(bus != (void*)SM_SIM_FMC_MAP_BASE)
+		return -1;
+
+	return 0;
+}
+
+/* Keep the flash open across execv() and say where to find it */
+const char* sm_sim_fmc_exec_env(void){
+	fcntl(g_fmc.m_fd, F_SETFD, fcntl(g_fmc.m_fd, F_GETFD) & ~FD_CLOEXEC);
+	snprintf(g_fmc.m_env, sizeof(g_fmc.m_env), "%d", g_fmc.m_fd);
+	return g_fmc.m_env;
+}
+
+uint8_t* sm_sim_flash(void){
+	return g_fmc.m_store;
+}
+
+uint32_t sm_sim_flash_program_count(void){
+	return g_fmc.m_program_count;
+}
+
+uint32_t sm_sim_flash_erase_count(void){
+	return g_fmc.m_erase_count;
+}
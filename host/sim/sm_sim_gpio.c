@@ -0,0 +1,195 @@
+/*
+ * sm_sim_gpio.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * GPIO ports PA..PF with their bit access window (GPIO_PIN_DATA). A pin reads
+ * the level the test drives onto it, or its own DOUT when it is an output;
+ * open drain and quasi-bidirectional pins idle high as with the pull-up.
+ * Edge and level interrupts follow INTTYPE/INTEN into INTSRC. No debounce.
+ */
+
+#define SM_SIM_GPIO_SIZE              0xA00UL
+#define SM_SIM_GPIO_PORT_STRIDE       0x40UL
+#define SM_SIM_GPIO_PIN_NUM           16
+
+typedef struct sm_sim_gpio_port{
+	uint16_t m_input;
+	uint16_t m_driven;
+	uint16_t m_level;
+	uint16_t m_dout;
+	uint16_t m_intsrc;
+}sm_sim_gpio_port_t;
+
+typedef struct sm_sim_gpio_impl{
+	sm_sim_gpio_port_t m_port[SM_SIM_GPIO_PORT_NUM];
+	sm_sim_gpio_fn_t m_hook;
+	void* m_hook_arg;
+}sm_sim_gpio_impl_t;
+
+static sm_sim_gpio_impl_t g_gpio;
+
+static GPIO_T* sm_sim_gpio_regs(uint8_t _port){
+	return SM_SIM_REG(GPIO_T, GPIOA_BASE + _port * SM_SIM_GPIO_PORT_STRIDE);
+}
+
+static volatile uint32_t* sm_sim_gpio_pin_data(uint8_t _port, uint8_t _pin){
+	return (volatile uint32_t*)sm_sim_reg(GPIO_PIN_DATA_BASE + _port * SM_SIM_GPIO_PORT_STRIDE + _pin * 4UL);
+}
+
+static uint16_t sm_sim_gpio_compute(uint8_t _port){
+	GPIO_T* regs = sm_sim_gpio_regs(_port);
+	sm_sim_gpio_port_t* port = &g_gpio.m_port[_port];
+	uint16_t level = 0;
+
+	for(uint8_t pin = 0; pin < SM_SIM_GPIO_PIN_NUM; pin++){
+		uint16_t bit = (uint16_t)(1U << pin);
+		uint32_t mode = (regs->MODE >> (pin * 2)) & 0x3;
+		uint8_t external = (port->m_driven & bit) ? ((port->m_input & bit) != 0) : (mode != GPIO_MODE_INPUT);
+		uint8_t value;
+
+		if(mode == GPIO_MODE_OUTPUT){
+			value = (port->m_dout & bit) != 0;
+		}else if(mode == GPIO_MODE_INPUT){
+			value = external;
+		}else{
+			value = (port->m_dout & bit) ? external : 0;
+		}
+
+		if(value)
+			level |= bit;
+	}
+	return level;
+}
+
+/* Recompute the pin levels, latch interrupts and report output changes */
+static void sm_sim_gpio_refresh(uint8_t _port){
+	GPIO_T* regs = sm_sim_gpio_regs(_port);
+	sm_sim_gpio_port_t* port = &g_gpio.m_port[_port];
+	uint16_t level = sm_sim_gpio_compute(_port);
+	uint16_t changed = level ^ port->m_level;
+	uint16_t rising = changed & level;
+	uint16_t falling = changed & ~level;
+	uint32_t inten = regs->INTEN;
+	uint16_t edge = (uint16_t)~regs->INTTYPE;
+	uint16_t src = 0;
+
+	src |= rising & edge & (uint16_t)(inten >> 16);
+	src |= falling & edge & (uint16_t)inten;
+	src |= level & (uint16_t)regs->INTTYPE & (uint16_t)(inten >> 16);
+	src |= (uint16_t)~level & (uint16_t)regs->INTTYPE & (uint16_t)inten;
+
+	port->m_level = level;
+	port->m_intsrc |= src;
+	regs->DOUT = port->m_dout;
+	SM_SIM_RO(regs->PIN) = level;
+	regs->INTSRC = port->m_intsrc;
+
+	for(uint8_t pin = 0; pin < SM_SIM_GPIO_PIN_NUM; pin++){
+		*sm_sim_gpio_pin_data(_port, pin) = (level >> pin) & 1;
+
+		if(g_gpio.m_hook && ((changed >> pin) & 1))
+			g_gpio.m_hook(_port, pin, (level >> pin) & 1, g_gpio.m_hook_arg);
+	}
+
+	sm_sim_irq_set_level(GPA_IRQn + _port, port->m_intsrc != 0);
+}
+
+static void sm_sim_gpio_reset(void){
+	memset(sm_sim_reg(GPIO_BASE), 0, SM_SIM_GPIO_SIZE);
+	memset(&g_gpio.m_port, 0, sizeof(g_gpio.m_port));
+
+	for(uint8_t port = 0; port < SM_SIM_GPIO_PORT_NUM; port++){
+		/* Pins come out of reset quasi-bidirectional, driving high */
+		sm_sim_gpio_regs(port)->MODE = 0xFFFFFFFFUL;
+		g_gpio.m_port[port].m_dout = 0xFFFF;
+		g_gpio.m_port[port].m_level = sm_sim_gpio_compute(port);
+		sm_sim_gpio_refresh(port);
+	}
+}
+
+static void sm_sim_gpio_write(uint32_t _addr, uint32_t _value){
+	if(_addr >= GPIO_PIN_DATA_BASE){
+		uint32_t offset = _addr - GPIO_PIN_DATA_BASE;
+		uint8_t port = (uint8_t)(offset / SM_SIM_GPIO_PORT_STRIDE);
+		uint16_t bit = (uint16_t)(1U << ((offset % SM_SIM_GPIO_PORT_STRIDE) / 4));
+
+		if(port >= SM_SIM_GPIO_PORT_NUM)
+			return;
+
+		if(_value & 1){
+			g_gpio.m_port[port].m_dout |= bit;
+		}else{
+			g_gpio.m_port[port].m_dout &= (uint16_t)~bit;
+		}
+		sm_sim_gpio_refresh(port);
+		return;
+	}
+
+	uint32_t offset = _addr - GPIOA_BASE;
+	uint8_t port = (uint8_t)(offset / SM_SIM_GPIO_PORT_STRIDE);
+
+	if(port >= SM_SIM_GPIO_PORT_NUM)
+		return;
+
+	GPIO_T* regs = sm_sim_gpio_regs(port);
+	sm_sim_gpio_port_t* state = &g_gpio.m_port[port];
+
+	switch(offset % SM_SIM_GPIO_PORT_STRIDE){
+	case offsetof(GPIO_T, DOUT):
+		/* DATMSK protects bits from DOUT writes */
+		state->m_dout = (uint16_t)((_value & ~regs->DATMSK) | (state->m_dout & regs->DATMSK));
+		break;
+	case offsetof(GPIO_T, INTSRC):
+		state->m_intsrc &= (uint16_t)~_value;
+		break;
+	default:
+		break;
+	}
+
+	sm_sim_gpio_refresh(port);
+}
+
+const sm_sim_model_t g_sm_sim_gpio = {
+		.m_name = "GPIO",
+		.m_base = GPIO_BASE,
+		.m_size = SM_SIM_GPIO_SIZE,
+		.m_reset = sm_sim_gpio_reset,
+		.m_write = sm_sim_gpio_write,
+};
+
+void sm_sim_gpio_set_input(uint8_t _port, uint8_t _pin, uint8_t _level){
+	if(_port >= SM_SIM_GPIO_PORT_NUM || _pin >= SM_SIM_GPIO_PIN_NUM)
+		return;
+
+	sm_sim_gpio_port_t* port = &g_gpio.m_port[_port];
+	uint16_t bit = (uint16_t)(1U << _pin);
+
+	port->m_driven |= bit;
+	if(_level){
+		port->m_input |= bit;
+	}else{
+		port->m_input &= (uint16_t)~bit;
+	}
+	sm_sim_gpio_refresh(_port);
+}
+
+uint8_t sm_sim_gpio_get(uint8_t _port, uint8_t _pin){
+	if(_port >= SM_SIM_GPIO_PORT_NUM || _pin >= SM_SIM_GPIO_PIN_NUM)
+		return 0;
+
+	return (g_gpio.m_port[_port].m_level >> _pin) & 1;
+}
+
+void sm_sim_gpio_set_hook(sm_sim_gpio_fn_t _fn, void* _arg){
+	g_gpio.m_hook_arg = _arg;
+	g_gpio.m_hook = _fn;
+}
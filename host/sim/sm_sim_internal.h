@@ -0,0 +1,94 @@
+/*
+ * sm_sim_internal.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#ifndef HOST_SIM_SM_SIM_INTERNAL_H_
+#define HOST_SIM_SM_SIM_INTERNAL_H_
+
+#include "NuMicro.h"
+#include "sm_sim.h"
+
+#define SM_SIM_PERIPH_BASE            0x40000000UL
+#define SM_SIM_PERIPH_SIZE            0x00100000UL
+#define SM_SIM_SCS_BASE               0xE000E000UL
+#define SM_SIM_SCS_SIZE               0x00001000UL
+
+/* Address of a register, as the firmware sees it */
+#define SM_SIM_ADDR(reg)              ((uint32_t)(uintptr_t)(reg))
+
+#define SM_SIM_EVENT_NONE             UINT64_MAX
+#define SM_SIM_EXC_NUM                (16 + 64)
+
+/*
+ * A register model owns [m_base, m_base + m_size). Its registers are stored in
+ * the backdoor view (sm_sim_reg()), which the CPU reaches through the trapped
+ * window. m_read() runs before any CPU access, to refresh dynamic values and,
+ * for a real read, to apply read side effects. m_write() runs after a CPU write
+ * with the word now in the register and must leave the visible value there.
+ */
+typedef struct sm_sim_model{
+	const char* m_name;
+	uint32_t m_base;
+	uint32_t m_size;
+	void (*m_reset)(void);
+	void (*m_read)(uint32_t _addr, uint8_t _is_write);
+	void (*m_write)(uint32_t _addr, uint32_t _value);
+	uint64_t (*m_next_event)(void);
+	void (*m_update)(uint64_t _now);
+}sm_sim_model_t;
+
+extern const sm_sim_model_t g_sm_sim_scs;
+extern const sm_sim_model_t g_sm_sim_sys;
+extern const sm_sim_model_t g_sm_sim_gpio;
+extern const sm_sim_model_t g_sm_sim_pdma;
+extern const sm_sim_model_t g_sm_sim_fmc;
+extern const sm_sim_model_t g_sm_sim_canfd;
+extern const sm_sim_model_t g_sm_sim_crc;
+extern const sm_sim_model_t g_sm_sim_eadc;
+extern const sm_sim_model_t g_sm_sim_timer;
+extern const sm_sim_model_t g_sm_sim_uart;
+
+extern const sm_sim_model_t* const g_sm_sim_models[];
+extern const uint32_t g_sm_sim_model_num;
+
+/* Bus, sm_sim_bus.c */
+int32_t sm_sim_bus_init(void);
+void* sm_sim_reg(uint32_t _addr);
+#define SM_SIM_REG(type, base)        ((type*)sm_sim_reg(base))
+/* A register the CMSIS struct declares read-only, as the model sets it */
+#define SM_SIM_RO(reg)                (*(volatile uint32_t*)&(reg))
+uint32_t sm_sim_bus_read(uint32_t _addr, uint8_t _size);
+void sm_sim_bus_write(uint32_t _addr, uint32_t _value, uint8_t _size);
+
+/* Core, sm_sim_core.c */
+void sm_sim_core_reset(void);
+void sm_sim_core_access(uint32_t _addr, uint8_t _is_write);
+void sm_sim_core_dispatch(void);
+void sm_sim_irq_set_level(int32_t _irqn, uint8_t _level);
+void sm_sim_request_reset(void);
+uint8_t sm_sim_reset_requested(void);
+void sm_sim_reset(void);
+uint64_t sm_sim_cycles_to_ns(uint64_t _cycles, uint32_t _hz);
+uint64_t sm_sim_ns_to_cycles(uint64_t _ns, uint32_t _hz);
+
+/* Clocks and module resets, sm_sim_sys.c */
+uint32_t sm_sim_clk_hclk(void);
+uint32_t sm_sim_clk_pclk(uint8_t _apb);
+uint32_t sm_sim_clk_uart(uint8_t _uart);
+uint32_t sm_sim_clk_timer(uint8_t _timer);
+
+void sm_sim_uart_module_reset(uint8_t _uart);
+void sm_sim_timer_module_reset(uint8_t _timer);
+
+/* Requests between models */
+int32_t sm_sim_pdma_request(uint8_t _req);
+void sm_sim_eadc_timer_trigger(uint8_t _timer);
+
+/* Flash, sm_sim_fmc.c */
+int32_t sm_sim_fmc_init(void);
+const char* sm_sim_fmc_exec_env(void);
+
+#endif /* HOST_SIM_SM_SIM_INTERNAL_H_ */
@@ -0,0 +1,342 @@
+/*
+ * sm_sim_pdma.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * PDMA, 5 channels. Memory to memory tables started by SWREQ take
+ * SM_SIM_PDMA_BEAT_CYCLES HCLK cycles per beat and the data lands when the
+ * table completes. Peripheral channels move data when their source asks
+ * (sm_sim_pdma_request()): one beat in single mode, one burst otherwise.
+ * Scatter-gather tables are fetched from SCATBA + NEXT, TXCNT counts down in
+ * DSCT CTL as on the chip. Channels 0 and 1 have the request timeout: it
+ * restarts on every request and when TOUTEN turns on, and flags REQTOFn once
+ * TOC prescaled HCLK periods pass without one. No pause or priority.
+ */
+
+#define SM_SIM_PDMA_CH_NUM            5
+#define SM_SIM_PDMA_SIZE              0x500UL
+#define SM_SIM_PDMA_BEAT_CYCLES       2
+#define SM_SIM_PDMA_LINK_MAX          64      /* link-only tables followed in a row */
+#define SM_SIM_PDMA_TOUT_CH_NUM       2
+
+typedef struct sm_sim_pdma_ch{
+	uint32_t m_index;             /* beats moved from the current table */
+	uint32_t m_total;
+	uint8_t m_busy;               /* memory table in flight */
+	uint64_t m_done;
+	uint64_t m_tout_at;           /* request timeout deadline */
+}sm_sim_pdma_ch_t;
+
+typedef struct sm_sim_pdma_impl{
+	sm_sim_pdma_ch_t m_ch[SM_SIM_PDMA_CH_NUM];
+	uint32_t m_tdsts;
+	uint32_t m_abtsts;
+	uint32_t m_reqtof;            /* REQTOFn, at INTSTS bit 8 + n */
+}sm_sim_pdma_impl_t;
+
+static sm_sim_pdma_impl_t g_pdma;
+
+static PDMA_T* sm_sim_pdma_regs(void){
+	return SM_SIM_REG(PDMA_T, PDMA_BASE);
+}
+
+static uint8_t sm_sim_pdma_reqsel(uint8_t _ch){
+	PDMA_T* regs = sm_sim_pdma_regs();
+	uint32_t sel = _ch < 4 ? regs->REQSEL0_3 >> (_ch * 8) : regs->REQSEL4_7 >> ((_ch - 4) * 8);
+
+	return (uint8_t)(sel & 0x7F);
+}
+
+static uint32_t sm_sim_pdma_opmode(uint8_t _ch){
+	return sm_sim_pdma_regs()->DSCT[_ch].CTL & PDMA_DSCT_CTL_OPMODE_Msk;
+}
+
+static void sm_sim_pdma_refresh(void){
+	PDMA_T* regs = sm_sim_pdma_regs();
+	uint32_t intsts = 0;
+	uint32_t active = 0;
+
+	for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+		if(g_pdma.m_ch[ch].m_busy)
+			active |= 1UL << ch;
+	}
+
+	if(g_pdma.m_abtsts)
+		intsts |= PDMA_INTSTS_ABTIF_Msk;
+	if(g_pdma.m_tdsts)
+		intsts |= PDMA_INTSTS_TDIF_Msk;
+	intsts |= g_pdma.m_reqtof << PDMA_INTSTS_REQTOF0_Pos;
+
+	regs->TDSTS = g_pdma.m_tdsts;
+	regs->ABTSTS = g_pdma.m_abtsts;
+	regs->INTSTS = intsts;
+	SM_SIM_RO(regs->TACTSTS) = active;
+
+	sm_sim_irq_set_level(PDMA_IRQn, ((g_pdma.m_tdsts | g_pdma.m_abtsts) & regs->INTEN) != 0 ||
+			(g_pdma.m_reqtof & regs->TOUTIEN) != 0);
+}
+
+/* Restart the request timeout of _ch, if it has one and it is on */
+static void sm_sim_pdma_tout_restart(uint8_t _ch, uint64_t _now){
+	PDMA_T* regs = sm_sim_pdma_regs();
+	uint32_t psc;
+	uint32_t toc;
+
+	if(_ch >= SM_SIM_PDMA_TOUT_CH_NUM)
+		return;
+
+	if(!(regs->TOUTEN & (1UL << _ch))){
+		g_pdma.m_ch[_ch].m_tout_at = SM_SIM_EVENT_NONE;
+		return;
+	}
+
+	psc = (regs->TOUTPSC >> (_ch * PDMA_TOUTPSC_TOUTPSC1_Pos)) & PDMA_TOUTPSC_TOUTPSC0_Msk;
+	toc = (regs->TOC0_1 >> (_ch * PDMA_TOC0_1_TOC1_Pos)) & PDMA_TOC0_1_TOC0_Msk;
+	g_pdma.m_ch[_ch].m_tout_at = _now + sm_sim_cycles_to_ns((uint64_t)toc << (8 + psc), sm_sim_clk_hclk());
+}
+
+/* A new table is in DSCT: its length, as TXCNT holds it now */
+static void sm_sim_pdma_table_load(uint8_t _ch){
+	uint32_t ctl = sm_sim_pdma_regs()->DSCT[_ch].CTL;
+
+	g_pdma.m_ch[_ch].m_index = 0;
+	g_pdma.m_ch[_ch].m_total = ((ctl & PDMA_DSCT_CTL_TXCNT_Msk) >> PDMA_DSCT_CTL_TXCNT_Pos) + 1;
+}
+
+/* Fetch the table NEXT points to, as the controller does for a link entry */
+static void sm_sim_pdma_fetch(uint8_t _ch){
+	PDMA_T* regs = sm_sim_pdma_regs();
+	DSCT_T* dsct = &regs->DSCT[_ch];
+	uint32_t offset = dsct->NEXT & PDMA_DSCT_NEXT_NEXT_Msk;
+	uint32_t addr = regs->SCATBA + offset;
+
+	dsct->CTL = sm_sim_bus_read(addr, 4);
+	dsct->SA = sm_sim_bus_read(addr + 4, 4);
+	dsct->DA = sm_sim_bus_read(addr + 8, 4);
+	dsct->NEXT = (sm_sim_bus_read(addr + 12, 4) & PDMA_DSCT_NEXT_NEXT_Msk) | (offset << PDMA_DSCT_NEXT_EXENEXT_Pos);
+	SM_SIM_RO(regs->CURSCAT[_ch]) = addr;
+
+	sm_sim_pdma_table_load(_ch);
+}
+
+/* Channel enabled and holding a table to run, link entries followed */
+static uint8_t sm_sim_pdma_ready(uint8_t _ch){
+	if(!(sm_sim_pdma_regs()->CHCTL & (1UL << _ch)))
+		return 0;
+
+	for(uint32_t i = 0; i < SM_SIM_PDMA_LINK_MAX && sm_sim_pdma_opmode(_ch) == PDMA_OP_SCATTER &&
+			g_pdma.m_ch[_ch].m_index == g_pdma.m_ch[_ch].m_total; i++){
+		sm_sim_pdma_fetch(_ch);
+	}
+
+	return sm_sim_pdma_opmode(_ch) != PDMA_OP_STOP && g_pdma.m_ch[_ch].m_index < g_pdma.m_ch[_ch].m_total;
+}
+
+static void sm_sim_pdma_beat(uint8_t _ch){
+	DSCT_T* dsct = &sm_sim_pdma_regs()->DSCT[_ch];
+	sm_sim_pdma_ch_t* state = &g_pdma.m_ch[_ch];
+	uint32_t ctl = dsct->CTL;
+	uint8_t width = (uint8_t)(1U << ((ctl & PDMA_DSCT_CTL_TXWIDTH_Msk) >> PDMA_DSCT_CTL_TXWIDTH_Pos));
+	uint32_t sa = dsct->SA;
+	uint32_t da = dsct->DA;
+
+	if((ctl & PDMA_DSCT_CTL_SAINC_Msk) != PDMA_SAR_FIX)
+		sa += state->m_index * width;
+	if((ctl & PDMA_DSCT_CTL_DAINC_Msk) != PDMA_DAR_FIX)
+		da += state->m_index * width;
+
+	sm_sim_bus_write(da, sm_sim_bus_read(sa, width), width);
+	state->m_index++;
+
+	if(state->m_index < state->m_total)
+		dsct->CTL = (ctl & ~PDMA_DSCT_CTL_TXCNT_Msk) | ((state->m_total - state->m_index - 1) << PDMA_DSCT_CTL_TXCNT_Pos);
+}
+
+/* Last beat of a table moved: flag it, then go idle or on to the next table */
+static void sm_sim_pdma_table_done(uint8_t _ch){
+	DSCT_T* dsct = &sm_sim_pdma_regs()->DSCT[_ch];
+	uint32_t ctl = dsct->CTL;
+
+	if((ctl & PDMA_DSCT_CTL_OPMODE_Msk) == PDMA_OP_BASIC){
+		dsct->CTL = ctl & ~(PDMA_DSCT_CTL_OPMODE_Msk | PDMA_DSCT_CTL_TXCNT_Msk);
+		g_pdma.m_tdsts |= 1UL << _ch;
+	}else if(!(ctl & PDMA_DSCT_CTL_TBINTDIS_Msk)){
+		g_pdma.m_tdsts |= 1UL << _ch;
+	}
+}
+
+static uint64_t sm_sim_pdma_duration(uint8_t _ch){
+	sm_sim_pdma_ch_t* state = &g_pdma.m_ch[_ch];
+
+	return sm_sim_cycles_to_ns((uint64_t)(state->m_total - state->m_index) * SM_SIM_PDMA_BEAT_CYCLES,
+			sm_sim_clk_hclk());
+}
+
+static void sm_sim_pdma_mem_start(uint8_t _ch, uint64_t _now){
+	sm_sim_pdma_ch_t* state = &g_pdma.m_ch[_ch];
+
+	state->m_busy = sm_sim_pdma_reqsel(_ch) == PDMA_MEM && sm_sim_pdma_ready(_ch);
+	if(state->m_busy)
+		state->m_done = _now + sm_sim_pdma_duration(_ch);
+}
+
+int32_t sm_sim_pdma_request(uint8_t _req){
+	for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+		if(sm_sim_pdma_reqsel(ch) != _req || !sm_sim_pdma_ready(ch))
+			continue;
+
+		sm_sim_pdma_ch_t* state = &g_pdma.m_ch[ch];
+		uint32_t ctl = sm_sim_pdma_regs()->DSCT[ch].CTL;
+		uint32_t beats = (ctl & PDMA_DSCT_CTL_TXTYPE_Msk) ? 1 :
+				128U >> ((ctl & PDMA_DSCT_CTL_BURSIZE_Msk) >> PDMA_DSCT_CTL_BURSIZE_Pos);
+		uint32_t moved = 0;
+
+		while(moved < beats && state->m_index < state->m_total){
+			sm_sim_pdma_beat(ch);
+			moved++;
+		}
+
+		if(state->m_index == state->m_total)
+			sm_sim_pdma_table_done(ch);
+
+		sm_sim_pdma_tout_restart(ch, sm_sim_now());
+		sm_sim_pdma_refresh();
+		return (int32_t)moved;
+	}
+	return 0;
+}
+
+static void sm_sim_pdma_reset(void){
+	memset(sm_sim_reg(PDMA_BASE), 0, SM_SIM_PDMA_SIZE);
+	memset(&g_pdma, 0, sizeof(g_pdma));
+	for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++)
+		g_pdma.m_ch[ch].m_tout_at = SM_SIM_EVENT_NONE;
+	sm_sim_pdma_refresh();
+}
+
+static void sm_sim_pdma_write(uint32_t _addr, uint32_t _value){
+	PDMA_T* regs = sm_sim_pdma_regs();
+	uint32_t offset = _addr - PDMA_BASE;
+
+	if(offset < sizeof(DSCT_T) * SM_SIM_PDMA_CH_NUM){
+		uint8_t ch = (uint8_t)(offset / sizeof(DSCT_T));
+
+		if(offset % sizeof(DSCT_T) != offsetof(DSCT_T, CTL))
+			return;
+
+		/* Written in scatter-gather mode, DSCT is only the link to the first table */
+		sm_sim_pdma_table_load(ch);
+		if(sm_sim_pdma_opmode(ch) == PDMA_OP_SCATTER)
+			g_pdma.m_ch[ch].m_index = g_pdma.m_ch[ch].m_total = 0;
+		return;
+	}
+
+	switch(offset){
+	case offsetof(PDMA_T, SWREQ):
+		for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+			if((_value & (1UL << ch)) && !g_pdma.m_ch[ch].m_busy)
+				sm_sim_pdma_mem_start(ch, sm_sim_now());
+		}
+		regs->SWREQ = 0;
+		break;
+
+	case offsetof(PDMA_T, CHRST):
+		for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+			if(_value & (1UL << ch)){
+				g_pdma.m_ch[ch].m_busy = 0;
+				g_pdma.m_ch[ch].m_index = g_pdma.m_ch[ch].m_total;
+			}
+		}
+		regs->CHRST = 0;
+		break;
+
+	case offsetof(PDMA_T, CHCTL):
+		/* Disabling a channel abandons its table */
+		for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+			if(!(_value & (1UL << ch)))
+				g_pdma.m_ch[ch].m_busy = 0;
+		}
+		break;
+
+	case offsetof(PDMA_T, TDSTS):
+		g_pdma.m_tdsts &= ~_value;
+		break;
+
+	case offsetof(PDMA_T, ABTSTS):
+		g_pdma.m_abtsts &= ~_value;
+		break;
+
+	case offsetof(PDMA_T, INTSTS):
+		g_pdma.m_reqtof &= ~(_value >> PDMA_INTSTS_REQTOF0_Pos);
+		break;
+
+	case offsetof(PDMA_T, TOUTEN):
+		/* Turning it on starts the count, turning it off stops it */
+		for(uint8_t ch = 0; ch < SM_SIM_PDMA_TOUT_CH_NUM; ch++){
+			uint8_t on = (_value >> ch) & 1;
+
+			if(!on || g_pdma.m_ch[ch].m_tout_at == SM_SIM_EVENT_NONE)
+				sm_sim_pdma_tout_restart(ch, sm_sim_now());
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_pdma_refresh();
+}
+
+static uint64_t sm_sim_pdma_next_event(void){
+	uint64_t next = SM_SIM_EVENT_NONE;
+
+	for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+		if(g_pdma.m_ch[ch].m_busy && g_pdma.m_ch[ch].m_done < next)
+			next = g_pdma.m_ch[ch].m_done;
+		if(g_pdma.m_ch[ch].m_tout_at < next)
+			next = g_pdma.m_ch[ch].m_tout_at;
+	}
+	return next;
+}
+
+static void sm_sim_pdma_update(uint64_t _now){
+	for(uint8_t ch = 0; ch < SM_SIM_PDMA_CH_NUM; ch++){
+		sm_sim_pdma_ch_t* state = &g_pdma.m_ch[ch];
+
+		while(state->m_busy && state->m_done <= _now){
+			uint64_t done = state->m_done;
+
+			while(state->m_index < state->m_total)
+				sm_sim_pdma_beat(ch);
+			sm_sim_pdma_table_done(ch);
+
+			/* A memory scatter-gather list runs on without a new request */
+			sm_sim_pdma_mem_start(ch, done);
+		}
+
+		if(state->m_tout_at <= _now){
+			state->m_tout_at = SM_SIM_EVENT_NONE;
+			g_pdma.m_reqtof |= 1UL << ch;
+		}
+	}
+
+	sm_sim_pdma_refresh();
+}
+
+const sm_sim_model_t g_sm_sim_pdma = {
+		.m_name = "PDMA",
+		.m_base = PDMA_BASE,
+		.m_size = SM_SIM_PDMA_SIZE,
+		.m_reset = sm_sim_pdma_reset,
+		.m_write = sm_sim_pdma_write,
+		.m_next_event = sm_sim_pdma_next_event,
+		.m_update = sm_sim_pdma_update,
+};
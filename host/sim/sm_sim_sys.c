@@ -0,0 +1,158 @@
+/*
+ * sm_sim_sys.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <string.h>
+
+/*
+ * SYS and CLK: register write protection, module resets and the clock tree the
+ * other models count with. Oscillators are stable as soon as they are enabled.
+ */
+
+#define SM_SIM_SYS_SIZE               0x400UL
+
+#define SM_SIM_CLK_STABLE             (CLK_STATUS_HXTSTB_Msk | CLK_STATUS_LXTSTB_Msk | CLK_STATUS_LIRCSTB_Msk | \
+		CLK_STATUS_HIRCSTB_Msk | CLK_STATUS_MIRCSTB_Msk)
+
+extern const uint32_t gau32ClkSrcTbl[];
+
+typedef struct sm_sim_sys_impl{
+	uint8_t m_unlock_step;
+	uint32_t m_iprst[3];
+}sm_sim_sys_impl_t;
+
+static sm_sim_sys_impl_t g_sys;
+
+uint32_t sm_sim_clk_hclk(void){
+	CLK_T* clk = SM_SIM_REG(CLK_T, CLK_BASE);
+	uint32_t src = (clk->CLKSEL0 & CLK_CLKSEL0_HCLKSEL_Msk) >> CLK_CLKSEL0_HCLKSEL_Pos;
+
+	return gau32ClkSrcTbl[src] / (((clk->CLKDIV0 & CLK_CLKDIV0_HCLKDIV_Msk) >> CLK_CLKDIV0_HCLKDIV_Pos) + 1);
+}
+
+uint32_t sm_sim_clk_pclk(uint8_t _apb){
+	uint32_t div = SM_SIM_REG(CLK_T, CLK_BASE)->PCLKDIV;
+
+	div = _apb ? (div & CLK_PCLKDIV_APB1DIV_Msk) >> CLK_PCLKDIV_APB1DIV_Pos :
+			(div & CLK_PCLKDIV_APB0DIV_Msk) >> CLK_PCLKDIV_APB0DIV_Pos;
+	return sm_sim_clk_hclk() >> div;
+}
+
+/* Same source tables as UART_Open() and TIMER_GetModuleClock() */
+uint32_t sm_sim_clk_uart(uint8_t _uart){
+	CLK_T* clk = SM_SIM_REG(CLK_T, CLK_BASE);
+	uint32_t table[6] = {__HXT, 0, __LXT, __HIRC, sm_sim_clk_pclk(_uart & 1), __LIRC};
+	uint32_t src, div;
+
+	switch(_uart){
+	case 0:
+		src = (clk->CLKSEL1 & CLK_CLKSEL1_UART0SEL_Msk) >> CLK_CLKSEL1_UART0SEL_Pos;
+		div = (clk->CLKDIV0 & CLK_CLKDIV0_UART0DIV_Msk) >> CLK_CLKDIV0_UART0DIV_Pos;
+		break;
+	case 1:
+		src = (clk->CLKSEL1 & CLK_CLKSEL1_UART1SEL_Msk) >> CLK_CLKSEL1_UART1SEL_Pos;
+		div = (clk->CLKDIV0 & CLK_CLKDIV0_UART1DIV_Msk) >> CLK_CLKDIV0_UART1DIV_Pos;
+		break;
+	case 2:
+		src = (clk->CLKSEL3 & CLK_CLKSEL3_UART2SEL_Msk) >> CLK_CLKSEL3_UART2SEL_Pos;
+		div = (clk->CLKDIV4 & CLK_CLKDIV4_UART2DIV_Msk) >> CLK_CLKDIV4_UART2DIV_Pos;
+		break;
+	case 3:
+		src = (clk->CLKSEL3 & CLK_CLKSEL3_UART3SEL_Msk) >> CLK_CLKSEL3_UART3SEL_Pos;
+		div = (clk->CLKDIV4 & CLK_CLKDIV4_UART3DIV_Msk) >> CLK_CLKDIV4_UART3DIV_Pos;
+		break;
+	default:
+		src = (clk->CLKSEL3 & CLK_CLKSEL3_UART4SEL_Msk) >> CLK_CLKSEL3_UART4SEL_Pos;
+		div = (clk->CLKDIV4 & CLK_CLKDIV4_UART4DIV_Msk) >> CLK_CLKDIV4_UART4DIV_Pos;
+		break;
+	}
+
+	return src < 6 ? table[src] / (div + 1) : 0;
+}
+
+uint32_t sm_sim_clk_timer(uint8_t _timer){
+	uint32_t table[8] = {__HXT, __LXT, sm_sim_clk_pclk(_timer >> 1), 0, 0, __LIRC, 0, __HIRC};
+	uint32_t sel = SM_SIM_REG(CLK_T, CLK_BASE)->CLKSEL1;
+
+	return table[(sel >> (CLK_CLKSEL1_TMR0SEL_Pos + _timer * 4)) & 0x7];
+}
+
+static void sm_sim_sys_reset(void){
+	memset(sm_sim_reg(SYS_BASE), 0, SM_SIM_SYS_SIZE);
+	memset(&g_sys, 0, sizeof(g_sys));
+
+	CLK_T* clk = SM_SIM_REG(CLK_T, CLK_BASE);
+	clk->PWRCTL = CLK_PWRCTL_HIRCEN_Msk | CLK_PWRCTL_LIRCEN_Msk;
+	clk->CLKSEL0 = CLK_CLKSEL0_HCLKSEL_HIRC | CLK_CLKSEL0_STCLKSEL_HIRC_DIV2;
+	clk->CLKSEL1 = CLK_CLKSEL1_TMR0SEL_HIRC | CLK_CLKSEL1_TMR1SEL_HIRC | CLK_CLKSEL1_TMR2SEL_HIRC |
+			CLK_CLKSEL1_TMR3SEL_HIRC | CLK_CLKSEL1_UART0SEL_HIRC | CLK_CLKSEL1_UART1SEL_HIRC;
+	clk->CLKSEL3 = CLK_CLKSEL3_UART2SEL_HIRC | CLK_CLKSEL3_UART3SEL_HIRC | CLK_CLKSEL3_UART4SEL_HIRC;
+	SM_SIM_RO(clk->STATUS) = SM_SIM_CLK_STABLE;
+}
+
+static void sm_sim_sys_write(uint32_t _addr, uint32_t _value){
+	SYS_T* sys = SM_SIM_REG(SYS_T, SYS_BASE);
+
+	if(_addr == SM_SIM_ADDR(&SYS->REGLCTL)){
+		/* 0x59, 0x16, 0x88 in a row unlock, anything else locks */
+		static const uint8_t key[3] = {0x59, 0x16, 0x88};
+
+		if(_value == key[g_sys.m_unlock_step]){
+			g_sys.m_unlock_step++;
+		}else{
+			g_sys.m_unlock_step = _value == key[0] ? 1 : 0;
+		}
+
+		sys->REGLCTL = g_sys.m_unlock_step == 3;
+		if(g_sys.m_unlock_step == 3)
+			g_sys.m_unlock_step = 0;
+		return;
+	}
+
+	for(uint32_t i = 0; i < 3; i++){
+		if(_addr != SM_SIM_ADDR(&SYS->IPRST0) + i * 4)
+			continue;
+
+		uint32_t rising = _value & ~g_sys.m_iprst[i];
+		g_sys.m_iprst[i] = _value;
+
+		if(i == 0 && (rising & SYS_IPRST0_PDMARST_Msk))
+			g_sm_sim_pdma.m_reset();
+		if(i == 0 && (rising & SYS_IPRST0_CRCRST_Msk))
+			g_sm_sim_crc.m_reset();
+
+		if(i == 1){
+			for(uint8_t n = 0; n < 4; n++){
+				if(rising & (SYS_IPRST1_TMR0RST_Msk << n))
+					sm_sim_timer_module_reset(n);
+			}
+			for(uint8_t n = 0; n < SM_SIM_UART_NUM; n++){
+				if(rising & (SYS_IPRST1_UART0RST_Msk << n))
+					sm_sim_uart_module_reset(n);
+			}
+			if(rising & SYS_IPRST1_CANFD0RST_Msk)
+				g_sm_sim_canfd.m_reset();
+			if(rising & SYS_IPRST1_EADCRST_Msk)
+				g_sm_sim_eadc.m_reset();
+		}
+		return;
+	}
+
+	if(_addr == SM_SIM_ADDR(&CLK->STATUS)){
+		SM_SIM_RO(SM_SIM_REG(CLK_T, CLK_BASE)->STATUS) = SM_SIM_CLK_STABLE;
+		return;
+	}
+}
+
+const sm_sim_model_t g_sm_sim_sys = {
+		.m_name = "SYS",
+		.m_base = SYS_BASE,
+		.m_size = SM_SIM_SYS_SIZE,
+		.m_reset = sm_sim_sys_reset,
+		.m_write = sm_sim_sys_write,
+};
@@ -0,0 +1,213 @@
+/*
+ * sm_sim_timer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * TIMER0..3: the 24 bit up counter in one-shot, periodic, toggle and
+ * continuous mode, TIF with its interrupt and the EADC/PDMA triggers on a
+ * compare match. CNT is computed from virtual time when read. No capture,
+ * event counting or PWM function.
+ */
+
+#define SM_SIM_TIMER_NUM              4
+#define SM_SIM_TIMER_SIZE             0x1200UL
+#define SM_SIM_TIMER_CNT_MAX          0x1000000ULL
+
+typedef struct sm_sim_timer_unit{
+	uint8_t m_running;
+	uint32_t m_hz;
+	uint64_t m_base;              /* time at which the counter was m_base_cnt */
+	uint32_t m_base_cnt;
+	uint64_t m_match;             /* time of the next compare match */
+	uint32_t m_intsts;
+}sm_sim_timer_unit_t;
+
+static sm_sim_timer_unit_t g_timer[SM_SIM_TIMER_NUM];
+
+static const uint32_t g_timer_base[SM_SIM_TIMER_NUM] = {TIMER01_BASE, TIMER01_BASE + 0x100UL,
+		TIMER23_BASE, TIMER23_BASE + 0x100UL};
+
+static TIMER_T* sm_sim_timer_regs(uint8_t _timer){
+	return SM_SIM_REG(TIMER_T, g_timer_base[_timer]);
+}
+
+static int32_t sm_sim_timer_index(uint32_t _addr){
+	for(uint8_t i = 0; i < SM_SIM_TIMER_NUM; i++){
+		if(_addr >= g_timer_base[i] && _addr - g_timer_base[i] < 0x100UL)
+			return i;
+	}
+	return -1;
+}
+
+static uint32_t sm_sim_timer_cmp(uint8_t _timer){
+	uint32_t cmp = sm_sim_timer_regs(_timer)->CMP & TIMER_CMP_CMPDAT_Msk;
+
+	/* 0 and 1 are not valid compare values */
+	return cmp < 2 ? 2 : cmp;
+}
+
+static uint32_t sm_sim_timer_count(uint8_t _timer, uint64_t _now){
+	sm_sim_timer_unit_t* unit = &g_timer[_timer];
+
+	if(!unit->m_running)
+		return unit->m_base_cnt;
+
+	return (uint32_t)((unit->m_base_cnt + sm_sim_ns_to_cycles(_now - unit->m_base, unit->m_hz)) % SM_SIM_TIMER_CNT_MAX);
+}
+
+/* Count on from _cnt at _now, with the clock and compare value now in place */
+static void sm_sim_timer_start(uint8_t _timer, uint64_t _now, uint32_t _cnt){
+	TIMER_T* regs = sm_sim_timer_regs(_timer);
+	sm_sim_timer_unit_t* unit = &g_timer[_timer];
+	uint32_t cmp = sm_sim_timer_cmp(_timer);
+	uint64_t ticks;
+
+	unit->m_hz = sm_sim_clk_timer(_timer) / (((regs->CTL & TIMER_CTL_PSC_Msk) >> TIMER_CTL_PSC_Pos) + 1);
+	unit->m_base = _now;
+	unit->m_base_cnt = _cnt;
+	unit->m_running = (regs->CTL & TIMER_CTL_CNTEN_Msk) && unit->m_hz;
+
+	if(!unit->m_running){
+		unit->m_match = SM_SIM_EVENT_NONE;
+		return;
+	}
+
+	ticks = _cnt < cmp ? cmp - _cnt : SM_SIM_TIMER_CNT_MAX - _cnt + cmp;
+	unit->m_match = _now + sm_sim_cycles_to_ns(ticks, unit->m_hz);
+}
+
+static void sm_sim_timer_refresh(uint8_t _timer){
+	TIMER_T* regs = sm_sim_timer_regs(_timer);
+	sm_sim_timer_unit_t* unit = &g_timer[_timer];
+
+	regs->INTSTS = unit->m_intsts;
+	regs->CTL = unit->m_running ? regs->CTL | TIMER_CTL_ACTSTS_Msk : regs->CTL & ~(TIMER_CTL_ACTSTS_Msk | TIMER_CTL_CNTEN_Msk);
+
+	sm_sim_irq_set_level(TMR0_IRQn + _timer, (unit->m_intsts & TIMER_INTSTS_TIF_Msk) && (regs->CTL & TIMER_CTL_INTEN_Msk));
+}
+
+void sm_sim_timer_module_reset(uint8_t _timer){
+	if(_timer >= SM_SIM_TIMER_NUM)
+		return;
+
+	memset(sm_sim_timer_regs(_timer), 0, 0x100UL);
+	memset(&g_timer[_timer], 0, sizeof(g_timer[_timer]));
+	g_timer[_timer].m_match = SM_SIM_EVENT_NONE;
+	sm_sim_timer_refresh(_timer);
+}
+
+static void sm_sim_timer_reset(void){
+	for(uint8_t i = 0; i < SM_SIM_TIMER_NUM; i++)
+		sm_sim_timer_module_reset(i);
+}
+
+static void sm_sim_timer_read(uint32_t _addr, uint8_t _is_write){
+	int32_t timer = sm_sim_timer_index(_addr);
+	(void)_is_write;
+
+	if(timer < 0)
+		return;
+
+	if(_addr - g_timer_base[timer] == offsetof(TIMER_T, CNT))
+		sm_sim_timer_regs((uint8_t)timer)->CNT = sm_sim_timer_count((uint8_t)timer, sm_sim_now());
+}
+
+static void sm_sim_timer_write(uint32_t _addr, uint32_t _value){
+	int32_t timer = sm_sim_timer_index(_addr);
+
+	if(timer < 0)
+		return;
+
+	uint8_t n = (uint8_t)timer;
+	uint64_t now = sm_sim_now();
+	sm_sim_timer_unit_t* unit = &g_timer[n];
+	uint32_t cnt = sm_sim_timer_count(n, now);
+
+	switch(_addr - g_timer_base[n]){
+	case offsetof(TIMER_T, CTL):
+		sm_sim_timer_start(n, now, cnt);
+		break;
+
+	case offsetof(TIMER_T, CMP):
+		/* A new compare value restarts the count, except in continuous mode */
+		if((sm_sim_timer_regs(n)->CTL & TIMER_CTL_OPMODE_Msk) != TIMER_CONTINUOUS_MODE)
+			cnt = 0;
+		sm_sim_timer_start(n, now, cnt);
+		break;
+
+	case offsetof(TIMER_T, CNT):
+		sm_sim_timer_start(n, now, 0);
+		sm_sim_timer_regs(n)->CNT = 0;
+		break;
+
+	case offsetof(TIMER_T, INTSTS):
+		unit->m_intsts &= ~_value;
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_timer_refresh(n);
+}
+
+static uint64_t sm_sim_timer_next_event(void){
+	uint64_t next = SM_SIM_EVENT_NONE;
+
+	for(uint8_t i = 0; i < SM_SIM_TIMER_NUM; i++){
+		if(g_timer[i].m_running && g_timer[i].m_match < next)
+			next = g_timer[i].m_match;
+	}
+	return next;
+}
+
+static void sm_sim_timer_update(uint64_t _now){
+	for(uint8_t i = 0; i < SM_SIM_TIMER_NUM; i++){
+		TIMER_T* regs = sm_sim_timer_regs(i);
+		sm_sim_timer_unit_t* unit = &g_timer[i];
+
+		if(!unit->m_running || unit->m_match > _now)
+			continue;
+
+		uint64_t match = unit->m_match;
+		uint32_t mode = regs->CTL & TIMER_CTL_OPMODE_Msk;
+
+		unit->m_intsts |= TIMER_INTSTS_TIF_Msk;
+
+		if(mode == TIMER_ONESHOT_MODE){
+			regs->CTL &= ~TIMER_CTL_CNTEN_Msk;
+			sm_sim_timer_start(i, match, 0);
+		}else{
+			/* Matches the handler could not keep up with collapse into one */
+			sm_sim_timer_start(i, match, mode == TIMER_CONTINUOUS_MODE ? sm_sim_timer_cmp(i) : 0);
+			while(unit->m_match <= _now)
+				sm_sim_timer_start(i, unit->m_match, mode == TIMER_CONTINUOUS_MODE ? sm_sim_timer_cmp(i) : 0);
+		}
+
+		sm_sim_timer_refresh(i);
+
+		if(regs->TRGCTL & TIMER_TRGCTL_TRGEADC_Msk)
+			sm_sim_eadc_timer_trigger(i);
+		if(regs->TRGCTL & TIMER_TRGCTL_TRGPDMA_Msk)
+			sm_sim_pdma_request((uint8_t)(PDMA_TMR0 + i));
+	}
+}
+
+const sm_sim_model_t g_sm_sim_timer = {
+		.m_name = "TIMER",
+		.m_base = TIMER01_BASE,
+		.m_size = SM_SIM_TIMER_SIZE,
+		.m_reset = sm_sim_timer_reset,
+		.m_read = sm_sim_timer_read,
+		.m_write = sm_sim_timer_write,
+		.m_next_event = sm_sim_timer_next_event,
+		.m_update = sm_sim_timer_update,
+};
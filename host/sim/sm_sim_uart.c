@@ -0,0 +1,410 @@
+/*
+ * sm_sim_uart.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: lekhacvuong
+ */
+
+#include "sm_sim_internal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * UART0..4: 16 byte FIFOs shifting one character per frame time at the
+ * programmed baud rate, RX timeout, the RDA/THRE/RXTO/TXEND interrupts and the
+ * PDMA requests. Bytes sent by the firmware are kept for sm_sim_uart_take()
+ * and passed to the TX hook; bytes injected by the test queue on the line.
+ */
+
+#define SM_SIM_UART_STRIDE            0x1000UL
+#define SM_SIM_UART_FIFO_SIZE         16
+#define SM_SIM_UART_LINE_SIZE         4096
+#define SM_SIM_UART_CAPTURE_SIZE      4096
+
+typedef struct sm_sim_uart_fifo{
+	uint8_t m_buf[SM_SIM_UART_FIFO_SIZE];
+	uint8_t m_head;
+	uint8_t m_count;
+}sm_sim_uart_fifo_t;
+
+typedef struct sm_sim_uart_port{
+	sm_sim_uart_fifo_t m_rx;
+	sm_sim_uart_fifo_t m_tx;
+	uint32_t m_fifosts;           /* sticky error flags */
+	uint32_t m_intsts;            /* sticky interrupt flags */
+
+	uint8_t m_line[SM_SIM_UART_LINE_SIZE];
+	uint32_t m_line_head;
+	uint32_t m_line_count;
+	uint64_t m_rx_next;           /* next injected byte fully received */
+	uint64_t m_rx_last;           /* last RX FIFO activity, for the timeout */
+
+	uint8_t m_tx_busy;
+	uint8_t m_tx_shift;
+	uint64_t m_tx_done;
+
+	uint8_t m_capture[SM_SIM_UART_CAPTURE_SIZE];
+	uint32_t m_capture_head;
+	uint32_t m_capture_count;
+	sm_sim_uart_tx_fn_t m_hook;
+	void* m_hook_arg;
+
+	uint8_t m_in_pdma;
+}sm_sim_uart_port_t;
+
+static sm_sim_uart_port_t g_uart[SM_SIM_UART_NUM];
+
+static const int32_t g_uart_irqn[SM_SIM_UART_NUM] = {UART0_IRQn, UART1_IRQn, UART2_IRQn, UART3_IRQn, UART4_IRQn};
+
+static UART_T* sm_sim_uart_regs(uint8_t _uart){
+	return SM_SIM_REG(UART_T, UART0_BASE + _uart * SM_SIM_UART_STRIDE);
+}
+
+static uint8_t sm_sim_uart_fifo_push(sm_sim_uart_fifo_t* _fifo, uint8_t _byte){
+	if(_fifo->m_count == SM_SIM_UART_FIFO_SIZE)
+		return 0;
+
+	_fifo->m_buf[(_fifo->m_head + _fifo->m_count) % SM_SIM_UART_FIFO_SIZE] = _byte;
+	_fifo->m_count++;
+	return 1;
+}
+
+static uint8_t sm_sim_uart_fifo_pop(sm_sim_uart_fifo_t* _fifo){
+	uint8_t byte = _fifo->m_buf[_fifo->m_head];
+
+	_fifo->m_head = (uint8_t)((_fifo->m_head + 1) % SM_SIM_UART_FIFO_SIZE);
+	_fifo->m_count--;
+	return byte;
+}
+
+static uint64_t sm_sim_uart_bit_ns(uint8_t _uart){
+	UART_T* regs = sm_sim_uart_regs(_uart);
+	uint32_t clk = sm_sim_clk_uart(_uart);
+	uint32_t brd = (regs->BAUD & UART_BAUD_BRD_Msk) + 2;
+	uint32_t baud;
+
+	if((regs->BAUD & (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk)) == (UART_BAUD_BAUDM1_Msk | UART_BAUD_BAUDM0_Msk)){
+		baud = clk / brd;
+	}else if(regs->BAUD & UART_BAUD_BAUDM1_Msk){
+		baud = clk / ((((regs->BAUD & UART_BAUD_EDIVM1_Msk) >> UART_BAUD_EDIVM1_Pos) + 1) * brd);
+	}else{
+		baud = clk / (16 * brd);
+	}
+
+	return baud ? SM_SIM_NS_PER_S / baud : SM_SIM_NS_PER_US;
+}
+
+/* Start + data + parity + stop bits */
+static uint64_t sm_sim_uart_char_ns(uint8_t _uart){
+	uint32_t line = sm_sim_uart_regs(_uart)->LINE;
+	uint32_t bits = 1 + 5 + (line & UART_LINE_WLS_Msk) + ((line & UART_LINE_PBE_Msk) ? 1 : 0) +
+			((line & UART_LINE_NSB_Msk) ? 2 : 1);
+
+	return bits * sm_sim_uart_bit_ns(_uart);
+}
+
+static uint64_t sm_sim_uart_timeout_at(uint8_t _uart){
+	UART_T* regs = sm_sim_uart_regs(_uart);
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+
+	if(!(regs->INTEN & UART_INTEN_TOCNTEN_Msk) || !port->m_rx.m_count)
+		return SM_SIM_EVENT_NONE;
+
+	return port->m_rx_last + ((regs->TOUT & UART_TOUT_TOIC_Msk) >> UART_TOUT_TOIC_Pos) * sm_sim_uart_bit_ns(_uart);
+}
+
+static const uint8_t g_uart_rx_level[4] = {1, 4, 8, 14};
+
+static void sm_sim_uart_refresh(uint8_t _uart){
+	UART_T* regs = sm_sim_uart_regs(_uart);
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+	uint32_t fifosts = port->m_fifosts;
+	uint32_t intsts = port->m_intsts;
+	uint32_t inten = regs->INTEN;
+
+	fifosts |= (uint32_t)port->m_rx.m_count << UART_FIFOSTS_RXPTR_Pos;
+	fifosts |= (uint32_t)port->m_tx.m_count << UART_FIFOSTS_TXPTR_Pos;
+	if(!port->m_rx.m_count)
+		fifosts |= UART_FIFOSTS_RXEMPTY_Msk;
+	if(port->m_rx.m_count == SM_SIM_UART_FIFO_SIZE)
+		fifosts |= UART_FIFOSTS_RXFULL_Msk | (0x0FUL << UART_FIFOSTS_RXPTR_Pos);
+	if(!port->m_tx.m_count)
+		fifosts |= UART_FIFOSTS_TXEMPTY_Msk;
+	if(port->m_tx.m_count == SM_SIM_UART_FIFO_SIZE)
+		fifosts |= UART_FIFOSTS_TXFULL_Msk | (0x0FUL << UART_FIFOSTS_TXPTR_Pos);
+	if(!port->m_tx.m_count && !port->m_tx_busy)
+		fifosts |= UART_FIFOSTS_TXEMPTYF_Msk;
+	if(!port->m_line_count)
+		fifosts |= UART_FIFOSTS_RXIDLE_Msk;
+
+	if(port->m_rx.m_count >= g_uart_rx_level[(regs->FIFO & UART_FIFO_RFITL_Msk) >> UART_FIFO_RFITL_Pos])
+		intsts |= UART_INTSTS_RDAIF_Msk;
+	if(!port->m_tx.m_count)
+		intsts |= UART_INTSTS_THREIF_Msk;
+	if(sm_sim_uart_timeout_at(_uart) <= sm_sim_now())
+		intsts |= UART_INTSTS_RXTOIF_Msk;
+	if(!port->m_tx.m_count && !port->m_tx_busy)
+		intsts |= UART_INTSTS_TXENDIF_Msk;
+	if(fifosts & (UART_FIFOSTS_RXOVIF_Msk | UART_FIFOSTS_TXOVIF_Msk))
+		intsts |= UART_INTSTS_BUFERRIF_Msk;
+
+	if((intsts & UART_INTSTS_RDAIF_Msk) && (inten & UART_INTEN_RDAIEN_Msk))
+		intsts |= UART_INTSTS_RDAINT_Msk;
+	if((intsts & UART_INTSTS_THREIF_Msk) && (inten & UART_INTEN_THREIEN_Msk))
+		intsts |= UART_INTSTS_THREINT_Msk;
+	if((intsts & UART_INTSTS_RXTOIF_Msk) && (inten & UART_INTEN_RXTOIEN_Msk))
+		intsts |= UART_INTSTS_RXTOINT_Msk;
+	if((intsts & UART_INTSTS_BUFERRIF_Msk) && (inten & UART_INTEN_BUFERRIEN_Msk))
+		intsts |= UART_INTSTS_BUFERRINT_Msk;
+	if((intsts & UART_INTSTS_TXENDIF_Msk) && (inten & UART_INTEN_TXENDIEN_Msk))
+		intsts |= UART_INTSTS_TXENDINT_Msk;
+
+	regs->FIFOSTS = fifosts;
+	regs->INTSTS = intsts;
+
+	sm_sim_irq_set_level(g_uart_irqn[_uart], (intsts & (UART_INTSTS_RDAINT_Msk | UART_INTSTS_THREINT_Msk |
+			UART_INTSTS_RXTOINT_Msk | UART_INTSTS_BUFERRINT_Msk | UART_INTSTS_TXENDINT_Msk)) != 0);
+}
+
+static void sm_sim_uart_tx_start(uint8_t _uart){
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+
+	if(port->m_tx_busy || !port->m_tx.m_count)
+		return;
+
+	port->m_tx_shift = sm_sim_uart_fifo_pop(&port->m_tx);
+	port->m_tx_busy = 1;
+	port->m_tx_done = sm_sim_now() + sm_sim_uart_char_ns(_uart);
+}
+
+/* Let PDMA move data while it has a channel on this UART */
+static void sm_sim_uart_pdma(uint8_t _uart){
+	UART_T* regs = sm_sim_uart_regs(_uart);
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+
+	if(port->m_in_pdma)
+		return;
+
+	port->m_in_pdma = 1;
+
+	if(regs->INTEN & UART_INTEN_RXPDMAEN_Msk){
+		while(port->m_rx.m_count && sm_sim_pdma_request((uint8_t)(PDMA_UART0_RX + _uart * 2)) > 0){}
+	}
+	if(regs->INTEN & UART_INTEN_TXPDMAEN_Msk){
+		while(port->m_tx.m_count < SM_SIM_UART_FIFO_SIZE &&
+				sm_sim_pdma_request((uint8_t)(PDMA_UART0_TX + _uart * 2)) > 0){}
+	}
+
+	port->m_in_pdma = 0;
+}
+
+static void sm_sim_uart_port_reset(uint8_t _uart){
+	UART_T* regs = sm_sim_uart_regs(_uart);
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+	sm_sim_uart_tx_fn_t hook = port->m_hook;
+	void* hook_arg = port->m_hook_arg;
+
+	memset(regs, 0, SM_SIM_UART_STRIDE);
+	memset(&port->m_rx, 0, sizeof(port->m_rx));
+	memset(&port->m_tx, 0, sizeof(port->m_tx));
+	port->m_fifosts = 0;
+	port->m_intsts = 0;
+	port->m_tx_busy = 0;
+	port->m_in_pdma = 0;
+	port->m_hook = hook;
+	port->m_hook_arg = hook_arg;
+
+	regs->TOUT = 0x00000020UL;
+	regs->BAUD = 0x0F000000UL;
+	sm_sim_uart_refresh(_uart);
+}
+
+void sm_sim_uart_module_reset(uint8_t _uart){
+	if(_uart < SM_SIM_UART_NUM)
+		sm_sim_uart_port_reset(_uart);
+}
+
+static void sm_sim_uart_reset(void){
+	memset(g_uart, 0, sizeof(g_uart));
+
+	for(uint8_t i = 0; i < SM_SIM_UART_NUM; i++)
+		sm_sim_uart_port_reset(i);
+}
+
+static void sm_sim_uart_read(uint32_t _addr, uint8_t _is_write){
+	uint8_t uart = (uint8_t)((_addr - UART0_BASE) / SM_SIM_UART_STRIDE);
+	uint32_t offset = (_addr - UART0_BASE) % SM_SIM_UART_STRIDE;
+	sm_sim_uart_port_t* port = &g_uart[uart];
+
+	if(uart >= SM_SIM_UART_NUM)
+		return;
+
+	if(offset == offsetof(UART_T, DAT) && !_is_write){
+		if(port->m_rx.m_count){
+			sm_sim_uart_regs(uart)->DAT = sm_sim_uart_fifo_pop(&port->m_rx);
+			port->m_rx_last = sm_sim_now();
+		}
+	}
+
+	sm_sim_uart_refresh(uart);
+}
+
+static void sm_sim_uart_write(uint32_t _addr, uint32_t _value){
+	uint8_t uart = (uint8_t)((_addr - UART0_BASE) / SM_SIM_UART_STRIDE);
+	uint32_t offset = (_addr - UART0_BASE) % SM_SIM_UART_STRIDE;
+
+	if(uart >= SM_SIM_UART_NUM)
+		return;
+
+	UART_T* regs = sm_sim_uart_regs(uart);
+	sm_sim_uart_port_t* port = &g_uart[uart];
+
+	switch(offset){
+	case offsetof(UART_T, DAT):
+		if(!sm_sim_uart_fifo_push(&port->m_tx, (uint8_t)_value))
+			port->m_fifosts |= UART_FIFOSTS_TXOVIF_Msk;
+		sm_sim_uart_tx_start(uart);
+		break;
+
+	case offsetof(UART_T, FIFO):
+		if(_value & UART_FIFO_RXRST_Msk)
+			memset(&port->m_rx, 0, sizeof(port->m_rx));
+		if(_value & UART_FIFO_TXRST_Msk)
+			memset(&port->m_tx, 0, sizeof(port->m_tx));
+		regs->FIFO = _value & ~(UART_FIFO_RXRST_Msk | UART_FIFO_TXRST_Msk);
+		break;
+
+	case offsetof(UART_T, FIFOSTS):
+		port->m_fifosts &= ~_value;
+		break;
+
+	case offsetof(UART_T, INTSTS):
+		port->m_intsts &= ~_value;
+		break;
+
+	default:
+		break;
+	}
+
+	sm_sim_uart_refresh(uart);
+	sm_sim_uart_pdma(uart);
+	sm_sim_uart_refresh(uart);
+}
+
+static uint64_t sm_sim_uart_next_event(void){
+	uint64_t next = SM_SIM_EVENT_NONE;
+
+	for(uint8_t i = 0; i < SM_SIM_UART_NUM; i++){
+		sm_sim_uart_port_t* port = &g_uart[i];
+		uint64_t timeout = sm_sim_uart_timeout_at(i);
+
+		if(port->m_tx_busy && port->m_tx_done < next)
+			next = port->m_tx_done;
+		if(port->m_line_count && port->m_rx_next < next)
+			next = port->m_rx_next;
+		if(timeout > sm_sim_now() && timeout < next)
+			next = timeout;
+	}
+	return next;
+}
+
+static void sm_sim_uart_update(uint64_t _now){
+	for(uint8_t i = 0; i < SM_SIM_UART_NUM; i++){
+		sm_sim_uart_port_t* port = &g_uart[i];
+
+		while(port->m_tx_busy && port->m_tx_done <= _now){
+			uint8_t byte = port->m_tx_shift;
+
+			port->m_capture[(port->m_capture_head + port->m_capture_count) % SM_SIM_UART_CAPTURE_SIZE] = byte;
+			if(port->m_capture_count < SM_SIM_UART_CAPTURE_SIZE){
+				port->m_capture_count++;
+			}else{
+				port->m_capture_head = (port->m_capture_head + 1) % SM_SIM_UART_CAPTURE_SIZE;
+			}
+
+			port->m_tx_busy = 0;
+			if(port->m_tx.m_count){
+				/* Back to back: the next frame starts when this one ends */
+				port->m_tx_shift = sm_sim_uart_fifo_pop(&port->m_tx);
+				port->m_tx_busy = 1;
+				port->m_tx_done += sm_sim_uart_char_ns(i);
+			}
+
+			if(port->m_hook)
+				port->m_hook(i, byte, port->m_hook_arg);
+		}
+
+		while(port->m_line_count && port->m_rx_next <= _now){
+			uint8_t byte = port->m_line[port->m_line_head];
+
+			port->m_line_head = (port->m_line_head + 1) % SM_SIM_UART_LINE_SIZE;
+			port->m_line_count--;
+
+			if(!sm_sim_uart_fifo_push(&port->m_rx, byte))
+				port->m_fifosts |= UART_FIFOSTS_RXOVIF_Msk;
+
+			port->m_rx_last = port->m_rx_next;
+			port->m_rx_next += sm_sim_uart_char_ns(i);
+		}
+
+		sm_sim_uart_refresh(i);
+		sm_sim_uart_pdma(i);
+		sm_sim_uart_refresh(i);
+	}
+}
+
+const sm_sim_model_t g_sm_sim_uart = {
+		.m_name = "UART",
+		.m_base = UART0_BASE,
+		.m_size = SM_SIM_UART_NUM * SM_SIM_UART_STRIDE,
+		.m_reset = sm_sim_uart_reset,
+		.m_read = sm_sim_uart_read,
+		.m_write = sm_sim_uart_write,
+		.m_next_event = sm_sim_uart_next_event,
+		.m_update = sm_sim_uart_update,
+};
+
+int32_t sm_sim_uart_inject(uint8_t _uart, const void* _data, uint32_t _len){
+	if(_uart >= SM_SIM_UART_NUM)
+		return -1;
+
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+	const uint8_t* data = (const uint8_t*)_data;
+
+	if(port->m_line_count + _len > SM_SIM_UART_LINE_SIZE)
+		return -1;
+
+	if(!port->m_line_count)
+		port->m_rx_next = sm_sim_now() + sm_sim_uart_char_ns(_uart);
+
+	for(uint32_t i = 0; i < _len; i++){
+		port->m_line[(port->m_line_head + port->m_line_count) % SM_SIM_UART_LINE_SIZE] = data[i];
+		port->m_line_count++;
+	}
+	return 0;
+}
+
+uint32_t sm_sim_uart_take(uint8_t _uart, void* _buf, uint32_t _max){
+	if(_uart >= SM_SIM_UART_NUM)
+		return 0;
+
+	sm_sim_uart_port_t* port = &g_uart[_uart];
+	uint8_t* buf = (uint8_t*)_buf;
+	uint32_t n = 0;
+
+	while(n < _max && port->m_capture_count){
+		buf[n++] = port->m_capture[port->m_capture_head];
+		port->m_capture_head = (port->m_capture_head + 1) % SM_SIM_UART_CAPTURE_SIZE;
+		port->m_capture_count--;
+	}
+	return n;
+}
+
+void sm_sim_uart_set_tx_hook(uint8_t _uart, sm_sim_uart_tx_fn_t _fn, void* _arg){
+	if(_uart >= SM_SIM_UART_NUM)
+		return;
+
+	g_uart[_uart].m_hook_arg = _arg;
+	g_uart[_uart].m_hook = _fn;
+}
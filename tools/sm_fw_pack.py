@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Pack a firmware image for the in-application updater.
+
+Builds the token stream decoded by User/services/sm_fw_update/sm_fw_decoder.c:
+literals, LZ matches into the last 256 output bytes and, with --old, copies
+from the image currently running on the target (delta update).
+
+    sm_fw_pack.py new.bin payload.bin [--old running.bin]
+
+Prints the BEGIN parameters (decoded size and CRC-32) the sender must use.
+"""
+
+import argparse
+import binascii
+import sys
+
+WINDOW = 256
+MATCH_MIN, MATCH_MAX = 3, 0x3F + 3
+OLD_MIN, OLD_MAX = 8, 0x3FFF + 1
+LITERAL_MAX = 0x80
+OLD_KEY = 8
+
+
+def index_old(old):
+    table = {}
+    for i in range(len(old) - OLD_KEY + 1):
+        table.setdefault(old[i:i + OLD_KEY], []).append(i)
+    return table
+
+
+def match_len(a, ai, b, bi, limit):
+    n = 0
+    while n < limit and ai + n < len(a) and bi + n < len(b) and a[ai + n] == b[bi + n]:
+        n += 1
+    return n
+
+
+def best_old(new, i, old, table, hint):
+    best = (0, 0)
+    if not old:
+        return best
+    limit = min(OLD_MAX, len(new) - i)
+    # The previous copy continued is the most likely candidate in a delta
+    candidates = [hint] if 0 <= hint < len(old) else []
+    candidates += table.get(bytes(new[i:i + OLD_KEY]), [])[:32]
+    for pos in candidates:
+        n = match_len(old, pos, new, i, limit)
+        if n > best[0]:
+            best = (n, pos)
+    return best
+
+
+def best_match(new, i):
+    best = (0, 0)
+    limit = min(MATCH_MAX, len(new) - i)
+    for dist in range(1, min(WINDOW, i) + 1):
+        n = 0
+        while n < limit and new[i + n] == new[i - dist + n]:
+            n += 1
+        if n > best[0]:
+            best = (n, dist)
+            if n == limit:
+                break
+    return best
+
+
+def pack(new, old):
+    out = bytearray()
+    literal = bytearray()
+    table = index_old(old) if old else {}
+    hint = -1
+
+    def flush():
+        while literal:
+            chunk = literal[:LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:LITERAL_MAX]
+
+    i = 0
+    while i < len(new):
+        old_len, old_pos = best_old(new, i, old, table, hint)
+        lz_len, lz_dist = best_match(new, i)
+
+        if old_len >= OLD_MIN and old_len - 5 >= lz_len - 2:
+            flush()
+            n = old_len - 1
+            out += bytes([0xC0 | (n >> 8), n & 0xFF, old_pos & 0xFF, (old_pos >> 8) & 0xFF, old_pos >> 16])
+            i += old_len
+            hint = old_pos + old_len
+        elif lz_len >= MATCH_MIN:
+            flush()
+            out += bytes([0x80 | (lz_len - MATCH_MIN), lz_dist - 1])
+            i += lz_len
+            hint += lz_len
+        else:
+            literal.append(new[i])
+            i += 1
+            hint += 1
+    flush()
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image")
+    parser.add_argument("payload")
+    parser.add_argument("--old", help="image running on the target, for a delta")
+    args = parser.parse_args()
+
+    new = open(args.image, "rb").read()
+    old = open(args.old, "rb").read() if args.old else b""
+    payload = pack(new, old)
+
+    with open(args.payload, "wb") as f:
+        f.write(payload)
+
+    crc = binascii.crc32(new) & 0xFFFFFFFF
+    print("size %d crc32 0x%08X payload %d (%.1f%%)" % (len(new), crc, len(payload),
+                                                      100.0 * len(payload) / max(len(new), 1)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())